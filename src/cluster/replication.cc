@@ -99,6 +99,34 @@ void FeedSlaveThread::checkLivenessIfNeed() {
   }
 }
 
+void FeedSlaveThread::EnqueuePublish(rocksdb::SequenceNumber seq, std::string frame) {
+  std::lock_guard<std::mutex> guard(publish_mu_);
+  if (pending_publish_bytes_ + frame.size() > kMaxPendingPublishBytes) {
+    if (!publish_overflowed_) {
+      LOG(WARNING) << "Too many pending published messages for the slave " << conn_->GetAddr()
+                   << ", would drop the new messages";
+    }
+    publish_overflowed_ = true;
+    return;
+  }
+  publish_overflowed_ = false;
+  pending_publish_bytes_ += frame.size();
+  pending_publish_.emplace_back(seq, std::move(frame));
+}
+
+bool FeedSlaveThread::appendPendingPublish(rocksdb::SequenceNumber next_seq, std::string *bulk) {
+  std::lock_guard<std::mutex> guard(publish_mu_);
+  bool appended = false;
+  while (!pending_publish_.empty() && pending_publish_.front().first < next_seq) {
+    auto &frame = pending_publish_.front().second;
+    pending_publish_bytes_ -= frame.size();
+    bulk->append(frame);
+    pending_publish_.pop_front();
+    appended = true;
+  }
+  return appended;
+}
+
 void FeedSlaveThread::loop() {
   // is_first_repl_batch was used to fix that replication may be stuck in a dead loop
   // when some seqs might be lost in the middle of the WAL log, so forced to replicate
@@ -107,6 +135,26 @@ void FeedSlaveThread::loop() {
   uint32_t yield_microseconds = 2 * 1000;
   std::string batches_bulk;
   size_t updates_in_batches = 0;
+  auto send_batches_bulk = [&]() {
+    auto s = util::SockSend(conn_->GetFD(), batches_bulk, conn_->GetBufferEvent());
+    if (!s.IsOK()) {
+      LOG(ERROR) << "Write error while sending batch to slave: " << s.Msg() << ". batches: 0x"
+                 << util::StringToHex(batches_bulk);
+      Stop();
+      return false;
+    }
+    batches_bulk.clear();
+    if (batches_bulk.capacity() > kMaxDelayBytes * 2) batches_bulk.shrink_to_fit();
+    updates_in_batches = 0;
+    return true;
+  };
+  // The published messages which are forwarded from memory are sent while waiting for new writes,
+  // they must follow the batches before `next_seq` in the ordered mode.
+  auto wait_wal = [&](rocksdb::SequenceNumber next_seq) {
+    usleep(yield_microseconds);
+    checkLivenessIfNeed();
+    if (!IsStopped() && appendPendingPublish(next_seq, &batches_bulk)) send_batches_bulk();
+  };
   while (!IsStopped()) {
     auto curr_seq = next_repl_seq_.load();
 
@@ -114,8 +162,7 @@ void FeedSlaveThread::loop() {
       if (iter_) LOG(INFO) << "WAL was rotated, would reopen again";
       if (!srv_->storage->WALHasNewData(curr_seq) || !srv_->storage->GetWALIter(curr_seq, &iter_).IsOK()) {
         iter_ = nullptr;
-        usleep(yield_microseconds);
-        checkLivenessIfNeed();
+        wait_wal(curr_seq);
         continue;
       }
     }
@@ -129,6 +176,8 @@ void FeedSlaveThread::loop() {
     }
     updates_in_batches += batch.writeBatchPtr->Count();
     batches_bulk += redis::BulkString(batch.writeBatchPtr->Data());
+    curr_seq = batch.sequence + batch.writeBatchPtr->Count();
+    bool has_publish = appendPendingPublish(curr_seq, &batches_bulk);
     // 1. We must send the first replication batch, as said above.
     // 2. To avoid frequently calling 'write' system call to send replication stream,
     //    we pack multiple batches into one big bulk if possible, and only send once.
@@ -138,26 +187,17 @@ void FeedSlaveThread::loop() {
     // 3. To avoid master don't send replication stream to slave since of packing
     //    batches strategy, we still send batches if current batch sequence is less
     //    kMaxDelayUpdates than latest sequence.
-    if (is_first_repl_batch || batches_bulk.size() >= kMaxDelayBytes || updates_in_batches >= kMaxDelayUpdates ||
+    // 4. The published messages are not delayed.
+    if (is_first_repl_batch || has_publish || batches_bulk.size() >= kMaxDelayBytes ||
+        updates_in_batches >= kMaxDelayUpdates ||
         srv_->storage->LatestSeqNumber() - batch.sequence <= kMaxDelayUpdates) {
       // Send entire bulk which contain multiple batches
-      auto s = util::SockSend(conn_->GetFD(), batches_bulk, conn_->GetBufferEvent());
-      if (!s.IsOK()) {
-        LOG(ERROR) << "Write error while sending batch to slave: " << s.Msg() << ". batches: 0x"
-                   << util::StringToHex(batches_bulk);
-        Stop();
-        return;
-      }
+      if (!send_batches_bulk()) return;
       is_first_repl_batch = false;
-      batches_bulk.clear();
-      if (batches_bulk.capacity() > kMaxDelayBytes * 2) batches_bulk.shrink_to_fit();
-      updates_in_batches = 0;
     }
-    curr_seq = batch.sequence + batch.writeBatchPtr->Count();
     next_repl_seq_.store(curr_seq);
     while (!IsStopped() && !srv_->storage->WALHasNewData(curr_seq)) {
-      usleep(yield_microseconds);
-      checkLivenessIfNeed();
+      wait_wal(curr_seq);
     }
     iter_->Next();
   }
@@ -300,6 +340,8 @@ void ReplicationThread::CallbacksStateMachine::Start() {
 
   handler_idx_ = 0;
   repl_->incr_state_ = Incr_batch_size;
+  repl_->incr_command_len_ = 0;
+  repl_->incr_command_.clear();
   if (getHandlerEventType(0) == WRITE) {
     SetWriteCB(bev, EventCallbackFunc<&CallbacksStateMachine::ReadWriteCB>);
   } else {
@@ -456,6 +498,11 @@ ReplicationThread::CBState ReplicationThread::replConfWriteCB(bufferevent *bev)
     data_to_send.emplace_back("ip-address");
     data_to_send.emplace_back(config->replica_announce_ip);
   }
+  if (!next_try_without_capa_) {
+    // Receive the published messages in the replication stream instead of the WAL
+    data_to_send.emplace_back("capa");
+    data_to_send.emplace_back("publish");
+  }
   SendString(bev, redis::ArrayOfBulkStrings(data_to_send));
   repl_state_.store(kReplReplConf, std::memory_order_relaxed);
   LOG(INFO) << "[replication] replconf request was sent, waiting for response";
@@ -467,7 +514,13 @@ ReplicationThread::CBState ReplicationThread::replConfReadCB(bufferevent *bev) {
   UniqueEvbufReadln line(input, EVBUFFER_EOL_CRLF_STRICT);
   if (!line) return CBState::AGAIN;
 
-  // on unknown option: first try without announce ip, if it fails again - do nothing (to prevent infinite loop)
+  // on unknown option: first try without capa, then without announce ip,
+  // if it fails again - do nothing (to prevent infinite loop)
+  if (isUnknownOption(line.get()) && !next_try_without_capa_) {
+    next_try_without_capa_ = true;
+    LOG(WARNING) << "The old version master, can't handle capa, try without it again";
+    return CBState::PREV;
+  }
   if (isUnknownOption(line.get()) && !next_try_without_announce_ip_address_) {
     next_try_without_announce_ip_address_ = true;
     LOG(WARNING) << "The old version master, can't handle ip-address, "
@@ -566,8 +619,20 @@ ReplicationThread::CBState ReplicationThread::incrementBatchLoopCB(bufferevent *
         // Read bulk length
         UniqueEvbufReadln line(input, EVBUFFER_EOL_CRLF_STRICT);
         if (!line) return CBState::AGAIN;
+        if (line.length > 0 && line[0] == '*') {
+          // The command sent in the replication stream, e.g. the published messages,
+          // it's followed by the bulk strings of its arguments
+          incr_command_len_ = std::strtoull(line.get() + 1, nullptr, 10);
+          if (incr_command_len_ == 0) {
+            LOG(ERROR) << "[replication] Invalid increment command size";
+            return CBState::RESTART;
+          }
+          incr_command_.clear();
+          break;
+        }
         incr_bulk_len_ = line.length > 0 ? std::strtoull(line.get() + 1, nullptr, 10) : 0;
-        if (incr_bulk_len_ == 0) {
+        // Only the arguments of commands can be empty
+        if (incr_bulk_len_ == 0 && incr_command_len_ == 0) {
           LOG(ERROR) << "[replication] Invalid increment data size";
           return CBState::RESTART;
         }
@@ -579,9 +644,16 @@ ReplicationThread::CBState ReplicationThread::incrementBatchLoopCB(bufferevent *
         if (incr_bulk_len_ + 2 <= evbuffer_get_length(input)) {  // We got enough data
           bulk_data = reinterpret_cast<char *>(evbuffer_pullup(input, static_cast<ssize_t>(incr_bulk_len_ + 2)));
           std::string bulk_string = std::string(bulk_data, incr_bulk_len_);
-          // master would send the ping heartbeat packet to check whether the slave was alive or not,
-          // don't write ping to db here.
-          if (bulk_string != "ping") {
+          if (incr_command_len_ > 0) {
+            incr_command_.emplace_back(std::move(bulk_string));
+            if (incr_command_.size() == incr_command_len_) {
+              handleReplCommand(incr_command_);
+              incr_command_len_ = 0;
+              incr_command_.clear();
+            }
+          } else if (bulk_string != "ping") {
+            // master would send the ping heartbeat packet to check whether the slave was alive or not,
+            // don't write ping to db here.
             auto s = storage_->ReplicaApplyWriteBatch(std::string(bulk_data, incr_bulk_len_));
             if (!s.IsOK()) {
               LOG(ERROR) << "[replication] CRITICAL - Failed to write batch to local, " << s.Msg() << ". batch: 0x"
@@ -998,6 +1070,16 @@ Status ReplicationThread::parseWriteBatch(const std::string &batch_string) {
   return Status::OK();
 }
 
+void ReplicationThread::handleReplCommand(const std::vector<std::string> &args) {
+  if (util::ToLower(args[0]) == "publish" && args.size() == 3) {
+    srv_->PublishMessage(args[1], args[2]);
+    // The messages aren't in the WAL, so forward them to the sub-replicas
+    srv_->ReplicatePublishMessage(args[1], args[2]);
+    return;
+  }
+  LOG(WARNING) << "[replication] Ignore the unknown command in the replication stream: " << args[0];
+}
+
 bool ReplicationThread::isRestoringError(const char *err) {
   return std::string(err) == "-ERR restoring the db from backup";
 }
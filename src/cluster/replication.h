@@ -25,6 +25,7 @@
 #include <atomic>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <tuple>
@@ -75,6 +76,9 @@ class FeedSlaveThread {
     auto seq = next_repl_seq_.load();
     return seq == 0 ? 0 : seq - 1;
   }
+  // Queue the published message to be sent once the WAL before `seq` was sent,
+  // it's dropped if there are too many pending messages
+  void EnqueuePublish(rocksdb::SequenceNumber seq, std::string frame);
 
  private:
   uint64_t interval_ = 0;
@@ -85,11 +89,19 @@ class FeedSlaveThread {
   std::thread t_;
   std::unique_ptr<rocksdb::TransactionLogIterator> iter_ = nullptr;
 
+  std::mutex publish_mu_;
+  std::deque<std::pair<rocksdb::SequenceNumber, std::string>> pending_publish_;
+  size_t pending_publish_bytes_ = 0;
+  bool publish_overflowed_ = false;
+
   static const size_t kMaxDelayUpdates = 16;
   static const size_t kMaxDelayBytes = 16 * 1024;
+  static const size_t kMaxPendingPublishBytes = 64 * 1024 * 1024;
 
   void loop();
   void checkLivenessIfNeed();
+  // Append the pending published messages which can be sent before the WAL from `next_seq`
+  bool appendPendingPublish(rocksdb::SequenceNumber next_seq, std::string *bulk);
 };
 
 class ReplicationThread : private EventCallbackBase<ReplicationThread> {
@@ -158,6 +170,7 @@ class ReplicationThread : private EventCallbackBase<ReplicationThread> {
   std::atomic<time_t> last_io_time_ = 0;
   bool next_try_old_psync_ = false;
   bool next_try_without_announce_ip_address_ = false;
+  bool next_try_without_capa_ = false;
 
   std::function<void()> pre_fullsync_cb_;
   std::function<void()> post_fullsync_cb_;
@@ -178,6 +191,9 @@ class ReplicationThread : private EventCallbackBase<ReplicationThread> {
   } incr_state_ = Incr_batch_size;
 
   size_t incr_bulk_len_ = 0;
+  // The command which is being received, e.g. the published messages
+  size_t incr_command_len_ = 0;
+  std::vector<std::string> incr_command_;
 
   using CBState = CallbacksStateMachine::State;
   CallbacksStateMachine psync_steps_;
@@ -209,6 +225,7 @@ class ReplicationThread : private EventCallbackBase<ReplicationThread> {
   static bool isUnknownOption(const char *err);
 
   Status parseWriteBatch(const std::string &batch_string);
+  void handleReplCommand(const std::vector<std::string> &args);
 };
 
 /*
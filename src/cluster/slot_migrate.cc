@@ -32,6 +32,8 @@
 #include "sync_migrate_context.h"
 #include "thread_util.h"
 #include "time_util.h"
+#include "types/list_chunks.h"
+#include "types/redis_bitmap.h"
 #include "types/redis_stream_base.h"
 
 const char *errFailedToSendCommands = "failed to send commands to restore a key";
@@ -676,13 +678,40 @@ StatusOr<KeyMigrationResult> SlotMigrator::migrateOneKey(const rocksdb::Slice &k
   // Construct command according to type of the key
   switch (metadata.Type()) {
     case kRedisString: {
+      // The chunks of a chunked string are migrated like the subkeys of the complex types
+      if (metadata.IsChunkedString()) {
+        auto s = migrateComplexKey(key, metadata, restore_cmds);
+        if (!s.IsOK()) {
+          return s.Prefixed("failed to migrate chunked string key");
+        }
+        break;
+      }
       auto s = migrateSimpleKey(key, metadata, bytes, restore_cmds);
       if (!s.IsOK()) {
         return s.Prefixed("failed to migrate simple key");
       }
       break;
     }
-    case kRedisList:
+    case kRedisList: {
+      // The elements of a chunked list are packed into chunks, which are ordered by its directory
+      if (metadata.IsChunkedList()) {
+        ListMetadata list_metadata(false);
+        if (auto s = list_metadata.Decode(bytes); !s.ok()) {
+          return {Status::NotOK, s.ToString()};
+        }
+
+        auto s = migrateChunkedList(key, list_metadata, restore_cmds);
+        if (!s.IsOK()) {
+          return s.Prefixed("failed to migrate chunked list key");
+        }
+        break;
+      }
+      auto s = migrateComplexKey(key, metadata, restore_cmds);
+      if (!s.IsOK()) {
+        return s.Prefixed("failed to migrate complex key");
+      }
+      break;
+    }
     case kRedisZSet:
     case kRedisBitmap:
     case kRedisHash:
@@ -740,14 +769,22 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
   std::vector<std::string> user_cmd = {cmd, key.ToString()};
   rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
   read_options.snapshot = slot_snapshot_;
-  // Should use th raw db iterator to avoid reading uncommitted writes in transaction mode
-  auto iter = util::UniqueIterator(storage_->GetDB()->NewIterator(read_options));
-
   // Construct key prefix to iterate values of the complex type user key
   std::string slot_key = AppendNamespacePrefix(key);
+  // Should use th raw db iterator to avoid reading uncommitted writes in transaction mode,
+  // while the elements of an inline collection are taken from its metadata
+  auto iter = metadata.IsInlineEncoded()
+                  ? util::UniqueIterator(new engine::InlineSubKeyIterator(slot_key, metadata, true))
+                  : util::UniqueIterator(storage_->GetDB()->NewIterator(read_options));
   std::string prefix_subkey = InternalKey(slot_key, "", metadata.version, true).Encode();
   int item_count = 0;
 
+  // The chunks of a string are written by SETRANGE, which needs an existing empty string to begin with
+  if (metadata.Type() == kRedisString) {
+    *restore_cmds += redis::ArrayOfBulkStrings({"SET", key.ToString(), ""});
+    current_pipeline_size_++;
+  }
+
   for (iter->Seek(prefix_subkey); iter->Valid(); iter->Next()) {
     if (stop_migration_) {
       return {Status::NotOK, errMigrationTaskCanceled};
@@ -777,7 +814,7 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
         break;
       }
       case kRedisBitmap: {
-        auto s = migrateBitmapKey(inkey, &iter, &user_cmd, restore_cmds);
+        auto s = migrateBitmapKey(inkey, metadata, &iter, &user_cmd, restore_cmds);
         if (!s.IsOK()) {
           return s.Prefixed("failed to migrate bitmap key");
         }
@@ -792,13 +829,24 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
         user_cmd.emplace_back(iter->value().ToString());
         break;
       }
+      case kRedisString: {
+        // The subkey of a chunk is its offset in the value
+        *restore_cmds += redis::ArrayOfBulkStrings(
+            {"SETRANGE", key.ToString(), inkey.GetSubKey().ToString(), iter->value().ToString()});
+        current_pipeline_size_++;
+        auto s = sendCmdsPipelineIfNeed(restore_cmds, false);
+        if (!s.IsOK()) {
+          return s.Prefixed(errFailedToSendCommands);
+        }
+        break;
+      }
       default:
         break;
     }
 
     // Check item count
-    // Exclude bitmap because it does not have hmset-like command
-    if (metadata.Type() != kRedisBitmap) {
+    // Exclude bitmap and string because they do not have hmset-like command
+    if (metadata.Type() != kRedisBitmap && metadata.Type() != kRedisString) {
       item_count++;
       if (item_count >= kMaxItemsInCommand) {
         *restore_cmds += redis::ArrayOfBulkStrings(user_cmd);
@@ -837,6 +885,77 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
   return Status::OK();
 }
 
+Status SlotMigrator::migrateChunkedList(const rocksdb::Slice &key, const ListMetadata &metadata,
+                                        std::string *restore_cmds) {
+  rocksdb::ReadOptions read_options;
+  read_options.snapshot = slot_snapshot_;
+  auto subkey_cf_handle = storage_->GetCFHandle(engine::kSubkeyColumnFamilyName);
+  std::string slot_key = AppendNamespacePrefix(key);
+
+  // Should use the raw db to avoid reading uncommitted writes in transaction mode
+  std::string directory;
+  auto s = storage_->GetDB()->Get(
+      read_options, subkey_cf_handle,
+      InternalKey(slot_key, redis::ListChunks::kDirectorySubKey, metadata.version, true).Encode(), &directory);
+  if (!s.ok() && !s.IsNotFound()) {
+    return {Status::NotOK, s.ToString()};
+  }
+  std::vector<uint64_t> ids;
+  if (s = redis::ListChunks::DecodeChunkIds(metadata, directory, &ids); !s.ok()) {
+    return {Status::NotOK, s.ToString()};
+  }
+
+  std::vector<std::string> user_cmd = {type_to_cmd[metadata.Type()], key.ToString()};
+  for (auto id : ids) {
+    if (stop_migration_) {
+      return {Status::NotOK, errMigrationTaskCanceled};
+    }
+
+    std::string chunk;
+    s = storage_->GetDB()->Get(
+        read_options, subkey_cf_handle,
+        InternalKey(slot_key, redis::ListChunks::ChunkSubKey(id), metadata.version, true).Encode(), &chunk);
+    if (!s.ok()) {
+      return {Status::NotOK, s.ToString()};
+    }
+    std::vector<Slice> elems;
+    if (s = redis::ListChunks::DecodeChunk(chunk, &elems); !s.ok()) {
+      return {Status::NotOK, s.ToString()};
+    }
+
+    for (const auto &elem : elems) {
+      user_cmd.emplace_back(elem.ToString());
+      if (static_cast<int>(user_cmd.size()) - 2 >= kMaxItemsInCommand) {
+        *restore_cmds += redis::ArrayOfBulkStrings(user_cmd);
+        current_pipeline_size_++;
+        user_cmd.erase(user_cmd.begin() + 2, user_cmd.end());
+
+        auto send_status = sendCmdsPipelineIfNeed(restore_cmds, false);
+        if (!send_status.IsOK()) {
+          return send_status.Prefixed(errFailedToSendCommands);
+        }
+      }
+    }
+  }
+
+  if (user_cmd.size() > 2) {
+    *restore_cmds += redis::ArrayOfBulkStrings(user_cmd);
+    current_pipeline_size_++;
+  }
+
+  if (metadata.expire > 0) {
+    *restore_cmds += redis::ArrayOfBulkStrings({"PEXPIREAT", key.ToString(), std::to_string(metadata.expire)});
+    current_pipeline_size_++;
+  }
+
+  auto send_status = sendCmdsPipelineIfNeed(restore_cmds, false);
+  if (!send_status.IsOK()) {
+    return send_status.Prefixed(errFailedToSendCommands);
+  }
+
+  return Status::OK();
+}
+
 Status SlotMigrator::migrateStream(const Slice &key, const StreamMetadata &metadata, std::string *restore_cmds) {
   rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
   read_options.snapshot = slot_snapshot_;
@@ -895,10 +1014,20 @@ Status SlotMigrator::migrateStream(const Slice &key, const StreamMetadata &metad
   return Status::OK();
 }
 
-Status SlotMigrator::migrateBitmapKey(const InternalKey &inkey, std::unique_ptr<rocksdb::Iterator> *iter,
-                                      std::vector<std::string> *user_cmd, std::string *restore_cmds) {
+Status SlotMigrator::migrateBitmapKey(const InternalKey &inkey, const Metadata &metadata,
+                                      std::unique_ptr<rocksdb::Iterator> *iter, std::vector<std::string> *user_cmd,
+                                      std::string *restore_cmds) {
+  // The popcount summary is rebuilt by the SETBIT commands
+  if (redis::Bitmap::IsSummarySubKey(inkey.GetSubKey())) return Status::OK();
+
   std::string index_str = inkey.GetSubKey().ToString();
   std::string fragment = (*iter)->value().ToString();
+  if (metadata.IsCompressedBitmap()) {
+    std::string encoded = std::move(fragment);
+    if (auto s = redis::Bitmap::DecodeSegment(encoded, &fragment); !s.ok()) {
+      return {Status::NotOK, s.ToString()};
+    }
+  }
   auto parse_result = ParseInt<int>(index_str, 10);
   if (!parse_result) {
     return {Status::RedisParseErr, "index is not a valid integer"};
@@ -1240,6 +1369,10 @@ Status SlotMigrator::sendSnapshotByRawKV() {
       }
     }
 
+    if (redis_type == RedisType::kRedisZSet) {
+      GET_OR_RET(sendZSetRankIndexByRawKV(iter.Key(), iter.Value(), read_options, &batch_sender));
+    }
+
     if (batch_sender.IsFull()) {
       GET_OR_RET(sendMigrationBatch(&batch_sender));
     }
@@ -1257,6 +1390,29 @@ Status SlotMigrator::sendSnapshotByRawKV() {
   return Status::OK();
 }
 
+Status SlotMigrator::sendZSetRankIndexByRawKV(const Slice &ns_key, const Slice &encoded_metadata,
+                                               const rocksdb::ReadOptions &read_options, BatchSender *batch_sender) {
+  ZSetMetadata metadata(false);
+  if (auto s = metadata.Decode(encoded_metadata); !s.ok()) {
+    return {Status::NotOK, s.ToString()};
+  }
+  if (!metadata.rank_indexed) {
+    return Status::OK();
+  }
+
+  auto rank_cf_handle = storage_->GetCFHandle(kColumnFamilyIDZSetRank);
+  std::string prefix_key = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
+  auto iter = util::UniqueIterator(storage_->GetDB()->NewIterator(read_options, rank_cf_handle));
+  for (iter->Seek(prefix_key); iter->Valid() && iter->key().starts_with(prefix_key); iter->Next()) {
+    GET_OR_RET(batch_sender->Put(rank_cf_handle, iter->key(), iter->value()));
+
+    if (batch_sender->IsFull()) {
+      GET_OR_RET(sendMigrationBatch(batch_sender));
+    }
+  }
+  return Status::OK();
+}
+
 Status SlotMigrator::syncWALByRawKV() {
   uint64_t start_ts = util::GetTimeStampMS();
   LOG(INFO) << "[migrate] Syncing WAL of slot " << migrating_slot_ << " by raw key value";
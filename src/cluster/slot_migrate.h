@@ -131,8 +131,9 @@ class SlotMigrator : public redis::Database {
   Status migrateSimpleKey(const rocksdb::Slice &key, const Metadata &metadata, const std::string &bytes,
                           std::string *restore_cmds);
   Status migrateComplexKey(const rocksdb::Slice &key, const Metadata &metadata, std::string *restore_cmds);
+  Status migrateChunkedList(const rocksdb::Slice &key, const ListMetadata &metadata, std::string *restore_cmds);
   Status migrateStream(const rocksdb::Slice &key, const StreamMetadata &metadata, std::string *restore_cmds);
-  Status migrateBitmapKey(const InternalKey &inkey, std::unique_ptr<rocksdb::Iterator> *iter,
+  Status migrateBitmapKey(const InternalKey &inkey, const Metadata &metadata, std::unique_ptr<rocksdb::Iterator> *iter,
                           std::vector<std::string> *user_cmd, std::string *restore_cmds);
 
   Status sendCmdsPipelineIfNeed(std::string *commands, bool need);
@@ -144,6 +145,8 @@ class SlotMigrator : public redis::Database {
 
   Status sendMigrationBatch(BatchSender *batch);
   Status sendSnapshotByRawKV();
+  Status sendZSetRankIndexByRawKV(const Slice &ns_key, const Slice &encoded_metadata,
+                                  const rocksdb::ReadOptions &read_options, BatchSender *batch_sender);
   Status syncWALByRawKV();
   bool catchUpIncrementalWAL();
   Status migrateIncrementalDataByRawKV(uint64_t end_seq, BatchSender *batch_sender);
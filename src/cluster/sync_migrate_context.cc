@@ -33,11 +33,7 @@ void SyncMigrateContext::Suspend() {
 
 void SyncMigrateContext::Resume(const Status &migrate_result) {
   migrate_result_ = migrate_result;
-  auto s = conn_->Owner()->EnableWriteEvent(conn_->GetFD());
-  if (!s.IsOK()) {
-    LOG(ERROR) << "[server] Failed to enable write event on the sync migrate connection " << conn_->GetFD() << ": "
-               << s.Msg();
-  }
+  conn_->Owner()->EnableWriteEvent(conn_->GetFD(), conn_->GetID());
 }
 
 void SyncMigrateContext::OnEvent(bufferevent *bev, int16_t events) {
@@ -37,7 +37,12 @@ class CommandHGet : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = s.IsNotFound() ? conn->NilString() : redis::BulkString(value);
+    auto writer = NewReplyWriter(conn, output);
+    if (s.IsNotFound()) {
+      writer->NilString();
+    } else {
+      writer->BulkString(std::move(value));
+    }
     return Status::OK();
   }
 };
@@ -236,10 +241,11 @@ class CommandHMSet : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
+    auto writer = NewReplyWriter(conn, output);
     if (GetAttributes()->name == "hset") {
-      *output = redis::Integer(ret);
+      writer->Integer(ret);
     } else {
-      *output = redis::SimpleString("OK");
+      writer->SimpleString("OK");
     }
     return Status::OK();
   }
@@ -294,20 +300,26 @@ class CommandHGetAll : public Commander {
  public:
   Status Execute(Server *srv, Connection *conn, std::string *output) override {
     redis::Hash hash_db(srv->storage, conn->GetNamespace());
-    std::vector<FieldValue> field_values;
-    auto s = hash_db.GetAll(args_[1], &field_values);
+    // The fields are written into the reply while iterating, and the header is placed before
+    // them once they're counted, so it always matches the fields which were written.
+    auto writer = NewReplyWriter(conn, output);
+    rocksdb::Status s;
+    writer->DeferredLen(&ReplyWriter::MapLen, [&]() -> std::optional<size_t> {
+      size_t n = 0;
+      s = hash_db.GetAll(
+          args_[1], [](uint64_t) {},
+          [&writer, &n](const Slice &field, const Slice &value) {
+            writer->BulkString(field.ToStringView());
+            writer->BulkString(value.ToStringView());
+            n++;
+          });
+      if (!s.ok()) return std::nullopt;
+      return n;
+    });
     if (!s.ok()) {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    std::vector<std::string> kv_pairs;
-    kv_pairs.reserve(field_values.size());
-    for (const auto &p : field_values) {
-      kv_pairs.emplace_back(p.field);
-      kv_pairs.emplace_back(p.value);
-    }
-    *output = conn->MapOfBulkStrings(kv_pairs);
-
     return Status::OK();
   }
 };
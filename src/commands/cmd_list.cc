@@ -530,13 +530,24 @@ class CommandLRange : public Commander {
 
   Status Execute(Server *srv, Connection *conn, std::string *output) override {
     redis::List list_db(srv->storage, conn->GetNamespace());
-    std::vector<std::string> elems;
-    auto s = list_db.Range(args_[1], start_, stop_, &elems);
+    // The header is placed before the elements once they're counted, see HGETALL
+    auto writer = NewReplyWriter(conn, output);
+    rocksdb::Status s;
+    writer->DeferredLen(&ReplyWriter::ArrayLen, [&]() -> std::optional<size_t> {
+      size_t n = 0;
+      s = list_db.Range(
+          args_[1], start_, stop_, [](uint64_t) {},
+          [&writer, &n](const Slice &elem) {
+            writer->BulkString(elem.ToStringView());
+            n++;
+          });
+      if (!s.ok() && !s.IsNotFound()) return std::nullopt;
+      return n;
+    });
     if (!s.ok() && !s.IsNotFound()) {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = ArrayOfBulkStrings(elems);
     return Status::OK();
   }
 
@@ -848,14 +859,15 @@ class CommandLPos : public Commander {
   PosSpec spec_;
 };
 
-REDIS_REGISTER_COMMANDS(MakeCmdAttr<CommandBLPop>("blpop", -3, "write no-script", 1, -2, 1),
-                        MakeCmdAttr<CommandBRPop>("brpop", -3, "write no-script", 1, -2, 1),
-                        MakeCmdAttr<CommandBLMPop>("blmpop", -5, "write no-script", CommandBLMPop::keyRangeGen),
+REDIS_REGISTER_COMMANDS(MakeCmdAttr<CommandBLPop>("blpop", -3, "write no-script blocking", 1, -2, 1),
+                        MakeCmdAttr<CommandBRPop>("brpop", -3, "write no-script blocking", 1, -2, 1),
+                        MakeCmdAttr<CommandBLMPop>("blmpop", -5, "write no-script blocking",
+                                                   CommandBLMPop::keyRangeGen),
                         MakeCmdAttr<CommandLIndex>("lindex", 3, "read-only", 1, 1, 1),
                         MakeCmdAttr<CommandLInsert>("linsert", 5, "write", 1, 1, 1),
                         MakeCmdAttr<CommandLLen>("llen", 2, "read-only", 1, 1, 1),
                         MakeCmdAttr<CommandLMove>("lmove", 5, "write", 1, 2, 1),
-                        MakeCmdAttr<CommandBLMove>("blmove", 6, "write", 1, 2, 1),
+                        MakeCmdAttr<CommandBLMove>("blmove", 6, "write blocking", 1, 2, 1),
                         MakeCmdAttr<CommandLPop>("lpop", -2, "write", 1, 1, 1),  //
                         MakeCmdAttr<CommandLPos>("lpos", -3, "read-only", 1, 1, 1),
                         MakeCmdAttr<CommandLPush>("lpush", -3, "write", 1, 1, 1),
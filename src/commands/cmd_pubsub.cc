@@ -25,20 +25,31 @@
 
 namespace redis {
 
+Status ReplicatePublish(Server *srv, const std::string &channel, const std::string &msg) {
+  if (srv->GetConfig()->publish_replication_mode != PublishReplicationMode::kWAL) {
+    srv->ReplicatePublishMessage(channel, msg);
+    return Status::OK();
+  }
+
+  if (!srv->IsSlave()) {
+    // Compromise: can't replicate a message to sub-replicas in a cascading-like structure.
+    // Replication relies on WAL seq; increasing the seq on a replica will break the replication process,
+    // hence the compromise solution
+    redis::PubSub pubsub_db(srv->storage);
+
+    auto s = pubsub_db.Publish(channel, msg);
+    if (!s.ok()) {
+      return {Status::RedisExecErr, s.ToString()};
+    }
+  }
+  return Status::OK();
+}
+
 class CommandPublish : public Commander {
  public:
   Status Execute(Server *srv, Connection *conn, std::string *output) override {
-    if (!srv->IsSlave()) {
-      // Compromise: can't replicate a message to sub-replicas in a cascading-like structure.
-      // Replication relies on WAL seq; increasing the seq on a replica will break the replication process,
-      // hence the compromise solution
-      redis::PubSub pubsub_db(srv->storage);
-
-      auto s = pubsub_db.Publish(args_[1], args_[2]);
-      if (!s.ok()) {
-        return {Status::RedisExecErr, s.ToString()};
-      }
-    }
+    auto s = ReplicatePublish(srv, args_[1], args_[2]);
+    if (!s.IsOK()) return s;
 
     int receivers = srv->PublishMessage(args_[1], args_[2]);
 
@@ -54,14 +65,8 @@ class CommandMPublish : public Commander {
     int total_receivers = 0;
 
     for (size_t i = 2; i < args_.size(); i++) {
-      if (!srv->IsSlave()) {
-        redis::PubSub pubsub_db(srv->storage);
-
-        auto s = pubsub_db.Publish(args_[1], args_[i]);
-        if (!s.ok()) {
-          return {Status::RedisExecErr, s.ToString()};
-        }
-      }
+      auto s = ReplicatePublish(srv, args_[1], args_[i]);
+      if (!s.IsOK()) return s;
 
       int receivers = srv->PublishMessage(args_[1], args_[i]);
       total_receivers += receivers;
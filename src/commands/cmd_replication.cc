@@ -178,6 +178,9 @@ class CommandReplConf : public Commander {
         return {Status::RedisParseErr, "ip-address should not be empty"};
       }
       ip_address_ = value;
+    } else if (option == "capa") {
+      // Unknown capabilities are ignored, so replicas can announce the new ones to old masters
+      if (util::ToLower(value) == "publish") publish_supported_ = true;
     } else {
       return {Status::RedisParseErr, errUnknownOption};
     }
@@ -192,6 +195,9 @@ class CommandReplConf : public Commander {
     if (!ip_address_.empty()) {
       conn->SetAnnounceIP(ip_address_);
     }
+    if (publish_supported_) {
+      conn->SetReplicaPublishSupported(true);
+    }
     *output = redis::SimpleString("OK");
     return Status::OK();
   }
@@ -199,6 +205,7 @@ class CommandReplConf : public Commander {
  private:
   int port_ = 0;
   std::string ip_address_;
+  bool publish_supported_ = false;
 };
 
 class CommandFetchMeta : public Commander {
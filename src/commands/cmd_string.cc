@@ -55,7 +55,13 @@ class CommandGet : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = s.IsNotFound() ? conn->NilString() : redis::BulkString(value);
+    auto writer = NewReplyWriter(conn, output);
+    if (s.IsNotFound()) {
+      writer->NilString();
+    } else {
+      // Large values are handed over to the output buffer without copying
+      writer->BulkString(std::move(value));
+    }
     return Status::OK();
   }
 };
@@ -114,18 +120,14 @@ class CommandGetEx : public Commander {
 class CommandStrlen : public Commander {
  public:
   Status Execute(Server *srv, Connection *conn, std::string *output) override {
-    std::string value;
+    uint64_t length = 0;
     redis::String string_db(srv->storage, conn->GetNamespace());
-    auto s = string_db.Get(args_[1], &value);
+    auto s = string_db.Strlen(args_[1], &length);
     if (!s.ok() && !s.IsNotFound()) {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    if (s.IsNotFound()) {
-      *output = redis::Integer(0);
-    } else {
-      *output = redis::Integer(value.size());
-    }
+    *output = redis::Integer(length);
     return Status::OK();
   }
 };
@@ -183,27 +185,14 @@ class CommandGetRange : public Commander {
   }
 
   Status Execute(Server *srv, Connection *conn, std::string *output) override {
-    std::string value;
+    std::optional<std::string> value;
     redis::String string_db(srv->storage, conn->GetNamespace());
-    auto s = string_db.Get(args_[1], &value);
+    auto s = string_db.GetRange(args_[1], start_, stop_, value);
     if (!s.ok() && !s.IsNotFound()) {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    if (s.IsNotFound()) {
-      *output = conn->NilString();
-      return Status::OK();
-    }
-
-    if (start_ < 0) start_ = static_cast<int>(value.size()) + start_;
-    if (stop_ < 0) stop_ = static_cast<int>(value.size()) + stop_;
-    if (start_ < 0) start_ = 0;
-    if (stop_ > static_cast<int>(value.size())) stop_ = static_cast<int>(value.size());
-    if (start_ > stop_) {
-      *output = conn->NilString();
-    } else {
-      *output = redis::BulkString(value.substr(start_, stop_ - start_ + 1));
-    }
+    *output = value.has_value() ? redis::BulkString(*value) : conn->NilString();
     return Status::OK();
   }
 
@@ -309,7 +298,7 @@ class CommandSet : public Commander {
       if (!s.ok()) {
         return {Status::RedisExecErr, s.ToString()};
       }
-      *output = redis::SimpleString("OK");
+      NewReplyWriter(conn, output)->SimpleString("OK");
       return Status::OK();
     }
 
@@ -320,18 +309,13 @@ class CommandSet : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    if (get_) {
-      if (ret.has_value()) {
-        *output = redis::BulkString(ret.value());
-      } else {
-        *output = conn->NilString();
-      }
+    auto writer = NewReplyWriter(conn, output);
+    if (!ret.has_value()) {
+      writer->NilString();
+    } else if (get_) {
+      writer->BulkString(std::move(ret.value()));
     } else {
-      if (ret.has_value()) {
-        *output = redis::SimpleString("OK");
-      } else {
-        *output = conn->NilString();
-      }
+      writer->SimpleString("OK");
     }
     return Status::OK();
   }
@@ -473,7 +457,7 @@ class CommandIncr : public Commander {
     auto s = string_db.IncrBy(args_[1], 1, &ret);
     if (!s.ok()) return {Status::RedisExecErr, s.ToString()};
 
-    *output = redis::Integer(ret);
+    NewReplyWriter(conn, output)->Integer(ret);
     return Status::OK();
   }
 };
@@ -486,7 +470,7 @@ class CommandDecr : public Commander {
     auto s = string_db.IncrBy(args_[1], -1, &ret);
     if (!s.ok()) return {Status::RedisExecErr, s.ToString()};
 
-    *output = redis::Integer(ret);
+    NewReplyWriter(conn, output)->Integer(ret);
     return Status::OK();
   }
 };
@@ -509,7 +493,7 @@ class CommandIncrBy : public Commander {
     auto s = string_db.IncrBy(args_[1], increment_, &ret);
     if (!s.ok()) return {Status::RedisExecErr, s.ToString()};
 
-    *output = redis::Integer(ret);
+    NewReplyWriter(conn, output)->Integer(ret);
     return Status::OK();
   }
 
@@ -567,7 +551,7 @@ class CommandDecrBy : public Commander {
     auto s = string_db.IncrBy(args_[1], -1 * increment_, &ret);
     if (!s.ok()) return {Status::RedisExecErr, s.ToString()};
 
-    *output = redis::Integer(ret);
+    NewReplyWriter(conn, output)->Integer(ret);
     return Status::OK();
   }
 
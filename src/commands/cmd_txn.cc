@@ -18,6 +18,8 @@
  *
  */
 
+#include <optional>
+
 #include "commander.h"
 #include "error_constants.h"
 #include "scope_exit.h"
@@ -78,6 +80,14 @@ class CommandExec : public Commander {
     }
 
     auto storage = srv->storage;
+    // EXEC was executed exclusively if the keys of the transaction are unknown, otherwise
+    // we lock the keys until the transaction was committed, so transactions touching
+    // different keys can run in parallel.
+    std::optional<TxnLockGuard> guard;
+    if (!conn->IsMultiExecExclusive()) {
+      guard.emplace(storage->GetLockManager(), conn->GetMultiExecLockKeys());
+    }
+
     // Reply multi length first
     conn->Reply(redis::MultiLen(conn->GetMultiExecCommands()->size()));
     // Execute multi-exec commands
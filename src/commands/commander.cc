@@ -21,9 +21,21 @@
 #include "commander.h"
 
 #include "cluster/cluster_defs.h"
+#include "server/redis_connection.h"
+#include "server/server.h"
 
 namespace redis {
 
+std::unique_ptr<ReplyWriter> Commander::NewReplyWriter(Connection *conn, std::string *output) const {
+  if (reply_sink_) {
+    return std::make_unique<ReplyWriter>(reply_sink_, conn->GetProtocolVersion());
+  }
+  if (reply_streaming_) {
+    return std::make_unique<ReplyWriter>(conn->Output(), conn->GetProtocolVersion(), &conn->GetServer()->stats);
+  }
+  return std::make_unique<ReplyWriter>(output, conn->GetProtocolVersion());
+}
+
 RegisterToCommandTable::RegisterToCommandTable(std::initializer_list<CommandAttributes> list) {
   for (const auto &attr : list) {
     CommandTable::redis_command_table.emplace_back(attr);
@@ -56,7 +56,7 @@ enum CommandFlags : uint64_t {
   kCmdReadOnly = 1ULL << 1,        // "read-only" flag
   kCmdReplication = 1ULL << 2,     // "replication" flag
   kCmdPubSub = 1ULL << 3,          // "pub-sub" flag
-  kCmdScript = 1ULL << 4,          // "script" flag
+  kCmdScript = 1ULL << 4,          // "script" flag for write script commands
   kCmdLoading = 1ULL << 5,         // "ok-loading" flag
   kCmdMulti = 1ULL << 6,           // "multi" flag
   kCmdExclusive = 1ULL << 7,       // "exclusive" flag
@@ -65,6 +65,7 @@ enum CommandFlags : uint64_t {
   kCmdROScript = 1ULL << 10,       // "ro-script" flag for read-only script commands
   kCmdCluster = 1ULL << 11,        // "cluster" flag
   kCmdNoDBSizeCheck = 1ULL << 12,  // "no-dbsize-check" flag
+  kCmdBlocking = 1ULL << 13,       // "blocking" flag
 };
 
 class Commander {
@@ -78,11 +79,25 @@ class Commander {
     return {Status::RedisExecErr, errNotImplemented};
   }
 
+  // Allow the command to stream its reply into the output buffer of the connection,
+  // it's only enabled when the command is executed by the connection directly,
+  // e.g. the replies of commands called from scripts must still go to `output`.
+  void EnableReplyStreaming() { reply_streaming_ = true; }
+  // Pass the reply values to the sink instead of `output` if the command supports it,
+  // otherwise the reply is still written into `output`.
+  void SetReplySink(ReplySink *sink) { reply_sink_ = sink; }
+
   virtual ~Commander() = default;
 
  protected:
+  // Create a writer which writes into the reply sink or streams into the connection if possible,
+  // otherwise writes into `output`
+  std::unique_ptr<ReplyWriter> NewReplyWriter(Connection *conn, std::string *output) const;
+
   std::vector<std::string> args_;
   const CommandAttributes *attributes_ = nullptr;
+  bool reply_streaming_ = false;
+  ReplySink *reply_sink_ = nullptr;
 };
 
 class CommanderWithParseMove : Commander {
@@ -179,12 +194,16 @@ inline uint64_t ParseCommandFlags(const std::string &description, const std::str
       flags |= kCmdNoMulti;
     else if (flag == "no-script")
       flags |= kCmdNoScript;
+    else if (flag == "script")
+      flags |= kCmdScript;
     else if (flag == "ro-script")
       flags |= kCmdROScript;
     else if (flag == "cluster")
       flags |= kCmdCluster;
     else if (flag == "no-dbsize-check")
       flags |= kCmdNoDBSizeCheck;
+    else if (flag == "blocking")
+      flags |= kCmdBlocking;
     else {
       std::cout << fmt::format("Encountered non-existent flag '{}' in command {} in command attribute parsing", flag,
                                cmd_name)
@@ -0,0 +1,284 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "bit_kernels.h"
+
+#include <cstring>
+
+#include "encoding.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KVROCKS_X86_BIT_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace util {
+
+namespace {
+
+enum class BitwiseOp { kAnd, kOr, kXor };
+
+inline uint64_t LoadWord(const uint8_t *p) {
+  uint64_t v = 0;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline void StoreWord(uint8_t *p, uint64_t v) { memcpy(p, &v, sizeof(v)); }
+
+// The position of the lowest set bit of a non-zero word loaded from the bitmap, in LSB numbering
+inline int LowestBitOfWord(uint64_t x) {
+  if constexpr (IsLittleEndian()) {
+    return __builtin_ctzll(x);
+  } else {
+    return __builtin_ctzll(__builtin_bswap64(x));
+  }
+}
+
+template <BitwiseOp Op, typename T>
+inline T ApplyOp(T a, T b) {
+  if constexpr (Op == BitwiseOp::kAnd) {
+    return a & b;
+  } else if constexpr (Op == BitwiseOp::kOr) {
+    return a | b;
+  } else {
+    return a ^ b;
+  }
+}
+
+template <BitwiseOp Op>
+void ScalarBitwise(uint8_t *dst, const uint8_t *src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    StoreWord(dst + i, ApplyOp<Op>(LoadWord(dst + i), LoadWord(src + i)));
+  }
+  for (; i < n; i++) {
+    dst[i] = ApplyOp<Op>(dst[i], src[i]);
+  }
+}
+
+void ScalarNot(uint8_t *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    StoreWord(dst + i, ~LoadWord(dst + i));
+  }
+  for (; i < n; i++) {
+    dst[i] = ~dst[i];
+  }
+}
+
+size_t ScalarPopcount(const uint8_t *p, size_t n) {
+  size_t bits = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    bits += __builtin_popcountll(LoadWord(p + i));
+  }
+  for (; i < n; i++) {
+    bits += __builtin_popcount(p[i]);
+  }
+  return bits;
+}
+
+int64_t ScalarFindFirstBit(const uint8_t *p, size_t n, bool bit) {
+  uint64_t flip = bit ? 0 : ~uint64_t(0);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t x = LoadWord(p + i) ^ flip;
+    if (x != 0) return static_cast<int64_t>(i * 8 + LowestBitOfWord(x));
+  }
+  for (; i < n; i++) {
+    auto x = static_cast<uint8_t>(p[i] ^ flip);
+    if (x != 0) return static_cast<int64_t>(i * 8 + __builtin_ctz(x));
+  }
+  return -1;
+}
+
+// Search the bytes from `offset` on, after the vectors before it are found to have no such bit
+inline int64_t FindFirstBitFrom(const uint8_t *p, size_t offset, size_t n, bool bit) {
+  int64_t pos = ScalarFindFirstBit(p + offset, n - offset, bit);
+  return pos < 0 ? pos : static_cast<int64_t>(offset * 8) + pos;
+}
+
+#ifdef KVROCKS_X86_BIT_KERNELS
+
+template <BitwiseOp Op>
+__attribute__((target("avx2"))) void AVX2Bitwise(uint8_t *dst, const uint8_t *src, size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    if constexpr (Op == BitwiseOp::kAnd) {
+      a = _mm256_and_si256(a, b);
+    } else if constexpr (Op == BitwiseOp::kOr) {
+      a = _mm256_or_si256(a, b);
+    } else {
+      a = _mm256_xor_si256(a, b);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), a);
+  }
+  ScalarBitwise<Op>(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2"))) void AVX2Not(uint8_t *dst, size_t n) {
+  const auto ones = _mm256_set1_epi8(-1);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(a, ones));
+  }
+  ScalarNot(dst + i, n - i);
+}
+
+// Count the bits of each nibble with a lookup table in a shuffle, see
+// "Faster Population Counts Using AVX2 Instructions" by Muła, Kurz and Lemire
+__attribute__((target("avx2"))) size_t AVX2Popcount(const uint8_t *p, size_t n) {
+  const auto lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2,
+                                       3, 2, 3, 3, 4);
+  const auto low_mask = _mm256_set1_epi8(0x0f);
+  auto acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    auto lo = _mm256_and_si256(v, low_mask);
+    auto hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    auto cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+  }
+  auto bits = static_cast<size_t>(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+                                  _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+  return bits + ScalarPopcount(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) int64_t AVX2FindFirstBit(const uint8_t *p, size_t n, bool bit) {
+  const auto flip = _mm256_set1_epi8(bit ? 0 : -1);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)), flip);
+    if (!_mm256_testz_si256(v, v)) break;
+  }
+  return FindFirstBitFrom(p, i, n, bit);
+}
+
+template <BitwiseOp Op>
+__attribute__((target("avx512f"))) void AVX512Bitwise(uint8_t *dst, const uint8_t *src, size_t n) {
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    auto a = _mm512_loadu_si512(dst + i);
+    auto b = _mm512_loadu_si512(src + i);
+    if constexpr (Op == BitwiseOp::kAnd) {
+      a = _mm512_and_si512(a, b);
+    } else if constexpr (Op == BitwiseOp::kOr) {
+      a = _mm512_or_si512(a, b);
+    } else {
+      a = _mm512_xor_si512(a, b);
+    }
+    _mm512_storeu_si512(dst + i, a);
+  }
+  ScalarBitwise<Op>(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void AVX512Not(uint8_t *dst, size_t n) {
+  const auto ones = _mm512_set1_epi64(-1);
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    _mm512_storeu_si512(dst + i, _mm512_xor_si512(_mm512_loadu_si512(dst + i), ones));
+  }
+  ScalarNot(dst + i, n - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) size_t AVX512Popcount(const uint8_t *p, size_t n) {
+  auto acc = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(p + i)));
+  }
+  uint64_t lanes[8];
+  _mm512_storeu_si512(lanes, acc);
+  size_t bits = 0;
+  for (auto lane : lanes) bits += lane;
+  return bits + ScalarPopcount(p + i, n - i);
+}
+
+__attribute__((target("avx512f"))) int64_t AVX512FindFirstBit(const uint8_t *p, size_t n, bool bit) {
+  const auto flip = _mm512_set1_epi64(bit ? 0 : -1);
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    auto v = _mm512_xor_si512(_mm512_loadu_si512(p + i), flip);
+    if (_mm512_test_epi64_mask(v, v) != 0) break;
+  }
+  return FindFirstBitFrom(p, i, n, bit);
+}
+
+#endif
+
+}  // namespace
+
+const BitKernels *GetBitKernels(BitKernelsISA isa) {
+  static const BitKernels scalar_kernels = {
+      BitKernelsISA::kScalar,
+      ScalarBitwise<BitwiseOp::kAnd>,
+      ScalarBitwise<BitwiseOp::kOr>,
+      ScalarBitwise<BitwiseOp::kXor>,
+      ScalarNot,
+      ScalarPopcount,
+      ScalarFindFirstBit,
+  };
+  if (isa == BitKernelsISA::kScalar) return &scalar_kernels;
+
+#ifdef KVROCKS_X86_BIT_KERNELS
+  __builtin_cpu_init();
+  static const BitKernels avx2_kernels = {
+      BitKernelsISA::kAVX2,
+      AVX2Bitwise<BitwiseOp::kAnd>,
+      AVX2Bitwise<BitwiseOp::kOr>,
+      AVX2Bitwise<BitwiseOp::kXor>,
+      AVX2Not,
+      AVX2Popcount,
+      AVX2FindFirstBit,
+  };
+  // VPOPCNTQ came after the other AVX-512 instructions, so the popcount may still be the AVX2 one
+  static const BitKernels avx512_kernels = {
+      BitKernelsISA::kAVX512,
+      AVX512Bitwise<BitwiseOp::kAnd>,
+      AVX512Bitwise<BitwiseOp::kOr>,
+      AVX512Bitwise<BitwiseOp::kXor>,
+      AVX512Not,
+      __builtin_cpu_supports("avx512vpopcntdq") ? AVX512Popcount : AVX2Popcount,
+      AVX512FindFirstBit,
+  };
+  bool has_avx2 = __builtin_cpu_supports("avx2");
+  if (isa == BitKernelsISA::kAVX2 && has_avx2) return &avx2_kernels;
+  if (isa == BitKernelsISA::kAVX512 && has_avx2 && __builtin_cpu_supports("avx512f")) return &avx512_kernels;
+#endif
+
+  return nullptr;
+}
+
+const BitKernels &BitKernelsForCPU() {
+  static const BitKernels *kernels = [] {
+    for (auto isa : {BitKernelsISA::kAVX512, BitKernelsISA::kAVX2}) {
+      if (const auto *k = GetBitKernels(isa)) return k;
+    }
+    return GetBitKernels(BitKernelsISA::kScalar);
+  }();
+  return *kernels;
+}
+
+}  // namespace util
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+enum class BitKernelsISA {
+  kScalar,
+  kAVX2,
+  kAVX512,
+};
+
+// Kernels over the bytes of a bitmap, implemented with 64-bit words for any CPU
+// and with AVX2 or AVX-512 vectors for the x86-64 CPUs supporting them.
+struct BitKernels {
+  BitKernelsISA isa;
+  // dst[i] = dst[i] OP src[i] for i in [0, n)
+  void (*and_bytes)(uint8_t *dst, const uint8_t *src, size_t n);
+  void (*or_bytes)(uint8_t *dst, const uint8_t *src, size_t n);
+  void (*xor_bytes)(uint8_t *dst, const uint8_t *src, size_t n);
+  void (*not_bytes)(uint8_t *dst, size_t n);
+  size_t (*popcount)(const uint8_t *p, size_t n);
+  // The position of the first bit equal to `bit` in LSB numbering, or -1 if there's none
+  int64_t (*find_first_bit)(const uint8_t *p, size_t n, bool bit);
+};
+
+// The kernels of `isa`, or nullptr if the CPU or the build doesn't support it
+const BitKernels *GetBitKernels(BitKernelsISA isa);
+// The kernels of the widest instruction set the CPU supports, which is detected once
+const BitKernels &BitKernelsForCPU();
+
+inline void BitwiseAnd(uint8_t *dst, const uint8_t *src, size_t n) { BitKernelsForCPU().and_bytes(dst, src, n); }
+inline void BitwiseOr(uint8_t *dst, const uint8_t *src, size_t n) { BitKernelsForCPU().or_bytes(dst, src, n); }
+inline void BitwiseXor(uint8_t *dst, const uint8_t *src, size_t n) { BitKernelsForCPU().xor_bytes(dst, src, n); }
+inline void BitwiseNot(uint8_t *dst, size_t n) { BitKernelsForCPU().not_bytes(dst, n); }
+inline size_t Popcount(const uint8_t *p, size_t n) { return BitKernelsForCPU().popcount(p, n); }
+inline int64_t FindFirstBit(const uint8_t *p, size_t n, bool bit) {
+  return BitKernelsForCPU().find_first_bit(p, n, bit);
+}
+
+}  // namespace util
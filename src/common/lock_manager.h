@@ -22,6 +22,7 @@
 
 #include <rocksdb/db.h>
 
+#include <algorithm>
 #include <functional>
 #include <mutex>
 #include <set>
@@ -79,11 +80,22 @@ class LockManager {
   unsigned hash(std::string_view key) const { return std::hash<std::string_view>{}(key)&hash_mask_; }
 };
 
+// The locks held by the transaction running in the current thread, see TxnLockGuard
+inline thread_local const std::vector<std::mutex *> *txn_held_locks = nullptr;
+
+inline bool IsHeldByCurrentTxn(std::mutex *lock) {
+  return txn_held_locks && std::find(txn_held_locks->begin(), txn_held_locks->end(), lock) != txn_held_locks->end();
+}
+
 class LockGuard {
  public:
   template <typename KeyType>
   explicit LockGuard(LockManager *lock_mgr, const KeyType &key) : lock_(lock_mgr->Get(key)) {
-    lock_->lock();
+    if (IsHeldByCurrentTxn(lock_)) {
+      lock_ = nullptr;
+    } else {
+      lock_->lock();
+    }
   }
   ~LockGuard() {
     if (lock_) lock_->unlock();
@@ -110,6 +122,9 @@ class MultiLockGuard {
  public:
   template <typename Keys>
   explicit MultiLockGuard(LockManager *lock_mgr, const Keys &keys) : locks_(lock_mgr->MultiGet(keys)) {
+    if (txn_held_locks) {
+      locks_.erase(std::remove_if(locks_.begin(), locks_.end(), IsHeldByCurrentTxn), locks_.end());
+    }
     for (const auto &iter : locks_) {
       iter->lock();
     }
@@ -127,6 +142,35 @@ class MultiLockGuard {
 
   MultiLockGuard(MultiLockGuard &&guard) : locks_(std::move(guard.locks_)) {}
 
+  const std::vector<std::mutex *> &GetLocks() const { return locks_; }
+
  private:
   std::vector<std::mutex *> locks_;
 };
+
+// TxnLockGuard locks all keys of a transaction until it's committed. The commands in the
+// transaction lock their keys again while executing, so the lock guards in the same thread
+// skip the locks which are already held by the transaction instead of deadlocking on them.
+//
+// The guards can be nested, e.g. EVAL inside MULTI, the inner one also treats the locks of
+// the outer one as held and restores them when it's released.
+class TxnLockGuard {
+ public:
+  template <typename Keys>
+  explicit TxnLockGuard(LockManager *lock_mgr, const Keys &keys)
+      : guard_(lock_mgr, keys), outer_held_locks_(txn_held_locks), held_locks_(guard_.GetLocks()) {
+    if (outer_held_locks_) {
+      held_locks_.insert(held_locks_.end(), outer_held_locks_->begin(), outer_held_locks_->end());
+    }
+    txn_held_locks = &held_locks_;
+  }
+  ~TxnLockGuard() { txn_held_locks = outer_held_locks_; }
+
+  TxnLockGuard(const TxnLockGuard &) = delete;
+  TxnLockGuard &operator=(const TxnLockGuard &) = delete;
+
+ private:
+  MultiLockGuard guard_;
+  const std::vector<std::mutex *> *outer_held_locks_;
+  std::vector<std::mutex *> held_locks_;
+};
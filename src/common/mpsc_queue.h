@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// MPSCQueue is a lock-free unbounded queue with multiple producers and a single consumer.
+//
+// Producers push onto an intrusive stack with one CAS, and the consumer takes all the pushed
+// items with one exchange and reverses them into the pushed order. Push reports whether the
+// queue was empty, so producers only need to wake up the consumer once per batch.
+template <typename T>
+class MPSCQueue {
+ public:
+  MPSCQueue() = default;
+  ~MPSCQueue() {
+    PopAll([](T &&) {});
+  }
+
+  MPSCQueue(const MPSCQueue &) = delete;
+  MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+  // Return true if the queue was empty before, then the consumer should be notified
+  bool Push(T value) {
+    auto node = new Node{std::move(value), nullptr};
+    auto head = head_.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!head_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+    return head == nullptr;
+  }
+
+  // Call fn on all the items in the pushed order of each producer, and return the number of items.
+  // It must only be called by the consumer.
+  template <typename F>
+  size_t PopAll(F &&fn) {
+    Node *head = head_.exchange(nullptr, std::memory_order_acquire);
+    Node *first = nullptr;
+    while (head) {
+      auto next = head->next;
+      head->next = first;
+      first = head;
+      head = next;
+    }
+
+    size_t count = 0;
+    while (first) {
+      auto next = first->next;
+      fn(std::move(first->value));
+      delete first;
+      first = next;
+      count++;
+    }
+    return count;
+  }
+
+  bool Empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+ private:
+  struct Node {
+    T value;
+    Node *next;
+  };
+
+  std::atomic<Node *> head_ = nullptr;
+};
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <tsl/htrie_map.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "string_util.h"
+
+// PatternIndex maps glob-style patterns to values, and finds the patterns matching a string
+// without evaluating all of them. The patterns are indexed by their literal prefixes (the part
+// before the first wildcard) in a trie, so only the patterns whose literal prefix is a prefix
+// of the string are candidates, and only the rest of their patterns need to be matched.
+//
+// The matching result is the same as util::StringMatch with case sensitivity.
+template <typename T>
+class PatternIndex {
+ public:
+  PatternIndex() = default;
+  PatternIndex(const PatternIndex &) = delete;
+  PatternIndex &operator=(const PatternIndex &) = delete;
+
+  size_t Size() const { return patterns_.size(); }
+
+  // Return the value of the pattern, a default constructed value is added if it doesn't exist
+  T &operator[](const std::string &pattern) {
+    auto [iter, inserted] = patterns_.try_emplace(pattern);
+    auto &entry = iter->second;
+    if (inserted) {
+      entry.pattern = &iter->first;
+      auto [prefix, rest_pos] = literalPrefix(pattern);
+      entry.prefix_len = prefix.size();
+      entry.rest_pos = rest_pos;
+      entry.kind = patternKind(std::string_view(pattern).substr(rest_pos));
+      auto &bucket = prefixes_[prefix];
+      bucket.prefix_len = prefix.size();
+      bucket.entries.push_back(&entry);
+    }
+    return entry.value;
+  }
+
+  T *Find(const std::string &pattern) {
+    auto iter = patterns_.find(pattern);
+    return iter == patterns_.end() ? nullptr : &iter->second.value;
+  }
+
+  void Erase(const std::string &pattern) {
+    auto iter = patterns_.find(pattern);
+    if (iter == patterns_.end()) return;
+
+    auto prefix = literalPrefix(pattern).first;
+    auto bucket = prefixes_.find(prefix);
+    auto &entries = bucket.value().entries;
+    entries.erase(std::find(entries.begin(), entries.end(), &iter->second));
+    if (entries.empty()) prefixes_.erase(bucket);
+    patterns_.erase(iter);
+  }
+
+  // Call fn(pattern, value) for each pattern which matches the string
+  template <typename F>
+  void ForEachMatch(std::string_view str, F &&fn) const {
+    auto key = str;
+    while (true) {
+      // Walk through the literal prefixes of the string from the longest one
+      auto bucket = prefixes_.longest_prefix_ks(key.data(), key.size());
+      if (bucket == prefixes_.end()) return;
+
+      for (const auto *entry : bucket.value().entries) {
+        if (entry->Match(str)) fn(*entry->pattern, entry->value);
+      }
+
+      size_t prefix_len = bucket.value().prefix_len;
+      if (prefix_len == 0) return;
+      key = str.substr(0, prefix_len - 1);
+    }
+  }
+
+ private:
+  // The trie can't hold very long keys, the rest of long prefixes is matched as patterns
+  static constexpr size_t kMaxPrefixLength = 1024;
+
+  enum class Kind {
+    kLiteral,  // No wildcard, e.g. "news"
+    kAny,      // Only '*' after the literal prefix, e.g. "news.*"
+    kGlob,
+  };
+
+  struct Entry {
+    const std::string *pattern = nullptr;
+    size_t prefix_len = 0;
+    size_t rest_pos = 0;
+    Kind kind = Kind::kGlob;
+    T value;
+
+    // The string must start with the literal prefix
+    bool Match(std::string_view str) const {
+      if (str.size() == prefix_len) {
+        // Keep the corner cases of matching the empty string, e.g. "*" doesn't match ""
+        return util::StringMatchLen(pattern->data(), pattern->size(), str.data(), str.size(), 0);
+      }
+      switch (kind) {
+        case Kind::kLiteral:
+          return false;
+        case Kind::kAny:
+          return true;
+        case Kind::kGlob:
+          return util::StringMatchLen(pattern->data() + rest_pos, pattern->size() - rest_pos, str.data() + prefix_len,
+                                      str.size() - prefix_len, 0);
+      }
+      return false;
+    }
+  };
+
+  struct Bucket {
+    size_t prefix_len = 0;
+    std::vector<Entry *> entries;
+  };
+
+  // Return the literal prefix of the pattern with escapes removed, and the position after it
+  static std::pair<std::string, size_t> literalPrefix(std::string_view pattern) {
+    std::string prefix;
+    size_t i = 0;
+    while (i < pattern.size() && prefix.size() < kMaxPrefixLength) {
+      char c = pattern[i];
+      if (c == '*' || c == '?' || c == '[') break;
+      if (c == '\\' && i + 1 < pattern.size()) {
+        prefix.push_back(pattern[i + 1]);
+        i += 2;
+      } else {
+        prefix.push_back(c);
+        i++;
+      }
+    }
+    return {prefix, i};
+  }
+
+  static Kind patternKind(std::string_view rest) {
+    if (rest.empty()) return Kind::kLiteral;
+    if (rest.find_first_not_of('*') == std::string_view::npos) return Kind::kAny;
+    return Kind::kGlob;
+  }
+
+  std::map<std::string, Entry> patterns_;
+  tsl::htrie_map<char, Bucket> prefixes_;
+};
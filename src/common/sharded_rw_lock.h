@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// ShardedRWLock is a reader-writer lock for read-mostly critical sections, e.g. the
+// concurrency guard of commands which is acquired by every command but is rarely
+// acquired exclusively.
+//
+// Every thread registers its readers in its own cache-line aligned slot, so the shared
+// path doesn't bounce a global counter between cores. The exclusive path announces
+// itself first, and then waits for all slots to drain, which means new readers
+// will wait until the exclusive owner has finished.
+//
+// It meets the Lockable and SharedLockable requirements, so it can be used with
+// std::unique_lock and std::shared_lock. It's NOT reentrant: a thread holding the
+// shared lock must not acquire it again, otherwise it may deadlock with a writer.
+// The shared lock must also be released by the thread which acquired it.
+class ShardedRWLock {
+ public:
+  static constexpr size_t kSlots = 128;
+
+  ShardedRWLock() = default;
+  ShardedRWLock(const ShardedRWLock &) = delete;
+  ShardedRWLock &operator=(const ShardedRWLock &) = delete;
+
+  void lock_shared() {  // NOLINT
+    auto &readers = slots_[slotIndex()].readers;
+    while (true) {
+      // Pairs with the writer: either the writer sees our increment while draining,
+      // or we see the writer flag here and back off.
+      readers.fetch_add(1, std::memory_order_seq_cst);
+      if (!writer_.load(std::memory_order_seq_cst)) return;
+
+      readers.fetch_sub(1, std::memory_order_release);
+      std::unique_lock<std::mutex> guard(mu_);
+      cv_.wait(guard, [this] { return !writer_.load(std::memory_order_relaxed); });
+    }
+  }
+
+  bool try_lock_shared() {  // NOLINT
+    auto &readers = slots_[slotIndex()].readers;
+    readers.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer_.load(std::memory_order_seq_cst)) return true;
+    readers.fetch_sub(1, std::memory_order_release);
+    return false;
+  }
+
+  void unlock_shared() { slots_[slotIndex()].readers.fetch_sub(1, std::memory_order_release); }  // NOLINT
+
+  void lock() {  // NOLINT
+    writer_mu_.lock();
+    {
+      std::lock_guard<std::mutex> guard(mu_);
+      writer_.store(true, std::memory_order_seq_cst);
+    }
+    for (auto &slot : slots_) {
+      for (int spins = 0; slot.readers.load(std::memory_order_seq_cst) != 0; spins++) {
+        if (spins < 128) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+      }
+    }
+  }
+
+  bool try_lock() {  // NOLINT
+    if (!writer_mu_.try_lock()) return false;
+    {
+      std::lock_guard<std::mutex> guard(mu_);
+      writer_.store(true, std::memory_order_seq_cst);
+    }
+    for (auto &slot : slots_) {
+      if (slot.readers.load(std::memory_order_seq_cst) != 0) {
+        unlock();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() {  // NOLINT
+    {
+      std::lock_guard<std::mutex> guard(mu_);
+      writer_.store(false, std::memory_order_seq_cst);
+    }
+    cv_.notify_all();
+    writer_mu_.unlock();
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<int64_t> readers = 0;
+  };
+
+  // Each thread sticks to one slot, threads are spread over the slots in the order
+  // of their first acquisition, so the worker threads normally own a slot each.
+  static size_t slotIndex() {
+    static std::atomic<size_t> next_index = 0;
+    thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % kSlots;
+    return index;
+  }
+
+  std::array<Slot, kSlots> slots_;
+  std::atomic<bool> writer_ = false;
+
+  // Serializes the writers
+  std::mutex writer_mu_;
+  // Readers wait on it while a writer is active
+  std::mutex mu_;
+  std::condition_variable cv_;
+};
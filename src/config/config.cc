@@ -83,6 +83,12 @@ const std::vector<ConfigEnum<BlockCacheType>> cache_types{[] {
   return res;
 }()};
 
+const std::vector<ConfigEnum<PublishReplicationMode>> publish_replication_modes{
+    {"wal", PublishReplicationMode::kWAL},
+    {"memory", PublishReplicationMode::kMemory},
+    {"memory-ordered", PublishReplicationMode::kMemoryOrdered},
+};
+
 const std::vector<ConfigEnum<MigrationType>> migration_types{{"redis-command", MigrationType::kRedisCommand},
                                                              {"raw-key-value", MigrationType::kRawKeyValue}};
 
@@ -123,6 +129,7 @@ Config::Config() {
       {"tls-replication", true, new YesNoField(&tls_replication, false)},
 #endif
       {"workers", false, new IntField(&workers, 8, 1, 256)},
+      {"async-execution-threads", true, new IntField(&async_execution_threads, 0, 0, 256)},
       {"timeout", false, new IntField(&timeout, 0, 0, INT_MAX)},
       {"tcp-backlog", true, new IntField(&backlog, 511, 0, INT_MAX)},
       {"maxclients", false, new IntField(&maxclients, 10240, 0, INT_MAX)},
@@ -149,6 +156,7 @@ Config::Config() {
       {"max-io-mb", false, new IntField(&max_io_mb, 0, 0, INT_MAX)},
       {"max-bitmap-to-string-mb", false, new IntField(&max_bitmap_to_string_mb, 16, 0, INT_MAX)},
       {"max-db-size", false, new IntField(&max_db_size, 0, 0, INT_MAX)},
+      {"metadata-cache-size", true, new IntField(&metadata_cache_size, 0, 0, INT_MAX)},
       {"max-replication-mb", false, new IntField(&max_replication_mb, 0, 0, INT_MAX)},
       {"supervised", true, new EnumField<SupervisedMode>(&supervised_mode, supervised_modes, kSupervisedNone)},
       {"slave-serve-stale-data", false, new YesNoField(&slave_serve_stale_data, true)},
@@ -156,6 +164,9 @@ Config::Config() {
       {"slave-priority", false, new IntField(&slave_priority, 100, 0, INT_MAX)},
       {"slave-read-only", false, new YesNoField(&slave_readonly, true)},
       {"use-rsid-psync", true, new YesNoField(&use_rsid_psync, false)},
+      {"publish-replication-mode", false,
+       new EnumField<PublishReplicationMode>(&publish_replication_mode, publish_replication_modes,
+                                             PublishReplicationMode::kWAL)},
       {"profiling-sample-ratio", false, new IntField(&profiling_sample_ratio, 0, 0, 100)},
       {"profiling-sample-record-max-len", false, new IntField(&profiling_sample_record_max_len, 256, 0, INT_MAX)},
       {"profiling-sample-record-threshold-ms", false,
@@ -182,9 +193,19 @@ Config::Config() {
       {"redis-cursor-compatible", false, new YesNoField(&redis_cursor_compatible, false)},
       {"resp3-enabled", false, new YesNoField(&resp3_enabled, false)},
       {"repl-namespace-enabled", false, new YesNoField(&repl_namespace_enabled, false)},
+      {"string-chunk-threshold", false, new IntField(&string_chunk_threshold, 0, 0, INT_MAX)},
+      {"inline-collection-max-entries", false, new IntField(&inline_collection_max_entries, 0, 0, INT_MAX)},
+      {"inline-collection-max-bytes", false, new IntField(&inline_collection_max_bytes, 512, 0, INT_MAX)},
+      {"list-chunk-max-entries", false, new IntField(&list_chunk_max_entries, 0, 0, INT_MAX)},
+      {"bitmap-compressed-segments", false, new YesNoField(&bitmap_compressed_segments, false)},
+      {"bitmap-popcount-summary", false, new YesNoField(&bitmap_popcount_summary, false)},
+      {"bloom-filter-paged", false, new YesNoField(&bloom_filter_paged, false)},
       {"json-max-nesting-depth", false, new IntField(&json_max_nesting_depth, 1024, 0, INT_MAX)},
       {"json-storage-format", false,
        new EnumField<JsonStorageFormat>(&json_storage_format, json_storage_formats, JsonStorageFormat::JSON)},
+      {"json-segment-threshold", false, new IntField(&json_segment_threshold, 0, 0, INT_MAX)},
+      {"zset-rank-index", false, new YesNoField(&zset_rank_index, false)},
+      {"lua-strict-key-accessing", false, new YesNoField(&lua_strict_key_accessing, false)},
 
       /* rocksdb options */
       {"rocksdb.compression", false,
@@ -244,6 +265,11 @@ Config::Config() {
       {"rocksdb.write_options.low_pri", true, new YesNoField(&rocks_db.write_options.low_pri, false)},
       {"rocksdb.write_options.memtable_insert_hint_per_batch", true,
        new YesNoField(&rocks_db.write_options.memtable_insert_hint_per_batch, false)},
+      {"rocksdb.write_options.group_commit", true, new YesNoField(&rocks_db.write_options.group_commit, false)},
+      {"rocksdb.write_options.group_commit_max_delay_us", true,
+       new IntField(&rocks_db.write_options.group_commit_max_delay_us, 100, 0, 1000000)},
+      {"rocksdb.write_options.group_commit_max_bytes", true,
+       new IntField(&rocks_db.write_options.group_commit_max_bytes, 1 * MiB, 1, INT_MAX)},
 
       /* rocksdb read options */
       {"rocksdb.read_options.async_io", false, new YesNoField(&rocks_db.read_options.async_io, false)},
@@ -57,6 +57,8 @@ constexpr const char *kDefaultNamespace = "__namespace";
 
 enum class BlockCacheType { kCacheTypeLRU = 0, kCacheTypeHCC };
 
+enum class PublishReplicationMode { kWAL = 0, kMemory, kMemoryOrdered };
+
 struct CompactionCheckerRange {
  public:
   int start;
@@ -96,6 +98,7 @@ struct Config {
   bool tls_replication = false;
 
   int workers = 0;
+  int async_execution_threads = 0;
   int timeout = 0;
   int log_level = 0;
   int backlog = 511;
@@ -111,6 +114,7 @@ struct Config {
   bool slave_empty_db_before_fullsync = false;
   int slave_priority = 100;
   int max_db_size = 0;
+  int metadata_cache_size = 0;
   int max_replication_mb = 0;
   int max_io_mb = 0;
   int max_bitmap_to_string_mb = 16;
@@ -119,6 +123,7 @@ struct Config {
   bool auto_resize_block_and_sst = true;
   int fullsync_recv_file_delay = 0;
   bool use_rsid_psync = false;
+  PublishReplicationMode publish_replication_mode = PublishReplicationMode::kWAL;
   std::vector<std::string> binds;
   std::string dir;
   std::string db_dir;
@@ -168,9 +173,33 @@ struct Config {
   std::set<std::string> profiling_sample_commands;
   bool profiling_sample_all_commands = false;
 
+  // string
+  int string_chunk_threshold = 0;
+
+  // hash, set and zset
+  int inline_collection_max_entries = 0;
+  int inline_collection_max_bytes = 512;
+
+  // list
+  int list_chunk_max_entries = 0;
+
+  // bitmap
+  bool bitmap_compressed_segments = false;
+  bool bitmap_popcount_summary = false;
+
+  // bloom filter
+  bool bloom_filter_paged = false;
+
   // json
   int json_max_nesting_depth = 1024;
   JsonStorageFormat json_storage_format = JsonStorageFormat::JSON;
+  int json_segment_threshold = 0;
+
+  // zset
+  bool zset_rank_index = false;
+
+  // lua
+  bool lua_strict_key_accessing = false;
 
   struct RocksDB {
     int block_size;
@@ -218,6 +247,9 @@ struct Config {
       bool no_slowdown;
       bool low_pri;
       bool memtable_insert_hint_per_batch;
+      bool group_commit;
+      int group_commit_max_delay_us;
+      int group_commit_max_bytes;
     } write_options;
 
     struct ReadOptions {
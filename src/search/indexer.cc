@@ -59,11 +59,8 @@ rocksdb::Status FieldValueRetriever::Retrieve(std::string_view field, std::strin
   if (std::holds_alternative<HashData>(db)) {
     auto &[hash, metadata, key] = std::get<HashData>(db);
     std::string ns_key = hash.AppendNamespacePrefix(key);
-    LatestSnapShot ss(hash.storage_);
     rocksdb::ReadOptions read_options;
-    read_options.snapshot = ss.GetSnapShot();
-    std::string sub_key = InternalKey(ns_key, field, metadata.version, hash.storage_->IsSlotIdEncoded()).Encode();
-    return hash.storage_->Get(read_options, sub_key, output);
+    return hash.getSubKey(read_options, ns_key, metadata, field, output);
   } else if (std::holds_alternative<JsonData>(db)) {
     auto &value = std::get<JsonData>(db);
     auto s = value.Get(field);
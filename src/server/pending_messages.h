@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "mpsc_queue.h"
+
+// PendingMessages queues the messages posted to the connections of a worker from other threads,
+// like the published messages or the wakeups of blocked clients, until the worker drains them.
+//
+// A message is addressed by both the fd and the id of the connection, since the connection may be
+// closed before the message is drained, and its fd reused by a new connection in the meantime.
+class PendingMessages {
+ public:
+  // The message enables the write event of the connection if there's no reply
+  struct Message {
+    int fd;
+    uint64_t id;
+    std::shared_ptr<const std::string> reply;
+  };
+
+  // Return true if the queue was empty before, then the worker should be woken up
+  bool Post(int fd, uint64_t id, std::shared_ptr<const std::string> reply) {
+    return queue_.Push({fd, id, std::move(reply)});
+  }
+
+  // Deliver the messages to the connections returned by find(fd), the messages to the connections
+  // which don't exist anymore are dropped. It must only be called by the worker.
+  template <typename Find, typename Deliver>
+  void Drain(Find &&find, Deliver &&deliver) {
+    queue_.PopAll([&find, &deliver](Message &&msg) {
+      auto conn = find(msg.fd);
+      if (!conn || conn->GetID() != msg.id) return;
+      deliver(conn, msg.reply);
+    });
+  }
+
+ private:
+  MPSCQueue<Message> queue_;
+};
@@ -22,7 +22,9 @@
 #include <rocksdb/iostats_context.h>
 #include <rocksdb/perf_context.h>
 
+#include <map>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 
 #include "commands/commander.h"
@@ -33,17 +35,38 @@
 #endif
 
 #include "commands/blocking_commander.h"
+#include "encoding.h"
 #include "redis_connection.h"
 #include "scope_exit.h"
 #include "server.h"
+#include "storage/redis_db.h"
 #include "time_util.h"
 #include "tls_util.h"
 #include "worker.h"
 
 namespace redis {
 
+// The maximum number of pipelined commands resolved by one batch of point reads
+constexpr size_t kMaxPointReadBatchSize = 1024;
+
+enum class PointReadCommand { kGet, kExists, kType, kHGet, kSIsMember, kZScore };
+
+static std::optional<PointReadCommand> ToPointReadCommand(const std::string &cmd_name) {
+  static const std::map<std::string, PointReadCommand> point_read_commands = {
+      {"get", PointReadCommand::kGet},
+      {"exists", PointReadCommand::kExists},
+      {"type", PointReadCommand::kType},
+      {"hget", PointReadCommand::kHGet},
+      {"sismember", PointReadCommand::kSIsMember},
+      {"zscore", PointReadCommand::kZScore},
+  };
+  auto iter = point_read_commands.find(cmd_name);
+  if (iter == point_read_commands.end()) return std::nullopt;
+  return iter->second;
+}
+
 Connection::Connection(bufferevent *bev, Worker *owner)
-    : need_free_bev_(true), bev_(bev), req_(owner->srv), owner_(owner), srv_(owner->srv) {
+    : need_free_bev_(true), bev_(bev), req_(&owner->srv->stats), owner_(owner), srv_(owner->srv) {
   int64_t now = util::GetTimeStamp();
   create_time_ = now;
   last_interaction_ = now;
@@ -70,6 +93,14 @@ std::string Connection::ToString() {
 }
 
 void Connection::Close() {
+  // The async execution pool is still using this connection, so defer closing
+  // until the worker is notified that the execution is done. The terminated
+  // worker has waited for the async executions before closing its connections.
+  if (executing_async_ && !owner_->IsTerminated()) {
+    EnableFlag(kCloseAsync);
+    return;
+  }
+
   if (close_cb) close_cb(GetFD());
   owner_->FreeConnection(this);
 }
@@ -77,6 +108,9 @@ void Connection::Close() {
 void Connection::Detach() { owner_->DetachConnection(this); }
 
 void Connection::OnRead(struct bufferevent *bev) {
+  // The input will be processed after the in-flight async execution is done
+  if (executing_async_) return;
+
   is_running_ = true;
   MakeScopeExit([this] { is_running_ = false; });
 
@@ -95,6 +129,24 @@ void Connection::OnRead(struct bufferevent *bev) {
   }
 }
 
+void Connection::OnAsyncExecutionDone() {
+  executing_async_ = false;
+
+  if (IsFlagEnabled(kCloseAsync)) {
+    Close();
+    return;
+  }
+  if (IsFlagEnabled(kCloseAfterReply)) {
+    // OnWrite will close the connection once the pending replies are flushed
+    if (evbuffer_get_length(Output()) == 0) Close();
+    return;
+  }
+
+  bufferevent_enable(bev_, EV_READ);
+  // Continue with the remaining pipelined commands and the input received in the meantime
+  OnRead(bev_);
+}
+
 void Connection::OnWrite(bufferevent *bev) {
   if (IsFlagEnabled(kCloseAfterReply) || IsFlagEnabled(kCloseAsync)) {
     Close();
@@ -233,6 +285,7 @@ bool Connection::IsFlagEnabled(Flag flag) const { return (flags_ & flag) > 0; }
 
 bool Connection::CanMigrate() const {
   return !is_running_                                                    // reading or writing
+         && !executing_async_                                            // executing in the async pool
          && !IsFlagEnabled(redis::Connection::kCloseAfterReply)          // close after reply
          && saved_current_command_ == nullptr                            // not executing blocking command like BLPOP
          && subscribe_channels_.empty() && subscribe_patterns_.empty();  // not subscribing any channel
@@ -391,6 +444,176 @@ void Connection::RecordProfilingSampleIfNeed(const std::string &cmd, uint64_t du
   srv_->GetPerfLog()->PushEntry(std::move(entry));
 }
 
+// Only the commands which access the storage by keys are worth to be executed asynchronously,
+// the others are cheap or need to run on the worker thread, since they may modify the state of
+// the worker or the event callbacks of the connection.
+bool Connection::canExecuteAsync(const CommandTokens &cmd_tokens) const {
+  if (IsFlagEnabled(kMultiExec) || IsFlagEnabled(kMonitor) || IsFlagEnabled(kSlave)) return false;
+
+  auto commands = CommandTable::Get();
+  auto iter = commands->find(util::ToLower(cmd_tokens.front()));
+  if (iter == commands->end()) return false;
+
+  const auto attributes = iter->second;
+  auto cmd_flags = attributes->GenerateFlags(cmd_tokens);
+  if (!(cmd_flags & (kCmdWrite | kCmdReadOnly))) return false;
+  if (cmd_flags &
+      (kCmdExclusive | kCmdBlocking | kCmdPubSub | kCmdMulti | kCmdScript | kCmdROScript | kCmdReplication)) {
+    return false;
+  }
+  return attributes->key_range.first_key != 0;
+}
+
+bool Connection::dispatchAsync() {
+  executing_async_ = true;
+  // Stop reading until the execution is done, the commands queued in the request mustn't be
+  // touched by the worker while the async execution pool is processing them.
+  bufferevent_disable(bev_, EV_READ);
+  auto s = srv_->PublishAsyncExecution([this, tracker = owner_->TrackAsyncExecution()] {
+    ExecuteCommands(req_.GetCommands());
+    owner_->PostAsyncExecutionDone(this);
+  });
+  if (!s.IsOK()) {
+    // Fallback to execute in the worker if the pool is overloaded
+    executing_async_ = false;
+    bufferevent_enable(bev_, EV_READ);
+    return false;
+  }
+  return true;
+}
+
+// The point reads are only batched if the connection is in a plain state,
+// otherwise the commands go through the regular checks one by one.
+bool Connection::canBatchPointReads() const {
+  Config *config = srv_->GetConfig();
+  if (ns_.empty() || IsFlagEnabled(kMultiExec) || IsFlagEnabled(kCloseAfterReply)) return false;
+  if (srv_->IsLoading() || config->profiling_sample_ratio > 0) return false;
+  if (!config->slave_serve_stale_data && srv_->IsSlave() && srv_->GetReplicationState() != kReplConnected) {
+    return false;
+  }
+  return true;
+}
+
+// executePointReads resolves a run of pipelined point read commands (e.g. GET, HGET) at the
+// front of the queue with batched MultiGet calls, and replies them in order. It returns
+// the number of executed commands, the commands which can't be served by the batch
+// (e.g. wrong type or errors) are left to the regular execution.
+size_t Connection::executePointReads(std::deque<CommandTokens> *to_process_cmds) {
+  struct BatchedCommand {
+    const CommandAttributes *attributes;
+    PointReadCommand type;
+    size_t first_read;
+    size_t num_reads;
+  };
+
+  Config *config = srv_->GetConfig();
+  auto commands = CommandTable::Get();
+  std::vector<BatchedCommand> batched_cmds;
+  std::vector<Database::PointRead> reads;
+  for (const auto &cmd_tokens : *to_process_cmds) {
+    if (batched_cmds.size() >= kMaxPointReadBatchSize || cmd_tokens.empty()) break;
+
+    auto iter = commands->find(util::ToLower(cmd_tokens.front()));
+    if (iter == commands->end()) break;
+    const auto attributes = iter->second;
+    auto type = ToPointReadCommand(attributes->name);
+    if (!type || !attributes->CheckArity(static_cast<int>(cmd_tokens.size()))) break;
+    if (config->cluster_enabled && !srv_->cluster->CanExecByMySelf(attributes, cmd_tokens, this).IsOK()) break;
+
+    BatchedCommand batched_cmd{attributes, *type, reads.size(), 0};
+    switch (*type) {
+      case PointReadCommand::kGet:
+        reads.push_back({kRedisString, cmd_tokens[1]});
+        break;
+      case PointReadCommand::kType:
+        reads.push_back({kRedisNone, cmd_tokens[1]});
+        break;
+      case PointReadCommand::kExists:
+        for (size_t i = 1; i < cmd_tokens.size(); i++) {
+          reads.push_back({kRedisNone, cmd_tokens[i]});
+        }
+        break;
+      case PointReadCommand::kHGet:
+        reads.push_back({kRedisHash, cmd_tokens[1], cmd_tokens[2], true});
+        break;
+      case PointReadCommand::kSIsMember:
+        reads.push_back({kRedisSet, cmd_tokens[1], cmd_tokens[2], true});
+        break;
+      case PointReadCommand::kZScore:
+        reads.push_back({kRedisZSet, cmd_tokens[1], cmd_tokens[2], true});
+        break;
+    }
+    batched_cmd.num_reads = reads.size() - batched_cmd.first_read;
+    batched_cmds.emplace_back(batched_cmd);
+  }
+  // It's not worth batching a single command
+  if (batched_cmds.size() < 2) return 0;
+
+  auto concurrency = srv_->WorkConcurrencyGuard();
+  auto start = std::chrono::high_resolution_clock::now();
+  Database database(srv_->storage, ns_);
+  std::vector<Database::PointReadResult> results;
+  database.MultiPointRead(reads, &results);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::string> replies;
+  for (const auto &batched_cmd : batched_cmds) {
+    const auto &result = results[batched_cmd.first_read];
+    // Only the found and not found results can be replied here, the others
+    // will be executed again by the regular command implementation.
+    if (batched_cmd.type != PointReadCommand::kExists && !result.status.ok() && !result.status.IsNotFound()) break;
+
+    std::string reply;
+    switch (batched_cmd.type) {
+      case PointReadCommand::kGet:
+      case PointReadCommand::kHGet:
+        reply = result.status.ok() ? BulkString(result.value) : NilString();
+        break;
+      case PointReadCommand::kType:
+        if (result.status.ok() && result.type >= RedisTypeNames.size()) break;
+        reply = SimpleString(RedisTypeNames[result.status.ok() ? result.type : kRedisNone]);
+        break;
+      case PointReadCommand::kExists: {
+        int cnt = 0;
+        for (size_t i = 0; i < batched_cmd.num_reads; i++) {
+          const auto &status = results[batched_cmd.first_read + i].status;
+          if (!status.ok() && !status.IsNotFound()) {
+            cnt = -1;
+            break;
+          }
+          if (status.ok()) cnt++;
+        }
+        if (cnt >= 0) reply = Integer(cnt);
+        break;
+      }
+      case PointReadCommand::kSIsMember:
+        reply = Integer(result.status.ok() ? 1 : 0);
+        break;
+      case PointReadCommand::kZScore:
+        reply = result.status.ok() ? Double(DecodeDouble(result.value.data())) : NilString();
+        break;
+    }
+    if (reply.empty()) break;
+    replies.emplace_back(std::move(reply));
+  }
+
+  // The duration is shared by all commands in the batch
+  uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / batched_cmds.size();
+  for (size_t i = 0; i < replies.size(); i++) {
+    const auto &cmd_name = batched_cmds[i].attributes->name;
+    auto cmd_tokens = std::move(to_process_cmds->front());
+    to_process_cmds->pop_front();
+
+    SetLastCmd(cmd_name);
+    srv_->stats.IncrCalls(cmd_name);
+    srv_->SlowlogPushEntryIfNeeded(&cmd_tokens, duration, this);
+    srv_->stats.IncrLatency(duration, cmd_name);
+    srv_->FeedMonitorConns(this, cmd_tokens);
+    Reply(replies[i]);
+  }
+  return replies.size();
+}
+
 Status Connection::ExecuteCommand(const std::string &cmd_name, const std::vector<std::string> &cmd_tokens,
                                   Commander *current_cmd, std::string *reply) {
   srv_->stats.IncrCalls(cmd_name);
@@ -411,8 +634,26 @@ Status Connection::ExecuteCommand(const std::string &cmd_name, const std::vector
 void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
   Config *config = srv_->GetConfig();
   std::string reply, password = config->requirepass;
+  // Share the read snapshots between the commands of the pipeline until a write happens
+  redis::SnapshotPinner snapshot_pinner(srv_->storage);
 
   while (!to_process_cmds->empty()) {
+    if (srv_->IsAsyncExecutionEnabled() && to_process_cmds == req_.GetCommands() &&
+        !to_process_cmds->front().empty()) {
+      // Hand over the remaining commands between the worker and the async execution pool,
+      // so the commands of the connection are still executed one by one in order.
+      bool async = canExecuteAsync(to_process_cmds->front());
+      if (async && !executing_async_) {
+        if (dispatchAsync()) return;
+      } else if (!async && executing_async_) {
+        return;
+      }
+    }
+
+    if (to_process_cmds == req_.GetCommands() && to_process_cmds->size() > 1 && canBatchPointReads()) {
+      if (executePointReads(to_process_cmds) > 0) continue;
+    }
+
     auto cmd_tokens = to_process_cmds->front();
     to_process_cmds->pop_front();
     if (cmd_tokens.empty()) continue;
@@ -431,6 +672,10 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
     const auto attributes = current_cmd->GetAttributes();
     auto cmd_name = attributes->name;
     auto cmd_flags = attributes->GenerateFlags(cmd_tokens);
+    // Scripts only lock their declared keys if they are not allowed to access other keys
+    if ((cmd_flags & kCmdScript) && config->lua_strict_key_accessing) {
+      cmd_flags &= ~kCmdExclusive;
+    }
 
     if (GetNamespace().empty()) {
       if (!password.empty()) {
@@ -444,14 +689,19 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
       }
     }
 
-    std::shared_lock<std::shared_mutex> concurrency;  // Allow concurrency
-    std::unique_lock<std::shared_mutex> exclusivity;  // Need exclusivity
+    std::shared_lock<ShardedRWLock> concurrency;  // Allow concurrency
+    std::unique_lock<ShardedRWLock> exclusivity;  // Need exclusivity
+    // EXEC locks the keys of the transaction instead of stopping the world if all of them are known
+    if (is_multi_exec && cmd_name == "exec" && !IsMultiExecExclusive()) {
+      cmd_flags &= ~kCmdExclusive;
+    }
+
     // If the command needs to process exclusively, we need to get 'ExclusivityGuard'
     // that can guarantee other threads can't come into critical zone, such as DEBUG,
     // CLUSTER subcommand, CONFIG SET, MULTI, LUA (in the immediate future).
     // Otherwise, we just use 'ConcurrencyGuard' to allow all workers to execute commands at the same time.
     if (is_multi_exec && cmd_name != "exec") {
-      // No lock guard, because 'exec' command has acquired 'WorkExclusivityGuard'
+      // No lock guard, because 'exec' command has acquired 'WorkExclusivityGuard' or 'WorkConcurrencyGuard'
     } else if (cmd_flags & kCmdExclusive) {
       exclusivity = srv_->WorkExclusivityGuard();
 
@@ -462,8 +712,8 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
       concurrency = srv_->WorkConcurrencyGuard();
     }
 
-    if (cmd_flags & kCmdROScript) {
-      // if executing read only lua script commands, set current connection.
+    if (cmd_flags & (kCmdROScript | kCmdScript)) {
+      // if executing lua script commands, set current connection.
       srv_->SetCurrentConnection(this);
     }
 
@@ -505,6 +755,7 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
 
     // We don't execute commands, but queue them, ant then execute in EXEC command
     if (is_multi_exec && !in_exec_ && !(cmd_flags & kCmdMulti)) {
+      queueMultiLockKeys(attributes, cmd_tokens, cmd_flags);
       multi_cmds_.emplace_back(cmd_tokens);
       Reply(redis::SimpleString("QUEUED"));
       continue;
@@ -529,6 +780,7 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
     }
 
     SetLastCmd(cmd_name);
+    current_cmd->EnableReplyStreaming();
     s = ExecuteCommand(cmd_name, cmd_tokens, current_cmd.get(), &reply);
 
     // Break the execution loop when occurring the blocking command like BLPOP or BRPOP,
@@ -555,10 +807,33 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
   }
 }
 
+void Connection::queueMultiLockKeys(const CommandAttributes *attributes, const std::vector<std::string> &cmd_tokens,
+                                    uint64_t cmd_flags) {
+  if (multi_exclusive_) return;
+  std::vector<int> keys_indexes;
+  // Only the keys declared by the key ranges are locked, so the ranges must also cover the keys which
+  // are written but not named first, e.g. the STORE destination of GEORADIUS. The commands without
+  // key ranges make the transaction exclusive instead.
+  //
+  // The script mode may be changed before EXEC, so scripts always make the transaction exclusive
+  if ((cmd_flags & (kCmdExclusive | kCmdScript)) ||
+      !CommandTable::GetKeysFromCommand(attributes, cmd_tokens, &keys_indexes).IsOK()) {
+    multi_exclusive_ = true;
+    multi_lock_keys_.clear();
+    return;
+  }
+  for (auto i : keys_indexes) {
+    if (i >= static_cast<int>(cmd_tokens.size())) break;
+    multi_lock_keys_.emplace_back(ComposeNamespaceKey(ns_, cmd_tokens[i], srv_->storage->IsSlotIdEncoded()));
+  }
+}
+
 void Connection::ResetMultiExec() {
   in_exec_ = false;
   multi_error_ = false;
   multi_cmds_.clear();
+  multi_lock_keys_.clear();
+  multi_exclusive_ = false;
   DisableFlag(Connection::kMultiExec);
 }
 
@@ -58,6 +58,7 @@ class Connection : public EvbufCallbackBase<Connection> {
   void OnRead(bufferevent *bev);
   void OnWrite(bufferevent *bev);
   void OnEvent(bufferevent *bev, int16_t events);
+  void OnAsyncExecutionDone();
   void SendFile(int fd);
   std::string ToString();
 
@@ -139,6 +140,9 @@ class Connection : public EvbufCallbackBase<Connection> {
   std::string GetAnnounceIP() const { return !announce_ip_.empty() ? announce_ip_ : ip_; }
   uint32_t GetAnnouncePort() const { return listening_port_ != 0 ? listening_port_ : port_; }
   std::string GetAnnounceAddr() const { return GetAnnounceIP() + ":" + std::to_string(GetAnnouncePort()); }
+  // Whether the replica can receive the published messages in the replication stream
+  void SetReplicaPublishSupported(bool supported) { replica_publish_supported_ = supported; }
+  bool IsReplicaPublishSupported() const { return replica_publish_supported_; }
   uint64_t GetClientType() const;
   Server *GetServer() { return srv_; }
 
@@ -166,6 +170,7 @@ class Connection : public EvbufCallbackBase<Connection> {
   void SetImporting() { importing_ = true; }
   bool IsImporting() const { return importing_; }
   bool CanMigrate() const;
+  bool IsExecutingAsync() const { return executing_async_; }
 
   // Multi exec
   void SetInExec() { in_exec_ = true; }
@@ -173,6 +178,10 @@ class Connection : public EvbufCallbackBase<Connection> {
   bool IsMultiError() const { return multi_error_; }
   void ResetMultiExec();
   std::deque<redis::CommandTokens> *GetMultiExecCommands() { return &multi_cmds_; }
+  // EXEC needs the exclusivity if it can't know all keys of the transaction in advance,
+  // otherwise it only locks the keys of the queued commands.
+  bool IsMultiExecExclusive() const { return multi_exclusive_ || !watched_keys.empty(); }
+  const std::vector<std::string> &GetMultiExecLockKeys() const { return multi_lock_keys_; }
 
   std::function<void(int)> close_cb = nullptr;
 
@@ -189,6 +198,7 @@ class Connection : public EvbufCallbackBase<Connection> {
   uint32_t port_ = 0;
   std::string addr_;
   int listening_port_ = 0;
+  bool replica_publish_supported_ = false;
   bool is_admin_ = false;
   bool need_free_bev_ = true;
   std::string last_cmd_;
@@ -208,10 +218,24 @@ class Connection : public EvbufCallbackBase<Connection> {
   bool in_exec_ = false;
   bool multi_error_ = false;
   std::atomic<bool> is_running_ = false;
+  // executing_async_ is true while the pipelined commands of this connection are being executed
+  // in the async execution pool, the worker shouldn't touch the request or free the connection.
+  std::atomic<bool> executing_async_ = false;
   std::deque<redis::CommandTokens> multi_cmds_;
+  // The namespace keys of the queued commands, multi_exclusive_ is set if any of them
+  // is exclusive or its keys are unknown.
+  std::vector<std::string> multi_lock_keys_;
+  bool multi_exclusive_ = false;
 
   bool importing_ = false;
   RESP protocol_version_ = RESP::v2;
+
+  void queueMultiLockKeys(const CommandAttributes *attributes, const std::vector<std::string> &cmd_tokens,
+                          uint64_t cmd_flags);
+  bool canExecuteAsync(const CommandTokens &cmd_tokens) const;
+  bool dispatchAsync();
+  bool canBatchPointReads() const;
+  size_t executePointReads(std::deque<CommandTokens> *to_process_cmds);
 };
 
 }  // namespace redis
@@ -21,6 +21,11 @@
 #include "redis_reply.h"
 
 #include <numeric>
+#include <utility>
+
+#include "event_util.h"
+#include "stats/stats.h"
+#include "string_util.h"
 
 namespace redis {
 
@@ -49,4 +54,174 @@ std::string ArrayOfBulkStrings(const std::vector<std::string> &elems) {
   return result;
 }
 
+void ReplyWriter::SimpleString(std::string_view data) {
+  if (sink_) {
+    sink_->SimpleString(data);
+    return;
+  }
+  Append("+");
+  Append(data);
+  Append(CRLF);
+}
+
+void ReplyWriter::Error(std::string_view err) {
+  if (sink_) {
+    sink_->Error(err);
+    return;
+  }
+  Append("-");
+  Append(err);
+  Append(CRLF);
+}
+
+void ReplyWriter::Double(double d) {
+  if (version_ == RESP::v3 && sink_) {
+    sink_->Double(d);
+  } else if (version_ == RESP::v3) {
+    Append("," + util::Float2String(d) + CRLF);
+  } else {
+    BulkString(util::Float2String(d));
+  }
+}
+
+void ReplyWriter::NilString() {
+  if (sink_) {
+    if (version_ == RESP::v3) {
+      sink_->Null();
+    } else {
+      sink_->NilBulkString();
+    }
+    return;
+  }
+  Append(redis::NilString(version_));
+}
+
+void ReplyWriter::BulkString(std::string_view data) {
+  if (sink_) {
+    sink_->BulkString(data);
+    return;
+  }
+  Append("$" + std::to_string(data.size()) + CRLF);
+  Append(data);
+  Append(CRLF);
+}
+
+void ReplyWriter::BulkString(std::string &&data) {
+  if (!IsStreaming() || data.size() < kReferenceThreshold) {
+    BulkString(std::string_view(data));
+    return;
+  }
+  addBulkReference(std::make_unique<std::string>(std::move(data)));
+}
+
+void ReplyWriter::BulkString(rocksdb::PinnableSlice &&data) {
+  if (!IsStreaming() || data.size() < kReferenceThreshold) {
+    BulkString(std::string_view(data.data(), data.size()));
+    return;
+  }
+  // Keep the value pinned until it was sent out, so the block cache entry
+  // can be written to the socket without copying.
+  addBulkReference(std::make_unique<rocksdb::PinnableSlice>(std::move(data)));
+}
+
+template <typename T>
+void ReplyWriter::addBulkReference(std::unique_ptr<T> holder) {
+  const char *data = holder->data();
+  size_t size = holder->size();
+  Append("$" + std::to_string(size) + CRLF);
+  // The referenced value must come after all buffered data
+  Flush();
+
+  auto cleanup = [](const void *, size_t, void *arg) { delete static_cast<T *>(arg); };
+  if (evbuffer_add_reference(evbuf_output_, data, size, cleanup, holder.get()) == 0) {
+    // The output buffer owns the value now, it will be freed by the cleanup callback
+    holder.release();
+  } else {
+    evbuffer_add(evbuf_output_, data, size);
+  }
+  if (stats_) stats_->IncrOutboundBytes(size);
+  Append(CRLF);
+}
+
+void ReplyWriter::ArrayLen(size_t len) {
+  if (sink_) {
+    sink_->ArrayLen(len);
+    return;
+  }
+  Append(MultiLen(len));
+}
+
+void ReplyWriter::MapLen(size_t len) {
+  if (version_ != RESP::v3) {
+    ArrayLen(len * 2);
+  } else if (sink_) {
+    sink_->MapLen(len);
+  } else {
+    Append("%" + std::to_string(len) + CRLF);
+  }
+}
+
+void ReplyWriter::SetLen(size_t len) {
+  if (version_ != RESP::v3) {
+    ArrayLen(len);
+  } else if (sink_) {
+    sink_->SetLen(len);
+  } else {
+    Append("~" + std::to_string(len) + CRLF);
+  }
+}
+
+void ReplyWriter::DeferredLen(void (ReplyWriter::*write_len)(size_t),
+                              const std::function<std::optional<size_t>()> &write_elements) {
+  if (evbuf_output_) {
+    // The elements are moved from the temporary buffer without copying, including the referenced values
+    Flush();
+    UniqueEvbuf elements;
+    evbuffer *output = std::exchange(evbuf_output_, elements.get());
+    Stats *stats = std::exchange(stats_, nullptr);
+    auto len = write_elements();
+    Flush();
+    evbuf_output_ = output;
+    stats_ = stats;
+    if (!len) return;
+
+    (this->*write_len)(*len);
+    Flush();
+    if (stats_) stats_->IncrOutboundBytes(evbuffer_get_length(elements.get()));
+    evbuffer_add_buffer(evbuf_output_, elements.get());
+    return;
+  }
+
+  std::string elements;
+  std::string *str_output = std::exchange(str_output_, &elements);
+  ReplySink *sink = std::exchange(sink_, nullptr);
+  auto len = write_elements();
+  str_output_ = str_output;
+  sink_ = sink;
+  if (!len) return;
+
+  (this->*write_len)(*len);
+  Append(elements);
+}
+
+void ReplyWriter::Append(std::string_view data) {
+  if (sink_) {
+    sink_->Append(data);
+    return;
+  }
+  if (str_output_) {
+    str_output_->append(data);
+    return;
+  }
+  buf_.append(data);
+  if (buf_.size() >= kFlushThreshold) Flush();
+}
+
+void ReplyWriter::Flush() {
+  if (!evbuf_output_ || buf_.empty()) return;
+  evbuffer_add(evbuf_output_, buf_.data(), buf_.size());
+  if (stats_) stats_->IncrOutboundBytes(buf_.size());
+  buf_.clear();
+}
+
 }  // namespace redis
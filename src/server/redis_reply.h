@@ -21,12 +21,19 @@
 #pragma once
 
 #include <event2/buffer.h>
+#include <rocksdb/slice.h>
 
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #define CRLF "\r\n"  // NOLINT
 
+class Stats;
+
 namespace redis {
 
 enum class RESP { v2, v3 };
@@ -57,4 +64,95 @@ std::string MultiLen(T len) {
 std::string Array(const std::vector<std::string> &list);
 std::string ArrayOfBulkStrings(const std::vector<std::string> &elements);
 
+// ReplySink receives the typed values of a reply instead of its RESP encoding,
+// e.g. the values can be converted into Lua values without parsing the reply.
+// Aggregates are started with their length and followed by their elements.
+class ReplySink {
+ public:
+  virtual ~ReplySink() = default;
+
+  virtual void SimpleString(std::string_view data) = 0;
+  virtual void Error(std::string_view err) = 0;
+  virtual void Integer(int64_t data) = 0;
+  // RESP3 double, it's a bulk string in RESP2
+  virtual void Double(double d) = 0;
+  virtual void BulkString(std::string_view data) = 0;
+  // RESP2 nil bulk string
+  virtual void NilBulkString() = 0;
+  // RESP3 null
+  virtual void Null() = 0;
+  virtual void ArrayLen(size_t len) = 0;
+  // RESP3 map and set, they are arrays in RESP2
+  virtual void MapLen(size_t len) = 0;
+  virtual void SetLen(size_t len) = 0;
+  // The already encoded reply, it always contains complete values
+  virtual void Append(std::string_view data) = 0;
+};
+
+// ReplyWriter serializes the reply either into a string or directly into the output
+// buffer of the connection, so that large replies can be streamed while iterating
+// instead of being built in memory first. It can also pass the values to a ReplySink.
+//
+// Small writes are coalesced in a local buffer to avoid locking the output buffer
+// for each element, and large values are added to the output buffer by reference.
+class ReplyWriter {
+ public:
+  // Values larger than this are added to the output buffer by reference instead of copying
+  static constexpr size_t kReferenceThreshold = 16 * 1024;
+  // The local buffer is flushed into the output buffer once it exceeds this size
+  static constexpr size_t kFlushThreshold = 16 * 1024;
+
+  ReplyWriter(std::string *output, RESP version) : str_output_(output), version_(version) {}
+  ReplyWriter(evbuffer *output, RESP version, Stats *stats = nullptr)
+      : evbuf_output_(output), version_(version), stats_(stats) {}
+  ReplyWriter(ReplySink *sink, RESP version) : sink_(sink), version_(version) {}
+  ~ReplyWriter() { Flush(); }
+
+  ReplyWriter(const ReplyWriter &) = delete;
+  ReplyWriter &operator=(const ReplyWriter &) = delete;
+
+  RESP GetProtocolVersion() const { return version_; }
+  bool IsStreaming() const { return evbuf_output_ != nullptr; }
+
+  void SimpleString(std::string_view data);
+  void Error(std::string_view err);
+  template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  void Integer(T data) {
+    if (sink_) {
+      sink_->Integer(static_cast<int64_t>(data));
+      return;
+    }
+    Append(":" + std::to_string(data) + CRLF);
+  }
+  void Double(double d);
+  void NilString();
+  void BulkString(std::string_view data);
+  void BulkString(const char *data) { BulkString(std::string_view(data)); }
+  void BulkString(std::string &&data);
+  void BulkString(rocksdb::PinnableSlice &&data);
+  void ArrayLen(size_t len);
+  void MapLen(size_t len);
+  void SetLen(size_t len);
+  // Write an aggregate whose length is only known after its elements are written, e.g. the elements are
+  // iterated from the storage and may not match the size in the metadata. `write_elements` writes the
+  // elements and returns their number, or std::nullopt to discard them. The length is written by
+  // `write_len` (e.g. &ReplyWriter::ArrayLen) and placed before the elements.
+  void DeferredLen(void (ReplyWriter::*write_len)(size_t),
+                   const std::function<std::optional<size_t>()> &write_elements);
+  // Append the already encoded reply
+  void Append(std::string_view data);
+  void Flush();
+
+ private:
+  template <typename T>
+  void addBulkReference(std::unique_ptr<T> holder);
+
+  std::string *str_output_ = nullptr;
+  evbuffer *evbuf_output_ = nullptr;
+  ReplySink *sink_ = nullptr;
+  RESP version_;
+  Stats *stats_ = nullptr;
+  std::string buf_;
+};
+
 }  // namespace redis
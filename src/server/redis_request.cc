@@ -23,6 +23,7 @@
 #include <glog/logging.h>
 #include <rocksdb/perf_context.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <utility>
@@ -36,103 +37,270 @@
 
 namespace redis {
 
+namespace {
+
+// EvbufferScanner walks through the chunks of an evbuffer in place, so the requests
+// can be parsed without linearizing the buffer or copying each line out of it.
+class EvbufferScanner {
+ public:
+  enum class LineResult { kOK, kIncomplete, kInvalid };
+
+  explicit EvbufferScanner(const std::vector<evbuffer_iovec> &iovecs) : iovecs_(iovecs) {
+    for (const auto &iov : iovecs_) total_ += iov.iov_len;
+    normalize();
+  }
+
+  size_t Consumed() const { return consumed_; }
+  size_t Remaining() const { return total_ - consumed_; }
+
+  // The caller must make sure that the buffer isn't exhausted
+  char PeekByte() const { return static_cast<const char *>(iovecs_[chunk_].iov_base)[offset_]; }
+
+  void Skip(size_t n) {
+    consumed_ += n;
+    while (n > 0) {
+      size_t step = std::min(n, iovecs_[chunk_].iov_len - offset_);
+      offset_ += step;
+      n -= step;
+      normalize();
+    }
+  }
+
+  // Copy the next n bytes into the string, this is the only copy of the bulk data
+  void CopyTo(std::string *dst, size_t n) {
+    dst->reserve(n);
+    consumed_ += n;
+    while (n > 0) {
+      size_t step = std::min(n, iovecs_[chunk_].iov_len - offset_);
+      dst->append(static_cast<const char *>(iovecs_[chunk_].iov_base) + offset_, step);
+      offset_ += step;
+      n -= step;
+      normalize();
+    }
+  }
+
+  // Skip an empty line "\r\n" if the next bytes are one, the scanner only moves forward if the line is complete
+  LineResult SkipEmptyLine() {
+    if (Remaining() < 2) return LineResult::kIncomplete;
+    size_t chunk = chunk_, offset = offset_ + 1;
+    while (offset == iovecs_[chunk].iov_len) {
+      chunk++;
+      offset = 0;
+    }
+    if (PeekByte() != '\r' || static_cast<const char *>(iovecs_[chunk].iov_base)[offset] != '\n') {
+      return LineResult::kInvalid;
+    }
+    Skip(2);
+    return LineResult::kOK;
+  }
+
+  // Parse a length line like "*<n>\r\n" or "$<n>\r\n" without allocation, the prefix character
+  // is skipped without being checked. The scanner only moves forward if the line is complete.
+  LineResult ParseLengthLine(int64_t *n, size_t *line_len) {
+    // the length is limited to 512MB, so there is no need to accept more digits
+    constexpr size_t max_digits = 18;
+
+    size_t chunk = chunk_, offset = offset_, scanned = 0;
+    auto next = [&](char *c) {
+      while (chunk < iovecs_.size() && offset == iovecs_[chunk].iov_len) {
+        chunk++;
+        offset = 0;
+      }
+      if (chunk == iovecs_.size()) return false;
+      *c = static_cast<const char *>(iovecs_[chunk].iov_base)[offset++];
+      scanned++;
+      return true;
+    };
+
+    char c = 0;
+    if (!next(&c)) return LineResult::kIncomplete;  // prefix
+    if (!next(&c)) return LineResult::kIncomplete;
+    bool negative = c == '-';
+    if (negative && !next(&c)) return LineResult::kIncomplete;
+
+    int64_t value = 0;
+    size_t digits = 0;
+    while (c >= '0' && c <= '9') {
+      if (++digits > max_digits) return LineResult::kInvalid;
+      value = value * 10 + (c - '0');
+      if (!next(&c)) return LineResult::kIncomplete;
+    }
+    if (digits == 0 || c != '\r') return LineResult::kInvalid;
+    if (!next(&c)) return LineResult::kIncomplete;
+    if (c != '\n') return LineResult::kInvalid;
+
+    *n = negative ? -value : value;
+    *line_len = scanned - 2;
+    chunk_ = chunk;
+    offset_ = offset;
+    consumed_ += scanned;
+    normalize();
+    return LineResult::kOK;
+  }
+
+ private:
+  // Move to the beginning of the next chunk if the current one is exhausted
+  void normalize() {
+    while (chunk_ < iovecs_.size() && offset_ == iovecs_[chunk_].iov_len) {
+      chunk_++;
+      offset_ = 0;
+    }
+  }
+
+  const std::vector<evbuffer_iovec> &iovecs_;
+  size_t chunk_ = 0;
+  size_t offset_ = 0;
+  size_t consumed_ = 0;
+  size_t total_ = 0;
+};
+
+}  // namespace
+
 Status Request::Tokenize(evbuffer *input) {
   size_t pipeline_size = 0;
 
   while (true) {
-    switch (state_) {
-      case ArrayLen: {
-        bool is_only_lf = true;
-        // We don't use the `EVBUFFER_EOL_CRLF_STRICT` here since only LF is allowed in INLINE protocol.
-        // So we need to search LF EOL and figure out current line has CR or not.
-        UniqueEvbufReadln line(input, EVBUFFER_EOL_LF);
-        if (line && line.length > 0 && line[line.length - 1] == '\r') {
-          // remove `\r` if exists
-          --line.length;
-          is_only_lf = false;
-        }
+    // Avoid scanning the buffer again and again while receiving a large bulk
+    if (state_ == BulkData && evbuffer_get_length(input) < bulk_len_ + 2) break;
+
+    int num_chunks = evbuffer_peek(input, -1, nullptr, nullptr, 0);
+    if (num_chunks <= 0) break;
+    iovecs_.resize(num_chunks);
+    evbuffer_peek(input, -1, nullptr, iovecs_.data(), num_chunks);
 
-        if (!line || line.length <= 0) {
-          if (pipeline_size > 128) {
-            LOG(INFO) << "Large pipeline detected: " << pipeline_size;
+    EvbufferScanner scanner(iovecs_);
+    Status s;
+    bool inline_request = false;
+    bool incomplete = false;
+    while (s.IsOK() && !incomplete && !inline_request) {
+      switch (state_) {
+        case ArrayLen: {
+          if (scanner.Remaining() == 0) {
+            incomplete = true;
+            break;
           }
-          if (line) {
-            continue;
+          if (scanner.PeekByte() != '*') {
+            inline_request = true;
+            break;
           }
-          return Status::OK();
-        }
 
-        pipeline_size++;
-        srv_->stats.IncrInboundBytes(line.length);
-        if (line[0] == '*') {
-          auto parse_result = ParseInt<int64_t>(std::string(line.get() + 1, line.length - 1), 10);
-          if (!parse_result) {
-            return {Status::NotOK, "Protocol error: invalid multibulk length"};
+          int64_t len = 0;
+          size_t line_len = 0;
+          auto result = scanner.ParseLengthLine(&len, &line_len);
+          if (result == EvbufferScanner::LineResult::kIncomplete) {
+            incomplete = true;
+            break;
           }
-
-          multi_bulk_len_ = *parse_result;
-          if (is_only_lf || multi_bulk_len_ > (int64_t)PROTO_MULTI_MAX_SIZE) {
-            return {Status::NotOK, "Protocol error: invalid multibulk length"};
+          if (result == EvbufferScanner::LineResult::kInvalid || len > (int64_t)PROTO_MULTI_MAX_SIZE) {
+            s = {Status::NotOK, "Protocol error: invalid multibulk length"};
+            break;
           }
 
-          if (multi_bulk_len_ <= 0) {
+          pipeline_size++;
+          stats_->IncrInboundBytes(line_len);
+          if (len <= 0) {
             multi_bulk_len_ = 0;
-            continue;
+            break;
           }
-
+          multi_bulk_len_ = len;
           state_ = BulkLen;
-        } else {
-          if (line.length > PROTO_INLINE_MAX_SIZE) {
-            return {Status::NotOK, "Protocol error: invalid bulk length"};
+          break;
+        }
+        case BulkLen: {
+          if (scanner.Remaining() == 0) {
+            incomplete = true;
+            break;
+          }
+          if (scanner.PeekByte() == '\r') {
+            // Tolerate empty lines before the bulk length like the line based parser did
+            auto result = scanner.SkipEmptyLine();
+            if (result == EvbufferScanner::LineResult::kIncomplete) {
+              incomplete = true;
+              break;
+            }
+            if (result == EvbufferScanner::LineResult::kOK) break;
+          }
+          if (scanner.PeekByte() != '$') {
+            s = {Status::NotOK, "Protocol error: expected '$'"};
+            break;
+          }
+
+          int64_t len = 0;
+          size_t line_len = 0;
+          auto result = scanner.ParseLengthLine(&len, &line_len);
+          if (result == EvbufferScanner::LineResult::kIncomplete) {
+            incomplete = true;
+            break;
+          }
+          if (result == EvbufferScanner::LineResult::kInvalid || len < 0 ||
+              static_cast<size_t>(len) > PROTO_BULK_MAX_SIZE) {
+            s = {Status::NotOK, "Protocol error: invalid bulk length"};
+            break;
           }
 
-          tokens_ = util::Split(std::string(line.get(), line.length), " \t");
-          if (tokens_.empty()) continue;
-          commands_.emplace_back(std::move(tokens_));
-          state_ = ArrayLen;
+          stats_->IncrInboundBytes(line_len);
+          bulk_len_ = len;
+          state_ = BulkData;
+          break;
         }
-        break;
+        case BulkData:
+          if (scanner.Remaining() < bulk_len_ + 2) {
+            incomplete = true;
+            break;
+          }
+
+          scanner.CopyTo(&tokens_.emplace_back(), bulk_len_);
+          scanner.Skip(2);
+          stats_->IncrInboundBytes(bulk_len_ + 2);
+          --multi_bulk_len_;
+          if (multi_bulk_len_ == 0) {
+            state_ = ArrayLen;
+            commands_.emplace_back(std::move(tokens_));
+            tokens_.clear();
+          } else {
+            state_ = BulkLen;
+          }
+          break;
       }
-      case BulkLen: {
-        UniqueEvbufReadln line(input, EVBUFFER_EOL_CRLF_STRICT);
-        if (!line || line.length <= 0) return Status::OK();
+    }
 
-        srv_->stats.IncrInboundBytes(line.length);
-        if (line[0] != '$') {
-          return {Status::NotOK, "Protocol error: expected '$'"};
-        }
+    evbuffer_drain(input, scanner.Consumed());
+    if (!s.IsOK()) return s;
+    if (!inline_request) break;
 
-        auto parse_result = ParseInt<uint64_t>(std::string(line.get() + 1, line.length - 1), 10);
-        if (!parse_result) {
-          return {Status::NotOK, "Protocol error: invalid bulk length"};
-        }
+    // The inline protocol is rarely used, so it's still parsed line by line
+    bool consumed = false;
+    s = tokenizeInline(input, &pipeline_size, &consumed);
+    if (!s.IsOK()) return s;
+    if (!consumed) break;
+  }
 
-        bulk_len_ = *parse_result;
-        if (bulk_len_ > PROTO_BULK_MAX_SIZE) {
-          return {Status::NotOK, "Protocol error: invalid bulk length"};
-        }
+  if (pipeline_size > 128) {
+    LOG(INFO) << "Large pipeline detected: " << pipeline_size;
+  }
+  return Status::OK();
+}
 
-        state_ = BulkData;
-        break;
-      }
-      case BulkData:
-        if (evbuffer_get_length(input) < bulk_len_ + 2) return Status::OK();
-
-        char *data = reinterpret_cast<char *>(evbuffer_pullup(input, static_cast<ssize_t>(bulk_len_ + 2)));
-        tokens_.emplace_back(data, bulk_len_);
-        evbuffer_drain(input, bulk_len_ + 2);
-        srv_->stats.IncrInboundBytes(bulk_len_ + 2);
-        --multi_bulk_len_;
-        if (multi_bulk_len_ == 0) {
-          state_ = ArrayLen;
-          commands_.emplace_back(std::move(tokens_));
-          tokens_.clear();
-        } else {
-          state_ = BulkLen;
-        }
-        break;
-    }
+Status Request::tokenizeInline(evbuffer *input, size_t *pipeline_size, bool *consumed) {
+  // We don't use the `EVBUFFER_EOL_CRLF_STRICT` here since only LF is allowed in INLINE protocol.
+  // So we need to search LF EOL and figure out current line has CR or not.
+  UniqueEvbufReadln line(input, EVBUFFER_EOL_LF);
+  *consumed = static_cast<bool>(line);
+  if (line && line.length > 0 && line[line.length - 1] == '\r') {
+    // remove `\r` if exists
+    --line.length;
   }
+  if (!line || line.length <= 0) return Status::OK();
+
+  (*pipeline_size)++;
+  stats_->IncrInboundBytes(line.length);
+  if (line.length > PROTO_INLINE_MAX_SIZE) {
+    return {Status::NotOK, "Protocol error: invalid bulk length"};
+  }
+
+  auto tokens = util::Split(std::string(line.get(), line.length), " \t");
+  if (!tokens.empty()) commands_.emplace_back(std::move(tokens));
+  return Status::OK();
 }
 
 }  // namespace redis
@@ -26,10 +26,9 @@
 #include <string>
 #include <vector>
 
+#include "stats/stats.h"
 #include "status.h"
 
-class Server;
-
 namespace redis {
 
 constexpr size_t PROTO_INLINE_MAX_SIZE = 16 * 1024L;
@@ -42,7 +41,7 @@ class Connection;
 
 class Request {
  public:
-  explicit Request(Server *srv) : srv_(srv) {}
+  explicit Request(Stats *stats) : stats_(stats) {}
   ~Request() = default;
 
   // Not copyable
@@ -63,8 +62,12 @@ class Request {
   size_t bulk_len_ = 0;
   CommandTokens tokens_;
   std::deque<CommandTokens> commands_;
+  // reused across calls to avoid allocating the iovec array for every read
+  std::vector<evbuffer_iovec> iovecs_;
+
+  Stats *stats_;
 
-  Server *srv_;
+  Status tokenizeInline(evbuffer *input, size_t *pipeline_size, bool *consumed);
 };
 
 }  // namespace redis
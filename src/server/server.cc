@@ -81,6 +81,10 @@ Server::Server(engine::Storage *storage, Config *config)
   // init shard pub/sub channels
   pubsub_shard_channels_.resize(config->cluster_enabled ? HASH_SLOTS_SIZE : 1);
 
+  if (config->async_execution_threads > 0) {
+    async_execution_runner_ = std::make_unique<TaskRunner>(config->async_execution_threads);
+  }
+
   for (int i = 0; i < config->workers; i++) {
     auto worker = std::make_unique<Worker>(this, config);
     // multiple workers can't listen to the same unix socket, so
@@ -176,6 +180,11 @@ Status Server::Start() {
   if (auto s = task_runner_.Start(); !s) {
     LOG(WARNING) << "Failed to start task runner: " << s.Msg();
   }
+  if (async_execution_runner_) {
+    if (auto s = async_execution_runner_->Start(); !s) {
+      LOG(WARNING) << "Failed to start async execution runner: " << s.Msg();
+    }
+  }
   // setup server cron thread
   cron_thread_ = GET_OR_RET(util::CreateThread("server-cron", [this] { this->cron(); }));
 
@@ -200,7 +209,8 @@ Status Server::Start() {
         if (local_time.tm_hour >= config_->compaction_checker_range.start &&
             local_time.tm_hour <= config_->compaction_checker_range.stop) {
           std::vector<std::string> cf_names = {engine::kMetadataColumnFamilyName, engine::kSubkeyColumnFamilyName,
-                                               engine::kZSetScoreColumnFamilyName, engine::kStreamColumnFamilyName};
+                                               engine::kZSetScoreColumnFamilyName, engine::kStreamColumnFamilyName,
+                                               engine::kZSetRankColumnFamilyName};
           for (const auto &cf_name : cf_names) {
             compaction_checker.PickCompactionFiles(cf_name);
           }
@@ -233,6 +243,7 @@ void Server::Stop() {
 
   rocksdb::CancelAllBackgroundWork(storage->GetDB(), true);
   task_runner_.Cancel();
+  if (async_execution_runner_) async_execution_runner_->Cancel();
 }
 
 void Server::Join() {
@@ -245,6 +256,11 @@ void Server::Join() {
   if (auto s = task_runner_.Join(); !s) {
     LOG(WARNING) << s.Msg();
   }
+  if (async_execution_runner_) {
+    if (auto s = async_execution_runner_->Join(); !s) {
+      LOG(WARNING) << s.Msg();
+    }
+  }
   for (const auto &worker : worker_threads_) {
     worker->Join();
   }
@@ -361,9 +377,24 @@ void Server::FeedMonitorConns(redis::Connection *conn, const std::vector<std::st
   }
 }
 
+void Server::ReplicatePublishMessage(const std::string &channel, const std::string &msg) {
+  rocksdb::SequenceNumber seq = 0;
+  if (config_->publish_replication_mode == PublishReplicationMode::kMemoryOrdered) {
+    // The message is sent after the writes which were committed before it
+    seq = storage->LatestSeqNumber();
+  }
+  auto frame = redis::ArrayOfBulkStrings({"publish", channel, msg});
+
+  std::lock_guard<std::mutex> lg(slave_threads_mu_);
+  for (auto &slave_thread : slave_threads_) {
+    if (!slave_thread->IsStopped() && slave_thread->GetConn()->IsReplicaPublishSupported()) {
+      slave_thread->EnqueuePublish(seq, frame);
+    }
+  }
+}
+
 int Server::PublishMessage(const std::string &channel, const std::string &msg) {
   int cnt = 0;
-  int index = 0;
 
   pubsub_channels_mu_.lock();
 
@@ -374,43 +405,49 @@ int Server::PublishMessage(const std::string &channel, const std::string &msg) {
     }
   }
 
+  pubsub_channels_mu_.unlock();
+
   // The patterns variable records the pattern of connections
   std::vector<std::string> patterns;
   std::vector<ConnContext> to_publish_patterns_conn_ctxs;
-  for (const auto &iter : pubsub_patterns_) {
-    if (util::StringMatch(iter.first, channel, 0)) {
-      for (const auto &conn_ctx : iter.second) {
+  {
+    // Only the patterns sharing the literal prefix with the channel are matched,
+    // and the publishers don't block each other while matching
+    std::shared_lock<ShardedRWLock> guard(pubsub_patterns_mu_);
+    pubsub_patterns_.ForEachMatch(channel, [&](const std::string &pattern, const std::list<ConnContext> &conn_ctxs) {
+      for (const auto &conn_ctx : conn_ctxs) {
         to_publish_patterns_conn_ctxs.emplace_back(conn_ctx);
-        patterns.emplace_back(iter.first);
+        patterns.emplace_back(pattern);
       }
-    }
+    });
   }
-  pubsub_channels_mu_.unlock();
 
-  std::string channel_reply;
-  channel_reply.append(redis::MultiLen(3));
-  channel_reply.append(redis::BulkString("message"));
-  channel_reply.append(redis::BulkString(channel));
-  channel_reply.append(redis::BulkString(msg));
+  // The reply is shared by all the subscribers, and it's written by the workers of connections
+  auto channel_reply = std::make_shared<std::string>();
+  channel_reply->append(redis::MultiLen(3));
+  channel_reply->append(redis::BulkString("message"));
+  channel_reply->append(redis::BulkString(channel));
+  channel_reply->append(redis::BulkString(msg));
   for (const auto &conn_ctx : to_publish_conn_ctxs) {
-    auto s = conn_ctx.owner->Reply(conn_ctx.fd, channel_reply);
-    if (s.IsOK()) {
-      cnt++;
-    }
-  }
-
-  // We should publish corresponding pattern and message for connections
-  for (const auto &conn_ctx : to_publish_patterns_conn_ctxs) {
-    std::string pattern_reply;
-    pattern_reply.append(redis::MultiLen(4));
-    pattern_reply.append(redis::BulkString("pmessage"));
-    pattern_reply.append(redis::BulkString(patterns[index++]));
-    pattern_reply.append(redis::BulkString(channel));
-    pattern_reply.append(redis::BulkString(msg));
-    auto s = conn_ctx.owner->Reply(conn_ctx.fd, pattern_reply);
-    if (s.IsOK()) {
-      cnt++;
+    conn_ctx.owner->Reply(conn_ctx.fd, conn_ctx.id, channel_reply);
+    cnt++;
+  }
+
+  // We should publish corresponding pattern and message for connections,
+  // the connections of the same pattern are adjacent and share the reply
+  std::shared_ptr<std::string> pattern_reply;
+  for (size_t i = 0; i < to_publish_patterns_conn_ctxs.size(); i++) {
+    if (i == 0 || patterns[i] != patterns[i - 1]) {
+      pattern_reply = std::make_shared<std::string>();
+      pattern_reply->append(redis::MultiLen(4));
+      pattern_reply->append(redis::BulkString("pmessage"));
+      pattern_reply->append(redis::BulkString(patterns[i]));
+      pattern_reply->append(redis::BulkString(channel));
+      pattern_reply->append(redis::BulkString(msg));
     }
+    const auto &conn_ctx = to_publish_patterns_conn_ctxs[i];
+    conn_ctx.owner->Reply(conn_ctx.fd, conn_ctx.id, pattern_reply);
+    cnt++;
   }
 
   return cnt;
@@ -419,7 +456,7 @@ int Server::PublishMessage(const std::string &channel, const std::string &msg) {
 void Server::SubscribeChannel(const std::string &channel, redis::Connection *conn) {
   std::lock_guard<std::mutex> guard(pubsub_channels_mu_);
 
-  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD());
+  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD(), conn->GetID());
   if (auto iter = pubsub_channels_.find(channel); iter == pubsub_channels_.end()) {
     pubsub_channels_.emplace(channel, std::list<ConnContext>{conn_ctx});
   } else {
@@ -470,29 +507,25 @@ void Server::ListChannelSubscribeNum(const std::vector<std::string> &channels,
 }
 
 void Server::PSubscribeChannel(const std::string &pattern, redis::Connection *conn) {
-  std::lock_guard<std::mutex> guard(pubsub_channels_mu_);
+  std::lock_guard<ShardedRWLock> guard(pubsub_patterns_mu_);
 
-  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD());
-  if (auto iter = pubsub_patterns_.find(pattern); iter == pubsub_patterns_.end()) {
-    pubsub_patterns_.emplace(pattern, std::list<ConnContext>{conn_ctx});
-  } else {
-    iter->second.emplace_back(conn_ctx);
-  }
+  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD(), conn->GetID());
+  pubsub_patterns_[pattern].emplace_back(conn_ctx);
 }
 
 void Server::PUnsubscribeChannel(const std::string &pattern, redis::Connection *conn) {
-  std::lock_guard<std::mutex> guard(pubsub_channels_mu_);
+  std::lock_guard<ShardedRWLock> guard(pubsub_patterns_mu_);
 
-  auto iter = pubsub_patterns_.find(pattern);
-  if (iter == pubsub_patterns_.end()) {
+  auto conn_ctxs = pubsub_patterns_.Find(pattern);
+  if (!conn_ctxs) {
     return;
   }
 
-  for (const auto &conn_ctx : iter->second) {
+  for (const auto &conn_ctx : *conn_ctxs) {
     if (conn->GetFD() == conn_ctx.fd && conn->Owner() == conn_ctx.owner) {
-      iter->second.remove(conn_ctx);
-      if (iter->second.empty()) {
-        pubsub_patterns_.erase(iter);
+      conn_ctxs->remove(conn_ctx);
+      if (conn_ctxs->empty()) {
+        pubsub_patterns_.Erase(pattern);
       }
       break;
     }
@@ -503,7 +536,7 @@ void Server::SSubscribeChannel(const std::string &channel, redis::Connection *co
   assert((config_->cluster_enabled && slot < HASH_SLOTS_SIZE) || slot == 0);
   std::lock_guard<std::mutex> guard(pubsub_shard_channels_mu_);
 
-  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD());
+  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD(), conn->GetID());
   if (auto iter = pubsub_shard_channels_[slot].find(channel); iter == pubsub_shard_channels_[slot].end()) {
     pubsub_shard_channels_[slot].emplace(channel, std::list<ConnContext>{conn_ctx});
   } else {
@@ -560,7 +593,7 @@ void Server::ListSChannelSubscribeNum(const std::vector<std::string> &channels,
 void Server::BlockOnKey(const std::string &key, redis::Connection *conn) {
   std::lock_guard<std::mutex> guard(blocking_keys_mu_);
 
-  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD());
+  auto conn_ctx = ConnContext(conn->Owner(), conn->GetFD(), conn->GetID());
 
   if (auto iter = blocking_keys_.find(key); iter == blocking_keys_.end()) {
     blocking_keys_.emplace(key, std::list<ConnContext>{conn_ctx});
@@ -599,7 +632,8 @@ void Server::BlockOnStreams(const std::vector<std::string> &keys, const std::vec
   IncrBlockedClientNum();
 
   for (size_t i = 0; i < keys.size(); ++i) {
-    auto consumer = std::make_shared<StreamConsumer>(conn->Owner(), conn->GetFD(), conn->GetNamespace(), entry_ids[i]);
+    auto consumer = std::make_shared<StreamConsumer>(conn->Owner(), conn->GetFD(), conn->GetID(), conn->GetNamespace(),
+                                                     entry_ids[i]);
     if (auto iter = blocked_stream_consumers_.find(keys[i]); iter == blocked_stream_consumers_.end()) {
       std::set<std::shared_ptr<StreamConsumer>> consumers;
       consumers.insert(consumer);
@@ -645,10 +679,7 @@ void Server::WakeupBlockingConns(const std::string &key, size_t n_conns) {
 
   while (n_conns-- && !iter->second.empty()) {
     auto conn_ctx = iter->second.front();
-    auto s = conn_ctx.owner->EnableWriteEvent(conn_ctx.fd);
-    if (!s.IsOK()) {
-      LOG(ERROR) << "[server] Failed to enable write event on blocked client " << conn_ctx.fd << ": " << s.Msg();
-    }
+    conn_ctx.owner->EnableWriteEvent(conn_ctx.fd, conn_ctx.id);
     iter->second.pop_front();
   }
 }
@@ -664,11 +695,7 @@ void Server::OnEntryAddedToStream(const std::string &ns, const std::string &key,
   for (auto it = iter->second.begin(); it != iter->second.end();) {
     auto consumer = *it;
     if (consumer->ns == ns && entry_id > consumer->last_consumed_id) {
-      auto s = consumer->owner->EnableWriteEvent(consumer->fd);
-      if (!s.IsOK()) {
-        LOG(ERROR) << "[server] Failed to enable write event on blocked stream consumer " << consumer->fd << ": "
-                   << s.Msg();
-      }
+      consumer->owner->EnableWriteEvent(consumer->fd, consumer->conn_id);
       it = iter->second.erase(it);
     } else {
       ++it;
@@ -693,11 +720,11 @@ int Server::IncrBlockedClientNum() { return blocked_clients_.fetch_add(1, std::m
 
 int Server::DecrBlockedClientNum() { return blocked_clients_.fetch_sub(1, std::memory_order_relaxed); }
 
-std::shared_lock<std::shared_mutex> Server::WorkConcurrencyGuard() {
+std::shared_lock<ShardedRWLock> Server::WorkConcurrencyGuard() {
   return std::shared_lock(works_concurrency_rw_lock_);
 }
 
-std::unique_lock<std::shared_mutex> Server::WorkExclusivityGuard() {
+std::unique_lock<ShardedRWLock> Server::WorkExclusivityGuard() {
   return std::unique_lock(works_concurrency_rw_lock_);
 }
 
@@ -892,6 +919,27 @@ void Server::GetRocksDBInfo(std::string *info) {
   auto db_stats = storage->GetDBStats();
   string_stream << "flush_count:" << db_stats->flush_count << "\r\n";
   string_stream << "compaction_count:" << db_stats->compaction_count << "\r\n";
+  if (auto group_commit_stats = storage->GetGroupCommitStats(); group_commit_stats) {
+    uint64_t commits = group_commit_stats->commits;
+    uint64_t batches = group_commit_stats->batches;
+    string_stream << "group_commit_count:" << commits << "\r\n";
+    string_stream << "group_commit_batches:" << batches << "\r\n";
+    string_stream << "group_commit_bytes:" << group_commit_stats->bytes << "\r\n";
+    string_stream << "group_commit_avg_batch_size:" << (commits ? static_cast<double>(batches) / commits : 0) << "\r\n";
+    string_stream << "group_commit_avg_wait_us:" << (batches ? group_commit_stats->wait_us / batches : 0) << "\r\n";
+  }
+  if (auto metadata_cache = storage->GetMetadataCache(); metadata_cache) {
+    const auto &metadata_cache_stats = metadata_cache->GetStats();
+    string_stream << "metadata_cache_hits:" << metadata_cache_stats.hits << "\r\n";
+    string_stream << "metadata_cache_misses:" << metadata_cache_stats.misses << "\r\n";
+    string_stream << "metadata_cache_evictions:" << metadata_cache_stats.evictions << "\r\n";
+    string_stream << "metadata_cache_entries:" << metadata_cache->Size() << "\r\n";
+    string_stream << "metadata_cache_usage:" << metadata_cache->Usage() << "\r\n";
+    string_stream << "metadata_cache_capacity:" << metadata_cache->Capacity() << "\r\n";
+  }
+  const auto &increment_stats = storage->GetIncrementCombiner()->GetStats();
+  string_stream << "combined_increments:" << increment_stats.increments << "\r\n";
+  string_stream << "combined_increment_applies:" << increment_stats.applies << "\r\n";
   string_stream << "put_per_sec:" << stats.GetInstantaneousMetric(STATS_METRIC_ROCKSDB_PUT) << "\r\n";
   string_stream << "get_per_sec:"
                 << stats.GetInstantaneousMetric(STATS_METRIC_ROCKSDB_GET) +
@@ -1099,7 +1147,10 @@ void Server::GetStatsInfo(std::string *info) {
   {
     std::lock_guard<std::mutex> lg(pubsub_channels_mu_);
     string_stream << "pubsub_channels:" << pubsub_channels_.size() << "\r\n";
-    string_stream << "pubsub_patterns:" << pubsub_patterns_.size() << "\r\n";
+  }
+  {
+    std::shared_lock<ShardedRWLock> lg(pubsub_patterns_mu_);
+    string_stream << "pubsub_patterns:" << pubsub_patterns_.Size() << "\r\n";
   }
 
   *info = string_stream.str();
@@ -1613,6 +1664,13 @@ StatusOr<std::unique_ptr<redis::Commander>> Server::LookupAndCreateCommand(const
   return cmd;
 }
 
+Status Server::PublishAsyncExecution(Task task) {
+  if (!async_execution_runner_) {
+    return {Status::NotOK, "async execution is disabled"};
+  }
+  return async_execution_runner_->TryPublish(std::move(task));
+}
+
 Status Server::ScriptExists(const std::string &sha) {
   if (lua::ScriptExists(lua_, sha)) {
     return Status::OK();
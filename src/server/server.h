@@ -44,7 +44,9 @@
 #include "commands/commander.h"
 #include "lua.hpp"
 #include "namespace.h"
+#include "pattern_index.h"
 #include "server/redis_connection.h"
+#include "sharded_rw_lock.h"
 #include "stats/log_collector.h"
 #include "stats/stats.h"
 #include "storage/redis_metadata.h"
@@ -62,8 +64,9 @@ struct DBScanInfo {
 struct ConnContext {
   Worker *owner;
   int fd;
+  uint64_t id;
 
-  ConnContext(Worker *w, int fd) : owner(w), fd(fd) {}
+  ConnContext(Worker *w, int fd, uint64_t id) : owner(w), fd(fd), id(id) {}
 
   bool operator<(const ConnContext &c) const {
     if (owner == c.owner) {
@@ -79,10 +82,11 @@ struct ConnContext {
 struct StreamConsumer {
   Worker *owner;
   int fd;
+  uint64_t conn_id;
   std::string ns;
   redis::StreamEntryID last_consumed_id;
-  StreamConsumer(Worker *w, int fd, std::string ns, redis::StreamEntryID id)
-      : owner(w), fd(fd), ns(std::move(ns)), last_consumed_id(id) {}
+  StreamConsumer(Worker *w, int fd, uint64_t conn_id, std::string ns, redis::StreamEntryID id)
+      : owner(w), fd(fd), conn_id(conn_id), ns(std::move(ns)), last_consumed_id(id) {}
 };
 
 struct ChannelSubscribeNum {
@@ -178,6 +182,8 @@ class Server {
   bool IsLoading() const { return is_loading_; }
   Config *GetConfig() { return config_; }
   static StatusOr<std::unique_ptr<redis::Commander>> LookupAndCreateCommand(const std::string &cmd_name);
+  bool IsAsyncExecutionEnabled() const { return async_execution_runner_ != nullptr; }
+  Status PublishAsyncExecution(Task task);
   void AdjustOpenFilesLimit();
   void AdjustWorkerThreads();
 
@@ -193,6 +199,8 @@ class Server {
   int GetFetchFileThreadNum() const { return fetch_file_threads_num_; }
 
   int PublishMessage(const std::string &channel, const std::string &msg);
+  // Forward the published message to the replicas in the replication stream instead of the WAL
+  void ReplicatePublishMessage(const std::string &channel, const std::string &msg);
   void SubscribeChannel(const std::string &channel, redis::Connection *conn);
   void UnsubscribeChannel(const std::string &channel, redis::Connection *conn);
   void GetChannelsByPattern(const std::string &pattern, std::vector<std::string> *channels);
@@ -200,7 +208,7 @@ class Server {
                                std::vector<ChannelSubscribeNum> *channel_subscribe_nums);
   void PSubscribeChannel(const std::string &pattern, redis::Connection *conn);
   void PUnsubscribeChannel(const std::string &pattern, redis::Connection *conn);
-  size_t GetPubSubPatternSize() const { return pubsub_patterns_.size(); }
+  size_t GetPubSubPatternSize() const { return pubsub_patterns_.Size(); }
   void SSubscribeChannel(const std::string &channel, redis::Connection *conn, uint16_t slot);
   void SUnsubscribeChannel(const std::string &channel, redis::Connection *conn, uint16_t slot);
   void GetSChannelsByPattern(const std::string &pattern, std::vector<std::string> *channels);
@@ -279,8 +287,8 @@ class Server {
   LogCollector<SlowEntry> *GetSlowLog() { return &slow_log_; }
   void SlowlogPushEntryIfNeeded(const std::vector<std::string> *args, uint64_t duration, const redis::Connection *conn);
 
-  std::shared_lock<std::shared_mutex> WorkConcurrencyGuard();
-  std::unique_lock<std::shared_mutex> WorkExclusivityGuard();
+  std::shared_lock<ShardedRWLock> WorkConcurrencyGuard();
+  std::unique_lock<ShardedRWLock> WorkExclusivityGuard();
 
   Stats stats;
   engine::Storage *storage;
@@ -324,7 +332,9 @@ class Server {
 
   std::atomic<lua_State *> lua_;
 
-  redis::Connection *curr_connection_ = nullptr;
+  // The connection which is running the script in the current thread, scripts
+  // may run concurrently in different workers.
+  static inline thread_local redis::Connection *curr_connection_ = nullptr;
 
   // client counters
   std::atomic<uint64_t> client_id_{1};
@@ -354,8 +364,9 @@ class Server {
   LogCollector<PerfEntry> perf_log_;
 
   std::map<std::string, std::list<ConnContext>> pubsub_channels_;
-  std::map<std::string, std::list<ConnContext>> pubsub_patterns_;
   std::mutex pubsub_channels_mu_;
+  PatternIndex<std::list<ConnContext>> pubsub_patterns_;
+  ShardedRWLock pubsub_patterns_mu_;
   std::vector<std::map<std::string, std::list<ConnContext>>> pubsub_shard_channels_;
   std::mutex pubsub_shard_channels_mu_;
   std::map<std::string, std::list<ConnContext>> blocking_keys_;
@@ -367,10 +378,13 @@ class Server {
   std::map<std::string, std::set<std::shared_ptr<StreamConsumer>>> blocked_stream_consumers_;
 
   // threads
-  std::shared_mutex works_concurrency_rw_lock_;
+  // It's acquired by every command, so the shared path must not touch any shared cache line
+  ShardedRWLock works_concurrency_rw_lock_;
   std::thread cron_thread_;
   std::thread compaction_checker_thread_;
   TaskRunner task_runner_;
+  // async_execution_runner_ is only created when `async-execution-threads` is greater than 0
+  std::unique_ptr<TaskRunner> async_execution_runner_;
   std::vector<std::unique_ptr<WorkerThread>> worker_threads_;
   std::unique_ptr<ReplicationThread> replication_thread_;
   tbb::concurrent_queue<std::unique_ptr<WorkerThread>> recycle_worker_threads_;
@@ -59,6 +59,9 @@ Worker::Worker(Server *srv, Config *config) : srv(srv), base_(event_base_new())
   timeval tm = {10, 0};
   evtimer_add(timer_.get(), &tm);
 
+  async_done_event_.reset(event_new(base_, -1, 0, EventCallbackFunc<&Worker::asyncExecutionDoneCB>, this));
+  pending_messages_event_.reset(event_new(base_, -1, 0, EventCallbackFunc<&Worker::pendingMessagesCB>, this));
+
   uint32_t ports[3] = {config->port, config->tls_port, 0};
   auto binds = config->binds;
 
@@ -76,6 +79,9 @@ Worker::Worker(Server *srv, Config *config) : srv(srv), base_(event_base_new())
 }
 
 Worker::~Worker() {
+  // The connections mustn't be freed while they're still used by the async execution pool
+  waitAsyncExecutions();
+
   std::vector<redis::Connection *> conns;
   conns.reserve(conns_.size() + monitor_conns_.size());
 
@@ -90,6 +96,8 @@ Worker::~Worker() {
   }
 
   timer_.reset();
+  async_done_event_.reset();
+  pending_messages_event_.reset();
   if (rate_limit_group_) {
     bufferevent_rate_limit_group_free(rate_limit_group_);
   }
@@ -413,6 +421,11 @@ void Worker::FreeConnectionByID(int fd, uint64_t id) {
   std::unique_lock<std::mutex> lock(conns_mu_);
   auto iter = conns_.find(fd);
   if (iter != conns_.end() && iter->second->GetID() == id) {
+    // The connection is still used by the async execution pool, so close it after the execution is done
+    if (iter->second->IsExecutingAsync()) {
+      iter->second->EnableFlag(redis::Connection::kCloseAsync);
+      return;
+    }
     if (rate_limit_group_ != nullptr) {
       bufferevent_remove_from_rate_limit_group(iter->second->GetBufferEvent());
     }
@@ -430,28 +443,33 @@ void Worker::FreeConnectionByID(int fd, uint64_t id) {
   }
 }
 
-Status Worker::EnableWriteEvent(int fd) {
-  std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end()) {
-    auto bev = iter->second->GetBufferEvent();
-    bufferevent_enable(bev, EV_WRITE);
-    return Status::OK();
-  }
+void Worker::EnableWriteEvent(int fd, uint64_t id) { postPendingMessage(fd, id, nullptr); }
 
-  return {Status::NotOK, "connection doesn't exist"};
+void Worker::Reply(int fd, uint64_t id, std::shared_ptr<const std::string> reply) {
+  postPendingMessage(fd, id, std::move(reply));
 }
 
-Status Worker::Reply(int fd, const std::string &reply) {
-  std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end()) {
-    iter->second->SetLastInteraction();
-    redis::Reply(iter->second->Output(), reply);
-    return Status::OK();
+void Worker::postPendingMessage(int fd, uint64_t id, std::shared_ptr<const std::string> reply) {
+  // Only wake up the worker once until it drains the queue
+  if (pending_messages_.Post(fd, id, std::move(reply))) {
+    event_active(pending_messages_event_.get(), EV_TIMEOUT, 0);
   }
+}
 
-  return {Status::NotOK, "connection doesn't exist"};
+void Worker::pendingMessagesCB(evutil_socket_t, int16_t) {
+  std::lock_guard<std::mutex> lock(conns_mu_);
+  auto find = [this](int fd) -> redis::Connection * {
+    auto iter = conns_.find(fd);
+    return iter != conns_.end() ? iter->second : nullptr;
+  };
+  pending_messages_.Drain(find, [](redis::Connection *conn, const std::shared_ptr<const std::string> &reply) {
+    if (reply) {
+      conn->SetLastInteraction();
+      redis::Reply(conn->Output(), *reply);
+    } else {
+      bufferevent_enable(conn->GetBufferEvent(), EV_WRITE);
+    }
+  });
 }
 
 void Worker::BecomeMonitorConn(redis::Connection *conn) {
@@ -486,6 +504,42 @@ void Worker::FeedMonitorConns(redis::Connection *conn, const std::string &respon
   }
 }
 
+void Worker::PostAsyncExecutionDone(redis::Connection *conn) {
+  {
+    std::lock_guard<std::mutex> guard(async_done_mu_);
+    async_done_conns_.emplace_back(conn);
+  }
+  event_active(async_done_event_.get(), EV_TIMEOUT, 0);
+}
+
+std::shared_ptr<void> Worker::TrackAsyncExecution() {
+  {
+    std::lock_guard<std::mutex> guard(async_done_mu_);
+    async_executions_++;
+  }
+  // The deleter is also called if the execution is dropped by the pool without being run
+  return {nullptr, [this](void *) {
+            std::lock_guard<std::mutex> guard(async_done_mu_);
+            if (--async_executions_ == 0) async_done_cv_.notify_all();
+          }};
+}
+
+void Worker::waitAsyncExecutions() {
+  std::unique_lock<std::mutex> lock(async_done_mu_);
+  async_done_cv_.wait(lock, [this] { return async_executions_ == 0; });
+}
+
+void Worker::asyncExecutionDoneCB(evutil_socket_t, int16_t) {
+  std::vector<redis::Connection *> conns;
+  {
+    std::lock_guard<std::mutex> guard(async_done_mu_);
+    conns.swap(async_done_conns_);
+  }
+  for (auto conn : conns) {
+    conn->OnAsyncExecutionDone();
+  }
+}
+
 std::string Worker::GetClientsStr() {
   std::unique_lock<std::mutex> lock(conns_mu_);
 
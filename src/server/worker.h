@@ -27,6 +27,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <condition_variable>
 #include <iostream>
 #include <lua.hpp>
 #include <map>
@@ -37,6 +38,7 @@
 #include <vector>
 
 #include "event_util.h"
+#include "pending_messages.h"
 #include "redis_connection.h"
 #include "storage/storage.h"
 
@@ -59,11 +61,20 @@ class Worker : EventCallbackBase<Worker>, EvconnlistenerBase<Worker> {
   void FreeConnection(redis::Connection *conn);
   void FreeConnectionByID(int fd, uint64_t id);
   Status AddConnection(redis::Connection *c);
-  Status EnableWriteEvent(int fd);
-  Status Reply(int fd, const std::string &reply);
+  // Enable the write event of the connection or write the reply into it, they're safe to be called
+  // from any thread. They're queued and done by the worker in its own loop, and ignored if the
+  // connection of the fd and id doesn't exist then.
+  void EnableWriteEvent(int fd, uint64_t id);
+  void Reply(int fd, uint64_t id, std::shared_ptr<const std::string> reply);
   void BecomeMonitorConn(redis::Connection *conn);
   void QuitMonitorConn(redis::Connection *conn);
   void FeedMonitorConns(redis::Connection *conn, const std::string &response);
+  // Notify the worker that the async execution of the connection is done,
+  // it's safe to be called from any thread.
+  void PostAsyncExecutionDone(redis::Connection *conn);
+  // Track an async execution of the connections until the returned token is released, the worker
+  // waits for the tracked executions before freeing its connections when it's destroyed.
+  std::shared_ptr<void> TrackAsyncExecution();
 
   std::string GetClientsStr();
   void KillClient(redis::Connection *self, uint64_t id, const std::string &addr, uint64_t type, bool skipme,
@@ -83,9 +94,21 @@ class Worker : EventCallbackBase<Worker>, EvconnlistenerBase<Worker> {
   void newTCPConnection(evconnlistener *listener, evutil_socket_t fd, sockaddr *address, int socklen);
   void newUnixSocketConnection(evconnlistener *listener, evutil_socket_t fd, sockaddr *address, int socklen);
   redis::Connection *removeConnection(int fd);
+  void asyncExecutionDoneCB(evutil_socket_t, int16_t);
+  void waitAsyncExecutions();
+  void pendingMessagesCB(evutil_socket_t, int16_t);
+  void postPendingMessage(int fd, uint64_t id, std::shared_ptr<const std::string> reply);
 
   event_base *base_;
   UniqueEvent timer_;
+  UniqueEvent async_done_event_;
+  std::mutex async_done_mu_;
+  std::condition_variable async_done_cv_;
+  std::vector<redis::Connection *> async_done_conns_;
+  size_t async_executions_ = 0;
+
+  UniqueEvent pending_messages_event_;
+  PendingMessages pending_messages_;
   std::thread::id tid_;
   std::vector<evconnlistener *> listen_events_;
   std::mutex conns_mu_;
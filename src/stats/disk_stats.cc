@@ -72,7 +72,14 @@ rocksdb::Status Disk::GetKeySize(const Slice &user_key, RedisType type, uint64_t
 rocksdb::Status Disk::GetStringSize(const Slice &ns_key, uint64_t *key_size) {
   auto limit = ns_key.ToString() + static_cast<char>(0);
   auto key_range = rocksdb::Range(Slice(ns_key), Slice(limit));
-  return storage_->GetDB()->GetApproximateSizes(option_, metadata_cf_handle_, &key_range, 1, key_size);
+  auto s = storage_->GetDB()->GetApproximateSizes(option_, metadata_cf_handle_, &key_range, 1, key_size);
+  if (!s.ok()) return s;
+
+  Metadata metadata(kRedisString, false);
+  s = Database::GetMetadata({kRedisString}, ns_key, &metadata);
+  if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
+  if (!metadata.IsChunkedString()) return rocksdb::Status::OK();
+  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size);
 }
 
 rocksdb::Status Disk::GetHashSize(const Slice &ns_key, uint64_t *key_size) {
@@ -94,7 +101,8 @@ rocksdb::Status Disk::GetListSize(const Slice &ns_key, uint64_t *key_size) {
   rocksdb::Status s = Database::GetMetadata({kRedisList}, ns_key, &metadata);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
   std::string buf;
-  PutFixed64(&buf, metadata.head);
+  // the chunks of a chunked list and its directory aren't ordered after its head
+  if (!metadata.IsChunkedList()) PutFixed64(&buf, metadata.head);
   return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size, buf);
 }
 
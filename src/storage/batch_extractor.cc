@@ -22,6 +22,8 @@
 
 #include <glog/logging.h>
 
+#include <optional>
+
 #include "cluster/redis_slot.h"
 #include "parse_util.h"
 #include "server/redis_reply.h"
@@ -40,11 +42,13 @@ void WriteBatchExtractor::LogData(const rocksdb::Slice &blob) {
     if (auto s = log_data_.Decode(blob); !s.IsOK()) {
       LOG(WARNING) << "Failed to decode Redis type log: " << s.Msg();
     }
+    // A batch may carry several commands (e.g. a transaction), each of them starts with its log data
+    first_seen_ = true;
   }
 }
 
 rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) {
-  if (column_family_id == kColumnFamilyIDZSetScore) {
+  if (column_family_id == kColumnFamilyIDZSetScore || column_family_id == kColumnFamilyIDZSetRank) {
     return rocksdb::Status::OK();
   }
 
@@ -56,12 +60,88 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
     if (slot_id_ >= 0 && static_cast<uint16_t>(slot_id_) != GetSlotIdFromKey(user_key)) {
       return rocksdb::Status::OK();
     }
+    if (extractChunkedListCommand(ns)) return rocksdb::Status::OK();
 
     Metadata metadata(kRedisNone);
     auto s = metadata.Decode(value);
     if (!s.ok()) return s;
 
-    if (metadata.Type() == kRedisString) {
+    if (metadata.IsChunkedString()) {
+      auto args = log_data_.GetArguments();
+      std::optional<RedisCommand> cmd;
+      if (args->size() > 0) {
+        auto parse_result = ParseInt<int>((*args)[0], 10);
+        if (!parse_result) {
+          return rocksdb::Status::InvalidArgument(
+              fmt::format("failed to parse Redis command from log data: {}", parse_result.Msg()));
+        }
+        cmd = static_cast<RedisCommand>(*parse_result);
+      }
+
+      // The chunks are replayed as SETRANGE commands, so the value is reset first
+      // unless it's updated in place or only the expiration is changed
+      if (cmd == kRedisCmdExpire) {
+        if (metadata.expire > 0) {
+          command_args = {"PEXPIREAT", user_key, std::to_string(metadata.expire)};
+        } else {
+          command_args = {"PERSIST", user_key};
+        }
+        resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+      } else if (cmd != kRedisCmdSetRange) {
+        command_args = {"SET", user_key, ""};
+        resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+        if (metadata.expire > 0) {
+          command_args = {"PEXPIREAT", user_key, std::to_string(metadata.expire)};
+          resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+        }
+      }
+    } else if (metadata.IsInlineEncoded()) {
+      auto args = log_data_.GetArguments();
+      std::optional<RedisCommand> cmd;
+      if (args->size() > 0) {
+        auto parse_result = ParseInt<int>((*args)[0], 10);
+        if (!parse_result) {
+          return rocksdb::Status::InvalidArgument(
+              fmt::format("failed to parse Redis command from log data: {}", parse_result.Msg()));
+        }
+        cmd = static_cast<RedisCommand>(*parse_result);
+      }
+
+      // The elements are in the metadata, so the whole collection is recreated by every update
+      if (cmd == kRedisCmdExpire) {
+        if (metadata.expire > 0) {
+          command_args = {"PEXPIREAT", user_key, std::to_string(metadata.expire)};
+        } else {
+          command_args = {"PERSIST", user_key};
+        }
+        resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+        return rocksdb::Status::OK();
+      }
+
+      command_args = {"DEL", user_key};
+      resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+      if (metadata.inline_entries.empty()) return rocksdb::Status::OK();
+
+      if (metadata.Type() == kRedisHash) {
+        command_args = {"HSET", user_key};
+      } else if (metadata.Type() == kRedisSet) {
+        command_args = {"SADD", user_key};
+      } else {
+        command_args = {"ZADD", user_key};
+      }
+      for (const auto &[sub_key, sub_value] : metadata.inline_entries) {
+        if (metadata.Type() == kRedisZSet) {
+          command_args.emplace_back(std::to_string(DecodeDouble(sub_value.data())));
+        }
+        command_args.emplace_back(sub_key);
+        if (metadata.Type() == kRedisHash) command_args.emplace_back(sub_value);
+      }
+      resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+      if (metadata.expire > 0) {
+        command_args = {"PEXPIREAT", user_key, std::to_string(metadata.expire)};
+        resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+      }
+    } else if (metadata.Type() == kRedisString) {
       command_args = {"SET", user_key, value.ToString().substr(Metadata::GetOffsetAfterExpire(value[0]))};
       resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
       if (metadata.expire > 0) {
@@ -120,6 +200,10 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
     ns = ikey.GetNamespace().ToString();
 
     switch (log_data_.GetRedisType()) {
+      case kRedisString:
+        // the subkey of a chunk is its offset in the value
+        command_args = {"SETRANGE", user_key, sub_key, value.ToString()};
+        break;
       case kRedisHash:
         command_args = {"HSET", user_key, sub_key, value.ToString()};
         break;
@@ -172,6 +256,9 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
           case kRedisCmdLMove:
             // LMOVE will be parsed in DeleteCF, so ignore it here
             break;
+          case kRedisCmdChunkedList:
+            // the command is extracted along with the metadata
+            break;
           default:
             LOG(ERROR) << "Failed to parse write_batch in PutCF. Type=List: unhandled command with code "
                        << *parse_result;
@@ -187,6 +274,8 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
         break;
       }
       case kRedisBitmap: {
+        // the popcount summary is written along with the segments
+        if (redis::Bitmap::IsSummarySubKey(sub_key)) break;
         auto args = log_data_.GetArguments();
         if (args->empty()) {
           LOG(ERROR)
@@ -214,7 +303,11 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
               return rocksdb::Status::InvalidArgument(
                   fmt::format("failed to parse an offset of SETBIT: {}", parsed_offset.Msg()));
             }
-            bool bit_value = redis::Bitmap::GetBitFromValueAndOffset(value.ToStringView(), *parsed_offset);
+            // The new bit is logged since the segment of a compressed bitmap is encoded,
+            // the older logs only have the offset
+            bool bit_value = args->size() > 2
+                                 ? (*args)[2] == "1"
+                                 : redis::Bitmap::GetBitFromValueAndOffset(value.ToStringView(), *parsed_offset);
             command_args = {"SETBIT", user_key, (*args)[1], bit_value ? "1" : "0"};
             break;
           }
@@ -268,7 +361,7 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
 }
 
 rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const Slice &key) {
-  if (column_family_id == kColumnFamilyIDZSetScore) {
+  if (column_family_id == kColumnFamilyIDZSetScore || column_family_id == kColumnFamilyIDZSetRank) {
     return rocksdb::Status::OK();
   }
 
@@ -282,6 +375,7 @@ rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const S
     if (slot_id_ >= 0 && static_cast<uint16_t>(slot_id_) != GetSlotIdFromKey(user_key)) {
       return rocksdb::Status::OK();
     }
+    if (extractChunkedListCommand(ns)) return rocksdb::Status::OK();
 
     command_args = {"DEL", user_key};
   } else if (column_family_id == kColumnFamilyIDDefault) {
@@ -361,6 +455,9 @@ rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const S
               first_seen_ = false;
             }
             break;
+          case kRedisCmdChunkedList:
+            // the command is extracted along with the metadata
+            break;
           default:
             LOG(ERROR) << "Failed to parse write_batch in DeleteCF. Type=List: unhandled command with code "
                        << *parse_result;
@@ -392,6 +489,22 @@ rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const S
   return rocksdb::Status::OK();
 }
 
+bool WriteBatchExtractor::extractChunkedListCommand(const std::string &ns) {
+  auto args = log_data_.GetArguments();
+  if (log_data_.GetRedisType() != kRedisList || args->size() < 2 ||
+      (*args)[0] != std::to_string(kRedisCmdChunkedList)) {
+    return false;
+  }
+
+  // Every list updated by the command has its metadata in the batch, but the command is replayed once
+  if (first_seen_) {
+    std::vector<std::string> command_args(args->begin() + 1, args->end());
+    resp_commands_[ns].emplace_back(redis::ArrayOfBulkStrings(command_args));
+    first_seen_ = false;
+  }
+  return true;
+}
+
 rocksdb::Status WriteBatchExtractor::DeleteRangeCF(uint32_t column_family_id, const Slice &begin_key,
                                                    const Slice &end_key) {
   // Do nothing with DeleteRange operations
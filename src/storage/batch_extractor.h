@@ -45,6 +45,9 @@ class WriteBatchExtractor : public rocksdb::WriteBatch::Handler {
                                         std::vector<std::string> *command_args);
 
  private:
+  // Extract the command carried by the log data of a chunked list, return false if it's not one
+  bool extractChunkedListCommand(const std::string &ns);
+
   std::map<std::string, std::vector<std::string>> resp_commands_;
   redis::WriteBatchLogData log_data_;
   bool first_seen_ = true;
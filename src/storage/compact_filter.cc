@@ -92,6 +92,7 @@ bool SubKeyFilter::IsMetadataExpired(const InternalKey &ikey, const Metadata &me
   // to prevent them from being recycled once they reach the expiration time.
   uint64_t lazy_expired_ts = util::GetTimeStampMS() - 300000;
   return metadata.IsSingleKVType()  // metadata key was overwrite by set command
+         || metadata.IsInlineEncoded()  // the elements of an inline collection live in the metadata
          || metadata.ExpireAt(lazy_expired_ts) || ikey.GetVersion() != metadata.version;
 }
 
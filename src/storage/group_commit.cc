@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "group_commit.h"
+
+#include <chrono>
+#include <string>
+
+#include "time_util.h"
+
+namespace engine {
+
+// RocksDB's WriteBatch rep starts with an 8-byte sequence number followed by a 4-byte
+// little-endian record count, then the records themselves.
+constexpr size_t kWriteBatchHeaderSize = 12;
+constexpr size_t kWriteBatchCountOffset = 8;
+
+rocksdb::Status GroupCommitter::Write(const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates) {
+  auto start = util::GetTimeStampUS();
+  Writer writer{&options, updates};
+
+  std::unique_lock<std::mutex> lock(mu_);
+  pending_.emplace_back(&writer);
+  pending_bytes_ += updates->GetDataSize();
+  if (has_leader_) {
+    // Wake up the leader if it's waiting for more batches and the group is already full
+    if (pending_bytes_ >= max_bytes_) cv_.notify_all();
+    cv_.wait(lock, [&] { return writer.done || !has_leader_; });
+  }
+
+  if (!writer.done) {
+    // No write is in flight, so this writer leads the next group
+    has_leader_ = true;
+    // A lone writer doesn't wait, only the writers queued behind a write in flight are worth grouping
+    if (max_delay_us_ > 0 && pending_.size() > 1 && pending_bytes_ < max_bytes_) {
+      cv_.wait_for(lock, std::chrono::microseconds(max_delay_us_), [this] { return pending_bytes_ >= max_bytes_; });
+    }
+    std::vector<Writer *> group;
+    group.swap(pending_);
+    pending_bytes_ = 0;
+
+    lock.unlock();
+    auto s = commitGroup(group);
+    lock.lock();
+
+    for (auto *w : group) {
+      w->status = s;
+      w->done = true;
+    }
+    has_leader_ = false;
+    cv_.notify_all();
+  }
+  lock.unlock();
+
+  stats_.wait_us += util::GetTimeStampUS() - start;
+  return writer.status;
+}
+
+rocksdb::Status GroupCommitter::commitGroup(const std::vector<Writer *> &group) {
+  uint64_t bytes = 0;
+  for (const auto *w : group) bytes += w->updates->GetDataSize();
+  stats_.commits++;
+  stats_.batches += group.size();
+  stats_.bytes += bytes;
+
+  if (group.size() == 1) {
+    return write_func_(*group[0]->options, group[0]->updates);
+  }
+
+  // The merged write must be at least as durable as the most demanding writer in the group
+  rocksdb::WriteOptions options = *group[0]->options;
+  std::string rep;
+  rep.reserve(bytes);
+  rep.append(group[0]->updates->Data());
+  uint32_t count = group[0]->updates->Count();
+  for (size_t i = 1; i < group.size(); i++) {
+    const auto *w = group[i];
+    options.sync = options.sync || w->options->sync;
+    options.disableWAL = options.disableWAL && w->options->disableWAL;
+    options.no_slowdown = options.no_slowdown && w->options->no_slowdown;
+    options.low_pri = options.low_pri && w->options->low_pri;
+
+    const auto &data = w->updates->Data();
+    rep.append(data, kWriteBatchHeaderSize, std::string::npos);
+    count += w->updates->Count();
+  }
+  for (size_t i = 0; i < sizeof(count); i++) {
+    rep[kWriteBatchCountOffset + i] = static_cast<char>((count >> (8 * i)) & 0xff);
+  }
+
+  rocksdb::WriteBatch merged(std::move(rep));
+  return write_func_(options, &merged);
+}
+
+}  // namespace engine
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/options.h>
+#include <rocksdb/status.h>
+#include <rocksdb/write_batch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace engine {
+
+struct GroupCommitStats {
+  // number of RocksDB writes issued by the group commit leaders
+  std::atomic<uint64_t> commits = 0;
+  // number of caller batches folded into those writes
+  std::atomic<uint64_t> batches = 0;
+  std::atomic<uint64_t> bytes = 0;
+  // accumulated time spent by callers between enqueueing and being completed
+  std::atomic<uint64_t> wait_us = 0;
+};
+
+// GroupCommitter coalesces the write batches of concurrent writers into a single RocksDB write,
+// so durable writes share one WAL append and fsync instead of paying for one each.
+//
+// The first writer arriving while no write is in flight becomes the leader. If other writers are
+// already pending, it waits for more followers up to `max_delay_us` or until `max_bytes` are pending,
+// merges all pending batches into one and writes it, then completes every follower with the shared
+// status. Writers arriving while the leader is writing form the next group.
+class GroupCommitter {
+ public:
+  using WriteFunc = std::function<rocksdb::Status(const rocksdb::WriteOptions &, rocksdb::WriteBatch *)>;
+
+  GroupCommitter(uint64_t max_delay_us, uint64_t max_bytes, WriteFunc write_func)
+      : max_delay_us_(max_delay_us), max_bytes_(max_bytes), write_func_(std::move(write_func)) {}
+
+  rocksdb::Status Write(const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates);
+  const GroupCommitStats &GetStats() const { return stats_; }
+
+  GroupCommitter(const GroupCommitter &) = delete;
+  GroupCommitter &operator=(const GroupCommitter &) = delete;
+
+ private:
+  struct Writer {
+    const rocksdb::WriteOptions *options;
+    rocksdb::WriteBatch *updates;
+    rocksdb::Status status;
+    bool done = false;
+  };
+
+  rocksdb::Status commitGroup(const std::vector<Writer *> &group);
+
+  uint64_t max_delay_us_;
+  uint64_t max_bytes_;
+  WriteFunc write_func_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<Writer *> pending_;
+  uint64_t pending_bytes_ = 0;
+  bool has_leader_ = false;
+
+  GroupCommitStats stats_;
+};
+
+}  // namespace engine
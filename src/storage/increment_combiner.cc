@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "increment_combiner.h"
+
+namespace engine {
+
+rocksdb::Status IncrementCombiner::IncrBy(const std::string &counter, int64_t delta, int64_t *new_value,
+                                          const ApplyFunc &apply_func) {
+  Increment increment{delta};
+  auto &shard = shards_[std::hash<std::string>{}(counter) % kNumShards];
+
+  std::unique_lock<std::mutex> lock(shard.mu);
+  // The group can't be erased while this increment is pending in it
+  auto *group = &shard.groups[counter];
+  group->pending.emplace_back(&increment);
+  if (group->has_leader) {
+    shard.cv.wait(lock, [&] { return increment.done || !group->has_leader; });
+  }
+
+  if (!increment.done) {
+    // No group of this counter is in flight, so this increment leads the next one
+    group->has_leader = true;
+    std::vector<Increment *> batch;
+    batch.swap(group->pending);
+
+    lock.unlock();
+    stats_.applies++;
+    stats_.increments += batch.size();
+    apply_func(batch);
+    lock.lock();
+
+    for (auto *inc : batch) inc->done = true;
+    group->has_leader = false;
+    if (group->pending.empty()) shard.groups.erase(counter);
+    shard.cv.notify_all();
+  }
+  lock.unlock();
+
+  if (increment.status.ok()) *new_value = increment.new_value;
+  return increment.status;
+}
+
+}  // namespace engine
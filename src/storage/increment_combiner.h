@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/status.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+struct IncrementCombinerStats {
+  // number of read-modify-writes issued by the leaders
+  std::atomic<uint64_t> applies = 0;
+  // number of increments folded into those read-modify-writes
+  std::atomic<uint64_t> increments = 0;
+};
+
+// IncrementCombiner folds the concurrent increments of the same counter into a single
+// read-modify-write, so a hot counter reads and writes RocksDB once per group instead of
+// once per increment while the others wait for the key lock.
+//
+// Like GroupCommitter, the first increment arriving while no group of the counter is in
+// flight becomes the leader and applies the increments pending at that time. Those arriving
+// meanwhile form the next group. Every increment still gets its own new value, as if they
+// were applied one by one in the order of the group.
+class IncrementCombiner {
+ public:
+  struct Increment {
+    int64_t delta;
+    int64_t new_value = 0;
+    rocksdb::Status status;
+    bool done = false;
+  };
+  // Apply the increments in order, setting the new value or the error of each one
+  using ApplyFunc = std::function<void(const std::vector<Increment *> &)>;
+
+  rocksdb::Status IncrBy(const std::string &counter, int64_t delta, int64_t *new_value, const ApplyFunc &apply_func);
+  const IncrementCombinerStats &GetStats() const { return stats_; }
+
+ private:
+  static constexpr size_t kNumShards = 64;
+
+  struct Group {
+    std::vector<Increment *> pending;
+    bool has_leader = false;
+  };
+
+  struct Shard {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::unordered_map<std::string, Group> groups;
+  };
+
+  std::array<Shard, kNumShards> shards_;
+  IncrementCombinerStats stats_;
+};
+
+}  // namespace engine
@@ -22,6 +22,8 @@
 
 #include <cluster/redis_slot.h>
 
+#include <algorithm>
+
 #include "db_util.h"
 
 namespace engine {
@@ -164,6 +166,42 @@ void SubKeyIterator::Reset() {
   if (iter_) iter_.reset();
 }
 
+InlineSubKeyIterator::InlineSubKeyIterator(const Slice &ns_key, const Metadata &metadata, bool slot_id_encoded,
+                                           bool score_order) {
+  entries_.reserve(metadata.inline_entries.size());
+  for (const auto &[sub_key, value] : metadata.inline_entries) {
+    if (score_order) {
+      // the key of a member in the score column family is its encoded score followed by the member
+      entries_.emplace_back(InternalKey(ns_key, value + sub_key, metadata.version, slot_id_encoded).Encode(), "");
+    } else {
+      entries_.emplace_back(InternalKey(ns_key, sub_key, metadata.version, slot_id_encoded).Encode(), value);
+    }
+  }
+  // the entries are ordered by subkey, hence by the encoded key unless they're ordered by score
+  if (score_order) std::sort(entries_.begin(), entries_.end());
+  pos_ = entries_.size();
+}
+
+void InlineSubKeyIterator::Seek(const Slice &target) {
+  auto iter = std::lower_bound(entries_.begin(), entries_.end(), target,
+                               [](const auto &entry, const Slice &key) { return Slice(entry.first).compare(key) < 0; });
+  pos_ = iter - entries_.begin();
+}
+
+void InlineSubKeyIterator::SeekForPrev(const Slice &target) {
+  auto iter = std::upper_bound(entries_.begin(), entries_.end(), target,
+                               [](const Slice &key, const auto &entry) { return key.compare(entry.first) < 0; });
+  pos_ = iter == entries_.begin() ? entries_.size() : iter - entries_.begin() - 1;
+}
+
+void InlineSubKeyIterator::Next() {
+  if (Valid()) pos_++;
+}
+
+void InlineSubKeyIterator::Prev() {
+  if (Valid()) pos_ = pos_ == 0 ? entries_.size() : pos_ - 1;
+}
+
 rocksdb::Status WALBatchExtractor::PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) {
   if (slot_ != -1 && slot_ != ExtractSlotId(key)) {
     return rocksdb::Status::OK();
@@ -22,6 +22,10 @@
 #include <rocksdb/iterator.h>
 #include <rocksdb/options.h>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "storage.h"
 
 namespace engine {
@@ -50,6 +54,30 @@ class SubKeyIterator {
   rocksdb::ColumnFamilyHandle *cf_handle_ = nullptr;
 };
 
+// InlineSubKeyIterator yields the inline elements of a hash, set or sorted set as the keys and values
+// its subkeys would have, so the code scanning subkeys works for inline encoded collections as well.
+// With `score_order`, it yields the keys of the score column family of a sorted set instead.
+class InlineSubKeyIterator : public rocksdb::Iterator {
+ public:
+  explicit InlineSubKeyIterator(const Slice &ns_key, const Metadata &metadata, bool slot_id_encoded,
+                                bool score_order = false);
+
+  bool Valid() const override { return pos_ < entries_.size(); }
+  void SeekToFirst() override { pos_ = 0; }
+  void SeekToLast() override { pos_ = entries_.empty() ? 0 : entries_.size() - 1; }
+  void Seek(const Slice &target) override;
+  void SeekForPrev(const Slice &target) override;
+  void Next() override;
+  void Prev() override;
+  Slice key() const override { return entries_[pos_].first; }
+  Slice value() const override { return entries_[pos_].second; }
+  rocksdb::Status status() const override { return rocksdb::Status::OK(); }
+
+ private:
+  std::vector<std::pair<std::string, std::string>> entries_;
+  size_t pos_ = 0;
+};
+
 class DBIterator {
  public:
   explicit DBIterator(Storage *storage, rocksdb::ReadOptions read_options, int slot = -1);
@@ -0,0 +1,217 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "metadata_cache.h"
+
+#include <algorithm>
+
+namespace engine {
+
+namespace {
+
+// Collects the writes to the metadata column family from a write batch
+class MetadataWriteCollector : public rocksdb::WriteBatch::Handler {
+ public:
+  MetadataWriteCollector(uint32_t metadata_cf_id, MetadataCache::WriteContext *ctx)
+      : metadata_cf_id_(metadata_cf_id), ctx_(ctx) {}
+
+  rocksdb::Status PutCF(uint32_t column_family_id, const rocksdb::Slice &key, const rocksdb::Slice &value) override {
+    add(column_family_id, key, MetadataCache::WriteContext::Op::kPut, value);
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status DeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override {
+    add(column_family_id, key, MetadataCache::WriteContext::Op::kDelete);
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status SingleDeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override {
+    add(column_family_id, key, MetadataCache::WriteContext::Op::kDelete);
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status MergeCF(uint32_t column_family_id, const rocksdb::Slice &key, const rocksdb::Slice &value) override {
+    add(column_family_id, key, MetadataCache::WriteContext::Op::kUnknown);
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status DeleteRangeCF(uint32_t column_family_id, const rocksdb::Slice &begin_key,
+                                const rocksdb::Slice &end_key) override {
+    if (column_family_id == metadata_cf_id_) ctx_->range_deleted = true;
+    return rocksdb::Status::OK();
+  }
+
+ private:
+  void add(uint32_t column_family_id, const rocksdb::Slice &key, MetadataCache::WriteContext::Op op,
+           const rocksdb::Slice &value = {}) {
+    if (column_family_id != metadata_cf_id_) return;
+    ctx_->updates.push_back({key.ToString(), op, value.ToString()});
+  }
+
+  uint32_t metadata_cf_id_;
+  MetadataCache::WriteContext *ctx_;
+};
+
+}  // namespace
+
+MetadataCache::LookupResult MetadataCache::Lookup(std::string_view key, rocksdb::SequenceNumber read_seq,
+                                                  std::string *value) {
+  auto &shard = getShard(key);
+  std::lock_guard<std::mutex> guard(shard.mu);
+  auto iter = shard.entries.find(key);
+  if (iter == shard.entries.end() || iter->second->seq > read_seq) {
+    stats_.misses.fetch_add(1, std::memory_order_relaxed);
+    return LookupResult::kMiss;
+  }
+
+  stats_.hits.fetch_add(1, std::memory_order_relaxed);
+  shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+  const auto &entry = *iter->second;
+  if (!entry.exists) return LookupResult::kNotFound;
+  value->assign(entry.value);
+  return LookupResult::kFound;
+}
+
+void MetadataCache::Insert(std::string_view key, rocksdb::SequenceNumber read_seq, const rocksdb::Slice *value) {
+  auto &shard = getShard(key);
+  std::lock_guard<std::mutex> guard(shard.mu);
+  // A write of this shard completed after the read, the value may be stale already
+  if (read_seq < shard.last_write_seq || shard.pending_range_deletes > 0 || shard.pending.count(std::string(key))) {
+    return;
+  }
+  if (auto iter = shard.entries.find(key); iter != shard.entries.end() && iter->second->seq >= read_seq) {
+    return;
+  }
+  insertLocked(shard, key, read_seq, value);
+}
+
+MetadataCache::WriteContext MetadataCache::BeginWrite(uint32_t metadata_cf_id, rocksdb::WriteBatch *updates) {
+  WriteContext ctx;
+  MetadataWriteCollector collector(metadata_cf_id, &ctx);
+  if (auto s = updates->Iterate(&collector); !s.ok()) {
+    // Fall back to invalidating everything if the batch can't be inspected
+    ctx.updates.clear();
+    ctx.range_deleted = true;
+  }
+
+  for (const auto &update : ctx.updates) {
+    auto &shard = getShard(update.key);
+    std::lock_guard<std::mutex> guard(shard.mu);
+    eraseLocked(shard, update.key);
+    shard.pending[update.key]++;
+  }
+  if (ctx.range_deleted) {
+    for (auto &shard : shards_) {
+      std::lock_guard<std::mutex> guard(shard.mu);
+      shard.pending_range_deletes++;
+      clearLocked(shard);
+    }
+  }
+  return ctx;
+}
+
+void MetadataCache::EndWrite(const WriteContext &ctx, bool succeeded, rocksdb::SequenceNumber latest_seq) {
+  for (const auto &update : ctx.updates) {
+    auto &shard = getShard(update.key);
+    std::lock_guard<std::mutex> guard(shard.mu);
+    shard.last_write_seq = std::max(shard.last_write_seq, latest_seq);
+    auto iter = shard.pending.find(update.key);
+    if (--iter->second > 0) continue;
+    shard.pending.erase(iter);
+
+    // Only the last update of a key in the batch gets here, so it holds the final value
+    if (!succeeded || ctx.range_deleted || update.op == WriteContext::Op::kUnknown ||
+        shard.pending_range_deletes > 0) {
+      eraseLocked(shard, update.key);
+      continue;
+    }
+    rocksdb::Slice value(update.value);
+    insertLocked(shard, update.key, latest_seq, update.op == WriteContext::Op::kPut ? &value : nullptr);
+  }
+  if (ctx.range_deleted) {
+    for (auto &shard : shards_) {
+      std::lock_guard<std::mutex> guard(shard.mu);
+      shard.last_write_seq = std::max(shard.last_write_seq, latest_seq);
+      shard.pending_range_deletes--;
+      clearLocked(shard);
+    }
+  }
+}
+
+void MetadataCache::Clear() {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    clearLocked(shard);
+  }
+}
+
+size_t MetadataCache::Usage() const {
+  size_t usage = 0;
+  for (const auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    usage += shard.usage;
+  }
+  return usage;
+}
+
+size_t MetadataCache::Size() const {
+  size_t size = 0;
+  for (const auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    size += shard.entries.size();
+  }
+  return size;
+}
+
+void MetadataCache::insertLocked(Shard &shard, std::string_view key, rocksdb::SequenceNumber seq,
+                                 const rocksdb::Slice *value) {
+  eraseLocked(shard, key);
+  if (value && value->size() > kMaxValueSize) return;
+
+  Entry entry{std::string(key), value ? value->ToString() : std::string(), value != nullptr, seq};
+  auto charge = entry.Charge();
+  if (charge > shard_capacity_) return;
+
+  while (!shard.lru.empty() && shard.usage + charge > shard_capacity_) {
+    stats_.evictions.fetch_add(1, std::memory_order_relaxed);
+    eraseLocked(shard, shard.lru.back().key);
+  }
+  shard.lru.emplace_front(std::move(entry));
+  shard.entries.emplace(shard.lru.front().key, shard.lru.begin());
+  shard.usage += charge;
+}
+
+void MetadataCache::eraseLocked(Shard &shard, std::string_view key) {
+  auto iter = shard.entries.find(key);
+  if (iter == shard.entries.end()) return;
+
+  auto entry = iter->second;
+  shard.entries.erase(iter);
+  shard.usage -= entry->Charge();
+  shard.lru.erase(entry);
+}
+
+void MetadataCache::clearLocked(Shard &shard) {
+  shard.entries.clear();
+  shard.lru.clear();
+  shard.usage = 0;
+}
+
+}  // namespace engine
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/slice.h>
+#include <rocksdb/types.h>
+#include <rocksdb/write_batch.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+struct MetadataCacheStats {
+  std::atomic<uint64_t> hits = 0;
+  std::atomic<uint64_t> misses = 0;
+  std::atomic<uint64_t> evictions = 0;
+};
+
+// MetadataCache keeps the recently read values of the metadata column family in memory,
+// so the hot keys of complex types don't pay a RocksDB Get for every command.
+//
+// Each entry carries the sequence number from which its value is known to be valid, so a
+// read with an older snapshot never sees a newer value. Writers invalidate the keys of their
+// batch before writing to RocksDB and refill them afterward, a read racing with a write can
+// only insert its result if no write of its shard completed after the read snapshot.
+class MetadataCache {
+ public:
+  // Values larger than this are not cached, which keeps big strings from flushing the metadata out.
+  static constexpr size_t kMaxValueSize = 512;
+  static constexpr size_t kNumShards = 64;
+
+  enum class LookupResult { kMiss, kFound, kNotFound };
+
+  // The metadata keys written by a batch, collected by BeginWrite and consumed by EndWrite
+  struct WriteContext {
+    enum class Op { kPut, kDelete, kUnknown };
+    struct Update {
+      std::string key;
+      Op op;
+      std::string value;
+    };
+    std::vector<Update> updates;
+    bool range_deleted = false;
+
+    bool Empty() const { return updates.empty() && !range_deleted; }
+  };
+
+  explicit MetadataCache(size_t capacity) : shard_capacity_(capacity / kNumShards) {}
+
+  // Look up `key` for a read at `read_seq`, the value is copied into `value` when found.
+  LookupResult Lookup(std::string_view key, rocksdb::SequenceNumber read_seq, std::string *value);
+  // Insert the result of a RocksDB read at `read_seq`, `value` is nullptr if the key was not found.
+  void Insert(std::string_view key, rocksdb::SequenceNumber read_seq, const rocksdb::Slice *value);
+
+  WriteContext BeginWrite(uint32_t metadata_cf_id, rocksdb::WriteBatch *updates);
+  void EndWrite(const WriteContext &ctx, bool succeeded, rocksdb::SequenceNumber latest_seq);
+
+  void Clear();
+
+  size_t Capacity() const { return shard_capacity_ * kNumShards; }
+  size_t Usage() const;
+  size_t Size() const;
+  const MetadataCacheStats &GetStats() const { return stats_; }
+
+  MetadataCache(const MetadataCache &) = delete;
+  MetadataCache &operator=(const MetadataCache &) = delete;
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    bool exists;
+    rocksdb::SequenceNumber seq;
+
+    size_t Charge() const { return key.size() * 2 + value.size() + sizeof(Entry) + 64; }
+  };
+
+  struct Shard {
+    mutable std::mutex mu;
+    // the most recently used entries are at the front
+    std::list<Entry> lru;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> entries;
+    // number of in-flight writes per key, a key can't be cached while it's being written
+    std::unordered_map<std::string, int> pending;
+    // number of in-flight range deletions, nothing can be cached while one is running
+    int pending_range_deletes = 0;
+    // the sequence number of the latest completed write to the keys of this shard
+    rocksdb::SequenceNumber last_write_seq = 0;
+    size_t usage = 0;
+  };
+
+  Shard &getShard(std::string_view key) { return shards_[std::hash<std::string_view>{}(key) % kNumShards]; }
+  void insertLocked(Shard &shard, std::string_view key, rocksdb::SequenceNumber seq, const rocksdb::Slice *value);
+  static void eraseLocked(Shard &shard, std::string_view key);
+  static void clearLocked(Shard &shard);
+
+  size_t shard_capacity_;
+  std::array<Shard, kNumShards> shards_;
+  MetadataCacheStats stats_;
+};
+
+}  // namespace engine
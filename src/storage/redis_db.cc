@@ -99,9 +99,7 @@ rocksdb::Status Database::GetMetadata(RedisTypes types, const Slice &ns_key, std
 }
 
 rocksdb::Status Database::GetRawMetadata(const Slice &ns_key, std::string *bytes) {
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
   return storage_->Get(read_options, metadata_cf_handle_, ns_key, bytes);
 }
 
@@ -175,9 +173,7 @@ rocksdb::Status Database::MDel(const std::vector<Slice> &keys, uint64_t *deleted
     slice_keys.emplace_back(ns_key);
   }
 
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
-  read_options.snapshot = ss.GetSnapShot();
   std::vector<rocksdb::Status> statuses(slice_keys.size());
   std::vector<rocksdb::PinnableSlice> pin_values(slice_keys.size());
   storage_->MultiGet(read_options, metadata_cf_handle_, slice_keys.size(), slice_keys.data(), pin_values.data(),
@@ -229,9 +225,7 @@ rocksdb::Status Database::TTL(const Slice &user_key, int64_t *ttl) {
   std::string ns_key = AppendNamespacePrefix(user_key);
 
   *ttl = -2;  // ttl is -2 when the key does not exist or expired
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
   std::string value;
   rocksdb::Status s = storage_->Get(read_options, metadata_cf_handle_, ns_key, &value);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
@@ -479,9 +473,7 @@ rocksdb::Status Database::Dump(const Slice &user_key, std::vector<std::string> *
 
   std::string ns_key = AppendNamespacePrefix(user_key);
 
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
   std::string value;
   rocksdb::Status s = storage_->Get(read_options, metadata_cf_handle_, ns_key, &value);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
@@ -532,9 +524,7 @@ rocksdb::Status Database::Type(const Slice &user_key, RedisType *type) {
   std::string ns_key = AppendNamespacePrefix(user_key);
 
   *type = kRedisNone;
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
   std::string value;
   rocksdb::Status s = storage_->Get(read_options, metadata_cf_handle_, ns_key, &value);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
@@ -550,6 +540,81 @@ rocksdb::Status Database::Type(const Slice &user_key, RedisType *type) {
   return rocksdb::Status::OK();
 }
 
+void Database::MultiPointRead(const std::vector<PointRead> &reads, std::vector<PointReadResult> *results) {
+  results->clear();
+  results->resize(reads.size());
+  if (reads.empty()) return;
+
+  rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
+  LatestSnapShot ss(storage_);
+  read_options.snapshot = ss.GetSnapShot();
+
+  std::vector<std::string> ns_keys;
+  std::vector<Slice> metadata_keys;
+  ns_keys.reserve(reads.size());
+  metadata_keys.reserve(reads.size());
+  for (const auto &read : reads) {
+    ns_keys.emplace_back(AppendNamespacePrefix(read.user_key));
+    metadata_keys.emplace_back(ns_keys.back());
+  }
+  std::vector<rocksdb::PinnableSlice> pin_values(reads.size());
+  std::vector<rocksdb::Status> statuses(reads.size());
+  storage_->MultiGet(read_options, metadata_cf_handle_, metadata_keys.size(), metadata_keys.data(), pin_values.data(),
+                     statuses.data());
+
+  std::vector<size_t> sub_key_indexes;
+  std::vector<std::string> sub_keys;
+  for (size_t i = 0; i < reads.size(); i++) {
+    auto &result = (*results)[i];
+    if (!statuses[i].ok()) {
+      result.status = statuses[i];
+      continue;
+    }
+
+    Metadata metadata(reads[i].type, false);
+    Slice rest(pin_values[i].data(), pin_values[i].size());
+    if (reads[i].type == kRedisNone) {
+      // Only resolve the type like TYPE and EXISTS, so the size of the metadata is not checked here
+      result.status = metadata.Decode(&rest);
+      if (result.status.ok() && metadata.Expired()) result.status = rocksdb::Status::NotFound(kErrMsgKeyExpired);
+    } else {
+      result.status = ParseMetadata({reads[i].type}, &rest, &metadata);
+    }
+    if (!result.status.ok()) continue;
+
+    result.type = metadata.Type();
+    if (reads[i].read_sub_key && metadata.IsInlineEncoded()) {
+      auto iter = metadata.inline_entries.find(reads[i].sub_key);
+      if (iter == metadata.inline_entries.end()) {
+        result.status = rocksdb::Status::NotFound();
+      } else {
+        result.value = iter->second;
+      }
+    } else if (reads[i].read_sub_key) {
+      sub_key_indexes.emplace_back(i);
+      sub_keys.emplace_back(
+          InternalKey(ns_keys[i], reads[i].sub_key, metadata.version, storage_->IsSlotIdEncoded()).Encode());
+    } else if (reads[i].type == kRedisString && metadata.IsChunkedString()) {
+      // The value of a chunked string is left to the regular execution
+      result.status = rocksdb::Status::Incomplete("chunked string");
+    } else if (result.type == kRedisString) {
+      result.value.assign(rest.data(), rest.size());
+    }
+  }
+  if (sub_keys.empty()) return;
+
+  std::vector<Slice> sub_key_slices(sub_keys.begin(), sub_keys.end());
+  std::vector<rocksdb::PinnableSlice> sub_values(sub_keys.size());
+  std::vector<rocksdb::Status> sub_statuses(sub_keys.size());
+  storage_->MultiGet(read_options, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), sub_key_slices.size(),
+                     sub_key_slices.data(), sub_values.data(), sub_statuses.data());
+  for (size_t i = 0; i < sub_key_indexes.size(); i++) {
+    auto &result = (*results)[sub_key_indexes[i]];
+    result.status = sub_statuses[i];
+    if (result.status.ok()) result.value.assign(sub_values[i].data(), sub_values[i].size());
+  }
+}
+
 std::string Database::AppendNamespacePrefix(const Slice &user_key) {
   return ComposeNamespaceKey(namespace_, user_key, storage_->IsSlotIdEncoded());
 }
@@ -642,7 +707,7 @@ rocksdb::Status SubKeyScanner::Scan(RedisType type, const Slice &user_key, const
   LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
   read_options.snapshot = ss.GetSnapShot();
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = newSubKeyIterator(ns_key, metadata, read_options);
   std::string match_prefix_key =
       InternalKey(ns_key, subkey_prefix, metadata.version, storage_->IsSlotIdEncoded()).Encode();
 
@@ -674,6 +739,78 @@ rocksdb::Status SubKeyScanner::Scan(RedisType type, const Slice &user_key, const
   return rocksdb::Status::OK();
 }
 
+void SubKeyScanner::initInlineEncoding(Metadata *metadata) const {
+  if (storage_->GetConfig()->inline_collection_max_entries > 0) {
+    metadata->flags |= METADATA_INLINE_ENCODING_MASK;
+  }
+}
+
+util::UniqueIterator SubKeyScanner::newSubKeyIterator(const Slice &ns_key, const Metadata &metadata,
+                                                      const rocksdb::ReadOptions &read_options) {
+  if (metadata.IsInlineEncoded()) {
+    return util::UniqueIterator(new engine::InlineSubKeyIterator(ns_key, metadata, storage_->IsSlotIdEncoded()));
+  }
+  return util::UniqueIterator(storage_, read_options);
+}
+
+rocksdb::Status SubKeyScanner::getSubKey(const rocksdb::ReadOptions &read_options, const Slice &ns_key,
+                                         const Metadata &metadata, const Slice &sub_key, std::string *value) {
+  if (metadata.IsInlineEncoded()) {
+    auto iter = metadata.inline_entries.find(sub_key.ToStringView());
+    if (iter == metadata.inline_entries.end()) return rocksdb::Status::NotFound();
+    *value = iter->second;
+    return rocksdb::Status::OK();
+  }
+  std::string internal_key = InternalKey(ns_key, sub_key, metadata.version, storage_->IsSlotIdEncoded()).Encode();
+  return storage_->Get(read_options, internal_key, value);
+}
+
+void SubKeyScanner::putSubKey(rocksdb::WriteBatchBase *batch, const Slice &ns_key, Metadata *metadata,
+                              const Slice &sub_key, const Slice &value) {
+  if (metadata->IsInlineEncoded()) {
+    metadata->inline_entries.insert_or_assign(sub_key.ToString(), value.ToString());
+  } else {
+    batch->Put(InternalKey(ns_key, sub_key, metadata->version, storage_->IsSlotIdEncoded()).Encode(), value);
+  }
+}
+
+void SubKeyScanner::deleteSubKey(rocksdb::WriteBatchBase *batch, const Slice &ns_key, Metadata *metadata,
+                                 const Slice &sub_key) {
+  if (metadata->IsInlineEncoded()) {
+    if (auto iter = metadata->inline_entries.find(sub_key.ToStringView()); iter != metadata->inline_entries.end()) {
+      metadata->inline_entries.erase(iter);
+    }
+  } else {
+    batch->Delete(InternalKey(ns_key, sub_key, metadata->version, storage_->IsSlotIdEncoded()).Encode());
+  }
+}
+
+bool SubKeyScanner::putCollectionMetadata(rocksdb::WriteBatchBase *batch, const Slice &ns_key, Metadata *metadata) {
+  bool moved = false;
+  if (metadata->IsInlineEncoded()) {
+    metadata->size = metadata->inline_entries.size();
+    const auto *config = storage_->GetConfig();
+    uint64_t entries_bytes = 0;
+    for (const auto &[sub_key, value] : metadata->inline_entries) {
+      entries_bytes += sub_key.size() + value.size();
+    }
+    if (metadata->inline_entries.size() > static_cast<uint64_t>(config->inline_collection_max_entries) ||
+        entries_bytes > static_cast<uint64_t>(config->inline_collection_max_bytes)) {
+      // There are no subkeys of this version yet, so the elements are simply written as subkeys
+      for (const auto &[sub_key, value] : metadata->inline_entries) {
+        batch->Put(InternalKey(ns_key, sub_key, metadata->version, storage_->IsSlotIdEncoded()).Encode(), value);
+      }
+      metadata->flags &= ~METADATA_INLINE_ENCODING_MASK;
+      moved = true;
+    }
+  }
+
+  std::string bytes;
+  metadata->Encode(&bytes);
+  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  return moved;
+}
+
 RedisType WriteBatchLogData::GetRedisType() const { return type_; }
 
 std::vector<std::string> *WriteBatchLogData::GetArguments() { return &args_; }
@@ -759,6 +896,60 @@ rocksdb::Status Database::Rename(const std::string &key, const std::string &new_
     }
   }
 
+  // copy the rank index of the sorted set if it has one
+  if (type == kRedisZSet) {
+    ZSetMetadata zset_metadata(false);
+    if (s = zset_metadata.Decode(iter.Value()); !s.ok()) return s;
+    if (zset_metadata.rank_indexed) {
+      auto zset_rank_cf = storage_->GetCFHandle(engine::kZSetRankColumnFamilyName);
+      std::string prefix_key = InternalKey(ns_key, "", zset_metadata.version, storage_->IsSlotIdEncoded()).Encode();
+      auto rank_iter = util::UniqueIterator(storage_, storage_->DefaultScanOptions(), zset_rank_cf);
+      for (rank_iter->Seek(prefix_key); rank_iter->Valid() && rank_iter->key().starts_with(prefix_key);
+           rank_iter->Next()) {
+        InternalKey from_ikey(rank_iter->key(), storage_->IsSlotIdEncoded());
+        std::string to_ikey =
+            InternalKey(new_ns_key, from_ikey.GetSubKey(), from_ikey.GetVersion(), storage_->IsSlotIdEncoded())
+                .Encode();
+        batch->Put(zset_rank_cf, to_ikey, rank_iter->value());
+      }
+    }
+  }
+
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
+
+thread_local SnapshotPinner *SnapshotPinner::current_ = nullptr;
+
+SnapshotPinner::SnapshotPinner(engine::Storage *storage) : storage_(storage) {
+  // Nested pinners of the same thread reuse the outer one
+  if (current_) return;
+
+  guard_ = storage_->TryReadLockGuard();
+  if (!guard_.owns_lock()) return;
+  if (storage_->IsClosing()) {
+    guard_.unlock();
+    return;
+  }
+  current_ = this;
+}
+
+SnapshotPinner::~SnapshotPinner() {
+  if (!IsActive()) return;
+
+  // The snapshot must be released before unlocking the DB
+  snapshot_.reset();
+  current_ = nullptr;
+}
+
+std::shared_ptr<const rocksdb::Snapshot> SnapshotPinner::acquire() {
+  auto db = storage_->GetDB();
+  // No write happened since the snapshot was taken, so it is still the latest one
+  if (snapshot_ && snapshot_->GetSequenceNumber() == db->GetLatestSequenceNumber()) return snapshot_;
+
+  // The readers still using the previous snapshot keep it alive until they finish
+  snapshot_ = std::shared_ptr<const rocksdb::Snapshot>(
+      db->GetSnapshot(), [db](const rocksdb::Snapshot *snapshot) { db->ReleaseSnapshot(snapshot); });
+  return snapshot_;
+}
+
 }  // namespace redis
@@ -21,10 +21,12 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "db_util.h"
 #include "redis_metadata.h"
 #include "storage.h"
 
@@ -33,6 +35,22 @@ class Database {
  public:
   static constexpr uint64_t RANDOM_KEY_SCAN_LIMIT = 60;
 
+  // PointRead is a metadata lookup of a key, optionally followed by a lookup of one of its subkeys.
+  struct PointRead {
+    // the expected type of the key, kRedisNone means any type and only resolves the type
+    RedisType type = kRedisNone;
+    Slice user_key;
+    Slice sub_key;
+    bool read_sub_key = false;
+  };
+
+  struct PointReadResult {
+    rocksdb::Status status;
+    RedisType type = kRedisNone;
+    // the value of the string key, or the value of the subkey if `read_sub_key` is set
+    std::string value;
+  };
+
   explicit Database(engine::Storage *storage, std::string ns = "");
   [[nodiscard]] rocksdb::Status ParseMetadata(RedisTypes types, Slice *bytes, Metadata *metadata);
   [[nodiscard]] rocksdb::Status GetMetadata(RedisTypes types, const Slice &ns_key, Metadata *metadata);
@@ -62,6 +80,9 @@ class Database {
   [[nodiscard]] rocksdb::Status ClearKeysOfSlot(const rocksdb::Slice &ns, int slot);
   [[nodiscard]] rocksdb::Status KeyExist(const std::string &key);
   [[nodiscard]] rocksdb::Status Rename(const std::string &key, const std::string &new_key, bool nx, bool *ret);
+  // MultiPointRead resolves a batch of point reads on the same snapshot with one MultiGet
+  // for the metadata and another one for the subkeys.
+  void MultiPointRead(const std::vector<PointRead> &reads, std::vector<PointReadResult> *results);
 
  protected:
   engine::Storage *storage_;
@@ -71,10 +92,49 @@ class Database {
   friend class LatestSnapShot;
 };
 
+// While a SnapshotPinner is alive, the LatestSnapShot objects created in the same thread share
+// one snapshot until a write advances the latest sequence number, instead of acquiring and
+// releasing a snapshot (and taking the DB mutex twice) each. It's meant to span the commands
+// of a pipeline, so the DB can't be closed meanwhile: the pinner holds the storage read lock,
+// and stays inactive if the lock isn't available right away.
+class SnapshotPinner {
+ public:
+  explicit SnapshotPinner(engine::Storage *storage);
+  ~SnapshotPinner();
+
+  bool IsActive() const { return current_ == this; }
+
+  SnapshotPinner(const SnapshotPinner &) = delete;
+  SnapshotPinner &operator=(const SnapshotPinner &) = delete;
+
+ private:
+  friend class LatestSnapShot;
+
+  static SnapshotPinner *current(engine::Storage *storage) {
+    return current_ && current_->storage_ == storage ? current_ : nullptr;
+  }
+  std::shared_ptr<const rocksdb::Snapshot> acquire();
+
+  engine::Storage *storage_ = nullptr;
+  std::shared_lock<std::shared_mutex> guard_;
+  std::shared_ptr<const rocksdb::Snapshot> snapshot_;
+
+  static thread_local SnapshotPinner *current_;
+};
+
 class LatestSnapShot {
  public:
-  explicit LatestSnapShot(engine::Storage *storage) : storage_(storage), snapshot_(storage_->GetDB()->GetSnapshot()) {}
-  ~LatestSnapShot() { storage_->GetDB()->ReleaseSnapshot(snapshot_); }
+  explicit LatestSnapShot(engine::Storage *storage) : storage_(storage) {
+    if (auto pinner = SnapshotPinner::current(storage); pinner) {
+      pinned_ = pinner->acquire();
+      snapshot_ = pinned_.get();
+    } else {
+      snapshot_ = storage_->GetDB()->GetSnapshot();
+    }
+  }
+  ~LatestSnapShot() {
+    if (!pinned_) storage_->GetDB()->ReleaseSnapshot(snapshot_);
+  }
   const rocksdb::Snapshot *GetSnapShot() const { return snapshot_; }
 
   LatestSnapShot(const LatestSnapShot &) = delete;
@@ -83,6 +143,8 @@ class LatestSnapShot {
  private:
   engine::Storage *storage_ = nullptr;
   const rocksdb::Snapshot *snapshot_ = nullptr;
+  // the snapshot shared with the other reads of the thread, if a SnapshotPinner is active
+  std::shared_ptr<const rocksdb::Snapshot> pinned_;
 };
 
 class SubKeyScanner : public redis::Database {
@@ -91,6 +153,23 @@ class SubKeyScanner : public redis::Database {
   rocksdb::Status Scan(RedisType type, const Slice &user_key, const std::string &cursor, uint64_t limit,
                        const std::string &subkey_prefix, std::vector<std::string> *keys,
                        std::vector<std::string> *values = nullptr);
+
+ protected:
+  // Keep the elements of a new hash, set or sorted set inline if `inline-collection-max-entries` is enabled
+  void initInlineEncoding(Metadata *metadata) const;
+  // Iterate the subkeys of a collection, or its inline elements as if they were subkeys
+  util::UniqueIterator newSubKeyIterator(const Slice &ns_key, const Metadata &metadata,
+                                         const rocksdb::ReadOptions &read_options);
+  // Read, write or delete a subkey of a collection, which is one of the inline elements if it's inline encoded
+  rocksdb::Status getSubKey(const rocksdb::ReadOptions &read_options, const Slice &ns_key, const Metadata &metadata,
+                            const Slice &sub_key, std::string *value);
+  void putSubKey(rocksdb::WriteBatchBase *batch, const Slice &ns_key, Metadata *metadata, const Slice &sub_key,
+                 const Slice &value);
+  void deleteSubKey(rocksdb::WriteBatchBase *batch, const Slice &ns_key, Metadata *metadata, const Slice &sub_key);
+  // Write the metadata of a collection. An inline collection exceeding the `inline-collection-max-*` limits
+  // is moved to subkeys, in which case true is returned and its elements are left in `inline_entries`
+  // for the callers storing more than the subkeys.
+  bool putCollectionMetadata(rocksdb::WriteBatchBase *batch, const Slice &ns_key, Metadata *metadata);
 };
 
 class WriteBatchLogData {
@@ -27,6 +27,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <ctime>
+#include <utility>
 
 #include "cluster/redis_slot.h"
 #include "encoding.h"
@@ -181,6 +182,23 @@ rocksdb::Status Metadata::Decode(Slice *input) {
     GetFixedCommon(input, &size);
   }
 
+  inline_entries.clear();
+  if (IsInlineEncoded()) {
+    for (uint64_t i = 0; i < size; i++) {
+      uint32_t sub_key_size = 0, value_size = 0;
+      if (!GetVarint32(input, &sub_key_size) || input->size() < sub_key_size) {
+        return rocksdb::Status::InvalidArgument(kErrMetadataTooShort);
+      }
+      std::string sub_key(input->data(), sub_key_size);
+      input->remove_prefix(sub_key_size);
+      if (!GetVarint32(input, &value_size) || input->size() < value_size) {
+        return rocksdb::Status::InvalidArgument(kErrMetadataTooShort);
+      }
+      inline_entries.emplace_hint(inline_entries.end(), std::move(sub_key), std::string(input->data(), value_size));
+      input->remove_prefix(value_size);
+    }
+  }
+
   return rocksdb::Status::OK();
 }
 
@@ -193,6 +211,14 @@ void Metadata::Encode(std::string *dst) const {
     PutFixed64(dst, version);
     PutFixedCommon(dst, size);
   }
+  if (IsInlineEncoded()) {
+    for (const auto &[sub_key, value] : inline_entries) {
+      PutVarint32(dst, static_cast<uint32_t>(sub_key.size()));
+      dst->append(sub_key);
+      PutVarint32(dst, static_cast<uint32_t>(value.size()));
+      dst->append(value);
+    }
+  }
 }
 
 void Metadata::InitVersionCounter() {
@@ -214,6 +240,7 @@ bool Metadata::operator==(const Metadata &that) const {
     if (size != that.size) return false;
     if (version != that.version) return false;
   }
+  if (IsInlineEncoded() && inline_entries != that.inline_entries) return false;
   return true;
 }
 
@@ -325,10 +352,36 @@ bool Metadata::ExpireAt(uint64_t expired_ts) const {
   return expire < expired_ts;
 }
 
-bool Metadata::IsSingleKVType() const { return Type() == kRedisString || Type() == kRedisJson; }
+bool Metadata::IsSingleKVType() const {
+  return (Type() == kRedisString && !IsChunkedString()) || (Type() == kRedisJson && !IsSegmentedJson());
+}
 
 bool Metadata::IsEmptyableType() const {
-  return IsSingleKVType() || Type() == kRedisStream || Type() == kRedisBloomFilter;
+  return IsSingleKVType() || Type() == kRedisString || Type() == kRedisJson || Type() == kRedisStream ||
+         Type() == kRedisBloomFilter;
+}
+
+bool Metadata::IsChunkedString() const { return Type() == kRedisString && (flags & METADATA_STRING_CHUNKED_MASK); }
+
+bool Metadata::IsChunkedList() const { return Type() == kRedisList && (flags & METADATA_LIST_CHUNKED_MASK); }
+
+bool Metadata::IsSegmentedJson() const { return Type() == kRedisJson && (flags & METADATA_JSON_SEGMENTED_MASK); }
+
+bool Metadata::IsCompressedBitmap() const {
+  return Type() == kRedisBitmap && (flags & METADATA_BITMAP_COMPRESSED_MASK);
+}
+
+bool Metadata::HasPopcountSummary() const {
+  return Type() == kRedisBitmap && (flags & METADATA_BITMAP_SUMMARY_MASK);
+}
+
+bool Metadata::IsPagedBloomFilter() const {
+  return Type() == kRedisBloomFilter && (flags & METADATA_BLOOM_PAGED_MASK);
+}
+
+bool Metadata::IsInlineEncoded() const {
+  return (Type() == kRedisHash || Type() == kRedisSet || Type() == kRedisZSet) &&
+         (flags & METADATA_INLINE_ENCODING_MASK);
 }
 
 bool Metadata::Expired() const { return ExpireAt(util::GetTimeStampMS()); }
@@ -340,6 +393,11 @@ void ListMetadata::Encode(std::string *dst) const {
   Metadata::Encode(dst);
   PutFixed64(dst, head);
   PutFixed64(dst, tail);
+  if (IsChunkedList()) {
+    PutFixed32(dst, head_chunk_size);
+    PutFixed32(dst, tail_chunk_size);
+    PutFixed64(dst, next_chunk_id);
+  }
 }
 
 rocksdb::Status ListMetadata::Decode(Slice *input) {
@@ -353,6 +411,33 @@ rocksdb::Status ListMetadata::Decode(Slice *input) {
   GetFixed64(input, &head);
   GetFixed64(input, &tail);
 
+  if (IsChunkedList()) {
+    if (input->size() < 4 + 4 + 8) {
+      return rocksdb::Status::InvalidArgument(kErrMetadataTooShort);
+    }
+    GetFixed32(input, &head_chunk_size);
+    GetFixed32(input, &tail_chunk_size);
+    GetFixed64(input, &next_chunk_id);
+  }
+
+  return rocksdb::Status::OK();
+}
+
+void ZSetMetadata::Encode(std::string *dst) const {
+  Metadata::Encode(dst);
+
+  PutFixed8(dst, rank_indexed ? 1 : 0);
+}
+
+rocksdb::Status ZSetMetadata::Decode(Slice *input) {
+  if (auto s = Metadata::Decode(input); !s.ok()) {
+    return s;
+  }
+
+  // sorted sets written before the rank index was introduced don't have this field
+  uint8_t rank_indexed_flag = 0;
+  rank_indexed = GetFixed8(input, &rank_indexed_flag) && rank_indexed_flag != 0;
+
   return rocksdb::Status::OK();
 }
 
@@ -24,7 +24,9 @@
 
 #include <atomic>
 #include <bitset>
+#include <functional>
 #include <initializer_list>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -89,6 +91,9 @@ enum RedisCommand {
   kRedisCmdBitOp,
   kRedisCmdBitfield,
   kRedisCmdLMove,
+  kRedisCmdSetRange,
+  // the log data of a chunked list carries the whole command, which is replayed as is
+  kRedisCmdChunkedList,
 };
 
 const std::vector<std::string> RedisTypeNames = {"none",   "string",    "hash",   "list",      "set",      "zset",
@@ -135,14 +140,36 @@ class InternalKey {
 };
 
 constexpr uint8_t METADATA_64BIT_ENCODING_MASK = 0x80;
+constexpr uint8_t METADATA_INLINE_ENCODING_MASK = 0x20;
+constexpr uint8_t METADATA_BITMAP_SUMMARY_MASK = 0x20;
+constexpr uint8_t METADATA_STRING_CHUNKED_MASK = 0x10;
+constexpr uint8_t METADATA_LIST_CHUNKED_MASK = 0x10;
+constexpr uint8_t METADATA_JSON_SEGMENTED_MASK = 0x10;
+constexpr uint8_t METADATA_BITMAP_COMPRESSED_MASK = 0x10;
+constexpr uint8_t METADATA_BLOOM_PAGED_MASK = 0x10;
 constexpr uint8_t METADATA_TYPE_MASK = 0x0f;
 
+// The elements of an inline encoded hash, set or sorted set: the subkeys (fields or members)
+// mapped to the values they'd have in the subkey layout, e.g. the encoded score of a member
+using InlineEntries = std::map<std::string, std::string, std::less<>>;
+
 class Metadata {
  public:
   // metadata flags
-  // <(1-bit) 64bit-common-field-indicator> 0 0 0 <(4-bit) redis-type>
+  // <(1-bit) 64bit-common-field-indicator> 0 <(1-bit) inline-encoding-indicator>
+  // <(1-bit) chunked-indicator> <(4-bit) redis-type>
   // 64bit-common-field-indicator: make `expire` and `size` 64bit instead of 32bit
   // NOTE: `expire` is stored in milliseconds for 64bit, seconds for 32bit
+  // inline-encoding-indicator: the elements of a small hash, set or sorted set follow `size`
+  // in the metadata (see `inline_entries`) instead of being stored as subkeys;
+  // for a bitmap, the popcounts of its segments are kept in summary subkeys (see BitmapSummary)
+  // chunked-indicator: the string value is split into chunk subkeys instead of following
+  // the metadata, so it has `version` and `size` (the length of the value) like the other types;
+  // for a list, its elements are packed into chunk subkeys (see ListMetadata);
+  // for a JSON document, the members of its root object are stored in subkeys, and `size`
+  // is the length of their encoded values;
+  // for a bitmap, its segments are encoded in containers (see Bitmap::EncodeSegment);
+  // for a bloom filter, its sub-filters are split into page subkeys (see BloomChainMetadata)
   // redis-type: RedisType for the key-value
   uint8_t flags;
 
@@ -155,6 +182,9 @@ class Metadata {
   // element size of the key-value
   uint64_t size;
 
+  // the elements of an inline encoded collection, `size` of them
+  InlineEntries inline_entries;
+
   explicit Metadata(RedisType type, bool generate_version = true,
                     bool use_64bit_common_field = USE_64BIT_COMMON_FIELD_DEFAULT);
 
@@ -181,15 +211,31 @@ class Metadata {
   // no other key-values.
   // this means that the metadata of these types do NOT have
   // `version` and `size` field.
-  // e.g. RedisString, RedisJson
+  // e.g. RedisString (unless it's chunked), RedisJson (unless it's segmented)
   bool IsSingleKVType() const;
 
   // return whether the `size` field of this type can be zero.
   // if a type is NOT an emptyable type,
   // any key of this type is regarded as expired if `size` equals to 0.
-  // e.g. any SingleKVType, RedisStream, RedisBloomFilter
+  // e.g. any SingleKVType, RedisJson, RedisStream, RedisBloomFilter
   bool IsEmptyableType() const;
 
+  // return whether this is a string whose value is stored in chunk subkeys
+  bool IsChunkedString() const;
+  bool IsChunkedList() const;
+  // return whether this is a JSON document whose root members are stored in subkeys
+  bool IsSegmentedJson() const;
+  // return whether this is a bitmap whose segments are encoded in containers
+  bool IsCompressedBitmap() const;
+  // return whether this is a bitmap with the popcount summary of its segments
+  bool HasPopcountSummary() const;
+  // return whether this is a bloom filter whose sub-filters are stored in pages
+  bool IsPagedBloomFilter() const;
+
+  // return whether the elements of this collection are stored in `inline_entries`
+  // instead of subkeys
+  bool IsInlineEncoded() const;
+
   virtual void Encode(std::string *dst) const;
   [[nodiscard]] virtual rocksdb::Status Decode(Slice *input);
   [[nodiscard]] rocksdb::Status Decode(Slice input);
@@ -213,7 +259,16 @@ class SetMetadata : public Metadata {
 
 class ZSetMetadata : public Metadata {
  public:
+  /// Whether an order-statistic index over the scores and members is maintained in the `zset_rank` column family.
+  /// It's decided once the key is created (see the `zset-rank-index` option), sorted sets without it
+  /// have to count the entries in the score column family to find a rank.
+  bool rank_indexed = false;
+
   explicit ZSetMetadata(bool generate_version = true) : Metadata(kRedisZSet, generate_version) {}
+
+  void Encode(std::string *dst) const override;
+  using Metadata::Decode;
+  rocksdb::Status Decode(Slice *input) override;
 };
 
 class BitmapMetadata : public Metadata {
@@ -228,8 +283,15 @@ class SortedintMetadata : public Metadata {
 
 class ListMetadata : public Metadata {
  public:
+  // the index of the first element and the one after the last element,
+  // or the ids of the first and the last chunk of a chunked list
   uint64_t head;
   uint64_t tail;
+  // chunked lists only: the number of elements in the first and the last chunk, which are
+  // kept here so pushes and pops don't touch the directory of the chunks in between
+  uint32_t head_chunk_size = 0;
+  uint32_t tail_chunk_size = 0;
+  uint64_t next_chunk_id = 0;
   explicit ListMetadata(bool generate_version = true);
 
   void Encode(std::string *dst) const override;
@@ -285,6 +347,10 @@ class BloomChainMetadata : public Metadata {
   double error_rate;
 
   /// The total number of bytes allocated for all sub-filters.
+  ///
+  /// The sub-filters of a paged bloom filter are split into pages of kBFPageBytes, each in a subkey of the index
+  /// of its sub-filter and its own index, so a lookup reads and an insertion writes only the pages of the probed
+  /// blocks. A missing page is all zeros. Otherwise each sub-filter is in a subkey of its index.
   uint32_t bloom_bytes;
 
   explicit BloomChainMetadata(bool generate_version = true) : Metadata(kRedisBloomFilter, generate_version) {}
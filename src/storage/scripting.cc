@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <optional>
 #include <string>
 
 #include "commands/commander.h"
@@ -40,6 +41,7 @@
 #include "server/redis_reply.h"
 #include "server/server.h"
 #include "sha1.h"
+#include "storage/redis_metadata.h"
 #include "storage/storage.h"
 
 /* The maximum number of characters needed to represent a long double
@@ -56,6 +58,10 @@ enum {
 
 namespace lua {
 
+// The keys declared by the script running in the current thread, it's only set if the
+// script is running in the strict key accessing mode and can't access other keys.
+thread_local const std::vector<std::string> *script_declared_keys = nullptr;
+
 lua_State *CreateState(Server *srv, bool read_only) {
   lua_State *lua = lua_open();
   LoadLibraries(lua);
@@ -181,6 +187,14 @@ void LoadFuncs(lua_State *lua, bool read_only) {
   lua_pcall(lua, 0, 0, 0);
 }
 
+void SetReadOnly(lua_State *lua, bool read_only) {
+  lua_getglobal(lua, "redis");
+  lua_pushstring(lua, "read_only");
+  lua_pushboolean(lua, read_only);
+  lua_settable(lua, -3);
+  lua_pop(lua, 1);
+}
+
 int RedisLogCommand(lua_State *lua) {
   int argc = lua_gettop(lua);
 
@@ -581,9 +595,12 @@ Status FunctionDelete(Server *srv, const std::string &name) {
 Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sha, const std::vector<std::string> &keys,
                           const std::vector<std::string> &argv, bool evalsha, std::string *output, bool read_only) {
   Server *srv = conn->GetServer();
+  // Write scripts only lock their declared keys and run concurrently with other scripts
+  // if they can't access other keys
+  bool strict_keys = !read_only && srv->GetConfig()->lua_strict_key_accessing;
 
-  // Use the worker's private Lua VM when entering the read-only mode
-  lua_State *lua = read_only ? conn->Owner()->Lua() : srv->Lua();
+  // Use the worker's private Lua VM when entering the read-only or the strict key accessing mode
+  lua_State *lua = read_only || strict_keys ? conn->Owner()->Lua() : srv->Lua();
 
   /* We obtain the script SHA1, then check if this function is already
    * defined into the Lua state */
@@ -637,6 +654,26 @@ Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sh
   SetGlobalArray(lua, "KEYS", keys);
   SetGlobalArray(lua, "ARGV", argv);
 
+  // The commands called by the script lock the declared keys again, which must be skipped
+  std::optional<TxnLockGuard> guard;
+  bool own_txn = false;
+  if (strict_keys) {
+    auto storage = srv->storage;
+    std::vector<std::string> lock_keys;
+    lock_keys.reserve(keys.size());
+    for (const auto &key : keys) {
+      lock_keys.emplace_back(ComposeNamespaceKey(conn->GetNamespace(), key, storage->IsSlotIdEncoded()));
+    }
+    guard.emplace(storage->GetLockManager(), lock_keys);
+    // The writes of the script are committed atomically after it's finished,
+    // unless it's called in a transaction which will commit them later.
+    if (!storage->IsTxnMode()) own_txn = storage->BeginTxn().IsOK();
+
+    // The worker's VM is read-only for EVAL_RO by default
+    SetReadOnly(lua, false);
+    script_declared_keys = &keys;
+  }
+
   if (lua_pcall(lua, 0, 1, -2)) {
     auto msg = fmt::format("ERR running script (call to {}): {}", funcname, lua_tostring(lua, -1));
     *output = redis::Error(msg);
@@ -647,6 +684,15 @@ Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sh
   }
   conn->SetProtocolVersion(saved_protocol_version);
 
+  if (strict_keys) {
+    script_declared_keys = nullptr;
+    SetReadOnly(lua, true);
+    if (own_txn) {
+      auto s = srv->storage->CommitTxn();
+      if (!s) *output = redis::Error("ERR " + s.Msg());
+    }
+  }
+
   // clean global variables to prevent information leak in function commands
   lua_pushnil(lua);
   lua_setglobal(lua, "KEYS");
@@ -660,7 +706,7 @@ Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sh
    * (and for LUA_GC_CYCLE_PERIOD collection steps) because calling it
    * for every command uses too much CPU. */
   constexpr int64_t LUA_GC_CYCLE_PERIOD = 50;
-  static int64_t gc_count = 0;
+  static thread_local int64_t gc_count = 0;
 
   gc_count++;
   if (gc_count == LUA_GC_CYCLE_PERIOD) {
@@ -744,6 +790,27 @@ int RedisGenericCommand(lua_State *lua, int raise_error) {
     return raise_error ? RaiseError(lua) : 1;
   }
 
+  if (script_declared_keys) {
+    std::vector<int> keys_indexes;
+    bool has_keys = redis::CommandTable::GetKeysFromCommand(attributes, args, &keys_indexes).IsOK();
+    // Exclusive commands and writes without keys may touch any key
+    if ((cmd_flags & redis::kCmdExclusive) || (!has_keys && (cmd_flags & redis::kCmdWrite))) {
+      PushError(lua, "This Redis command is not allowed from scripts in the strict key accessing mode");
+      return raise_error ? RaiseError(lua) : 1;
+    }
+    if (has_keys) {
+      for (auto i : keys_indexes) {
+        if (i >= static_cast<int>(args.size())) break;
+        if (std::find(script_declared_keys->begin(), script_declared_keys->end(), args[i]) ==
+            script_declared_keys->end()) {
+          auto msg = fmt::format("Script attempted to access key '{}' which is not declared in KEYS", args[i]);
+          PushError(lua, msg.c_str());
+          return raise_error ? RaiseError(lua) : 1;
+        }
+      }
+    }
+  }
+
   std::string cmd_name = attributes->name;
 
   auto srv = GetServer(lua);
@@ -778,14 +845,23 @@ int RedisGenericCommand(lua_State *lua, int raise_error) {
     return raise_error ? RaiseError(lua) : 1;
   }
 
+  // Convert the reply into Lua values directly if the command supports it
+  LuaReplySink sink(lua);
+  cmd->SetReplySink(&sink);
+  int top = lua_gettop(lua);
+
   std::string output;
   s = conn->ExecuteCommand(cmd_name, args, cmd.get(), &output);
   if (!s) {
+    lua_settop(lua, top);
     PushError(lua, s.Msg().data());
     return raise_error ? RaiseError(lua) : 1;
   }
 
-  RedisProtocolToLuaType(lua, output.data());
+  if (!sink.IsDone()) {
+    lua_settop(lua, top);
+    RedisProtocolToLuaType(lua, output.data());
+  }
   return 1;
 }
 
@@ -1144,6 +1220,113 @@ const char *RedisProtocolToLuaTypeVerbatimString(lua_State *lua, const char *rep
   return p + bulklen + 2;
 }
 
+void LuaReplySink::SimpleString(std::string_view data) { pushTable("ok", data); }
+
+void LuaReplySink::Error(std::string_view err) { pushTable("err", err); }
+
+void LuaReplySink::Integer(int64_t data) {
+  lua_pushnumber(lua_, static_cast<lua_Number>(data));
+  valuePushed();
+}
+
+void LuaReplySink::Double(double d) {
+  lua_newtable(lua_);
+  lua_pushstring(lua_, "double");
+  lua_pushnumber(lua_, d);
+  lua_settable(lua_, -3);
+  valuePushed();
+}
+
+void LuaReplySink::BulkString(std::string_view data) {
+  lua_pushlstring(lua_, data.data(), data.size());
+  valuePushed();
+}
+
+void LuaReplySink::NilBulkString() {
+  lua_pushboolean(lua_, 0);
+  valuePushed();
+}
+
+void LuaReplySink::Null() {
+  lua_pushnil(lua_);
+  valuePushed();
+}
+
+void LuaReplySink::ArrayLen(size_t len) {
+  lua_newtable(lua_);
+  beginAggregate('*', len);
+}
+
+void LuaReplySink::MapLen(size_t len) {
+  lua_newtable(lua_);
+  lua_pushstring(lua_, "map");
+  lua_newtable(lua_);
+  beginAggregate('%', len);
+}
+
+void LuaReplySink::SetLen(size_t len) {
+  lua_newtable(lua_);
+  lua_pushstring(lua_, "set");
+  lua_newtable(lua_);
+  beginAggregate('~', len);
+}
+
+void LuaReplySink::Append(std::string_view data) {
+  // The parser relies on the terminating null character
+  std::string reply(data);
+  const char *p = reply.data();
+  const char *end = p + reply.size();
+  while (p < end) {
+    const char *next = RedisProtocolToLuaType(lua_, p);
+    if (next == p) break;
+    p = next;
+    valuePushed();
+  }
+}
+
+void LuaReplySink::pushTable(const char *field, std::string_view data) {
+  lua_newtable(lua_);
+  lua_pushstring(lua_, field);
+  lua_pushlstring(lua_, data.data(), data.size());
+  lua_settable(lua_, -3);
+  valuePushed();
+}
+
+void LuaReplySink::beginAggregate(char type, size_t len) {
+  if (len > 0) {
+    aggregates_.push_back({type, len});
+    return;
+  }
+  // The map and set tables are the field of the outer table
+  if (type != '*') lua_settable(lua_, -3);
+  valuePushed();
+}
+
+void LuaReplySink::valuePushed() {
+  while (!aggregates_.empty()) {
+    auto &aggregate = aggregates_.back();
+    if (aggregate.type == '*') {
+      lua_rawseti(lua_, -2, ++aggregate.index);
+    } else if (aggregate.type == '%') {
+      // Wait for the value of the map entry
+      if (!aggregate.has_key) {
+        aggregate.has_key = true;
+        return;
+      }
+      aggregate.has_key = false;
+      lua_settable(lua_, -3);
+    } else {
+      lua_pushboolean(lua_, 1);
+      lua_settable(lua_, -3);
+    }
+
+    if (--aggregate.remaining > 0) return;
+    if (aggregate.type != '*') lua_settable(lua_, -3);
+    aggregates_.pop_back();
+  }
+  done_ = true;
+}
+
 /* This function is used in order to push an error on the Lua stack in the
  * format used by redis.pcall to return errors, which is a lua table
  * with a single "err" field set to the error string. Note that this
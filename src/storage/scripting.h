@@ -25,6 +25,7 @@
 
 #include "lua.hpp"
 #include "server/redis_connection.h"
+#include "server/redis_reply.h"
 #include "status.h"
 
 inline constexpr const char REDIS_LUA_FUNC_SHA_PREFIX[] = "f_";
@@ -41,6 +42,7 @@ void DestroyState(lua_State *lua);
 Server *GetServer(lua_State *lua);
 
 void LoadFuncs(lua_State *lua, bool read_only = false);
+void SetReadOnly(lua_State *lua, bool read_only);
 void LoadLibraries(lua_State *lua);
 void RemoveUnsupportedFunctions(lua_State *lua);
 void EnableGlobalsProtection(lua_State *lua);
@@ -89,6 +91,45 @@ const char *RedisProtocolToLuaTypeVerbatimString(lua_State *lua, const char *rep
 
 std::string ReplyToRedisReply(redis::Connection *conn, lua_State *lua);
 
+// LuaReplySink converts the reply of a command called from scripts into the Lua value
+// directly, it pushes the same value as RedisProtocolToLuaType does for the RESP reply,
+// but without encoding and parsing the reply.
+class LuaReplySink : public redis::ReplySink {
+ public:
+  explicit LuaReplySink(lua_State *lua) : lua_(lua) {}
+
+  // Whether a complete value was pushed on the stack of the Lua state
+  bool IsDone() const { return done_; }
+
+  void SimpleString(std::string_view data) override;
+  void Error(std::string_view err) override;
+  void Integer(int64_t data) override;
+  void Double(double d) override;
+  void BulkString(std::string_view data) override;
+  void NilBulkString() override;
+  void Null() override;
+  void ArrayLen(size_t len) override;
+  void MapLen(size_t len) override;
+  void SetLen(size_t len) override;
+  void Append(std::string_view data) override;
+
+ private:
+  struct Aggregate {
+    char type;
+    size_t remaining;
+    int index = 0;
+    bool has_key = false;
+  };
+
+  void beginAggregate(char type, size_t len);
+  void pushTable(const char *field, std::string_view data);
+  void valuePushed();
+
+  lua_State *lua_;
+  std::vector<Aggregate> aggregates_;
+  bool done_ = false;
+};
+
 void PushError(lua_State *lua, const char *err);
 [[noreturn]] int RaiseError(lua_State *lua);
 
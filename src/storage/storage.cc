@@ -33,6 +33,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <random>
 
@@ -78,6 +79,16 @@ Storage::Storage(Config *config)
     : backup_creating_time_(util::GetTimeStamp()), env_(rocksdb::Env::Default()), config_(config), lock_mgr_(16) {
   Metadata::InitVersionCounter();
   SetWriteOptions(config->rocks_db.write_options);
+  if (config->rocks_db.write_options.group_commit) {
+    group_committer_ = std::make_unique<GroupCommitter>(
+        config->rocks_db.write_options.group_commit_max_delay_us, config->rocks_db.write_options.group_commit_max_bytes,
+        [this](const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates) {
+          return db_->Write(options, updates);
+        });
+  }
+  if (config->metadata_cache_size > 0) {
+    metadata_cache_ = std::make_unique<MetadataCache>(static_cast<size_t>(config->metadata_cache_size) * MiB);
+  }
 }
 
 Storage::~Storage() {
@@ -86,7 +97,9 @@ Storage::~Storage() {
 }
 
 void Storage::CloseDB() {
+  db_close_requested_ = true;
   auto guard = WriteLockGuard();
+  db_close_requested_ = false;
   if (!db_) return;
 
   db_closing_ = true;
@@ -233,7 +246,8 @@ Status Storage::CreateColumnFamilies(const rocksdb::Options &options) {
   if (res) {
     std::vector<std::string> cf_names = {kMetadataColumnFamilyName, kZSetScoreColumnFamilyName,
                                          kPubSubColumnFamilyName,   kPropagateColumnFamilyName,
-                                         kStreamColumnFamilyName,   kSearchColumnFamilyName};
+                                         kStreamColumnFamilyName,   kSearchColumnFamilyName,
+                                         kZSetRankColumnFamilyName};
     std::vector<rocksdb::ColumnFamilyHandle *> cf_handles;
     auto s = (*res)->CreateColumnFamilies(cf_options, cf_names, &cf_handles);
     if (!s.ok()) {
@@ -341,6 +355,7 @@ Status Storage::Open(DBOpenMode mode) {
   column_families.emplace_back(kPropagateColumnFamilyName, propagate_opts);
   column_families.emplace_back(kStreamColumnFamilyName, subkey_opts);
   column_families.emplace_back(kSearchColumnFamilyName, subkey_opts);
+  column_families.emplace_back(kZSetRankColumnFamilyName, subkey_opts);
 
   std::vector<std::string> old_column_families;
   auto s = rocksdb::DB::ListColumnFamilies(options, config_->db_dir, &old_column_families);
@@ -372,6 +387,8 @@ Status Storage::Open(DBOpenMode mode) {
     return {Status::DBOpenErr};
   }
   LOG(INFO) << "[storage] Success to load the data from disk: " << duration << " ms";
+  // The database may be replaced by a backup or a checkpoint while reopening
+  if (metadata_cache_) metadata_cache_->Clear();
 
   return Status::OK();
 }
@@ -567,8 +584,10 @@ rocksdb::Status Storage::Get(const rocksdb::ReadOptions &options, const rocksdb:
 rocksdb::Status Storage::Get(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family,
                              const rocksdb::Slice &key, std::string *value) {
   rocksdb::Status s;
-  if (is_txn_mode_ && txn_write_batch_->GetWriteBatch()->Count() > 0) {
-    s = txn_write_batch_->GetFromBatchAndDB(db_.get(), options, column_family, key, value);
+  if (auto txn_write_batch = getTxnWriteBatch(); txn_write_batch && txn_write_batch->GetWriteBatch()->Count() > 0) {
+    s = txn_write_batch->GetFromBatchAndDB(db_.get(), options, column_family, key, value);
+  } else if (metadata_cache_ && column_family->GetID() == kColumnFamilyIDMetadata) {
+    s = getFromMetadataCache(options, key, value);
   } else {
     s = db_->Get(options, column_family, key, value);
   }
@@ -585,8 +604,12 @@ rocksdb::Status Storage::Get(const rocksdb::ReadOptions &options, const rocksdb:
 rocksdb::Status Storage::Get(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family,
                              const rocksdb::Slice &key, rocksdb::PinnableSlice *value) {
   rocksdb::Status s;
-  if (is_txn_mode_ && txn_write_batch_->GetWriteBatch()->Count() > 0) {
-    s = txn_write_batch_->GetFromBatchAndDB(db_.get(), options, column_family, key, value);
+  if (auto txn_write_batch = getTxnWriteBatch(); txn_write_batch && txn_write_batch->GetWriteBatch()->Count() > 0) {
+    s = txn_write_batch->GetFromBatchAndDB(db_.get(), options, column_family, key, value);
+  } else if (metadata_cache_ && column_family->GetID() == kColumnFamilyIDMetadata) {
+    value->Reset();
+    s = getFromMetadataCache(options, key, value->GetSelf());
+    if (s.ok()) value->PinSelf();
   } else {
     s = db_->Get(options, column_family, key, value);
   }
@@ -595,6 +618,31 @@ rocksdb::Status Storage::Get(const rocksdb::ReadOptions &options, rocksdb::Colum
   return s;
 }
 
+rocksdb::Status Storage::getFromMetadataCache(const rocksdb::ReadOptions &options, const rocksdb::Slice &key,
+                                              std::string *value) {
+  auto read_seq = options.snapshot ? options.snapshot->GetSequenceNumber()
+                                   : std::numeric_limits<rocksdb::SequenceNumber>::max();
+  switch (metadata_cache_->Lookup(key.ToStringView(), read_seq, value)) {
+    case MetadataCache::LookupResult::kFound:
+      return rocksdb::Status::OK();
+    case MetadataCache::LookupResult::kNotFound:
+      return rocksdb::Status::NotFound();
+    case MetadataCache::LookupResult::kMiss:
+      break;
+  }
+
+  // Without a snapshot, the read sees at least the writes up to the current latest sequence number
+  if (!options.snapshot) read_seq = db_->GetLatestSequenceNumber();
+  auto s = db_->Get(options, GetCFHandle(kColumnFamilyIDMetadata), key, value);
+  if (s.ok()) {
+    rocksdb::Slice found(*value);
+    metadata_cache_->Insert(key.ToStringView(), read_seq, &found);
+  } else if (s.IsNotFound()) {
+    metadata_cache_->Insert(key.ToStringView(), read_seq, nullptr);
+  }
+  return s;
+}
+
 rocksdb::Iterator *Storage::NewIterator(const rocksdb::ReadOptions &options) {
   return NewIterator(options, db_->DefaultColumnFamily());
 }
@@ -612,8 +660,8 @@ void Storage::recordKeyspaceStat(const rocksdb::ColumnFamilyHandle *column_famil
 rocksdb::Iterator *Storage::NewIterator(const rocksdb::ReadOptions &options,
                                         rocksdb::ColumnFamilyHandle *column_family) {
   auto iter = db_->NewIterator(options, column_family);
-  if (is_txn_mode_ && txn_write_batch_->GetWriteBatch()->Count() > 0) {
-    return txn_write_batch_->NewIteratorWithBase(column_family, iter, &options);
+  if (auto txn_write_batch = getTxnWriteBatch(); txn_write_batch && txn_write_batch->GetWriteBatch()->Count() > 0) {
+    return txn_write_batch->NewIteratorWithBase(column_family, iter, &options);
   }
   return iter;
 }
@@ -621,9 +669,9 @@ rocksdb::Iterator *Storage::NewIterator(const rocksdb::ReadOptions &options,
 void Storage::MultiGet(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family,
                        const size_t num_keys, const rocksdb::Slice *keys, rocksdb::PinnableSlice *values,
                        rocksdb::Status *statuses) {
-  if (is_txn_mode_ && txn_write_batch_->GetWriteBatch()->Count() > 0) {
-    txn_write_batch_->MultiGetFromBatchAndDB(db_.get(), options, column_family, num_keys, keys, values, statuses,
-                                             false);
+  if (auto txn_write_batch = getTxnWriteBatch(); txn_write_batch && txn_write_batch->GetWriteBatch()->Count() > 0) {
+    txn_write_batch->MultiGetFromBatchAndDB(db_.get(), options, column_family, num_keys, keys, values, statuses,
+                                            false);
   } else {
     db_->MultiGet(options, column_family, num_keys, keys, values, statuses, false);
   }
@@ -634,7 +682,7 @@ void Storage::MultiGet(const rocksdb::ReadOptions &options, rocksdb::ColumnFamil
 }
 
 rocksdb::Status Storage::Write(const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates) {
-  if (is_txn_mode_) {
+  if (getTxnWriteBatch()) {
     // The batch won't be flushed until the transaction was committed or rollback
     return rocksdb::Status::OK();
   }
@@ -647,7 +695,24 @@ rocksdb::Status Storage::writeToDB(const rocksdb::WriteOptions &options, rocksdb
     updates->PutLogData(ServerLogData(kReplIdLog, replid_).Encode());
   }
 
-  return db_->Write(options, updates);
+  return writeThroughMetadataCache(updates, [&] {
+    if (group_committer_) {
+      return group_committer_->Write(options, updates);
+    }
+    return db_->Write(options, updates);
+  });
+}
+
+template <typename WriteFunc>
+rocksdb::Status Storage::writeThroughMetadataCache(rocksdb::WriteBatch *updates, const WriteFunc &write_func) {
+  if (!metadata_cache_) return write_func();
+
+  auto ctx = metadata_cache_->BeginWrite(kColumnFamilyIDMetadata, updates);
+  if (ctx.Empty()) return write_func();
+
+  auto s = write_func();
+  metadata_cache_->EndWrite(ctx, s.ok(), db_->GetLatestSequenceNumber());
+  return s;
 }
 
 rocksdb::Status Storage::Delete(const rocksdb::WriteOptions &options, rocksdb::ColumnFamilyHandle *cf_handle,
@@ -697,7 +762,7 @@ Status Storage::ApplyWriteBatch(const rocksdb::WriteOptions &options, std::strin
     return {Status::NotOK, "reach space limit"};
   }
   auto batch = rocksdb::WriteBatch(std::move(raw_batch));
-  auto s = db_->Write(options, &batch);
+  auto s = writeThroughMetadataCache(&batch, [&] { return db_->Write(options, &batch); });
   if (!s.ok()) {
     return {Status::NotOK, s.ToString()};
   }
@@ -734,6 +799,8 @@ rocksdb::ColumnFamilyHandle *Storage::GetCFHandle(const std::string &name) {
     return cf_handles_[5];
   } else if (name == kSearchColumnFamilyName) {
     return cf_handles_[6];
+  } else if (name == kZSetRankColumnFamilyName) {
+    return cf_handles_[7];
   }
   return cf_handles_[0];
 }
@@ -811,26 +878,42 @@ void Storage::SetIORateLimit(int64_t max_io_mb) {
 
 rocksdb::DB *Storage::GetDB() { return db_.get(); }
 
+namespace {
+
+// The transaction running in the current thread, the commands of a transaction
+// are always executed in the thread which is executing the EXEC command.
+struct TxnContext {
+  const Storage *owner = nullptr;
+  std::unique_ptr<rocksdb::WriteBatchWithIndex> write_batch;
+};
+
+thread_local TxnContext current_txn;
+
+}  // namespace
+
+rocksdb::WriteBatchWithIndex *Storage::getTxnWriteBatch() const {
+  return current_txn.owner == this ? current_txn.write_batch.get() : nullptr;
+}
+
 Status Storage::BeginTxn() {
-  if (is_txn_mode_) {
+  if (current_txn.owner) {
     return Status{Status::NotOK, "cannot begin a new transaction while already in transaction mode"};
   }
-  // The EXEC command is exclusive and shouldn't have multi transaction at the same time,
-  // so it's fine to reset the global write batch without any lock.
-  is_txn_mode_ = true;
-  txn_write_batch_ = std::make_unique<rocksdb::WriteBatchWithIndex>();
+  current_txn.owner = this;
+  current_txn.write_batch = std::make_unique<rocksdb::WriteBatchWithIndex>();
   return Status::OK();
 }
 
 Status Storage::CommitTxn() {
-  if (!is_txn_mode_) {
+  auto txn_write_batch = getTxnWriteBatch();
+  if (!txn_write_batch) {
     return Status{Status::NotOK, "cannot commit while not in transaction mode"};
   }
 
-  auto s = writeToDB(write_opts_, txn_write_batch_->GetWriteBatch());
+  auto s = writeToDB(write_opts_, txn_write_batch->GetWriteBatch());
 
-  is_txn_mode_ = false;
-  txn_write_batch_ = nullptr;
+  current_txn.owner = nullptr;
+  current_txn.write_batch = nullptr;
   if (s.ok()) {
     return Status::OK();
   }
@@ -838,8 +921,8 @@ Status Storage::CommitTxn() {
 }
 
 ObserverOrUniquePtr<rocksdb::WriteBatchBase> Storage::GetWriteBatchBase() {
-  if (is_txn_mode_) {
-    return ObserverOrUniquePtr<rocksdb::WriteBatchBase>(txn_write_batch_.get(), ObserverOrUnique::Observer);
+  if (auto txn_write_batch = getTxnWriteBatch()) {
+    return ObserverOrUniquePtr<rocksdb::WriteBatchBase>(txn_write_batch, ObserverOrUnique::Observer);
   }
   return ObserverOrUniquePtr<rocksdb::WriteBatchBase>(new rocksdb::WriteBatch(), ObserverOrUnique::Unique);
 }
@@ -930,6 +1013,10 @@ std::string Storage::GetReplIdFromDbEngine() {
 
 std::shared_lock<std::shared_mutex> Storage::ReadLockGuard() { return std::shared_lock(db_rw_lock_); }
 
+std::shared_lock<std::shared_mutex> Storage::TryReadLockGuard() {
+  return std::shared_lock(db_rw_lock_, std::try_to_lock);
+}
+
 std::unique_lock<std::shared_mutex> Storage::WriteLockGuard() { return std::unique_lock(db_rw_lock_); }
 
 Status Storage::ReplDataManager::GetFullReplDataInfo(Storage *storage, std::string *files) {
@@ -37,7 +37,10 @@
 #include <vector>
 
 #include "config/config.h"
+#include "group_commit.h"
+#include "increment_combiner.h"
 #include "lock_manager.h"
+#include "metadata_cache.h"
 #include "observer_or_unique.h"
 #include "status.h"
 
@@ -58,6 +61,7 @@ enum ColumnFamilyID {
   kColumnFamilyIDPropagate,
   kColumnFamilyIDStream,
   kColumnFamilyIDSearch,
+  kColumnFamilyIDZSetRank,
 };
 
 enum DBOpenMode {
@@ -75,6 +79,7 @@ constexpr const char *kSubkeyColumnFamilyName = "default";
 constexpr const char *kPropagateColumnFamilyName = "propagate";
 constexpr const char *kStreamColumnFamilyName = "stream";
 constexpr const char *kSearchColumnFamilyName = "search";
+constexpr const char *kZSetRankColumnFamilyName = "zset_rank";
 
 constexpr const char *kPropagateScriptCommand = "script";
 
@@ -176,12 +181,13 @@ class Storage {
   [[nodiscard]] rocksdb::Status Compact(rocksdb::ColumnFamilyHandle *cf, const rocksdb::Slice *begin,
                                         const rocksdb::Slice *end);
   rocksdb::DB *GetDB();
-  bool IsClosing() const { return db_closing_; }
+  bool IsClosing() const { return db_closing_ || db_close_requested_; }
   std::string GetName() const { return config_->db_name; }
   rocksdb::ColumnFamilyHandle *GetCFHandle(const std::string &name);
   rocksdb::ColumnFamilyHandle *GetCFHandle(ColumnFamilyID id);
   std::vector<rocksdb::ColumnFamilyHandle *> *GetCFHandles() { return &cf_handles_; }
   LockManager *GetLockManager() { return &lock_mgr_; }
+  IncrementCombiner *GetIncrementCombiner() { return &increment_combiner_; }
   void PurgeOldBackups(uint32_t num_backups_to_keep, uint32_t backup_max_keep_hours);
   uint64_t GetTotalSize(const std::string &ns = kDefaultNamespace);
   void CheckDBSizeLimit();
@@ -190,16 +196,22 @@ class Storage {
   void SetIORateLimit(int64_t max_io_mb);
 
   std::shared_lock<std::shared_mutex> ReadLockGuard();
+  std::shared_lock<std::shared_mutex> TryReadLockGuard();
   std::unique_lock<std::shared_mutex> WriteLockGuard();
 
   bool IsSlotIdEncoded() const { return config_->slot_id_encoded; }
   Config *GetConfig() const { return config_; }
 
   const DBStats *GetDBStats() const { return &db_stats_; }
+  const GroupCommitStats *GetGroupCommitStats() const {
+    return group_committer_ ? &group_committer_->GetStats() : nullptr;
+  }
+  const MetadataCache *GetMetadataCache() const { return metadata_cache_.get(); }
   void RecordStat(StatType type, uint64_t v);
 
   Status BeginTxn();
   Status CommitTxn();
+  bool IsTxnMode() const { return getTxnWriteBatch() != nullptr; }
   ObserverOrUniquePtr<rocksdb::WriteBatchBase> GetWriteBatchBase();
 
   Storage(const Storage &) = delete;
@@ -259,27 +271,38 @@ class Storage {
   Config *config_ = nullptr;
   std::vector<rocksdb::ColumnFamilyHandle *> cf_handles_;
   LockManager lock_mgr_;
+  IncrementCombiner increment_combiner_;
   std::atomic<bool> db_size_limit_reached_{false};
 
   DBStats db_stats_;
 
   std::shared_mutex db_rw_lock_;
   bool db_closing_ = true;
+  // set while CloseDB is waiting for the DB lock, so the long read lock holders back off
+  std::atomic<bool> db_close_requested_{false};
 
   std::atomic<bool> db_in_retryable_io_error_{false};
 
-  std::atomic<bool> is_txn_mode_ = false;
-  // txn_write_batch_ is used as the global write batch for the transaction mode,
-  // all writes will be grouped in this write batch when entering the transaction mode,
-  // then write it at once when committing.
-  //
-  // Notice: the reason why we can use the global transaction? because the EXEC is an exclusive
-  // command, so it won't have multi transactions to be executed at the same time.
-  std::unique_ptr<rocksdb::WriteBatchWithIndex> txn_write_batch_;
 
   rocksdb::WriteOptions write_opts_ = rocksdb::WriteOptions();
+  // group_committer_ is only created when `rocksdb.write_options.group_commit` is enabled
+  std::unique_ptr<GroupCommitter> group_committer_;
+  // metadata_cache_ is only created when `metadata-cache-size` is not 0
+  std::unique_ptr<MetadataCache> metadata_cache_;
 
   rocksdb::Status writeToDB(const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates);
+  // Run `write_func` to write `updates` into RocksDB, keeping metadata_cache_ consistent with it
+  template <typename WriteFunc>
+  rocksdb::Status writeThroughMetadataCache(rocksdb::WriteBatch *updates, const WriteFunc &write_func);
+  rocksdb::Status getFromMetadataCache(const rocksdb::ReadOptions &options, const rocksdb::Slice &key,
+                                       std::string *value);
+  // The write batch of the transaction running in the current thread, or nullptr if not in
+  // the transaction mode. All writes of the transaction are grouped in this write batch,
+  // then written at once when committing.
+  //
+  // Each transaction has its own write batch, so the transactions of different connections
+  // can run in parallel since they lock their keys while executing.
+  rocksdb::WriteBatchWithIndex *getTxnWriteBatch() const;
   void recordKeyspaceStat(const rocksdb::ColumnFamilyHandle *column_family, const rocksdb::Status &s);
 };
 
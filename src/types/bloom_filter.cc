@@ -22,6 +22,94 @@
 
 #include "xxh3.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KVROCKS_X86_BLOOM_FILTER
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// The block test and update of a key, i.e. the low 32 bits of a hash, which set a bit
+// in each of the eight 32-bit words of the block, chosen by the key multiplied by a salt
+struct BlockKernels {
+  bool (*find)(uint32_t key, const uint32_t* salt, const char* block);
+  void (*insert)(uint32_t key, const uint32_t* salt, char* block);
+  void (*find_batch)(const uint64_t* hashes, const char* const* blocks, size_t n, const uint32_t* salt,
+                     uint8_t* found);
+};
+
+bool ScalarFindKeyInBlock(uint32_t key, const uint32_t* salt, const char* block) {
+  const auto* bitset32 = reinterpret_cast<const uint32_t*>(block);
+  for (int i = 0; i < 8; ++i) {
+    // Calculate mask for key in the given bitset.
+    const uint32_t mask = UINT32_C(0x1) << ((key * salt[i]) >> 27);
+    if ((0 == (bitset32[i] & mask))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ScalarInsertKeyInBlock(uint32_t key, const uint32_t* salt, char* block) {
+  auto* bitset32 = reinterpret_cast<uint32_t*>(block);
+  for (int i = 0; i < 8; i++) {
+    // Calculate mask for key in the given bitset.
+    const uint32_t mask = UINT32_C(0x1) << ((key * salt[i]) >> 27);
+    bitset32[i] |= mask;
+  }
+}
+
+void ScalarFindHashesInBlocks(const uint64_t* hashes, const char* const* blocks, size_t n, const uint32_t* salt,
+                              uint8_t* found) {
+  for (size_t i = 0; i < n; ++i) {
+    found[i] = ScalarFindKeyInBlock(static_cast<uint32_t>(hashes[i]), salt, blocks[i]);
+  }
+}
+
+#ifdef KVROCKS_X86_BLOOM_FILTER
+
+// The masks of the eight words are computed at once, one word per lane
+__attribute__((target("avx2"))) inline __m256i AVX2BlockMask(uint32_t key, const uint32_t* salt) {
+  auto products = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(salt)));
+  return _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(products, 27));
+}
+
+__attribute__((target("avx2"))) bool AVX2FindKeyInBlock(uint32_t key, const uint32_t* salt, const char* block) {
+  auto bitset = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  // whether all the bits of the mask are set in the block
+  return _mm256_testc_si256(bitset, AVX2BlockMask(key, salt));
+}
+
+__attribute__((target("avx2"))) void AVX2InsertKeyInBlock(uint32_t key, const uint32_t* salt, char* block) {
+  auto bitset = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(block), _mm256_or_si256(bitset, AVX2BlockMask(key, salt)));
+}
+
+__attribute__((target("avx2"))) void AVX2FindHashesInBlocks(const uint64_t* hashes, const char* const* blocks,
+                                                            size_t n, const uint32_t* salt, uint8_t* found) {
+  for (size_t i = 0; i < n; ++i) {
+    found[i] = AVX2FindKeyInBlock(static_cast<uint32_t>(hashes[i]), salt, blocks[i]);
+  }
+}
+
+#endif
+
+const BlockKernels& GetBlockKernels() {
+  static const BlockKernels kernels = [] {
+#ifdef KVROCKS_X86_BLOOM_FILTER
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return BlockKernels{AVX2FindKeyInBlock, AVX2InsertKeyInBlock, AVX2FindHashesInBlocks};
+    }
+#endif
+    return BlockKernels{ScalarFindKeyInBlock, ScalarInsertKeyInBlock, ScalarFindHashesInBlocks};
+  }();
+  return kernels;
+}
+
+}  // namespace
+
 OwnedBlockSplitBloomFilter CreateBlockSplitBloomFilter(uint32_t num_bytes) {
   if (num_bytes < kMinimumBloomFilterBytes) {
     num_bytes = kMinimumBloomFilterBytes;
@@ -59,30 +147,29 @@ StatusOr<BlockSplitBloomFilter> CreateBlockSplitBloomFilter(std::string& bitset)
 }
 
 bool BlockSplitBloomFilter::FindHash(uint64_t hash) const {
-  const auto bucket_index = static_cast<uint32_t>(((hash >> 32) * (data_.size() / kBytesPerFilterBlock)) >> 32);
-  const auto key = static_cast<uint32_t>(hash);
-  const auto* bitset32 = reinterpret_cast<const uint32_t*>(data_.data());
-
-  for (int i = 0; i < kBitsSetPerBlock; ++i) {
-    // Calculate mask for key in the given bitset.
-    const uint32_t mask = UINT32_C(0x1) << ((key * SALT[i]) >> 27);
-    if ((0 == (bitset32[kBitsSetPerBlock * bucket_index + i] & mask))) {
-      return false;
-    }
-  }
-  return true;
+  return FindHashInBlock(hash, data_.data() + BlockOffset(hash, data_.size()));
 }
 
 void BlockSplitBloomFilter::InsertHash(uint64_t hash) {
-  const auto bucket_index = static_cast<uint32_t>(((hash >> 32) * (data_.size() / kBytesPerFilterBlock)) >> 32);
-  const auto key = static_cast<uint32_t>(hash);
-  auto* bitset32 = reinterpret_cast<uint32_t*>(data_.data());
+  InsertHashInBlock(hash, data_.data() + BlockOffset(hash, data_.size()));
+}
 
-  for (int i = 0; i < kBitsSetPerBlock; i++) {
-    // Calculate mask for key in the given bitset.
-    const uint32_t mask = UINT32_C(0x1) << ((key * SALT[i]) >> 27);
-    bitset32[bucket_index * kBitsSetPerBlock + i] |= mask;
-  }
+uint32_t BlockSplitBloomFilter::BlockOffset(uint64_t hash, uint32_t num_bytes) {
+  const auto bucket_index = static_cast<uint32_t>(((hash >> 32) * (num_bytes / kBytesPerFilterBlock)) >> 32);
+  return bucket_index * kBytesPerFilterBlock;
+}
+
+bool BlockSplitBloomFilter::FindHashInBlock(uint64_t hash, const char* block) {
+  return GetBlockKernels().find(static_cast<uint32_t>(hash), SALT, block);
+}
+
+void BlockSplitBloomFilter::InsertHashInBlock(uint64_t hash, char* block) {
+  GetBlockKernels().insert(static_cast<uint32_t>(hash), SALT, block);
+}
+
+void BlockSplitBloomFilter::FindHashesInBlocks(const uint64_t* hashes, const char* const* blocks, size_t n,
+                                               uint8_t* found) {
+  GetBlockKernels().find_batch(hashes, blocks, n, SALT, found);
 }
 
 uint64_t BlockSplitBloomFilter::Hash(const char* data, size_t length) { return XXH64(data, length, /*seed=*/0); }
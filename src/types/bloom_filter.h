@@ -91,6 +91,9 @@ StatusOr<BlockSplitBloomFilter> CreateBlockSplitBloomFilter(std::string& bitset)
 /// filter is 32 bytes to take advantage of 32-byte SIMD instructions.
 class BlockSplitBloomFilter {
  public:
+  // Bytes in a tiny Bloom filter block.
+  static constexpr int kBytesPerFilterBlock = 32;
+
   /// The constructor of BlockSplitBloomFilter. It uses XXH64 as hash function.
   explicit BlockSplitBloomFilter(nonstd::span<char> data) : data_(data){};
 
@@ -156,6 +159,28 @@ class BlockSplitBloomFilter {
   /// @param hash the hash of value to insert into Bloom filter.
   void InsertHash(uint64_t hash);
 
+  /// Get the offset of the tiny Bloom filter block of a hash in a bitset, which is the only
+  /// block FindHash and InsertHash touch, so a part of the bitset holding it is enough for them.
+  ///
+  /// @param hash the hash of value.
+  /// @param num_bytes the number of bytes of the bitset.
+  /// @return the offset of the block, a multiple of kBytesPerFilterBlock.
+  static uint32_t BlockOffset(uint64_t hash, uint32_t num_bytes);
+
+  /// FindHash and InsertHash on the block of the hash found by BlockOffset.
+  ///
+  /// @param block the address of the block.
+  static bool FindHashInBlock(uint64_t hash, const char* block);
+  static void InsertHashInBlock(uint64_t hash, char* block);
+
+  /// FindHashInBlock for many hashes at once, each in its own block.
+  ///
+  /// @param hashes the hashes to find.
+  /// @param blocks the addresses of the blocks of the hashes.
+  /// @param n the number of hashes.
+  /// @param found [out] whether each hash is PROBABLY in set.
+  static void FindHashesInBlocks(const uint64_t* hashes, const char* const* blocks, size_t n, uint8_t* found);
+
   uint32_t GetBitsetSize() const { return data_.size(); }
 
   /// Get the plain bitset value from the Bloom filter bitset.
@@ -171,9 +196,6 @@ class BlockSplitBloomFilter {
   static uint64_t Hash(const char* data, size_t length);
 
  private:
-  // Bytes in a tiny Bloom filter block.
-  static constexpr int kBytesPerFilterBlock = 32;
-
   // The number of bits to be set in each tiny Bloom filter
   static constexpr int kBitsSetPerBlock = 8;
 
@@ -0,0 +1,441 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "list_chunks.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "encoding.h"
+
+namespace redis {
+
+ListChunks::ListChunks(engine::Storage *storage, std::string ns_key, ListMetadata *metadata,
+                       rocksdb::ReadOptions read_options)
+    : storage_(storage), ns_key_(std::move(ns_key)), metadata_(metadata), read_options_(std::move(read_options)) {
+  if (metadata_->size == 0) {
+    // a new list has neither chunks nor a directory
+    directory_loaded_ = true;
+    return;
+  }
+  chunks_.push_back({metadata_->head, metadata_->head_chunk_size});
+  if (metadata_->tail != metadata_->head) {
+    chunks_.push_back({metadata_->tail, metadata_->tail_chunk_size});
+  }
+}
+
+std::string ListChunks::ChunkSubKey(uint64_t id) {
+  std::string sub_key;
+  PutFixed64(&sub_key, id);
+  return sub_key;
+}
+
+void ListChunks::EncodeChunk(const std::vector<std::string> &elems, std::string *dst) {
+  for (const auto &elem : elems) {
+    PutVarint32(dst, static_cast<uint32_t>(elem.size()));
+    dst->append(elem);
+  }
+}
+
+rocksdb::Status ListChunks::DecodeChunk(Slice input, std::vector<Slice> *elems) {
+  elems->clear();
+  while (!input.empty()) {
+    uint32_t size = 0;
+    if (!GetVarint32(&input, &size) || input.size() < size) {
+      return rocksdb::Status::Corruption("broken list chunk");
+    }
+    elems->emplace_back(input.data(), size);
+    input.remove_prefix(size);
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::DecodeChunkIds(const ListMetadata &metadata, Slice directory, std::vector<uint64_t> *ids) {
+  ids->clear();
+  if (metadata.size == 0) return rocksdb::Status::OK();
+
+  ids->push_back(metadata.head);
+  while (!directory.empty()) {
+    uint64_t id = 0;
+    uint32_t size = 0;
+    if (!GetFixed64(&directory, &id) || !GetFixed32(&directory, &size)) {
+      return rocksdb::Status::Corruption("broken list chunk directory");
+    }
+    ids->push_back(id);
+  }
+  if (metadata.tail != metadata.head) ids->push_back(metadata.tail);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Push(const std::vector<Slice> &elems, bool left, uint32_t max_chunk_size) {
+  if (chunks_.empty() || chunks_[left ? 0 : chunks_.size() - 1].size + elems.size() > max_chunk_size) {
+    // new chunks will be added to the end
+    if (auto s = loadDirectory(); !s.ok()) return s;
+  }
+
+  for (const auto &elem : elems) {
+    if (chunks_.empty() || chunks_[left ? 0 : chunks_.size() - 1].size >= max_chunk_size) {
+      insertChunk(left ? 0 : chunks_.size());
+    }
+    size_t pos = left ? 0 : chunks_.size() - 1;
+    std::vector<std::string> *chunk_elems = nullptr;
+    if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+    if (left) {
+      chunk_elems->insert(chunk_elems->begin(), elem.ToString());
+    } else {
+      chunk_elems->emplace_back(elem.ToString());
+    }
+    updated(pos);
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Pop(bool left, uint64_t count, std::vector<std::string> *elems) {
+  if (chunks_.empty()) return rocksdb::Status::OK();
+  if (count >= chunks_[left ? 0 : chunks_.size() - 1].size) {
+    // the chunks emptied will be removed
+    if (auto s = loadDirectory(); !s.ok()) return s;
+  }
+
+  while (count > 0 && !chunks_.empty()) {
+    size_t pos = left ? 0 : chunks_.size() - 1;
+    std::vector<std::string> *chunk_elems = nullptr;
+    if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+
+    uint64_t n = std::min<uint64_t>(count, chunk_elems->size());
+    for (uint64_t i = 0; i < n; i++) {
+      elems->emplace_back(std::move((*chunk_elems)[left ? i : chunk_elems->size() - 1 - i]));
+    }
+    if (left) {
+      chunk_elems->erase(chunk_elems->begin(), chunk_elems->begin() + static_cast<ptrdiff_t>(n));
+    } else {
+      chunk_elems->erase(chunk_elems->end() - static_cast<ptrdiff_t>(n), chunk_elems->end());
+    }
+    count -= n;
+    if (chunk_elems->empty()) {
+      eraseChunk(pos);
+    } else {
+      updated(pos);
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Get(uint64_t index, std::string *elem) {
+  size_t pos = 0;
+  uint64_t offset = 0;
+  if (auto s = locate(index, &pos, &offset); !s.ok()) return s;
+  std::vector<std::string> *chunk_elems = nullptr;
+  if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+  *elem = (*chunk_elems)[offset];
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Set(uint64_t index, const Slice &elem) {
+  size_t pos = 0;
+  uint64_t offset = 0;
+  if (auto s = locate(index, &pos, &offset); !s.ok()) return s;
+  std::vector<std::string> *chunk_elems = nullptr;
+  if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+  (*chunk_elems)[offset] = elem.ToString();
+  updated(pos);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Insert(uint64_t index, const Slice &elem, uint32_t max_chunk_size) {
+  if (auto s = loadDirectory(); !s.ok()) return s;
+
+  size_t pos = chunks_.size() - 1;
+  uint64_t offset = chunks_[pos].size;
+  if (index < metadata_->size) {
+    if (auto s = locate(index, &pos, &offset); !s.ok()) return s;
+  }
+  std::vector<std::string> *chunk_elems = nullptr;
+  if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+  chunk_elems->insert(chunk_elems->begin() + static_cast<ptrdiff_t>(offset), elem.ToString());
+
+  if (chunk_elems->size() > max_chunk_size) {
+    // split the chunk in halves, so the following inserts to them don't split them again right away
+    insertChunk(pos + 1);
+    std::vector<std::string> *next_elems = nullptr;
+    if (auto s = elements(pos + 1, &next_elems); !s.ok()) return s;
+    auto half = chunk_elems->begin() + static_cast<ptrdiff_t>(chunk_elems->size() / 2);
+    next_elems->assign(std::make_move_iterator(half), std::make_move_iterator(chunk_elems->end()));
+    chunk_elems->erase(half, chunk_elems->end());
+    updated(pos + 1);
+  }
+  updated(pos);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Remove(const Slice &elem, uint64_t limit, bool reversed, uint64_t *removed_cnt) {
+  *removed_cnt = 0;
+  if (auto s = loadDirectory(); !s.ok()) return s;
+
+  for (size_t i = 0; i < chunks_.size() && (limit == 0 || *removed_cnt < limit);) {
+    size_t pos = reversed ? chunks_.size() - 1 - i : i;
+    std::vector<std::string> *chunk_elems = nullptr;
+    if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+
+    std::vector<std::string> kept;
+    kept.reserve(chunk_elems->size());
+    for (size_t j = 0; j < chunk_elems->size(); j++) {
+      auto &chunk_elem = (*chunk_elems)[reversed ? chunk_elems->size() - 1 - j : j];
+      if (chunk_elem == elem && (limit == 0 || *removed_cnt < limit)) {
+        ++*removed_cnt;
+      } else {
+        kept.emplace_back(std::move(chunk_elem));
+      }
+    }
+    if (kept.size() == chunk_elems->size()) {
+      i++;
+      continue;
+    }
+
+    if (reversed) std::reverse(kept.begin(), kept.end());
+    *chunk_elems = std::move(kept);
+    if (chunk_elems->empty()) {
+      // the next chunk to visit takes the position of this one
+      eraseChunk(pos);
+    } else {
+      updated(pos);
+      i++;
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Trim(uint64_t start, uint64_t stop) {
+  if (auto s = loadDirectory(); !s.ok()) return s;
+
+  uint64_t counts[] = {start, metadata_->size - 1 - stop};
+  for (bool left : {true, false}) {
+    uint64_t count = counts[left ? 0 : 1];
+    while (count > 0) {
+      size_t pos = left ? 0 : chunks_.size() - 1;
+      // the chunks out of range are removed without being read
+      if (chunks_[pos].size <= count) {
+        count -= chunks_[pos].size;
+        eraseChunk(pos);
+        continue;
+      }
+
+      std::vector<std::string> *chunk_elems = nullptr;
+      if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+      if (left) {
+        chunk_elems->erase(chunk_elems->begin(), chunk_elems->begin() + static_cast<ptrdiff_t>(count));
+      } else {
+        chunk_elems->erase(chunk_elems->end() - static_cast<ptrdiff_t>(count), chunk_elems->end());
+      }
+      updated(pos);
+      count = 0;
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Scan(bool reversed, const std::function<bool(const Slice &)> &elem_cb) {
+  if (auto s = loadDirectory(); !s.ok()) return s;
+
+  for (size_t i = 0; i < chunks_.size(); i++) {
+    size_t pos = reversed ? chunks_.size() - 1 - i : i;
+    std::vector<std::string> *chunk_elems = nullptr;
+    if (auto s = elements(pos, &chunk_elems); !s.ok()) return s;
+    for (size_t j = 0; j < chunk_elems->size(); j++) {
+      if (!elem_cb((*chunk_elems)[reversed ? chunk_elems->size() - 1 - j : j])) return rocksdb::Status::OK();
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::Range(uint64_t start, uint64_t stop, const std::function<void(const Slice &)> &elem_cb) {
+  size_t pos = 0;
+  uint64_t offset = 0;
+  if (auto s = locate(start, &pos, &offset); !s.ok()) return s;
+  uint64_t remaining = stop - start + 1;
+  if (remaining > chunks_[pos].size - offset) {
+    // the range goes on in the next chunks
+    if (auto s = loadDirectory(); !s.ok()) return s;
+    if (auto s = locate(start, &pos, &offset); !s.ok()) return s;
+  }
+
+  // all the chunks in range are read at once
+  std::vector<std::string> keys;
+  for (uint64_t covered = 0; covered < remaining + offset; pos++) {
+    keys.emplace_back(internalKey(ChunkSubKey(chunks_[pos].id)));
+    covered += chunks_[pos].size;
+  }
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+  std::vector<rocksdb::PinnableSlice> values(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+  storage_->MultiGet(read_options_, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_slices.size(),
+                     key_slices.data(), values.data(), statuses.data());
+
+  std::vector<Slice> elems;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!statuses[i].ok()) return statuses[i];
+    if (auto s = DecodeChunk(values[i], &elems); !s.ok()) return s;
+    for (size_t j = i == 0 ? offset : 0; j < elems.size() && remaining > 0; j++, remaining--) {
+      elem_cb(elems[j]);
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+void ListChunks::Save(rocksdb::WriteBatchBase *batch, rocksdb::ColumnFamilyHandle *metadata_cf_handle) {
+  for (auto id : erased_chunks_) {
+    batch->Delete(internalKey(ChunkSubKey(id)));
+  }
+  if (chunks_.empty()) {
+    // the directory left is recycled along with the chunks of the list by the compaction
+    batch->Delete(metadata_cf_handle, ns_key_);
+    return;
+  }
+
+  for (auto id : updated_chunks_) {
+    std::string value;
+    EncodeChunk(cached_elems_[id], &value);
+    batch->Put(internalKey(ChunkSubKey(id)), value);
+  }
+  if (directory_loaded_) {
+    std::string directory;
+    for (size_t i = 1; i + 1 < chunks_.size(); i++) {
+      PutFixed64(&directory, chunks_[i].id);
+      PutFixed32(&directory, static_cast<uint32_t>(chunks_[i].size));
+    }
+    if (directory != directory_) {
+      if (directory.empty()) {
+        batch->Delete(internalKey(kDirectorySubKey));
+      } else {
+        batch->Put(internalKey(kDirectorySubKey), directory);
+      }
+      directory_ = std::move(directory);
+    }
+  }
+
+  metadata_->head = chunks_.front().id;
+  metadata_->head_chunk_size = static_cast<uint32_t>(chunks_.front().size);
+  metadata_->tail = chunks_.back().id;
+  metadata_->tail_chunk_size = static_cast<uint32_t>(chunks_.back().size);
+  std::string bytes;
+  metadata_->Encode(&bytes);
+  batch->Put(metadata_cf_handle, ns_key_, bytes);
+}
+
+std::string ListChunks::internalKey(const Slice &sub_key) const {
+  return InternalKey(ns_key_, sub_key, metadata_->version, storage_->IsSlotIdEncoded()).Encode();
+}
+
+rocksdb::Status ListChunks::loadDirectory() {
+  if (directory_loaded_) return rocksdb::Status::OK();
+
+  directory_.clear();
+  auto s = storage_->Get(read_options_, internalKey(kDirectorySubKey), &directory_);
+  if (!s.ok() && !s.IsNotFound()) return s;
+
+  std::vector<Chunk> chunks{chunks_.front()};
+  Slice input(directory_);
+  while (!input.empty()) {
+    uint64_t id = 0;
+    uint32_t size = 0;
+    if (!GetFixed64(&input, &id) || !GetFixed32(&input, &size)) {
+      return rocksdb::Status::Corruption("broken list chunk directory");
+    }
+    chunks.push_back({id, size});
+  }
+  if (chunks_.size() > 1) chunks.push_back(chunks_.back());
+  chunks_ = std::move(chunks);
+  directory_loaded_ = true;
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ListChunks::locate(uint64_t index, size_t *pos, uint64_t *offset) {
+  if (index < chunks_.front().size) {
+    *pos = 0;
+    *offset = index;
+    return rocksdb::Status::OK();
+  }
+  uint64_t last_begin = metadata_->size - chunks_.back().size;
+  if (index >= last_begin) {
+    *pos = chunks_.size() - 1;
+    *offset = index - last_begin;
+    return rocksdb::Status::OK();
+  }
+
+  if (auto s = loadDirectory(); !s.ok()) return s;
+  uint64_t begin = 0;
+  for (size_t i = 0; i < chunks_.size(); i++) {
+    if (index < begin + chunks_[i].size) {
+      *pos = i;
+      *offset = index - begin;
+      return rocksdb::Status::OK();
+    }
+    begin += chunks_[i].size;
+  }
+  return rocksdb::Status::Corruption("the sizes of the list chunks don't match the size of the list");
+}
+
+rocksdb::Status ListChunks::elements(size_t pos, std::vector<std::string> **elems) {
+  uint64_t id = chunks_[pos].id;
+  auto iter = cached_elems_.find(id);
+  if (iter == cached_elems_.end()) {
+    std::string value;
+    auto s = storage_->Get(read_options_, internalKey(ChunkSubKey(id)), &value);
+    if (!s.ok()) return s;
+    std::vector<Slice> slices;
+    if (s = DecodeChunk(value, &slices); !s.ok()) return s;
+
+    std::vector<std::string> chunk_elems;
+    chunk_elems.reserve(slices.size());
+    for (const auto &slice : slices) {
+      chunk_elems.emplace_back(slice.data(), slice.size());
+    }
+    iter = cached_elems_.emplace(id, std::move(chunk_elems)).first;
+  }
+  *elems = &iter->second;
+  return rocksdb::Status::OK();
+}
+
+void ListChunks::updated(size_t pos) {
+  auto &chunk = chunks_[pos];
+  uint64_t size = cached_elems_[chunk.id].size();
+  metadata_->size = metadata_->size - chunk.size + size;
+  chunk.size = size;
+  updated_chunks_.insert(chunk.id);
+}
+
+void ListChunks::insertChunk(size_t pos) {
+  uint64_t id = metadata_->next_chunk_id++;
+  chunks_.insert(chunks_.begin() + static_cast<ptrdiff_t>(pos), {id, 0});
+  cached_elems_[id].clear();
+  updated_chunks_.insert(id);
+}
+
+void ListChunks::eraseChunk(size_t pos) {
+  uint64_t id = chunks_[pos].id;
+  metadata_->size -= chunks_[pos].size;
+  chunks_.erase(chunks_.begin() + static_cast<ptrdiff_t>(pos));
+  cached_elems_.erase(id);
+  updated_chunks_.erase(id);
+  erased_chunks_.push_back(id);
+}
+
+}  // namespace redis
@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/status.h>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "storage/redis_metadata.h"
+#include "storage/storage.h"
+
+namespace redis {
+
+// ListChunks reads and updates a chunked list, whose elements are packed into chunk subkeys of
+// at most `list-chunk-max-entries` elements, like the nodes of the Redis quicklist.
+//
+// The chunks are ordered by a directory: the ids and the sizes of the first and the last chunk
+// are in the metadata, the ones of the chunks in between are in the directory subkey. So the chunk
+// holding an index is found through the sizes, and an update in the middle of the list rewrites
+// its chunk, plus the directory when a chunk is split or emptied. Pushes and pops only rewrite the
+// directory when they add or remove a chunk.
+//
+// The chunks read or updated are kept in memory until `Save`, so the updates made through the
+// same ListChunks see each other.
+class ListChunks {
+ public:
+  // The subkey of the directory, which doesn't collide with the 8-byte ids of the chunks
+  static constexpr const char *kDirectorySubKey = "directory";
+
+  ListChunks(engine::Storage *storage, std::string ns_key, ListMetadata *metadata,
+             rocksdb::ReadOptions read_options = rocksdb::ReadOptions());
+
+  static std::string ChunkSubKey(uint64_t id);
+  static void EncodeChunk(const std::vector<std::string> &elems, std::string *dst);
+  static rocksdb::Status DecodeChunk(Slice input, std::vector<Slice> *elems);
+  // The ids of the chunks in the order of the list, `directory` is empty if there's no directory subkey
+  static rocksdb::Status DecodeChunkIds(const ListMetadata &metadata, Slice directory, std::vector<uint64_t> *ids);
+
+  rocksdb::Status Push(const std::vector<Slice> &elems, bool left, uint32_t max_chunk_size);
+  rocksdb::Status Pop(bool left, uint64_t count, std::vector<std::string> *elems);
+  rocksdb::Status Get(uint64_t index, std::string *elem);
+  rocksdb::Status Set(uint64_t index, const Slice &elem);
+  // Insert the element before the one at `index`, or after the last one if `index` is the size of the list
+  rocksdb::Status Insert(uint64_t index, const Slice &elem, uint32_t max_chunk_size);
+  // Remove up to `limit` elements equal to `elem` from the head, or from the tail if `reversed`,
+  // a zero `limit` removes all of them
+  rocksdb::Status Remove(const Slice &elem, uint64_t limit, bool reversed, uint64_t *removed_cnt);
+  // Keep the elements from `start` to `stop` only, both of them must be in the list
+  rocksdb::Status Trim(uint64_t start, uint64_t stop);
+  // Call `elem_cb` with the elements from the head, or from the tail if `reversed`, until it returns false
+  rocksdb::Status Scan(bool reversed, const std::function<bool(const Slice &)> &elem_cb);
+  // Call `elem_cb` with the elements from `start` to `stop`, both of them must be in the list
+  rocksdb::Status Range(uint64_t start, uint64_t stop, const std::function<void(const Slice &)> &elem_cb);
+
+  // Write the updated chunks and the metadata, or delete the metadata once the list is empty
+  void Save(rocksdb::WriteBatchBase *batch, rocksdb::ColumnFamilyHandle *metadata_cf_handle);
+
+ private:
+  struct Chunk {
+    uint64_t id;
+    uint64_t size;
+  };
+
+  std::string internalKey(const Slice &sub_key) const;
+  rocksdb::Status loadDirectory();
+  // Find the position in `chunks_` of the chunk holding the element at `index`, and its offset in the chunk
+  rocksdb::Status locate(uint64_t index, size_t *pos, uint64_t *offset);
+  rocksdb::Status elements(size_t pos, std::vector<std::string> **elems);
+  // Mark the chunk at `pos` updated after its elements are changed
+  void updated(size_t pos);
+  // Add an empty chunk at `pos`, the directory must be loaded before a chunk is added or erased
+  void insertChunk(size_t pos);
+  void eraseChunk(size_t pos);
+
+  engine::Storage *storage_;
+  std::string ns_key_;
+  ListMetadata *metadata_;
+  rocksdb::ReadOptions read_options_;
+
+  // all the chunks once the directory is loaded, only the first and the last one before that
+  std::vector<Chunk> chunks_;
+  bool directory_loaded_ = false;
+  std::string directory_;
+
+  std::map<uint64_t, std::vector<std::string>> cached_elems_;
+  std::set<uint64_t> updated_chunks_;
+  std::vector<uint64_t> erased_chunks_;
+};
+
+}  // namespace redis
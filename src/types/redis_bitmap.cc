@@ -21,13 +21,17 @@
 #include "redis_bitmap.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
+#include "common/bit_kernels.h"
 #include "common/bit_util.h"
 #include "db_util.h"
 #include "parse_util.h"
 #include "redis_bitmap_string.h"
+#include "redis_string.h"
 
 namespace redis {
 
@@ -37,6 +41,17 @@ constexpr uint32_t kBitmapSegmentBytes = 1024;
 constexpr char kErrBitmapStringOutOfRange[] =
     "The size of the bitmap string exceeds the "
     "configuration item max-bitmap-to-string-mb";
+constexpr char kErrInvalidBitmapSegment[] = "invalid segment of compressed bitmap";
+
+// The containers of the segments of a compressed bitmap, like those of Roaring bitmaps
+enum class BitmapContainer : uint8_t {
+  // the bytes of the segment without the trailing zero bytes
+  kBytes = 0,
+  // the sorted offsets of the set bits, 16 bits each
+  kArray = 1,
+  // the runs of set bits, each with the 16-bit offset of its first bit and its 16-bit length minus one
+  kRuns = 2,
+};
 
 /*
  * If you setbit bit 0 1, the value is stored as 0x01 in Kvrocks Bitmap but 0x80
@@ -93,12 +108,116 @@ uint32_t SegmentSubKeyIndexForBit(uint32_t bit_offset) {
   return (bit_offset / kBitmapSegmentBits) * kBitmapSegmentBytes;
 }
 
+// The popcount summary of a bitmap, i.e. the number of set bits of each segment. The 16-bit counts
+// are stored in blocks of kSummaryBlockSegments segments, a subkey per block, so the bits of a range
+// of segments are counted with a read per block. A missing block or count is 0 like a missing segment,
+// so the compaction filter is free to drop a block of zeros as if it were an empty segment.
+class BitmapSummary {
+ public:
+  static constexpr uint32_t kSummaryBlockSegments = 1024;
+
+  BitmapSummary(engine::Storage *storage, std::string ns_key, uint64_t version,
+                rocksdb::ReadOptions read_options = rocksdb::ReadOptions())
+      : storage_(storage), ns_key_(std::move(ns_key)), version_(version), read_options_(std::move(read_options)) {}
+
+  // The number of set bits of the segment at `index`
+  rocksdb::Status Get(uint32_t index, uint32_t *count) {
+    std::string *counts = nullptr;
+    auto s = block(index / kSummaryBlockSegments, &counts);
+    if (!s.ok()) return s;
+    size_t pos = (index % kSummaryBlockSegments) * sizeof(uint16_t);
+    *count = pos < counts->size() ? DecodeFixed16(counts->data() + pos) : 0;
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status Set(uint32_t index, uint32_t count) {
+    std::string *counts = nullptr;
+    auto s = block(index / kSummaryBlockSegments, &counts);
+    if (!s.ok()) return s;
+    size_t pos = (index % kSummaryBlockSegments) * sizeof(uint16_t);
+    if (counts->size() < pos + sizeof(uint16_t)) counts->resize(pos + sizeof(uint16_t), 0);
+    EncodeFixed16(counts->data() + pos, static_cast<uint16_t>(count));
+    dirty_blocks_.insert(index / kSummaryBlockSegments);
+    return rocksdb::Status::OK();
+  }
+
+  // The number of set bits of the segments from `first` to `last`
+  rocksdb::Status Sum(uint32_t first, uint32_t last, uint64_t *count) {
+    *count = 0;
+    for (uint32_t index = first; index <= last; index++) {
+      uint32_t segment_count = 0;
+      auto s = Get(index, &segment_count);
+      if (!s.ok()) return s;
+      *count += segment_count;
+    }
+    return rocksdb::Status::OK();
+  }
+
+  // Write the updated blocks without their trailing zero counts
+  void Save(rocksdb::WriteBatchBase *batch) {
+    for (auto block_index : dirty_blocks_) {
+      std::string &counts = blocks_[block_index];
+      size_t size = counts.size();
+      while (size >= sizeof(uint16_t) && DecodeFixed16(counts.data() + size - sizeof(uint16_t)) == 0) {
+        size -= sizeof(uint16_t);
+      }
+      std::string sub_key = subKey(block_index);
+      if (size == 0) {
+        batch->Delete(sub_key);
+      } else {
+        batch->Put(sub_key, Slice(counts.data(), size));
+      }
+    }
+    dirty_blocks_.clear();
+  }
+
+ private:
+  std::string subKey(uint32_t block_index) const {
+    return InternalKey(ns_key_, Bitmap::kSummarySubKeyPrefix + std::to_string(block_index), version_,
+                       storage_->IsSlotIdEncoded())
+        .Encode();
+  }
+
+  rocksdb::Status block(uint32_t block_index, std::string **counts) {
+    auto [iter, inserted] = blocks_.try_emplace(block_index);
+    *counts = &iter->second;
+    if (!inserted) return rocksdb::Status::OK();
+
+    auto s = storage_->Get(read_options_, subKey(block_index), *counts);
+    if (s.IsNotFound()) {
+      (*counts)->clear();
+      return rocksdb::Status::OK();
+    }
+    if (!s.ok()) blocks_.erase(iter);
+    return s;
+  }
+
+  engine::Storage *storage_;
+  std::string ns_key_;
+  uint64_t version_;
+  rocksdb::ReadOptions read_options_;
+  std::map<uint32_t, std::string> blocks_;
+  std::set<uint32_t> dirty_blocks_;
+};
+
 rocksdb::Status Bitmap::GetMetadata(const Slice &ns_key, BitmapMetadata *metadata, std::string *raw_value) {
   auto s = GetRawMetadata(ns_key, raw_value);
   if (!s.ok()) return s;
 
   Slice slice = *raw_value;
-  return ParseMetadata({kRedisBitmap, kRedisString}, &slice, metadata);
+  s = ParseMetadata({kRedisBitmap, kRedisString}, &slice, metadata);
+  if (!s.ok() || !metadata->IsChunkedString()) return s;
+
+  // BitmapString works on the whole value of the string, which is read from its chunks
+  s = String(storage_, namespace_).GetRawValue(ns_key.ToString(), raw_value);
+  if (!s.ok()) return s;
+  return metadata->Decode(*raw_value);
+}
+
+void Bitmap::initMetadata(BitmapMetadata *metadata) const {
+  const auto *config = storage_->GetConfig();
+  if (config->bitmap_compressed_segments) metadata->flags |= METADATA_BITMAP_COMPRESSED_MASK;
+  if (config->bitmap_popcount_summary) metadata->flags |= METADATA_BITMAP_SUMMARY_MASK;
 }
 
 rocksdb::Status Bitmap::GetBit(const Slice &user_key, uint32_t bit_offset, bool *bit) {
@@ -115,9 +234,7 @@ rocksdb::Status Bitmap::GetBit(const Slice &user_key, uint32_t bit_offset, bool
     return bitmap_string_db.GetBit(raw_value, bit_offset, bit);
   }
 
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
   rocksdb::PinnableSlice value;
   std::string sub_key = InternalKey(ns_key, std::to_string(SegmentSubKeyIndexForBit(bit_offset)), metadata.version,
                                     storage_->IsSlotIdEncoded())
@@ -126,6 +243,8 @@ rocksdb::Status Bitmap::GetBit(const Slice &user_key, uint32_t bit_offset, bool
   // If s.IsNotFound(), it means all bits in this segment are 0,
   // so we can return with *bit == false directly.
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
+  s = decodeSegment(metadata, SegmentSubKeyIndexForBit(bit_offset), &value);
+  if (!s.ok()) return s;
   uint32_t bit_offset_in_segment = bit_offset % kBitmapSegmentBits;
   if (bit_offset_in_segment / 8 < value.size() &&
       util::lsb::GetBit(reinterpret_cast<const uint8_t *>(value.data()), bit_offset_in_segment)) {
@@ -158,12 +277,15 @@ rocksdb::Status Bitmap::GetString(const Slice &user_key, const uint32_t max_btos
   auto iter = util::UniqueIterator(storage_, read_options);
   for (iter->Seek(prefix_key); iter->Valid() && iter->key().starts_with(prefix_key); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
+    if (IsSummarySubKey(ikey.GetSubKey())) continue;
     auto parse_result = ParseInt<uint32_t>(ikey.GetSubKey().ToString(), 10);
     if (!parse_result) {
       return rocksdb::Status::InvalidArgument(parse_result.Msg());
     }
     uint32_t frag_index = *parse_result;
     std::string fragment = iter->value().ToString();
+    s = decodeSegment(metadata, frag_index, &fragment);
+    if (!s.ok()) return s;
     // To be compatible with data written before the commit d603b0e(#338)
     // and avoid returning extra null char after expansion.
     uint32_t valid_size = std::min(
@@ -191,6 +313,7 @@ rocksdb::Status Bitmap::SetBit(const Slice &user_key, uint32_t bit_offset, bool
     redis::BitmapString bitmap_string_db(storage_, namespace_);
     return bitmap_string_db.SetBit(ns_key, &raw_value, bit_offset, new_bit, old_bit);
   }
+  if (s.IsNotFound()) initMetadata(&metadata);
 
   std::string value;
   uint32_t segment_index = SegmentSubKeyIndexForBit(bit_offset);
@@ -199,6 +322,10 @@ rocksdb::Status Bitmap::SetBit(const Slice &user_key, uint32_t bit_offset, bool
   if (s.ok()) {
     s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
+    if (s.ok()) {
+      s = decodeSegment(metadata, segment_index, &value);
+      if (!s.ok()) return s;
+    }
   }
   uint32_t bit_offset_in_segment = bit_offset % kBitmapSegmentBits;
   uint32_t byte_index = (bit_offset / 8) % kBitmapSegmentBytes;
@@ -210,9 +337,23 @@ rocksdb::Status Bitmap::SetBit(const Slice &user_key, uint32_t bit_offset, bool
   *old_bit = util::lsb::GetBit(data_ptr, bit_offset_in_segment);
   util::lsb::SetBitTo(data_ptr, bit_offset_in_segment, new_bit);
   auto batch = storage_->GetWriteBatchBase();
-  WriteBatchLogData log_data(kRedisBitmap, {std::to_string(kRedisCmdSetBit), std::to_string(bit_offset)});
+  // The new bit is logged as well since the segment of a compressed bitmap is encoded
+  WriteBatchLogData log_data(kRedisBitmap,
+                             {std::to_string(kRedisCmdSetBit), std::to_string(bit_offset), new_bit ? "1" : "0"});
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, value);
+  if (metadata.IsCompressedBitmap()) {
+    std::string encoded;
+    EncodeSegment(value, &encoded);
+    batch->Put(sub_key, encoded);
+  } else {
+    batch->Put(sub_key, value);
+  }
+  if (metadata.HasPopcountSummary() && *old_bit != new_bit) {
+    BitmapSummary summary(storage_, ns_key, metadata.version);
+    s = summary.Set(segment_index / kBitmapSegmentBytes, util::Popcount(data_ptr, value.size()));
+    if (!s.ok()) return s;
+    summary.Save(batch.Get());
+  }
   if (metadata.size != bitmap_size) {
     metadata.size = bitmap_size;
     std::string bytes;
@@ -262,9 +403,21 @@ rocksdb::Status Bitmap::BitCount(const Slice &user_key, int64_t start, int64_t s
   read_options.snapshot = ss.GetSnapShot();
   uint32_t start_index = u_start / kBitmapSegmentBytes;
   uint32_t stop_index = u_stop / kBitmapSegmentBytes;
+  std::optional<BitmapSummary> summary;
+  if (metadata.HasPopcountSummary()) summary.emplace(storage_, ns_key, metadata.version, read_options);
   // Don't use multi get to prevent large range query, and take too much memory
   uint32_t mask_cnt = 0;
   for (uint32_t i = start_index; i <= stop_index; i++) {
+    // The segments between the first and the last one are counted as a whole, so only the ones
+    // at both ends are read if there's a summary
+    if (summary && i != start_index && i != stop_index) {
+      uint64_t summary_cnt = 0;
+      s = summary->Sum(i, stop_index - 1, &summary_cnt);
+      if (!s.ok()) return s;
+      *cnt += static_cast<uint32_t>(summary_cnt);
+      i = stop_index - 1;
+      continue;
+    }
     rocksdb::PinnableSlice pin_value;
     std::string sub_key =
         InternalKey(ns_key, std::to_string(i * kBitmapSegmentBytes), metadata.version, storage_->IsSlotIdEncoded())
@@ -273,6 +426,8 @@ rocksdb::Status Bitmap::BitCount(const Slice &user_key, int64_t start, int64_t s
     if (!s.ok() && !s.IsNotFound()) return s;
     // NotFound means all bits in this segment are 0.
     if (s.IsNotFound()) continue;
+    s = decodeSegment(metadata, i * kBitmapSegmentBytes, &pin_value);
+    if (!s.ok()) return s;
     // Counting bits in [start_in_segment, stop_in_segment]
     int64_t start_in_segment = 0;                                                // start_index in 1024 bytes segment
     auto readable_stop_in_segment = static_cast<int64_t>(pin_value.size() - 1);  // stop_index  in 1024 bytes segment
@@ -295,7 +450,7 @@ rocksdb::Status Bitmap::BitCount(const Slice &user_key, int64_t start, int64_t s
     if (stop_in_segment >= start_in_segment && readable_stop_in_segment >= start_in_segment) {
       int64_t bytes = 0;
       bytes = std::min(stop_in_segment, readable_stop_in_segment) - start_in_segment + 1;
-      *cnt += util::RawPopcount(reinterpret_cast<const uint8_t *>(pin_value.data()) + start_in_segment, bytes);
+      *cnt += util::Popcount(reinterpret_cast<const uint8_t *>(pin_value.data()) + start_in_segment, bytes);
     }
   }
   *cnt -= mask_cnt;
@@ -327,22 +482,24 @@ rocksdb::Status Bitmap::BitPos(const Slice &user_key, bool bit, int64_t start, i
     return rocksdb::Status::OK();
   }
 
-  auto bit_pos_in_byte = [](char byte, bool bit) -> int {
-    for (int i = 0; i < 8; i++) {
-      if (bit && (byte & (1 << i)) != 0) return i;
-      if (!bit && (byte & (1 << i)) == 0) return i;
-    }
-    return -1;
-  };
-
   LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
   read_options.snapshot = ss.GetSnapShot();
   uint32_t start_index = u_start / kBitmapSegmentBytes;
   uint32_t stop_index = u_stop / kBitmapSegmentBytes;
+  std::optional<BitmapSummary> summary;
+  if (metadata.HasPopcountSummary()) summary.emplace(storage_, ns_key, metadata.version, read_options);
   // Don't use multi get to prevent large range query, and take too much memory
   // Searching bits in segments [start_index, stop_index].
   for (uint32_t i = start_index; i <= stop_index; i++) {
+    if (summary) {
+      // Skip the segments without the bit, i.e. the ones of zeros when looking for 1
+      // and the full ones of ones when looking for 0
+      uint32_t segment_cnt = 0;
+      s = summary->Get(i, &segment_cnt);
+      if (!s.ok()) return s;
+      if (segment_cnt == (bit ? 0 : kBitmapSegmentBits)) continue;
+    }
     rocksdb::PinnableSlice pin_value;
     std::string sub_key =
         InternalKey(ns_key, std::to_string(i * kBitmapSegmentBytes), metadata.version, storage_->IsSlotIdEncoded())
@@ -358,6 +515,8 @@ rocksdb::Status Bitmap::BitPos(const Slice &user_key, bool bit, int64_t start, i
       }
       continue;
     }
+    s = decodeSegment(metadata, i * kBitmapSegmentBytes, &pin_value);
+    if (!s.ok()) return s;
     size_t byte_pos_in_segment = 0;
     if (i == start_index) byte_pos_in_segment = u_start % kBitmapSegmentBytes;
     size_t stop_byte_in_segment = pin_value.size();
@@ -368,10 +527,11 @@ rocksdb::Status Bitmap::BitPos(const Slice &user_key, bool bit, int64_t start, i
     // Invariant:
     // 1. pin_value.size() <= kBitmapSegmentBytes.
     // 2. If it's the last segment, metadata.size % kBitmapSegmentBytes <= pin_value.size().
-    for (; byte_pos_in_segment < stop_byte_in_segment; byte_pos_in_segment++) {
-      int bit_pos_in_byte_value = bit_pos_in_byte(pin_value[byte_pos_in_segment], bit);
-      if (bit_pos_in_byte_value != -1) {
-        *pos = static_cast<int64_t>(i * kBitmapSegmentBits + byte_pos_in_segment * 8 + bit_pos_in_byte_value);
+    if (byte_pos_in_segment < stop_byte_in_segment) {
+      int64_t bit_pos = util::FindFirstBit(reinterpret_cast<const uint8_t *>(pin_value.data()) + byte_pos_in_segment,
+                                           stop_byte_in_segment - byte_pos_in_segment, bit);
+      if (bit_pos != -1) {
+        *pos = static_cast<int64_t>(i * kBitmapSegmentBits + byte_pos_in_segment * 8) + bit_pos;
         return rocksdb::Status::OK();
       }
     }
@@ -447,6 +607,9 @@ rocksdb::Status Bitmap::BitOp(BitOpFlags op_flag, const std::string &op_name, co
   batch->PutLogData(log_data.Encode());
 
   BitmapMetadata res_metadata;
+  initMetadata(&res_metadata);
+  BitmapSummary res_summary(storage_, ns_key, res_metadata.version);
+  std::string encoded;
   // If the operation is AND and the number of keys is less than the number of op_keys,
   // we can skip setting the subkeys of the result bitmap and just set the metadata.
   const bool can_skip_op = op_flag == kBitOpAnd && num_keys != op_keys.size();
@@ -455,115 +618,68 @@ rocksdb::Status Bitmap::BitOp(BitOpFlags op_flag, const std::string &op_name, co
     std::unique_ptr<unsigned char[]> frag_res(new unsigned char[kBitmapSegmentBytes]);
 
     LatestSnapShot ss(storage_);
-    rocksdb::ReadOptions read_options;
+    rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
     read_options.snapshot = ss.GetSnapShot();
+    std::vector<std::string> sub_keys(num_keys);
+    std::vector<Slice> sub_key_slices(num_keys);
+    std::vector<rocksdb::PinnableSlice> fragments(num_keys);
+    std::vector<rocksdb::Status> statuses(num_keys);
+    std::vector<const rocksdb::PinnableSlice *> found;
     for (uint64_t frag_index = 0; frag_index <= stop_index; frag_index++) {
-      std::vector<rocksdb::PinnableSlice> fragments;
-      uint16_t frag_maxlen = 0, frag_minlen = 0;
-      for (const auto &meta_pair : meta_pairs) {
-        std::string sub_key = InternalKey(meta_pair.first, std::to_string(frag_index * kBitmapSegmentBytes),
-                                          meta_pair.second.version, storage_->IsSlotIdEncoded())
-                                  .Encode();
-        rocksdb::PinnableSlice fragment;
-        auto s = storage_->Get(read_options, sub_key, &fragment);
-        if (!s.ok() && !s.IsNotFound()) {
-          return s;
-        }
-        if (s.IsNotFound()) {
+      // The segments at the same index of all the bitmaps are read at once
+      for (size_t i = 0; i < num_keys; i++) {
+        sub_keys[i] = InternalKey(meta_pairs[i].first, std::to_string(frag_index * kBitmapSegmentBytes),
+                                  meta_pairs[i].second.version, storage_->IsSlotIdEncoded())
+                          .Encode();
+        sub_key_slices[i] = sub_keys[i];
+        fragments[i].Reset();
+      }
+      storage_->MultiGet(read_options, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), num_keys,
+                         sub_key_slices.data(), fragments.data(), statuses.data());
+
+      found.clear();
+      size_t frag_maxlen = 0;
+      for (size_t i = 0; i < num_keys; i++) {
+        if (!statuses[i].ok() && !statuses[i].IsNotFound()) return statuses[i];
+        if (statuses[i].IsNotFound()) {
+          // If any of the input bitmaps is empty, the result of AND is empty.
           if (op_flag == kBitOpAnd) {
-            // If any of the input bitmaps is empty, the result of AND
-            // is empty.
             frag_maxlen = 0;
             break;
           }
-        } else {
-          if (frag_maxlen < fragment.size()) frag_maxlen = fragment.size();
-          if (fragment.size() < frag_minlen || frag_minlen == 0) frag_minlen = fragment.size();
-          fragments.emplace_back(std::move(fragment));
+          continue;
         }
+        auto s = decodeSegment(meta_pairs[i].second, frag_index * kBitmapSegmentBytes, &fragments[i]);
+        if (!s.ok()) return s;
+        frag_maxlen = std::max(frag_maxlen, fragments[i].size());
+        found.emplace_back(&fragments[i]);
       }
 
-      size_t frag_numkeys = fragments.size();
       if (frag_maxlen != 0 || op_flag == kBitOpNot) {
-        uint16_t j = 0;
+        auto *res = frag_res.get();
         if (op_flag == kBitOpNot) {
-          memset(frag_res.get(), UCHAR_MAX, kBitmapSegmentBytes);
-        } else {
-          memset(frag_res.get(), 0, frag_maxlen);
-        }
-
-        /* Fast path: as far as we have data for all the input bitmaps we
-         * can take a fast path that performs much better than the
-         * vanilla algorithm. On ARM we skip the fast path since it will
-         * result in GCC compiling the code using multiple-words load/store
-         * operations that are not supported even in ARM >= v6. */
-#ifndef USE_ALIGNED_ACCESS
-        if (frag_minlen >= sizeof(uint64_t) * 4 && frag_numkeys <= 16) {
-          auto *lres = reinterpret_cast<uint64_t *>(frag_res.get());
-          const uint64_t *lp[16];
-          for (uint64_t i = 0; i < frag_numkeys; i++) {
-            lp[i] = reinterpret_cast<const uint64_t *>(fragments[i].data());
-          }
-          memcpy(frag_res.get(), fragments[0].data(), frag_minlen);
-          auto apply_fast_path_op = [&](auto op) {
-            // Note: kBitOpNot cannot use this op, it only applying
-            // to kBitOpAnd, kBitOpOr, kBitOpXor.
-            DCHECK(op_flag != kBitOpNot);
-            while (frag_minlen >= sizeof(uint64_t) * 4) {
-              for (uint64_t i = 1; i < frag_numkeys; i++) {
-                op(lres[0], lp[i][0]);
-                op(lres[1], lp[i][1]);
-                op(lres[2], lp[i][2]);
-                op(lres[3], lp[i][3]);
-                lp[i] += 4;
-              }
-              lres += 4;
-              j += sizeof(uint64_t) * 4;
-              frag_minlen -= sizeof(uint64_t) * 4;
-            }
-          };
-
-          if (op_flag == kBitOpAnd) {
-            apply_fast_path_op([](uint64_t &a, uint64_t b) { a &= b; });
-          } else if (op_flag == kBitOpOr) {
-            apply_fast_path_op([](uint64_t &a, uint64_t b) { a |= b; });
-          } else if (op_flag == kBitOpXor) {
-            apply_fast_path_op([](uint64_t &a, uint64_t b) { a ^= b; });
-          } else if (op_flag == kBitOpNot) {
-            while (frag_minlen >= sizeof(uint64_t) * 4) {
-              lres[0] = ~lres[0];
-              lres[1] = ~lres[1];
-              lres[2] = ~lres[2];
-              lres[3] = ~lres[3];
-              lres += 4;
-              j += sizeof(uint64_t) * 4;
-              frag_minlen -= sizeof(uint64_t) * 4;
-            }
+          // The missing bytes are zeros, which turn into ones
+          memset(res, UCHAR_MAX, kBitmapSegmentBytes);
+          if (!found.empty()) {
+            memcpy(res, found[0]->data(), found[0]->size());
+            util::BitwiseNot(res, found[0]->size());
           }
-        }
-#endif
-
-        uint8_t output = 0, byte = 0;
-        for (; j < frag_maxlen; j++) {
-          output = (fragments[0].size() <= j) ? 0 : fragments[0][j];
-          if (op_flag == kBitOpNot) output = ~output;
-          for (uint64_t i = 1; i < frag_numkeys; i++) {
-            byte = (fragments[i].size() <= j) ? 0 : fragments[i][j];
-            switch (op_flag) {
-              case kBitOpAnd:
-                output &= byte;
-                break;
-              case kBitOpOr:
-                output |= byte;
-                break;
-              case kBitOpXor:
-                output ^= byte;
-                break;
-              default:
-                break;
+        } else {
+          memset(res, 0, frag_maxlen);
+          memcpy(res, found[0]->data(), found[0]->size());
+          for (size_t i = 1; i < found.size(); i++) {
+            const auto *fragment = reinterpret_cast<const uint8_t *>(found[i]->data());
+            size_t size = found[i]->size();
+            if (op_flag == kBitOpAnd) {
+              util::BitwiseAnd(res, fragment, size);
+              // ANDed with the missing bytes, which are zeros
+              memset(res + size, 0, frag_maxlen - size);
+            } else if (op_flag == kBitOpOr) {
+              util::BitwiseOr(res, fragment, size);
+            } else if (op_flag == kBitOpXor) {
+              util::BitwiseXor(res, fragment, size);
             }
           }
-          frag_res[j] = output;
         }
 
         if (op_flag == kBitOpNot) {
@@ -585,9 +701,19 @@ rocksdb::Status Bitmap::BitOp(BitOpFlags op_flag, const std::string &op_name, co
         std::string sub_key = InternalKey(ns_key, std::to_string(frag_index * kBitmapSegmentBytes),
                                           res_metadata.version, storage_->IsSlotIdEncoded())
                                   .Encode();
-        batch->Put(sub_key, Slice(reinterpret_cast<char *>(frag_res.get()), frag_maxlen));
+        Slice frag(reinterpret_cast<char *>(frag_res.get()), frag_maxlen);
+        if (res_metadata.HasPopcountSummary()) {
+          auto s = res_summary.Set(static_cast<uint32_t>(frag_index), util::Popcount(frag_res.get(), frag_maxlen));
+          if (!s.ok()) return s;
+        }
+        if (res_metadata.IsCompressedBitmap()) {
+          EncodeSegment(frag, &encoded);
+          frag = encoded;
+        }
+        batch->Put(sub_key, frag);
       }
     }
+    res_summary.Save(batch.Get());
   }
 
   std::string bytes;
@@ -622,13 +748,25 @@ class Bitmap::SegmentCacheStore {
   rocksdb::Status GetMut(uint32_t index, std::string **cache) { return get(index, /*set_dirty=*/true, cache); }
 
   // Add all dirty segments into write batch.
-  void BatchForFlush(ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch) {
+  rocksdb::Status BatchForFlush(ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch) {
+    BitmapSummary summary(storage_, ns_key_, metadata_.version);
     uint64_t used_size = 0;
     for (auto &[index, content] : cache_) {
       if (content.first) {
+        if (metadata_.HasPopcountSummary()) {
+          auto s = summary.Set(index, util::Popcount(reinterpret_cast<const uint8_t *>(content.second.data()),
+                                                     content.second.size()));
+          if (!s.ok()) return s;
+        }
         std::string sub_key =
             InternalKey(ns_key_, getSegmentSubKey(index), metadata_.version, storage_->IsSlotIdEncoded()).Encode();
-        batch->Put(sub_key, content.second);
+        if (metadata_.IsCompressedBitmap()) {
+          std::string encoded;
+          EncodeSegment(content.second, &encoded);
+          batch->Put(sub_key, encoded);
+        } else {
+          batch->Put(sub_key, content.second);
+        }
         used_size = std::max(used_size, static_cast<uint64_t>(index) * kBitmapSegmentBytes + content.second.size());
       }
     }
@@ -638,6 +776,8 @@ class Bitmap::SegmentCacheStore {
       metadata_.Encode(&bytes);
       batch->Put(metadata_cf_handle_, ns_key_, bytes);
     }
+    summary.Save(batch.Get());
+    return rocksdb::Status::OK();
   }
 
  private:
@@ -653,6 +793,10 @@ class Bitmap::SegmentCacheStore {
       if (!s.ok() && !s.IsNotFound()) {
         return s;
       }
+      if (s.ok()) {
+        s = decodeSegment(metadata_, index * kBitmapSegmentBytes, &str);
+        if (!s.ok()) return s;
+      }
     }
 
     is_dirty |= set_dirty;
@@ -786,6 +930,7 @@ rocksdb::Status Bitmap::bitfield(const Slice &user_key, const std::vector<Bitfie
   if (metadata.Type() != RedisType::kRedisBitmap) {
     return rocksdb::Status::InvalidArgument("The value is not a bitmap or string.");
   }
+  if (s.IsNotFound()) initMetadata(&metadata);
 
   // We firstly do the bitfield operation by fetching segments into memory.
   // Use SegmentCacheStore to record dirty segments. (if not read-only mode)
@@ -796,7 +941,8 @@ rocksdb::Status Bitmap::bitfield(const Slice &user_key, const std::vector<Bitfie
     // Write changes into storage.
     auto batch = storage_->GetWriteBatchBase();
     if (bitfieldWriteAheadLog(batch, ops)) {
-      cache.BatchForFlush(batch);
+      s = cache.BatchForFlush(batch);
+      if (!s.ok()) return s;
       return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
     }
   }
@@ -923,8 +1069,117 @@ bool Bitmap::GetBitFromValueAndOffset(std::string_view value, uint32_t bit_offse
   return bit;
 }
 
+bool Bitmap::IsSummarySubKey(const Slice &sub_key) { return sub_key.starts_with(kSummarySubKeyPrefix); }
+
 bool Bitmap::IsEmptySegment(const Slice &segment) {
-  static const char zero_byte_segment[kBitmapSegmentBytes] = {0};
-  return !memcmp(zero_byte_segment, segment.data(), segment.size());
+  static const char zero_byte_segment[kBitmapSegmentBytes + 1] = {0};
+  // a segment of a compressed bitmap with no bits is a zero byte, as the bytes without the trailing zeros
+  return segment.size() <= sizeof(zero_byte_segment) && !memcmp(zero_byte_segment, segment.data(), segment.size());
+}
+
+void Bitmap::EncodeSegment(const Slice &bytes, std::string *dst) {
+  dst->clear();
+  const auto *p = reinterpret_cast<const uint8_t *>(bytes.data());
+  size_t size = std::min(bytes.size(), static_cast<size_t>(kBitmapSegmentBytes));
+  while (size > 0 && p[size - 1] == 0) size--;
+
+  size_t bits = util::Popcount(p, size);
+  size_t runs = 0;
+  uint8_t prev_high_bit = 0;
+  for (size_t i = 0; i < size; i++) {
+    // a run starts at each set bit following a clear one
+    runs += __builtin_popcount(static_cast<uint8_t>(p[i] & ~((p[i] << 1) | prev_high_bit)));
+    prev_high_bit = p[i] >> 7;
+  }
+
+  if (size <= bits * 2 && size <= runs * 4) {
+    PutFixed8(dst, static_cast<uint8_t>(BitmapContainer::kBytes));
+    dst->append(bytes.data(), size);
+  } else if (bits * 2 <= runs * 4) {
+    PutFixed8(dst, static_cast<uint8_t>(BitmapContainer::kArray));
+    for (size_t i = 0; i < size; i++) {
+      for (uint8_t byte = p[i]; byte != 0; byte &= byte - 1) {
+        PutFixed16(dst, static_cast<uint16_t>(i * 8 + __builtin_ctz(byte)));
+      }
+    }
+  } else {
+    PutFixed8(dst, static_cast<uint8_t>(BitmapContainer::kRuns));
+    uint32_t pos = 0;
+    while (pos < size * 8) {
+      if (!util::lsb::GetBit(p, pos)) {
+        pos++;
+        continue;
+      }
+      uint32_t start = pos;
+      while (pos < size * 8 && util::lsb::GetBit(p, pos)) pos++;
+      PutFixed16(dst, static_cast<uint16_t>(start));
+      PutFixed16(dst, static_cast<uint16_t>(pos - start - 1));
+    }
+  }
+}
+
+rocksdb::Status Bitmap::DecodeSegment(const Slice &value, std::string *bytes) {
+  bytes->clear();
+  if (value.empty()) return rocksdb::Status::OK();
+
+  auto container = static_cast<BitmapContainer>(value[0]);
+  Slice input(value.data() + 1, value.size() - 1);
+  auto set_bits = [bytes](uint32_t start, uint32_t stop) {
+    if (bytes->size() < stop / 8 + 1) bytes->resize(stop / 8 + 1, 0);
+    for (uint32_t pos = start; pos <= stop; pos++) {
+      util::lsb::SetBitTo(reinterpret_cast<uint8_t *>(bytes->data()), pos, true);
+    }
+  };
+
+  switch (container) {
+    case BitmapContainer::kBytes:
+      if (input.size() > kBitmapSegmentBytes) return rocksdb::Status::Corruption(kErrInvalidBitmapSegment);
+      bytes->assign(input.data(), input.size());
+      return rocksdb::Status::OK();
+    case BitmapContainer::kArray:
+      if (input.size() % 2 != 0) return rocksdb::Status::Corruption(kErrInvalidBitmapSegment);
+      for (size_t i = 0; i < input.size(); i += 2) {
+        uint32_t pos = DecodeFixed16(input.data() + i);
+        if (pos >= kBitmapSegmentBits) return rocksdb::Status::Corruption(kErrInvalidBitmapSegment);
+        set_bits(pos, pos);
+      }
+      return rocksdb::Status::OK();
+    case BitmapContainer::kRuns:
+      if (input.size() % 4 != 0) return rocksdb::Status::Corruption(kErrInvalidBitmapSegment);
+      for (size_t i = 0; i < input.size(); i += 4) {
+        uint32_t start = DecodeFixed16(input.data() + i);
+        uint32_t stop = start + DecodeFixed16(input.data() + i + 2);
+        if (stop >= kBitmapSegmentBits) return rocksdb::Status::Corruption(kErrInvalidBitmapSegment);
+        set_bits(start, stop);
+      }
+      return rocksdb::Status::OK();
+  }
+  return rocksdb::Status::Corruption(kErrInvalidBitmapSegment);
+}
+
+rocksdb::Status Bitmap::decodeSegment(const Metadata &metadata, uint32_t segment_offset, std::string *value) {
+  if (!metadata.IsCompressedBitmap()) return rocksdb::Status::OK();
+
+  std::string bytes;
+  auto s = DecodeSegment(*value, &bytes);
+  if (!s.ok()) return s;
+  if (metadata.size > segment_offset) {
+    auto padded_size = std::min(metadata.size - segment_offset, static_cast<uint64_t>(kBitmapSegmentBytes));
+    if (bytes.size() < padded_size) bytes.resize(padded_size, 0);
+  }
+  *value = std::move(bytes);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Bitmap::decodeSegment(const Metadata &metadata, uint32_t segment_offset,
+                                      rocksdb::PinnableSlice *value) {
+  if (!metadata.IsCompressedBitmap()) return rocksdb::Status::OK();
+
+  std::string bytes = value->ToString();
+  auto s = decodeSegment(metadata, segment_offset, &bytes);
+  if (!s.ok()) return s;
+  value->Reset();
+  value->PinSelf(bytes);
+  return rocksdb::Status::OK();
 }
 }  // namespace redis
@@ -28,10 +28,6 @@
 #include "storage/redis_db.h"
 #include "storage/redis_metadata.h"
 
-#if defined(__sparc__) || defined(__arm__)
-#define USE_ALIGNED_ACCESS
-#endif
-
 enum BitOpFlags {
   kBitOpAnd,
   kBitOpOr,
@@ -48,6 +44,9 @@ class Bitmap : public Database {
  public:
   class SegmentCacheStore;
 
+  // The subkeys of the popcount summary start with it, which doesn't collide with the offsets of the segments
+  static constexpr const char *kSummarySubKeyPrefix = "summary";
+
   Bitmap(engine::Storage *storage, const std::string &ns) : Database(storage, ns) {}
   rocksdb::Status GetBit(const Slice &user_key, uint32_t bit_offset, bool *bit);
   rocksdb::Status GetString(const Slice &user_key, uint32_t max_btos_size, std::string *value);
@@ -68,6 +67,12 @@ class Bitmap : public Database {
   }
   static bool GetBitFromValueAndOffset(std::string_view value, uint32_t bit_offset);
   static bool IsEmptySegment(const Slice &segment);
+  static bool IsSummarySubKey(const Slice &sub_key);
+  // Encode the bytes of a segment of a compressed bitmap into the container taking the least space:
+  // the bytes, the sorted offsets of the set bits, or the runs of set bits, after a byte of its type
+  static void EncodeSegment(const Slice &bytes, std::string *dst);
+  // Decode a segment of a compressed bitmap into its bytes, without the trailing zero bytes
+  static rocksdb::Status DecodeSegment(const Slice &value, std::string *bytes);
 
  private:
   template <bool ReadOnly>
@@ -76,6 +81,13 @@ class Bitmap : public Database {
   static bool bitfieldWriteAheadLog(const ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch,
                                     const std::vector<BitfieldOperation> &ops);
   rocksdb::Status GetMetadata(const Slice &ns_key, BitmapMetadata *metadata, std::string *raw_value);
+  // Set the flags of a bitmap to be created from the configuration
+  void initMetadata(BitmapMetadata *metadata) const;
+  // Decode the segment at `segment_offset` read from the bitmap if it's compressed, which is then
+  // padded with zeros to the size of the bitmap like the raw segments
+  static rocksdb::Status decodeSegment(const Metadata &metadata, uint32_t segment_offset, std::string *value);
+  static rocksdb::Status decodeSegment(const Metadata &metadata, uint32_t segment_offset,
+                                       rocksdb::PinnableSlice *value);
 
   template <bool ReadOnly>
   static rocksdb::Status runBitfieldOperationsWithCache(SegmentCacheStore &cache,
@@ -20,44 +20,205 @@
 
 #include "redis_bloom_chain.h"
 
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <set>
+
 #include "types/bloom_filter.h"
 
 namespace redis {
 
-rocksdb::Status BloomChain::getBloomChainMetadata(const Slice &ns_key, BloomChainMetadata *metadata) {
-  return Database::GetMetadata({kRedisBloomFilter}, ns_key, metadata);
+// The number of bytes of the sub-filter at `filters_index`, whose capacity is the one of the previous
+// sub-filter multiplied by the expansion
+static uint32_t GetBloomFilterBytes(const BloomChainMetadata &metadata, uint16_t filters_index) {
+  return BlockSplitBloomFilter::OptimalNumOfBytes(
+      static_cast<uint32_t>(metadata.base_capacity * pow(metadata.expansion, filters_index)), metadata.error_rate);
 }
 
-std::string BloomChain::getBFKey(const Slice &ns_key, const BloomChainMetadata &metadata, uint16_t filters_index) {
-  std::string sub_key;
-  PutFixed16(&sub_key, filters_index);
-  std::string bf_key = InternalKey(ns_key, sub_key, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  return bf_key;
-}
+// BloomFilterPages reads and updates the blocks probed by a command in the sub-filters of a bloom filter.
+// The pages of the blocks are read at once, and only the updated ones are written. A page is the whole
+// sub-filter if the bloom filter isn't paged.
+class BloomFilterPages {
+ public:
+  BloomFilterPages(engine::Storage *storage, std::string ns_key, const BloomChainMetadata &metadata,
+                   rocksdb::ReadOptions read_options)
+      : storage_(storage),
+        ns_key_(std::move(ns_key)),
+        version_(metadata.version),
+        paged_(metadata.IsPagedBloomFilter()),
+        read_options_(std::move(read_options)) {
+    for (uint16_t i = 0; i < metadata.n_filters; ++i) {
+      filter_bytes_.push_back(GetBloomFilterBytes(metadata, i));
+    }
+  }
 
-void BloomChain::getBFKeyList(const Slice &ns_key, const BloomChainMetadata &metadata,
-                              std::vector<std::string> *bf_key_list) {
-  bf_key_list->reserve(metadata.n_filters);
-  for (uint16_t i = 0; i < metadata.n_filters; ++i) {
-    std::string bf_key = getBFKey(ns_key, metadata, i);
-    bf_key_list->push_back(std::move(bf_key));
+  // Add an empty sub-filter after the existing ones
+  void AddFilter(uint32_t bytes) {
+    auto filters_index = static_cast<uint16_t>(filter_bytes_.size());
+    filter_bytes_.push_back(bytes);
+    if (!paged_) pages_[{filters_index, 0}] = {std::string(bytes, 0), true};
   }
-}
 
-rocksdb::Status BloomChain::getBFDataList(const std::vector<std::string> &bf_key_list,
-                                          std::vector<rocksdb::PinnableSlice> *bf_data_list) {
-  LatestSnapShot ss(storage_);
-  rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
+  // Read the pages of the blocks of the hashes in all the sub-filters with a MultiGet
+  rocksdb::Status Fetch(const std::vector<uint64_t> &hashes) {
+    std::set<PageId> page_ids;
+    for (auto hash : hashes) {
+      for (uint16_t i = 0; i < filter_bytes_.size(); ++i) {
+        PageId page_id{i, pageIndex(hash, i)};
+        if (pages_.count(page_id) == 0) page_ids.insert(page_id);
+      }
+    }
 
-  bf_data_list->reserve(bf_key_list.size());
-  for (const auto &bf_key : bf_key_list) {
-    rocksdb::PinnableSlice pin_value;
-    rocksdb::Status s = storage_->Get(read_options, bf_key, &pin_value);
+    std::vector<std::string> keys;
+    keys.reserve(page_ids.size());
+    for (const auto &page_id : page_ids) keys.emplace_back(pageKey(page_id));
+    std::vector<Slice> key_slices(keys.begin(), keys.end());
+    std::vector<rocksdb::PinnableSlice> values(keys.size());
+    std::vector<rocksdb::Status> statuses(keys.size());
+    storage_->MultiGet(read_options_, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), keys.size(),
+                       key_slices.data(), values.data(), statuses.data());
+    size_t i = 0;
+    for (const auto &page_id : page_ids) {
+      auto s = loaded(page_id, statuses[i], values[i]);
+      if (!s.ok()) return s;
+      i++;
+    }
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status Find(uint64_t hash, uint16_t filters_index, bool *exist) {
+    char *block = nullptr;
+    auto s = getBlock(hash, filters_index, /*mut=*/false, &block);
     if (!s.ok()) return s;
-    bf_data_list->push_back(std::move(pin_value));
+    *exist = BlockSplitBloomFilter::FindHashInBlock(hash, block);
+    return rocksdb::Status::OK();
   }
-  return rocksdb::Status::OK();
+
+  // Find all the hashes in the sub-filters from the last one, each sub-filter is only probed for
+  // the hashes not found in the ones after it
+  rocksdb::Status FindAll(const std::vector<uint64_t> &hashes, std::vector<bool> *exists) {
+    std::vector<size_t> pending(hashes.size());
+    std::iota(pending.begin(), pending.end(), 0);
+    std::vector<std::pair<const char *, size_t>> probes;
+    std::vector<uint64_t> probe_hashes;
+    std::vector<const char *> blocks;
+    std::vector<uint8_t> found;
+    for (int i = static_cast<int>(filter_bytes_.size()) - 1; i >= 0 && !pending.empty(); --i) {
+      probes.clear();
+      for (auto item : pending) {
+        char *block = nullptr;
+        auto s = getBlock(hashes[item], i, /*mut=*/false, &block);
+        if (!s.ok()) return s;
+        probes.emplace_back(block, item);
+      }
+      // The probes are grouped by their blocks, which are then visited in the order of the pages
+      std::sort(probes.begin(), probes.end());
+
+      probe_hashes.clear();
+      blocks.clear();
+      for (const auto &[block, item] : probes) {
+        probe_hashes.push_back(hashes[item]);
+        blocks.push_back(block);
+      }
+      found.resize(probes.size());
+      BlockSplitBloomFilter::FindHashesInBlocks(probe_hashes.data(), blocks.data(), probes.size(), found.data());
+
+      pending.clear();
+      for (size_t j = 0; j < probes.size(); ++j) {
+        if (found[j]) {
+          (*exists)[probes[j].second] = true;
+        } else {
+          pending.push_back(probes[j].second);
+        }
+      }
+    }
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status Insert(uint64_t hash, uint16_t filters_index) {
+    char *block = nullptr;
+    auto s = getBlock(hash, filters_index, /*mut=*/true, &block);
+    if (!s.ok()) return s;
+    BlockSplitBloomFilter::InsertHashInBlock(hash, block);
+    return rocksdb::Status::OK();
+  }
+
+  // Write the updated pages
+  void Save(rocksdb::WriteBatchBase *batch) {
+    for (auto &[page_id, page] : pages_) {
+      if (page.dirty) batch->Put(pageKey(page_id), page.data);
+      page.dirty = false;
+    }
+  }
+
+ private:
+  // The index of the sub-filter and the index of the page in it
+  using PageId = std::pair<uint16_t, uint32_t>;
+
+  struct Page {
+    std::string data;
+    bool dirty = false;
+  };
+
+  uint32_t pageIndex(uint64_t hash, uint16_t filters_index) const {
+    if (!paged_) return 0;
+    return BlockSplitBloomFilter::BlockOffset(hash, filter_bytes_[filters_index]) / kBFPageBytes;
+  }
+
+  std::string pageKey(const PageId &page_id) const {
+    std::string sub_key;
+    PutFixed16(&sub_key, page_id.first);
+    if (paged_) PutFixed32(&sub_key, page_id.second);
+    return InternalKey(ns_key_, sub_key, version_, storage_->IsSlotIdEncoded()).Encode();
+  }
+
+  // A page that was never written is all zeros, while a sub-filter that isn't paged always exists
+  rocksdb::Status loaded(const PageId &page_id, const rocksdb::Status &s, const rocksdb::PinnableSlice &value) {
+    if (!s.ok() && !(s.IsNotFound() && paged_)) return s;
+    pages_[page_id].data = s.ok() ? value.ToString() : std::string();
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status getBlock(uint64_t hash, uint16_t filters_index, bool mut, char **block) {
+    PageId page_id{filters_index, pageIndex(hash, filters_index)};
+    auto iter = pages_.find(page_id);
+    if (iter == pages_.end()) {
+      rocksdb::PinnableSlice value;
+      auto s = storage_->Get(read_options_, pageKey(page_id), &value);
+      s = loaded(page_id, s, value);
+      if (!s.ok()) return s;
+      iter = pages_.find(page_id);
+    }
+
+    auto &page = iter->second;
+    uint32_t filter_bytes = filter_bytes_[filters_index];
+    uint32_t offset = 0;
+    if (paged_) {
+      if (page.data.empty()) page.data.assign(std::min(filter_bytes, kBFPageBytes), 0);
+      offset = BlockSplitBloomFilter::BlockOffset(hash, filter_bytes) % kBFPageBytes;
+    } else {
+      offset = BlockSplitBloomFilter::BlockOffset(hash, page.data.size());
+    }
+    if (offset + BlockSplitBloomFilter::kBytesPerFilterBlock > page.data.size()) {
+      return rocksdb::Status::Corruption("invalid bloom filter page");
+    }
+    page.dirty |= mut;
+    *block = page.data.data() + offset;
+    return rocksdb::Status::OK();
+  }
+
+  engine::Storage *storage_;
+  std::string ns_key_;
+  uint64_t version_;
+  bool paged_;
+  rocksdb::ReadOptions read_options_;
+  std::vector<uint32_t> filter_bytes_;
+  std::map<PageId, Page> pages_;
+};
+
+rocksdb::Status BloomChain::getBloomChainMetadata(const Slice &ns_key, BloomChainMetadata *metadata) {
+  return Database::GetMetadata({kRedisBloomFilter}, ns_key, metadata);
 }
 
 void BloomChain::getItemHashList(const std::vector<std::string> &items, std::vector<uint64_t> *item_hash_list) {
@@ -69,56 +230,42 @@ void BloomChain::getItemHashList(const std::vector<std::string> &items, std::vec
 
 rocksdb::Status BloomChain::createBloomChain(const Slice &ns_key, double error_rate, uint32_t capacity,
                                              uint16_t expansion, BloomChainMetadata *metadata) {
-  metadata->n_filters = 1;
+  metadata->n_filters = 0;
   metadata->expansion = expansion;
   metadata->size = 0;
 
   metadata->error_rate = error_rate;
   metadata->base_capacity = capacity;
-  metadata->bloom_bytes = BlockSplitBloomFilter::OptimalNumOfBytes(capacity, error_rate);
-
-  auto [block_split_bloom_filter, _] = CreateBlockSplitBloomFilter(metadata->bloom_bytes);
+  metadata->bloom_bytes = 0;
+  if (storage_->GetConfig()->bloom_filter_paged) {
+    metadata->flags |= METADATA_BLOOM_PAGED_MASK;
+  }
 
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisBloomFilter, {"createBloomChain"});
   batch->PutLogData(log_data.Encode());
 
-  std::string bloom_chain_meta_bytes;
-  metadata->Encode(&bloom_chain_meta_bytes);
-  batch->Put(metadata_cf_handle_, ns_key, bloom_chain_meta_bytes);
-
-  std::string bf_key = getBFKey(ns_key, *metadata, metadata->n_filters - 1);
-  batch->Put(bf_key, block_split_bloom_filter.GetData());
+  // The pages of an empty paged sub-filter are only written once they have any bits
+  BloomFilterPages pages(storage_, ns_key.ToString(), *metadata, rocksdb::ReadOptions());
+  createBloomFilterInBatch(ns_key, metadata, batch, &pages);
+  pages.Save(batch.Get());
 
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
 void BloomChain::createBloomFilterInBatch(const Slice &ns_key, BloomChainMetadata *metadata,
-                                          ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch, std::string *bf_data) {
-  uint32_t bloom_filter_bytes = BlockSplitBloomFilter::OptimalNumOfBytes(
-      static_cast<uint32_t>(metadata->base_capacity * pow(metadata->expansion, metadata->n_filters)),
-      metadata->error_rate);
+                                          ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch,
+                                          BloomFilterPages *pages) {
+  uint32_t bloom_filter_bytes = GetBloomFilterBytes(*metadata, metadata->n_filters);
   metadata->n_filters += 1;
   metadata->bloom_bytes += bloom_filter_bytes;
-
-  std::tie(std::ignore, *bf_data) = CreateBlockSplitBloomFilter(bloom_filter_bytes);
+  pages->AddFilter(bloom_filter_bytes);
 
   std::string bloom_chain_meta_bytes;
   metadata->Encode(&bloom_chain_meta_bytes);
   batch->Put(metadata_cf_handle_, ns_key, bloom_chain_meta_bytes);
 }
 
-void BloomChain::bloomAdd(uint64_t item_hash, std::string &bf_data) {
-  BlockSplitBloomFilter block_split_bloom_filter(bf_data);
-  block_split_bloom_filter.InsertHash(item_hash);
-}
-
-bool BloomChain::bloomCheck(uint64_t item_hash, std::string_view &bf_data) {
-  const BlockSplitBloomFilter block_split_bloom_filter(
-      nonstd::span<char>(const_cast<char *>(bf_data.data()), bf_data.size()));
-  return block_split_bloom_filter.FindHash(item_hash);
-}
-
 rocksdb::Status BloomChain::Reserve(const Slice &user_key, uint32_t capacity, double error_rate, uint16_t expansion) {
   std::string ns_key = AppendNamespacePrefix(user_key);
 
@@ -161,16 +308,16 @@ rocksdb::Status BloomChain::InsertCommon(const Slice &user_key, const std::vecto
   }
   if (!s.ok()) return s;
 
-  std::vector<std::string> bf_key_list;
-  getBFKeyList(ns_key, metadata, &bf_key_list);
-
-  std::vector<rocksdb::PinnableSlice> bf_data_list;
-  s = getBFDataList(bf_key_list, &bf_data_list);
-  if (!s.ok()) return s;
-
   std::vector<uint64_t> item_hash_list;
   getItemHashList(items, &item_hash_list);
 
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
+  read_options.snapshot = ss.GetSnapShot();
+  BloomFilterPages pages(storage_, ns_key, metadata, read_options);
+  s = pages.Fetch(item_hash_list);
+  if (!s.ok()) return s;
+
   uint64_t origin_size = metadata.size;
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisBloomFilter, {"insert"});
@@ -180,9 +327,9 @@ rocksdb::Status BloomChain::InsertCommon(const Slice &user_key, const std::vecto
     // check
     bool exist = false;
     // TODO: to test which direction for searching is better
-    for (int ii = static_cast<int>(bf_data_list.size()) - 1; ii >= 0; --ii) {
-      std::string_view data = bf_data_list[ii].ToStringView();
-      exist = bloomCheck(item_hash_list[i], data);
+    for (int ii = static_cast<int>(metadata.n_filters) - 1; ii >= 0; --ii) {
+      s = pages.Find(item_hash_list[i], ii, &exist);
+      if (!s.ok()) return s;
       if (exist) break;
     }
 
@@ -192,23 +339,14 @@ rocksdb::Status BloomChain::InsertCommon(const Slice &user_key, const std::vecto
     } else {
       if (metadata.size + 1 > metadata.GetCapacity()) {
         if (metadata.IsScaling()) {
-          batch->Put(bf_key_list.back(), bf_data_list.back().ToStringView());
-          std::string bf_data;
-          createBloomFilterInBatch(ns_key, &metadata, batch, &bf_data);
-          rocksdb::PinnableSlice pin_slice;
-          *pin_slice.GetSelf() = std::move(bf_data);
-          pin_slice.PinSelf();
-          bf_data_list.push_back(std::move(pin_slice));
-          bf_key_list.push_back(getBFKey(ns_key, metadata, metadata.n_filters - 1));
+          createBloomFilterInBatch(ns_key, &metadata, batch, &pages);
         } else {
           (*rets)[i] = BloomFilterAddResult::kFull;
           continue;
         }
       }
-      std::string data = bf_data_list.back().ToString();
-      bloomAdd(item_hash_list[i], data);
-      *bf_data_list.back().GetSelf() = std::move(data);
-      bf_data_list.back().PinSelf();
+      s = pages.Insert(item_hash_list[i], metadata.n_filters - 1);
+      if (!s.ok()) return s;
       (*rets)[i] = BloomFilterAddResult::kOk;
       metadata.size += 1;
     }
@@ -218,7 +356,7 @@ rocksdb::Status BloomChain::InsertCommon(const Slice &user_key, const std::vecto
     std::string bloom_chain_metadata_bytes;
     metadata.Encode(&bloom_chain_metadata_bytes);
     batch->Put(metadata_cf_handle_, ns_key, bloom_chain_metadata_bytes);
-    batch->Put(bf_key_list.back(), bf_data_list.back().ToStringView());
+    pages.Save(batch.Get());
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -242,27 +380,20 @@ rocksdb::Status BloomChain::MExists(const Slice &user_key, const std::vector<std
   }
   if (!s.ok()) return s;
 
-  std::vector<std::string> bf_key_list;
-  getBFKeyList(ns_key, metadata, &bf_key_list);
-
-  std::vector<rocksdb::PinnableSlice> bf_data_list;
-  s = getBFDataList(bf_key_list, &bf_data_list);
-  if (!s.ok()) return s;
-
   std::vector<uint64_t> item_hash_list;
   getItemHashList(items, &item_hash_list);
 
-  for (size_t i = 0; i < items.size(); ++i) {
-    // check
-    // TODO: to test which direction for searching is better
-    for (int ii = static_cast<int>(bf_data_list.size()) - 1; ii >= 0; --ii) {
-      std::string_view data = bf_data_list[ii].ToStringView();
-      (*exists)[i] = bloomCheck(item_hash_list[i], data);
-      if ((*exists)[i]) break;
-    }
-  }
+  // Only the pages of the probed blocks are read, at once
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
+  read_options.snapshot = ss.GetSnapShot();
+  BloomFilterPages pages(storage_, ns_key, metadata, read_options);
+  s = pages.Fetch(item_hash_list);
+  if (!s.ok()) return s;
 
-  return rocksdb::Status::OK();
+  std::fill(exists->begin(), exists->end(), false);
+  // TODO: to test which direction for searching is better
+  return pages.FindAll(item_hash_list, exists);
 }
 
 rocksdb::Status BloomChain::Info(const Slice &user_key, BloomFilterInfo *info) {
@@ -29,6 +29,8 @@ namespace redis {
 const uint32_t kBFDefaultInitCapacity = 100;
 const double kBFDefaultErrorRate = 0.01;
 const uint16_t kBFDefaultExpansion = 2;
+// The number of bytes of a page of a paged bloom filter, see BloomChainMetadata
+const uint32_t kBFPageBytes = 4096;
 
 enum class BloomInfoType {
   kAll,
@@ -60,6 +62,8 @@ struct BloomFilterInfo {
   uint16_t expansion;
 };
 
+class BloomFilterPages;
+
 class BloomChain : public Database {
  public:
   BloomChain(engine::Storage *storage, const std::string &ns) : Database(storage, ns) {}
@@ -75,20 +79,11 @@ class BloomChain : public Database {
 
  private:
   rocksdb::Status getBloomChainMetadata(const Slice &ns_key, BloomChainMetadata *metadata);
-  std::string getBFKey(const Slice &ns_key, const BloomChainMetadata &metadata, uint16_t filters_index);
-  void getBFKeyList(const Slice &ns_key, const BloomChainMetadata &metadata, std::vector<std::string> *bf_key_list);
-  rocksdb::Status getBFDataList(const std::vector<std::string> &bf_key_list,
-                                std::vector<rocksdb::PinnableSlice> *bf_data_list);
   static void getItemHashList(const std::vector<std::string> &items, std::vector<uint64_t> *item_hash_list);
 
   rocksdb::Status createBloomChain(const Slice &ns_key, double error_rate, uint32_t capacity, uint16_t expansion,
                                    BloomChainMetadata *metadata);
   void createBloomFilterInBatch(const Slice &ns_key, BloomChainMetadata *metadata,
-                                ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch, std::string *bf_data);
-
-  /// bf_data: [in/out] The content string of bloomfilter.
-  static void bloomAdd(uint64_t item_hash, std::string &bf_data);
-
-  static bool bloomCheck(uint64_t item_hash, std::string_view &bf_data);
+                                ObserverOrUniquePtr<rocksdb::WriteBatchBase> &batch, BloomFilterPages *pages);
 };
 }  // namespace redis
@@ -54,58 +54,90 @@ rocksdb::Status Hash::Get(const Slice &user_key, const Slice &field, std::string
   HashMetadata metadata(false);
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok()) return s;
-  LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
-  std::string sub_key = InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  return storage_->Get(read_options, sub_key, value);
+  return getSubKey(read_options, ns_key, metadata, field, value);
 }
 
 rocksdb::Status Hash::IncrBy(const Slice &user_key, const Slice &field, int64_t increment, int64_t *new_value) {
-  bool exists = false;
-  int64_t old_value = 0;
-
   std::string ns_key = AppendNamespacePrefix(user_key);
+  auto apply = [this, &ns_key, &field](const std::vector<engine::IncrementCombiner::Increment *> &increments) {
+    applyIncrements(ns_key, field, increments);
+  };
+  // The writes of a transaction or a script go into its own write batch, so they can't be combined
+  // with others. Its keys are also locked by this thread, the leader of a combined group would wait
+  // for the lock while this thread waits for the group.
+  if (storage_->IsTxnMode() || txn_held_locks) {
+    engine::IncrementCombiner::Increment inc{increment};
+    apply({&inc});
+    if (inc.status.ok()) *new_value = inc.new_value;
+    return inc.status;
+  }
+
+  std::string counter = "h";
+  PutFixed32(&counter, static_cast<uint32_t>(ns_key.size()));
+  counter.append(ns_key);
+  counter.append(field.data(), field.size());
+  return storage_->GetIncrementCombiner()->IncrBy(counter, increment, new_value, apply);
+}
+
+void Hash::applyIncrements(const std::string &ns_key, const Slice &field,
+                           const std::vector<engine::IncrementCombiner::Increment *> &increments) {
+  auto fail_all = [&increments](const rocksdb::Status &s) {
+    for (auto *inc : increments) inc->status = s;
+  };
+  bool exists = false;
+  int64_t value = 0;
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   HashMetadata metadata;
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
-  if (!s.ok() && !s.IsNotFound()) return s;
+  if (!s.ok() && !s.IsNotFound()) return fail_all(s);
+  if (s.IsNotFound()) initInlineEncoding(&metadata);
 
-  std::string sub_key = InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode();
   if (s.ok()) {
     std::string value_bytes;
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value_bytes);
-    if (!s.ok() && !s.IsNotFound()) return s;
+    s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, field, &value_bytes);
+    if (!s.ok() && !s.IsNotFound()) return fail_all(s);
     if (s.ok()) {
       auto parse_result = ParseInt<int64_t>(value_bytes, 10);
       if (!parse_result) {
-        return rocksdb::Status::InvalidArgument(parse_result.Msg());
+        return fail_all(rocksdb::Status::InvalidArgument(parse_result.Msg()));
       }
       if (isspace(value_bytes[0])) {
-        return rocksdb::Status::InvalidArgument("value is not an integer");
+        return fail_all(rocksdb::Status::InvalidArgument("value is not an integer"));
       }
-      old_value = *parse_result;
+      value = *parse_result;
       exists = true;
     }
   }
-  if ((increment < 0 && old_value < 0 && increment < (LLONG_MIN - old_value)) ||
-      (increment > 0 && old_value > 0 && increment > (LLONG_MAX - old_value))) {
-    return rocksdb::Status::InvalidArgument("increment or decrement would overflow");
+
+  bool updated = false;
+  for (auto *inc : increments) {
+    int64_t increment = inc->delta;
+    if ((increment < 0 && value < 0 && increment < (LLONG_MIN - value)) ||
+        (increment > 0 && value > 0 && increment > (LLONG_MAX - value))) {
+      inc->status = rocksdb::Status::InvalidArgument("increment or decrement would overflow");
+      continue;
+    }
+    value += increment;
+    inc->new_value = value;
+    updated = true;
   }
+  if (!updated) return;
 
-  *new_value = old_value + increment;
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisHash);
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, std::to_string(*new_value));
-  if (!exists) {
-    metadata.size += 1;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+  putSubKey(batch.Get(), ns_key, &metadata, field, std::to_string(value));
+  if (!exists) metadata.size += 1;
+  // the fields of an inline hash are in the metadata, so it's rewritten by any update
+  if (!exists || metadata.IsInlineEncoded()) putCollectionMetadata(batch.Get(), ns_key, &metadata);
+  s = storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  if (!s.ok()) {
+    for (auto *inc : increments) {
+      if (inc->status.ok()) inc->status = s;
+    }
   }
-  return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
 rocksdb::Status Hash::IncrByFloat(const Slice &user_key, const Slice &field, double increment, double *new_value) {
@@ -118,11 +150,11 @@ rocksdb::Status Hash::IncrByFloat(const Slice &user_key, const Slice &field, dou
   HashMetadata metadata;
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok() && !s.IsNotFound()) return s;
+  if (s.IsNotFound()) initInlineEncoding(&metadata);
 
-  std::string sub_key = InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode();
   if (s.ok()) {
     std::string value_bytes;
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value_bytes);
+    s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, field, &value_bytes);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.ok()) {
       auto value_stat = ParseFloat(value_bytes);
@@ -142,13 +174,9 @@ rocksdb::Status Hash::IncrByFloat(const Slice &user_key, const Slice &field, dou
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisHash);
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, std::to_string(*new_value));
-  if (!exists) {
-    metadata.size += 1;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
-  }
+  putSubKey(batch.Get(), ns_key, &metadata, field, std::to_string(*new_value));
+  if (!exists) metadata.size += 1;
+  if (!exists || metadata.IsInlineEncoded()) putCollectionMetadata(batch.Get(), ns_key, &metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -164,9 +192,15 @@ rocksdb::Status Hash::MGet(const Slice &user_key, const std::vector<Slice> &fiel
     return s;
   }
 
-  LatestSnapShot ss(storage_);
+  if (metadata.IsInlineEncoded()) {
+    for (const auto &field : fields) {
+      values->emplace_back();
+      statuses->emplace_back(getSubKey(rocksdb::ReadOptions(), ns_key, metadata, field, &values->back()));
+    }
+    return rocksdb::Status::OK();
+  }
+
   rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
-  read_options.snapshot = ss.GetSnapShot();
   std::vector<rocksdb::Slice> keys;
 
   keys.reserve(fields.size());
@@ -214,20 +248,17 @@ rocksdb::Status Hash::Delete(const Slice &user_key, const std::vector<Slice> &fi
     if (!field_set.emplace(field.ToStringView()).second) {
       continue;
     }
-    std::string sub_key = InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, field, &value);
     if (s.ok()) {
       *deleted_cnt += 1;
-      batch->Delete(sub_key);
+      deleteSubKey(batch.Get(), ns_key, &metadata, field);
     }
   }
   if (*deleted_cnt == 0) {
     return rocksdb::Status::OK();
   }
   metadata.size -= *deleted_cnt;
-  std::string bytes;
-  metadata.Encode(&bytes);
-  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  putCollectionMetadata(batch.Get(), ns_key, &metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -240,8 +271,10 @@ rocksdb::Status Hash::MSet(const Slice &user_key, const std::vector<FieldValue>
   HashMetadata metadata;
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok() && !s.IsNotFound()) return s;
+  if (s.IsNotFound()) initInlineEncoding(&metadata);
 
   int added = 0;
+  bool updated = false;
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisHash);
   batch->PutLogData(log_data.Encode());
@@ -252,11 +285,9 @@ rocksdb::Status Hash::MSet(const Slice &user_key, const std::vector<FieldValue>
     }
 
     bool exists = false;
-    std::string sub_key = InternalKey(ns_key, it->field, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-
     if (metadata.size > 0) {
       std::string field_value;
-      s = storage_->Get(rocksdb::ReadOptions(), sub_key, &field_value);
+      s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, it->field, &field_value);
       if (!s.ok() && !s.IsNotFound()) return s;
 
       if (s.ok()) {
@@ -268,15 +299,16 @@ rocksdb::Status Hash::MSet(const Slice &user_key, const std::vector<FieldValue>
 
     if (!exists) added++;
 
-    batch->Put(sub_key, it->value);
+    putSubKey(batch.Get(), ns_key, &metadata, it->field, it->value);
+    updated = true;
   }
 
   if (added > 0) {
     *added_cnt = added;
     metadata.size += added;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+  }
+  if (added > 0 || (updated && metadata.IsInlineEncoded())) {
+    putCollectionMetadata(batch.Get(), ns_key, &metadata);
   }
 
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
@@ -306,7 +338,7 @@ rocksdb::Status Hash::RangeByLex(const Slice &user_key, const RangeLexSpec &spec
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = newSubKeyIterator(ns_key, metadata, read_options);
   if (!spec.reversed) {
     iter->Seek(start_key);
   } else {
@@ -344,34 +376,57 @@ rocksdb::Status Hash::RangeByLex(const Slice &user_key, const RangeLexSpec &spec
 rocksdb::Status Hash::GetAll(const Slice &user_key, std::vector<FieldValue> *field_values, HashFetchType type) {
   field_values->clear();
 
+  return GetAll(
+      user_key, [field_values](uint64_t size) { field_values->reserve(size); },
+      [field_values, type](const Slice &field, const Slice &value) {
+        if (type == HashFetchType::kOnlyKey) {
+          field_values->emplace_back(field.ToString(), "");
+        } else if (type == HashFetchType::kOnlyValue) {
+          field_values->emplace_back("", value.ToString());
+        } else {
+          field_values->emplace_back(field.ToString(), value.ToString());
+        }
+      });
+}
+
+rocksdb::Status Hash::GetAll(const Slice &user_key, const std::function<void(uint64_t)> &size_cb,
+                             const std::function<void(const Slice &, const Slice &)> &field_cb) {
   std::string ns_key = AppendNamespacePrefix(user_key);
+
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options;
+  read_options.snapshot = ss.GetSnapShot();
+  // Read the metadata in the same snapshot as the fields, it's the state
+  // of the hash when the iteration below starts.
+  std::string raw_metadata;
   HashMetadata metadata(false);
-  rocksdb::Status s = GetMetadata(ns_key, &metadata);
-  if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
+  rocksdb::Status s = storage_->Get(read_options, metadata_cf_handle_, ns_key, &raw_metadata);
+  if (s.ok()) {
+    Slice rest = raw_metadata;
+    s = ParseMetadata({kRedisHash}, &rest, &metadata);
+  }
+  if (!s.ok()) {
+    if (!s.IsNotFound()) return s;
+    size_cb(0);
+    return rocksdb::Status::OK();
+  }
+  size_cb(metadata.size);
 
   std::string prefix_key = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
   std::string next_version_prefix_key =
       InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode();
 
-  rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
+  rocksdb::ReadOptions scan_options = storage_->DefaultScanOptions();
+  scan_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix_key);
-  read_options.iterate_upper_bound = &upper_bound;
+  scan_options.iterate_upper_bound = &upper_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = newSubKeyIterator(ns_key, metadata, scan_options);
   for (iter->Seek(prefix_key); iter->Valid() && iter->key().starts_with(prefix_key); iter->Next()) {
-    if (type == HashFetchType::kOnlyKey) {
-      InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
-      field_values->emplace_back(ikey.GetSubKey().ToString(), "");
-    } else if (type == HashFetchType::kOnlyValue) {
-      field_values->emplace_back("", iter->value().ToString());
-    } else {
-      InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
-      field_values->emplace_back(ikey.GetSubKey().ToString(), iter->value().ToString());
-    }
+    InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
+    field_cb(ikey.GetSubKey(), iter->value());
   }
-  return rocksdb::Status::OK();
+  return iter->status();
 }
 
 rocksdb::Status Hash::Scan(const Slice &user_key, const std::string &cursor, uint64_t limit,
@@ -22,6 +22,7 @@
 
 #include <rocksdb/status.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -58,6 +59,11 @@ class Hash : public SubKeyScanner {
                        std::vector<rocksdb::Status> *statuses);
   rocksdb::Status GetAll(const Slice &user_key, std::vector<FieldValue> *field_values,
                          HashFetchType type = HashFetchType::kAll);
+  // Iterate all fields without copying them, `size_cb` is called with the number of fields expected
+  // by the metadata before the first `field_cb`, and both of them come from the same snapshot. The
+  // number of fields iterated may still differ from it, e.g. if some subkeys are missing.
+  rocksdb::Status GetAll(const Slice &user_key, const std::function<void(uint64_t)> &size_cb,
+                         const std::function<void(const Slice &, const Slice &)> &field_cb);
   rocksdb::Status Scan(const Slice &user_key, const std::string &cursor, uint64_t limit,
                        const std::string &field_prefix, std::vector<std::string> *fields,
                        std::vector<std::string> *values = nullptr);
@@ -66,6 +72,8 @@ class Hash : public SubKeyScanner {
 
  private:
   rocksdb::Status GetMetadata(const Slice &ns_key, HashMetadata *metadata);
+  void applyIncrements(const std::string &ns_key, const Slice &field,
+                       const std::vector<engine::IncrementCombiner::Increment *> &increments);
 
   friend struct FieldValueRetriever;
 };
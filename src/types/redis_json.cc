@@ -20,28 +20,126 @@
 
 #include "redis_json.h"
 
+#include <cctype>
+#include <optional>
+
+#include "db_util.h"
 #include "json.h"
 #include "lock_manager.h"
 #include "storage/redis_metadata.h"
 
 namespace redis {
 
-rocksdb::Status Json::write(Slice ns_key, JsonMetadata *metadata, const JsonValue &json_val) {
+namespace {
+
+// The member of the root object that `path` starts with, if it's named plainly like in `$.name`
+// or `$['name']`, so that the path only reaches into that member
+std::optional<std::string> PathRootMember(std::string_view path) {
+  if (path.size() < 2 || path[0] != '$') return std::nullopt;
+
+  std::string name;
+  size_t pos = 0;
+  if (path[1] == '.') {
+    pos = 2;
+    while (pos < path.size() && (std::isalnum(static_cast<unsigned char>(path[pos])) || path[pos] == '_')) pos++;
+    name = path.substr(2, pos - 2);
+    if (pos < path.size() && path[pos] != '.' && path[pos] != '[') return std::nullopt;
+  } else if (path[1] == '[' && path.size() > 2 && (path[2] == '\'' || path[2] == '"')) {
+    size_t end = path.find(path[2], 3);
+    if (end == std::string_view::npos || end + 1 >= path.size() || path[end + 1] != ']') return std::nullopt;
+    name = path.substr(3, end - 3);
+    if (name.find('\\') != std::string::npos) return std::nullopt;
+    pos = end + 2;
+  } else {
+    return std::nullopt;
+  }
+
+  // the rest of the path may refer to the root again in a filter
+  if (name.empty() || path.find('$', pos) != std::string_view::npos) return std::nullopt;
+  return name;
+}
+
+}  // namespace
+
+rocksdb::Status Json::write(Slice ns_key, JsonMetadata *metadata, const JsonValue &json_val,
+                            const JsonSegments &segments) {
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisJson);
   batch->PutLogData(log_data.Encode());
 
-  auto format = storage_->GetConfig()->json_storage_format;
-  metadata->format = format;
+  // Only the members read are written back, in the format of the others
+  if (metadata->IsSegmentedJson() && !segments.complete) {
+    auto s = writeMembers(batch.Get(), ns_key, metadata, json_val, segments);
+    if (!s.ok()) return s;
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
+  bool was_segmented = metadata->IsSegmentedJson();
+  metadata->flags &= ~METADATA_JSON_SEGMENTED_MASK;
+  metadata->format = storage_->GetConfig()->json_storage_format;
 
   std::string val;
   metadata->Encode(&val);
+  size_t header_size = val.size();
+  auto s = encode(metadata->format, json_val, &val);
+  if (!s.ok()) return s;
+
+  int threshold = storage_->GetConfig()->json_segment_threshold;
+  if (threshold > 0 && val.size() - header_size >= static_cast<size_t>(threshold) && json_val.value.is_object()) {
+    if (was_segmented) {
+      metadata->flags |= METADATA_JSON_SEGMENTED_MASK;
+      s = writeMembers(batch.Get(), ns_key, metadata, json_val, segments);
+    } else {
+      // a new version, so the members left by a former segmented document are never taken for these
+      JsonMetadata segmented_metadata;
+      segmented_metadata.flags |= METADATA_JSON_SEGMENTED_MASK;
+      segmented_metadata.expire = metadata->expire;
+      segmented_metadata.format = metadata->format;
+      *metadata = segmented_metadata;
+      s = writeMembers(batch.Get(), ns_key, metadata, json_val, JsonSegments());
+    }
+    if (!s.ok()) return s;
+  } else {
+    batch->Put(metadata_cf_handle_, ns_key, val);
+  }
+
+  return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+}
 
+rocksdb::Status Json::writeMembers(rocksdb::WriteBatchBase *batch, const Slice &ns_key, JsonMetadata *metadata,
+                                   const JsonValue &json_val, const JsonSegments &segments) {
+  for (const auto &[name, encoded] : segments.members) {
+    if (json_val.value.contains(name)) continue;
+    batch->Delete(InternalKey(ns_key, name, metadata->version, storage_->IsSlotIdEncoded()).Encode());
+    metadata->size -= encoded.size();
+  }
+
+  for (const auto &member : json_val.value.object_range()) {
+    std::string encoded;
+    auto s = encode(metadata->format, JsonValue(member.value()), &encoded);
+    if (!s.ok()) return s;
+
+    uint64_t old_size = 0;
+    if (auto iter = segments.members.find(member.key()); iter != segments.members.end()) {
+      if (iter->second == encoded) continue;
+      old_size = iter->second.size();
+    }
+    batch->Put(InternalKey(ns_key, member.key(), metadata->version, storage_->IsSlotIdEncoded()).Encode(), encoded);
+    metadata->size = metadata->size - old_size + encoded.size();
+  }
+
+  std::string bytes;
+  metadata->Encode(&bytes);
+  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Json::encode(JsonStorageFormat format, const JsonValue &json_val, std::string *dst) {
   Status s;
   if (format == JsonStorageFormat::JSON) {
-    s = json_val.Dump(&val, storage_->GetConfig()->json_max_nesting_depth);
+    s = json_val.Dump(dst, storage_->GetConfig()->json_max_nesting_depth);
   } else if (format == JsonStorageFormat::CBOR) {
-    s = json_val.DumpCBOR(&val, storage_->GetConfig()->json_max_nesting_depth);
+    s = json_val.DumpCBOR(dst, storage_->GetConfig()->json_max_nesting_depth);
   } else {
     return rocksdb::Status::InvalidArgument("JSON storage format not supported");
   }
@@ -49,9 +147,7 @@ rocksdb::Status Json::write(Slice ns_key, JsonMetadata *metadata, const JsonValu
     return rocksdb::Status::InvalidArgument("Failed to encode JSON into storage: " + s.Msg());
   }
 
-  batch->Put(metadata_cf_handle_, ns_key, val);
-
-  return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  return rocksdb::Status::OK();
 }
 
 rocksdb::Status Json::parse(const JsonMetadata &metadata, const Slice &json_bytes, JsonValue *value) {
@@ -71,20 +167,96 @@ rocksdb::Status Json::parse(const JsonMetadata &metadata, const Slice &json_byte
 }
 
 rocksdb::Status Json::read(const Slice &ns_key, JsonMetadata *metadata, JsonValue *value) {
-  std::string bytes;
-  Slice rest;
+  return read(ns_key, {"$"}, metadata, value);
+}
 
-  auto s = GetMetadata({kRedisJson}, ns_key, &bytes, metadata, &rest);
+rocksdb::Status Json::read(const Slice &ns_key, const std::vector<std::string> &paths, JsonMetadata *metadata,
+                           JsonValue *value, JsonSegments *segments) {
+  // The members of a segmented document are read in the same snapshot as its metadata
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options;
+  read_options.snapshot = ss.GetSnapShot();
+  std::string bytes;
+  auto s = storage_->Get(read_options, metadata_cf_handle_, ns_key, &bytes);
+  if (!s.ok()) return s;
+  Slice rest = bytes;
+  s = ParseMetadata({kRedisJson}, &rest, metadata);
   if (!s.ok()) return s;
 
-  return parse(*metadata, rest, value);
+  if (!metadata->IsSegmentedJson()) return parse(*metadata, rest, value);
+
+  std::set<std::string> names;
+  for (const auto &path : paths) {
+    auto name = PathRootMember(path);
+    if (!name) return readMembers(read_options, ns_key, *metadata, nullptr, value, segments);
+    names.emplace(*std::move(name));
+  }
+  return readMembers(read_options, ns_key, *metadata, &names, value, segments);
+}
+
+rocksdb::Status Json::readMembers(const rocksdb::ReadOptions &read_options, const Slice &ns_key,
+                                  const JsonMetadata &metadata, const std::set<std::string> *names, JsonValue *value,
+                                  JsonSegments *segments) {
+  value->value = jsoncons::json::object();
+  if (segments) {
+    segments->members.clear();
+    segments->complete = names == nullptr;
+  }
+  auto add_member = [&](const std::string &name, const Slice &encoded) {
+    JsonValue member;
+    auto s = parse(metadata, encoded, &member);
+    if (!s.ok()) return s;
+    value->value.insert_or_assign(name, std::move(member.value));
+    if (segments) segments->members.emplace(name, encoded.ToString());
+    return rocksdb::Status::OK();
+  };
+
+  if (names) {
+    std::vector<std::string> keys;
+    keys.reserve(names->size());
+    for (const auto &name : *names) {
+      keys.emplace_back(InternalKey(ns_key, name, metadata.version, storage_->IsSlotIdEncoded()).Encode());
+    }
+    std::vector<Slice> key_slices(keys.begin(), keys.end());
+    std::vector<rocksdb::PinnableSlice> values(keys.size());
+    std::vector<rocksdb::Status> statuses(keys.size());
+    storage_->MultiGet(read_options, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_slices.size(),
+                       key_slices.data(), values.data(), statuses.data());
+
+    size_t i = 0;
+    for (const auto &name : *names) {
+      if (statuses[i].ok()) {
+        if (auto s = add_member(name, values[i]); !s.ok()) return s;
+      } else if (!statuses[i].IsNotFound()) {
+        return statuses[i];
+      }
+      i++;
+    }
+    return rocksdb::Status::OK();
+  }
+
+  std::string prefix = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
+  std::string next_version_prefix = InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode();
+  rocksdb::ReadOptions scan_options = storage_->DefaultScanOptions();
+  scan_options.snapshot = read_options.snapshot;
+  rocksdb::Slice upper_bound(next_version_prefix);
+  scan_options.iterate_upper_bound = &upper_bound;
+
+  auto iter = util::UniqueIterator(storage_, scan_options);
+  for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
+    InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
+    if (auto s = add_member(ikey.GetSubKey().ToString(), iter->value()); !s.ok()) return s;
+  }
+  return rocksdb::Status::OK();
 }
 
-rocksdb::Status Json::create(const std::string &ns_key, JsonMetadata &metadata, const std::string &value) {
+rocksdb::Status Json::create(const std::string &ns_key, const std::string &value) {
   auto json_res = JsonValue::FromString(value, storage_->GetConfig()->json_max_nesting_depth);
   if (!json_res) return rocksdb::Status::InvalidArgument(json_res.Msg());
   auto json_val = *std::move(json_res);
 
+  // the metadata of an expired key may be left, so it's not reused
+  JsonMetadata metadata;
   return write(ns_key, &metadata, json_val);
 }
 
@@ -120,12 +292,13 @@ rocksdb::Status Json::Set(const std::string &user_key, const std::string &path,
 
   JsonMetadata metadata;
   JsonValue origin;
-  auto s = read(ns_key, &metadata, &origin);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &origin, &segments);
 
   if (s.IsNotFound()) {
     if (path != "$") return rocksdb::Status::InvalidArgument("new objects must be created at the root");
 
-    return create(ns_key, metadata, value);
+    return create(ns_key, value);
   }
 
   if (!s.ok()) return s;
@@ -137,7 +310,7 @@ rocksdb::Status Json::Set(const std::string &user_key, const std::string &path,
   auto set_res = origin.Set(path, std::move(new_val));
   if (!set_res) return rocksdb::Status::InvalidArgument(set_res.Msg());
 
-  return write(ns_key, &metadata, origin);
+  return write(ns_key, &metadata, origin, segments);
 }
 
 rocksdb::Status Json::Get(const std::string &user_key, const std::vector<std::string> &paths, JsonValue *result) {
@@ -145,7 +318,7 @@ rocksdb::Status Json::Get(const std::string &user_key, const std::vector<std::st
 
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  auto s = paths.empty() ? read(ns_key, &metadata, &json_val) : read(ns_key, paths, &metadata, &json_val);
   if (!s.ok()) return s;
 
   JsonValue res;
@@ -185,7 +358,8 @@ rocksdb::Status Json::ArrAppend(const std::string &user_key, const std::string &
 
   JsonMetadata metadata;
   JsonValue value;
-  auto s = read(ns_key, &metadata, &value);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &value, &segments);
   if (!s.ok()) return s;
 
   auto append_res = value.ArrAppend(path, append_values);
@@ -196,7 +370,7 @@ rocksdb::Status Json::ArrAppend(const std::string &user_key, const std::string &
       std::any_of(results->begin(), results->end(), [](std::optional<uint64_t> c) { return c.has_value(); });
   if (!is_write) return rocksdb::Status::OK();
 
-  return write(ns_key, &metadata, value);
+  return write(ns_key, &metadata, value, segments);
 }
 
 rocksdb::Status Json::ArrIndex(const std::string &user_key, const std::string &path, const std::string &needle,
@@ -209,7 +383,7 @@ rocksdb::Status Json::ArrIndex(const std::string &user_key, const std::string &p
 
   JsonMetadata metadata;
   JsonValue value;
-  auto s = read(ns_key, &metadata, &value);
+  auto s = read(ns_key, {path}, &metadata, &value);
   if (!s.ok()) return s;
 
   auto index_res = value.ArrIndex(path, needle_value.value, start, end);
@@ -224,7 +398,7 @@ rocksdb::Status Json::Type(const std::string &user_key, const std::string &path,
 
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  auto s = read(ns_key, {path}, &metadata, &json_val);
   if (!s.ok()) return s;
 
   auto res = json_val.Type(path);
@@ -242,13 +416,13 @@ rocksdb::Status Json::Merge(const std::string &user_key, const std::string &path
 
   JsonMetadata metadata;
   JsonValue json_val;
-
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &json_val, &segments);
 
   if (s.IsNotFound()) {
     if (path != "$") return rocksdb::Status::InvalidArgument("new objects must be created at the root");
     result = true;
-    return create(ns_key, metadata, merge_value);
+    return create(ns_key, merge_value);
   }
 
   if (!s.ok()) return s;
@@ -262,7 +436,7 @@ rocksdb::Status Json::Merge(const std::string &user_key, const std::string &path
     return rocksdb::Status::OK();
   }
 
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::Clear(const std::string &user_key, const std::string &path, size_t *result) {
@@ -272,7 +446,8 @@ rocksdb::Status Json::Clear(const std::string &user_key, const std::string &path
 
   JsonValue json_val;
   JsonMetadata metadata;
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &json_val, &segments);
 
   if (!s.ok()) return s;
 
@@ -284,14 +459,14 @@ rocksdb::Status Json::Clear(const std::string &user_key, const std::string &path
     return rocksdb::Status::OK();
   }
 
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::ArrLen(const std::string &user_key, const std::string &path, Optionals<uint64_t> *results) {
   auto ns_key = AppendNamespacePrefix(user_key);
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  auto s = read(ns_key, {path}, &metadata, &json_val);
   if (!s.ok()) return s;
 
   auto len_res = json_val.ArrLen(path);
@@ -318,7 +493,8 @@ rocksdb::Status Json::ArrInsert(const std::string &user_key, const std::string &
 
   JsonMetadata metadata;
   JsonValue value;
-  auto s = read(ns_key, &metadata, &value);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &value, &segments);
   if (!s.ok()) return s;
 
   auto insert_res = value.ArrInsert(path, index, insert_values);
@@ -329,7 +505,7 @@ rocksdb::Status Json::ArrInsert(const std::string &user_key, const std::string &
       std::any_of(results->begin(), results->end(), [](std::optional<uint64_t> c) { return c.has_value(); });
   if (!is_write) return rocksdb::Status::OK();
 
-  return write(ns_key, &metadata, value);
+  return write(ns_key, &metadata, value, segments);
 }
 
 rocksdb::Status Json::Toggle(const std::string &user_key, const std::string &path, Optionals<bool> *results) {
@@ -339,14 +515,15 @@ rocksdb::Status Json::Toggle(const std::string &user_key, const std::string &pat
 
   JsonMetadata metadata;
   JsonValue origin;
-  auto s = read(ns_key, &metadata, &origin);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &origin, &segments);
   if (!s.ok()) return s;
 
   auto toggle_res = origin.Toggle(path);
   if (!toggle_res) return rocksdb::Status::InvalidArgument(toggle_res.Msg());
   *results = std::move(*toggle_res);
 
-  return write(ns_key, &metadata, origin);
+  return write(ns_key, &metadata, origin, segments);
 }
 
 rocksdb::Status Json::ArrPop(const std::string &user_key, const std::string &path, int64_t index,
@@ -357,7 +534,8 @@ rocksdb::Status Json::ArrPop(const std::string &user_key, const std::string &pat
 
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &json_val, &segments);
   if (!s.ok()) return s;
 
   auto pop_res = json_val.ArrPop(path, index);
@@ -368,7 +546,7 @@ rocksdb::Status Json::ArrPop(const std::string &user_key, const std::string &pat
                               [](const std::optional<JsonValue> &val) { return val.has_value(); });
   if (!is_write) return rocksdb::Status::OK();
 
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::ObjKeys(const std::string &user_key, const std::string &path,
@@ -376,7 +554,7 @@ rocksdb::Status Json::ObjKeys(const std::string &user_key, const std::string &pa
   auto ns_key = AppendNamespacePrefix(user_key);
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  auto s = read(ns_key, {path}, &metadata, &json_val);
   if (!s.ok()) return s;
   auto keys_res = json_val.ObjKeys(path);
   if (!keys_res) return rocksdb::Status::InvalidArgument(keys_res.Msg());
@@ -393,7 +571,8 @@ rocksdb::Status Json::ArrTrim(const std::string &user_key, const std::string &pa
 
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &json_val, &segments);
   if (!s.ok()) return s;
 
   auto len_res = json_val.ArrTrim(path, start, stop);
@@ -403,7 +582,7 @@ rocksdb::Status Json::ArrTrim(const std::string &user_key, const std::string &pa
   bool is_write =
       std::any_of(results->begin(), results->end(), [](const std::optional<uint64_t> &val) { return val.has_value(); });
   if (!is_write) return rocksdb::Status::OK();
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::Del(const std::string &user_key, const std::string &path, size_t *result) {
@@ -413,7 +592,10 @@ rocksdb::Status Json::Del(const std::string &user_key, const std::string &path,
   LockGuard guard(storage_->GetLockManager(), ns_key);
   JsonValue json_val;
   JsonMetadata metadata;
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  // there's no need to read the whole document to delete it
+  auto s = path == "$" ? GetMetadata({kRedisJson}, ns_key, &metadata)
+                       : read(ns_key, {path}, &metadata, &json_val, &segments);
 
   if (!s.ok() && !s.IsNotFound()) return s;
   if (s.IsNotFound()) {
@@ -432,7 +614,7 @@ rocksdb::Status Json::Del(const std::string &user_key, const std::string &path,
   if (*result == 0) {
     return rocksdb::Status::OK();
   }
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::NumIncrBy(const std::string &user_key, const std::string &path, const std::string &value,
@@ -455,26 +637,28 @@ rocksdb::Status Json::numop(JsonValue::NumOpEnum op, const std::string &user_key
   number = std::move(number_res.GetValue());
 
   auto ns_key = AppendNamespacePrefix(user_key);
+  LockGuard guard(storage_->GetLockManager(), ns_key);
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &json_val, &segments);
   if (!s.ok()) return s;
 
-  LockGuard guard(storage_->GetLockManager(), ns_key);
-
   auto res = json_val.NumOp(path, number, op, result);
   if (!res) {
     return rocksdb::Status::InvalidArgument(res.Msg());
   }
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::StrAppend(const std::string &user_key, const std::string &path, const std::string &value,
                                 Optionals<uint64_t> *results) {
   auto ns_key = AppendNamespacePrefix(user_key);
+  LockGuard guard(storage_->GetLockManager(), ns_key);
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  JsonSegments segments;
+  auto s = read(ns_key, {path}, &metadata, &json_val, &segments);
   if (!s.ok()) return s;
 
   auto append_res = json_val.StrAppend(path, value);
@@ -487,14 +671,14 @@ rocksdb::Status Json::StrAppend(const std::string &user_key, const std::string &
     return rocksdb::Status::OK();
   }
 
-  return write(ns_key, &metadata, json_val);
+  return write(ns_key, &metadata, json_val, segments);
 }
 
 rocksdb::Status Json::StrLen(const std::string &user_key, const std::string &path, Optionals<uint64_t> *results) {
   auto ns_key = AppendNamespacePrefix(user_key);
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  auto s = read(ns_key, {path}, &metadata, &json_val);
   if (!s.ok()) return s;
 
   auto str_lens = json_val.StrLen(path);
@@ -507,7 +691,7 @@ rocksdb::Status Json::ObjLen(const std::string &user_key, const std::string &pat
   auto ns_key = AppendNamespacePrefix(user_key);
   JsonMetadata metadata;
   JsonValue json_val;
-  auto s = read(ns_key, &metadata, &json_val);
+  auto s = read(ns_key, {path}, &metadata, &json_val);
   if (!s.ok()) return s;
 
   auto obj_lens = json_val.ObjLen(path);
@@ -530,7 +714,7 @@ std::vector<rocksdb::Status> Json::MGet(const std::vector<std::string> &user_key
 
   std::vector<JsonValue> json_vals;
   json_vals.resize(ns_keys.size());
-  auto statuses = readMulti(ns_keys, json_vals);
+  auto statuses = readMulti(ns_keys, path, json_vals);
 
   results.resize(ns_keys.size());
   for (size_t i = 0; i < ns_keys.size(); i++) {
@@ -548,10 +732,9 @@ std::vector<rocksdb::Status> Json::MGet(const std::vector<std::string> &user_key
   return statuses;
 }
 
-std::vector<rocksdb::Status> Json::readMulti(const std::vector<Slice> &ns_keys, std::vector<JsonValue> &values) {
+std::vector<rocksdb::Status> Json::readMulti(const std::vector<Slice> &ns_keys, const std::string &path,
+                                             std::vector<JsonValue> &values) {
   rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
 
   std::vector<rocksdb::Status> statuses(ns_keys.size());
   std::vector<rocksdb::PinnableSlice> pin_values(ns_keys.size());
@@ -564,6 +747,11 @@ std::vector<rocksdb::Status> Json::readMulti(const std::vector<Slice> &ns_keys,
     statuses[i] = ParseMetadata({kRedisJson}, &rest, &metadata);
     if (!statuses[i].ok()) continue;
 
+    if (metadata.IsSegmentedJson()) {
+      // the members in the path are read along with the metadata again
+      statuses[i] = read(ns_keys[i], {path}, &metadata, &values[i]);
+      continue;
+    }
     statuses[i] = parse(metadata, rest, &values[i]);
     if (!statuses[i].ok()) continue;
   }
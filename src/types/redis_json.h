@@ -22,6 +22,8 @@
 
 #include <storage/redis_db.h>
 
+#include <map>
+#include <set>
 #include <string>
 
 #include "json.h"
@@ -29,6 +31,14 @@
 
 namespace redis {
 
+// The members of a segmented JSON document read for an update along with their encoded values,
+// so that only the members it changes are written back
+struct JsonSegments {
+  std::map<std::string, std::string> members;
+  // whether all the members of the document are read
+  bool complete = true;
+};
+
 class Json : public Database {
  public:
   Json(engine::Storage *storage, std::string ns) : Database(storage, std::move(ns)) {}
@@ -68,14 +78,25 @@ class Json : public Database {
                                     std::vector<JsonValue> &results);
 
  private:
-  rocksdb::Status write(Slice ns_key, JsonMetadata *metadata, const JsonValue &json_val);
+  rocksdb::Status write(Slice ns_key, JsonMetadata *metadata, const JsonValue &json_val,
+                        const JsonSegments &segments = JsonSegments());
+  rocksdb::Status writeMembers(rocksdb::WriteBatchBase *batch, const Slice &ns_key, JsonMetadata *metadata,
+                               const JsonValue &json_val, const JsonSegments &segments);
   rocksdb::Status read(const Slice &ns_key, JsonMetadata *metadata, JsonValue *value);
+  // Read the document as far as `paths` need, i.e. only the members they address if it's segmented
+  rocksdb::Status read(const Slice &ns_key, const std::vector<std::string> &paths, JsonMetadata *metadata,
+                       JsonValue *value, JsonSegments *segments = nullptr);
+  rocksdb::Status readMembers(const rocksdb::ReadOptions &read_options, const Slice &ns_key,
+                              const JsonMetadata &metadata, const std::set<std::string> *names, JsonValue *value,
+                              JsonSegments *segments);
   static rocksdb::Status parse(const JsonMetadata &metadata, const Slice &json_byt, JsonValue *value);
-  rocksdb::Status create(const std::string &ns_key, JsonMetadata &metadata, const std::string &value);
+  rocksdb::Status encode(JsonStorageFormat format, const JsonValue &json_val, std::string *dst);
+  rocksdb::Status create(const std::string &ns_key, const std::string &value);
   rocksdb::Status del(const Slice &ns_key);
   rocksdb::Status numop(JsonValue::NumOpEnum op, const std::string &user_key, const std::string &path,
                         const std::string &value, JsonValue *result);
-  std::vector<rocksdb::Status> readMulti(const std::vector<Slice> &ns_keys, std::vector<JsonValue> &values);
+  std::vector<rocksdb::Status> readMulti(const std::vector<Slice> &ns_keys, const std::string &path,
+                                         std::vector<JsonValue> &values);
 
   friend struct FieldValueRetriever;
 };
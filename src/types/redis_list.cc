@@ -24,13 +24,45 @@
 #include <utility>
 
 #include "db_util.h"
+#include "list_chunks.h"
 
 namespace redis {
 
+namespace {
+
+// The chunks of a list can't be mapped to its elements, so its log data carries the whole command
+WriteBatchLogData ChunkedListLogData(std::vector<std::string> args) {
+  args.insert(args.begin(), std::to_string(kRedisCmdChunkedList));
+  return WriteBatchLogData(kRedisList, std::move(args));
+}
+
+}  // namespace
+
 rocksdb::Status List::GetMetadata(const Slice &ns_key, ListMetadata *metadata) {
   return Database::GetMetadata({kRedisList}, ns_key, metadata);
 }
 
+rocksdb::Status List::getMetadata(const rocksdb::ReadOptions &read_options, const Slice &ns_key,
+                                  ListMetadata *metadata) {
+  std::string raw_metadata;
+  rocksdb::Status s = storage_->Get(read_options, metadata_cf_handle_, ns_key, &raw_metadata);
+  if (!s.ok()) return s;
+  Slice rest = raw_metadata;
+  return ParseMetadata({kRedisList}, &rest, metadata);
+}
+
+uint32_t List::chunkMaxSize() const {
+  int max_entries = storage_->GetConfig()->list_chunk_max_entries;
+  // the chunked lists created before the option is disabled keep using chunks of a default size
+  return max_entries > 0 ? static_cast<uint32_t>(max_entries) : kDefaultChunkMaxSize;
+}
+
+void List::newChunkedList(ListMetadata *metadata) const {
+  if (storage_->GetConfig()->list_chunk_max_entries > 0) {
+    metadata->flags |= METADATA_LIST_CHUNKED_MASK;
+  }
+}
+
 rocksdb::Status List::Size(const Slice &user_key, uint64_t *size) {
   *size = 0;
 
@@ -56,15 +88,30 @@ rocksdb::Status List::push(const Slice &user_key, const std::vector<Slice> &elem
   std::string ns_key = AppendNamespacePrefix(user_key);
 
   ListMetadata metadata;
-  auto batch = storage_->GetWriteBatchBase();
-  RedisCommand cmd = left ? kRedisCmdLPush : kRedisCmdRPush;
-  WriteBatchLogData log_data(kRedisList, {std::to_string(cmd)});
-  batch->PutLogData(log_data.Encode());
   LockGuard guard(storage_->GetLockManager(), ns_key);
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok() && !(create_if_missing && s.IsNotFound())) {
     return s.IsNotFound() ? rocksdb::Status::OK() : s;
   }
+  if (s.IsNotFound()) newChunkedList(&metadata);
+
+  auto batch = storage_->GetWriteBatchBase();
+  if (metadata.IsChunkedList()) {
+    std::vector<std::string> args{left ? "LPUSH" : "RPUSH", user_key.ToString()};
+    for (const auto &elem : elems) args.emplace_back(elem.ToString());
+    batch->PutLogData(ChunkedListLogData(std::move(args)).Encode());
+
+    ListChunks chunks(storage_, ns_key, &metadata);
+    s = chunks.Push(elems, left, chunkMaxSize());
+    if (!s.ok()) return s;
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    *new_size = metadata.size;
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
+  RedisCommand cmd = left ? kRedisCmdLPush : kRedisCmdRPush;
+  WriteBatchLogData log_data(kRedisList, {std::to_string(cmd)});
+  batch->PutLogData(log_data.Encode());
   uint64_t index = left ? metadata.head - 1 : metadata.tail;
   for (const auto &elem : elems) {
     std::string index_buf;
@@ -109,6 +156,16 @@ rocksdb::Status List::PopMulti(const rocksdb::Slice &user_key, bool left, uint32
   if (!s.ok()) return s;
 
   auto batch = storage_->GetWriteBatchBase();
+  if (metadata.IsChunkedList()) {
+    batch->PutLogData(
+        ChunkedListLogData({left ? "LPOP" : "RPOP", user_key.ToString(), std::to_string(count)}).Encode());
+    ListChunks chunks(storage_, ns_key, &metadata);
+    s = chunks.Pop(left, count, elems);
+    if (!s.ok()) return s;
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
   RedisCommand cmd = left ? kRedisCmdLPop : kRedisCmdRPop;
   WriteBatchLogData log_data(kRedisList, {std::to_string(cmd)});
   batch->PutLogData(log_data.Encode());
@@ -172,6 +229,19 @@ rocksdb::Status List::Rem(const Slice &user_key, int count, const Slice &elem, u
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok()) return s;
 
+  if (metadata.IsChunkedList()) {
+    ListChunks chunks(storage_, ns_key, &metadata);
+    s = chunks.Remove(elem, static_cast<uint64_t>(std::abs(count)), count < 0, removed_cnt);
+    if (!s.ok()) return s;
+    if (*removed_cnt == 0) return rocksdb::Status::NotFound();
+
+    auto batch = storage_->GetWriteBatchBase();
+    batch->PutLogData(
+        ChunkedListLogData({"LREM", user_key.ToString(), std::to_string(count), elem.ToString()}).Encode());
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
   uint64_t index = count >= 0 ? metadata.head : metadata.tail - 1;
   std::string buf;
   PutFixed64(&buf, index);
@@ -262,6 +332,32 @@ rocksdb::Status List::Insert(const Slice &user_key, const Slice &pivot, const Sl
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok()) return s;
 
+  if (metadata.IsChunkedList()) {
+    ListChunks chunks(storage_, ns_key, &metadata);
+    uint64_t index = 0;
+    bool found = false;
+    s = chunks.Scan(false, [&](const Slice &chunk_elem) {
+      found = chunk_elem == pivot;
+      if (!found) index++;
+      return !found;
+    });
+    if (!s.ok()) return s;
+    if (!found) {
+      *new_size = -1;
+      return rocksdb::Status::NotFound();
+    }
+
+    s = chunks.Insert(before ? index : index + 1, elem, chunkMaxSize());
+    if (!s.ok()) return s;
+    auto batch = storage_->GetWriteBatchBase();
+    batch->PutLogData(ChunkedListLogData({"LINSERT", user_key.ToString(), before ? "BEFORE" : "AFTER",
+                                          pivot.ToString(), elem.ToString()})
+                          .Encode());
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    *new_size = static_cast<int>(metadata.size);
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
   std::string buf;
   uint64_t pivot_index = metadata.head - 1;
   PutFixed64(&buf, metadata.head);
@@ -333,16 +429,21 @@ rocksdb::Status List::Index(const Slice &user_key, int index, std::string *elem)
   elem->clear();
 
   std::string ns_key = AppendNamespacePrefix(user_key);
+  // The chunks of a chunked list are moved around by the updates, so they are read in the same snapshot as the metadata
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options;
+  read_options.snapshot = ss.GetSnapShot();
   ListMetadata metadata(false);
-  rocksdb::Status s = GetMetadata(ns_key, &metadata);
+  rocksdb::Status s = getMetadata(read_options, ns_key, &metadata);
   if (!s.ok()) return s;
 
   if (index < 0) index += static_cast<int>(metadata.size);
   if (index < 0 || index >= static_cast<int>(metadata.size)) return rocksdb::Status::NotFound();
 
-  rocksdb::ReadOptions read_options;
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
+  if (metadata.IsChunkedList()) {
+    return ListChunks(storage_, ns_key, &metadata, read_options).Get(index, elem);
+  }
+
   std::string buf;
   PutFixed64(&buf, metadata.head + index);
   std::string sub_key = InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode();
@@ -357,15 +458,41 @@ rocksdb::Status List::Index(const Slice &user_key, int index, std::string *elem)
 rocksdb::Status List::Range(const Slice &user_key, int start, int stop, std::vector<std::string> *elems) {
   elems->clear();
 
+  return Range(
+      user_key, start, stop, [elems](uint64_t size) { elems->reserve(size); },
+      [elems](const Slice &elem) { elems->emplace_back(elem.ToString()); });
+}
+
+rocksdb::Status List::Range(const Slice &user_key, int start, int stop, const std::function<void(uint64_t)> &size_cb,
+                            const std::function<void(const Slice &)> &elem_cb) {
   std::string ns_key = AppendNamespacePrefix(user_key);
+
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options;
+  read_options.snapshot = ss.GetSnapShot();
+  // Read the metadata in the same snapshot as the elements, so the range
+  // is resolved against the same state as the iteration below.
   ListMetadata metadata(false);
-  rocksdb::Status s = GetMetadata(ns_key, &metadata);
-  if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
+  rocksdb::Status s = getMetadata(read_options, ns_key, &metadata);
+  if (!s.ok()) {
+    if (!s.IsNotFound()) return s;
+    size_cb(0);
+    return rocksdb::Status::OK();
+  }
 
   if (start < 0) start = static_cast<int>(metadata.size) + start;
   if (stop < 0) stop = static_cast<int>(metadata.size) + stop;
-  if (start > static_cast<int>(metadata.size) || stop < 0 || start > stop) return rocksdb::Status::OK();
   if (start < 0) start = 0;
+  if (stop >= static_cast<int>(metadata.size)) stop = static_cast<int>(metadata.size) - 1;
+  if (start > stop) {
+    size_cb(0);
+    return rocksdb::Status::OK();
+  }
+  size_cb(stop - start + 1);
+
+  if (metadata.IsChunkedList()) {
+    return ListChunks(storage_, ns_key, &metadata, read_options).Range(start, stop, elem_cb);
+  }
 
   std::string buf;
   PutFixed64(&buf, metadata.head + start);
@@ -373,13 +500,12 @@ rocksdb::Status List::Range(const Slice &user_key, int start, int stop, std::vec
   std::string prefix = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
   std::string next_version_prefix = InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode();
 
-  rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
+  rocksdb::ReadOptions scan_options = storage_->DefaultScanOptions();
+  scan_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix);
-  read_options.iterate_upper_bound = &upper_bound;
+  scan_options.iterate_upper_bound = &upper_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, scan_options);
   for (iter->Seek(start_key); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     Slice sub_key = ikey.GetSubKey();
@@ -387,9 +513,9 @@ rocksdb::Status List::Range(const Slice &user_key, int start, int stop, std::vec
     GetFixed64(&sub_key, &index);
     // index should be always >= start
     if (index > metadata.head + stop) break;
-    elems->push_back(iter->value().ToString());
+    elem_cb(iter->value());
   }
-  return rocksdb::Status::OK();
+  return iter->status();
 }
 
 rocksdb::Status List::Pos(const Slice &user_key, const Slice &elem, const PosSpec &spec,
@@ -397,8 +523,11 @@ rocksdb::Status List::Pos(const Slice &user_key, const Slice &elem, const PosSpe
   indexes->clear();
 
   std::string ns_key = AppendNamespacePrefix(user_key);
+  LatestSnapShot ss(storage_);
+  rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
+  read_options.snapshot = ss.GetSnapShot();
   ListMetadata metadata(false);
-  rocksdb::Status s = GetMetadata(ns_key, &metadata);
+  rocksdb::Status s = getMetadata(read_options, ns_key, &metadata);
   if (!s.ok()) return s;
 
   // A negative rank means start from the tail.
@@ -411,39 +540,46 @@ rocksdb::Status List::Pos(const Slice &user_key, const Slice &elem, const PosSpe
     reversed = true;
   }
 
-  std::string buf;
-  PutFixed64(&buf, start);
-  std::string start_key = InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  std::string prefix = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  std::string next_version_prefix = InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode();
-
-  rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
-  rocksdb::Slice upper_bound(next_version_prefix);
-  read_options.iterate_upper_bound = &upper_bound;
-  rocksdb::Slice lower_bound(prefix);
-  read_options.iterate_lower_bound = &lower_bound;
-
   auto list_len = static_cast<int64_t>(metadata.size);
   int64_t max_len = spec.max_len;
   int64_t count = spec.count.value_or(-1);
   int64_t offset = 0, matches = 0;
 
-  auto iter = util::UniqueIterator(storage_, read_options);
-  iter->Seek(start_key);
-  while (iter->Valid() && iter->key().starts_with(prefix) && (max_len == 0 || offset < max_len)) {
-    if (iter->value() == elem) {
+  // Return false once no more elements need to be visited
+  auto visit = [&](const Slice &value) {
+    if (max_len != 0 && offset >= max_len) return false;
+    if (value == elem) {
       matches++;
       if (matches >= rank) {
         int64_t pos = !reversed ? offset : list_len - offset - 1;
         indexes->push_back(pos);
         if (count != 0 && matches - rank + 1 >= count) {
-          break;
+          return false;
         }
       }
     }
     offset++;
+    return true;
+  };
+
+  if (metadata.IsChunkedList()) {
+    return ListChunks(storage_, ns_key, &metadata, read_options).Scan(reversed, visit);
+  }
+
+  std::string buf;
+  PutFixed64(&buf, start);
+  std::string start_key = InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode();
+  std::string prefix = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
+  std::string next_version_prefix = InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode();
+
+  rocksdb::Slice upper_bound(next_version_prefix);
+  read_options.iterate_upper_bound = &upper_bound;
+  rocksdb::Slice lower_bound(prefix);
+  read_options.iterate_lower_bound = &lower_bound;
+
+  auto iter = util::UniqueIterator(storage_, read_options);
+  iter->Seek(start_key);
+  while (iter->Valid() && iter->key().starts_with(prefix) && visit(iter->value())) {
     !reversed ? iter->Next() : iter->Prev();
   }
   return rocksdb::Status::OK();
@@ -461,6 +597,22 @@ rocksdb::Status List::Set(const Slice &user_key, int index, Slice elem) {
     return rocksdb::Status::InvalidArgument("index out of range");
   }
 
+  if (metadata.IsChunkedList()) {
+    ListChunks chunks(storage_, ns_key, &metadata);
+    std::string value;
+    s = chunks.Get(index, &value);
+    if (!s.ok()) return s;
+    if (value == elem) return rocksdb::Status::OK();
+
+    s = chunks.Set(index, elem);
+    if (!s.ok()) return s;
+    auto batch = storage_->GetWriteBatchBase();
+    batch->PutLogData(
+        ChunkedListLogData({"LSET", user_key.ToString(), std::to_string(index), elem.ToString()}).Encode());
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
   std::string buf, value;
   PutFixed64(&buf, metadata.head + index);
   std::string sub_key = InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode();
@@ -497,6 +649,28 @@ rocksdb::Status List::lmoveOnSingleList(const rocksdb::Slice &src, bool src_left
 
   elem->clear();
 
+  if (metadata.IsChunkedList()) {
+    ListChunks chunks(storage_, ns_key, &metadata);
+    if (src_left == dst_left || metadata.size == 1) {
+      // no-op, just get the element
+      return chunks.Get(src_left ? 0 : metadata.size - 1, elem);
+    }
+
+    std::vector<std::string> elems;
+    s = chunks.Pop(src_left, 1, &elems);
+    if (!s.ok()) return s;
+    *elem = std::move(elems[0]);
+    s = chunks.Push({*elem}, dst_left, chunkMaxSize());
+    if (!s.ok()) return s;
+
+    auto batch = storage_->GetWriteBatchBase();
+    batch->PutLogData(ChunkedListLogData({"LMOVE", src.ToString(), src.ToString(), src_left ? "LEFT" : "RIGHT",
+                                          dst_left ? "LEFT" : "RIGHT"})
+                          .Encode());
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
   uint64_t curr_index = src_left ? metadata.head : metadata.tail - 1;
   std::string curr_index_buf;
   PutFixed64(&curr_index_buf, curr_index);
@@ -563,48 +737,74 @@ rocksdb::Status List::lmoveOnTwoLists(const rocksdb::Slice &src, const rocksdb::
   if (!s.ok() && !s.IsNotFound()) {
     return s;
   }
+  if (s.IsNotFound()) {
+    dst_metadata = ListMetadata();
+    newChunkedList(&dst_metadata);
+  }
 
   elem->clear();
 
   auto batch = storage_->GetWriteBatchBase();
-  WriteBatchLogData log_data(kRedisList, {std::to_string(kRedisCmdLMove), src.ToString(), dst.ToString(),
-                                          src_left ? "left" : "right", dst_left ? "left" : "right"});
-  batch->PutLogData(log_data.Encode());
+  if (src_metadata.IsChunkedList() || dst_metadata.IsChunkedList()) {
+    batch->PutLogData(ChunkedListLogData({"LMOVE", src.ToString(), dst.ToString(), src_left ? "LEFT" : "RIGHT",
+                                          dst_left ? "LEFT" : "RIGHT"})
+                          .Encode());
+  } else {
+    WriteBatchLogData log_data(kRedisList, {std::to_string(kRedisCmdLMove), src.ToString(), dst.ToString(),
+                                            src_left ? "left" : "right", dst_left ? "left" : "right"});
+    batch->PutLogData(log_data.Encode());
+  }
+
+  if (src_metadata.IsChunkedList()) {
+    ListChunks src_chunks(storage_, src_ns_key, &src_metadata);
+    std::vector<std::string> elems;
+    s = src_chunks.Pop(src_left, 1, &elems);
+    if (!s.ok()) return s;
+    *elem = std::move(elems[0]);
+    src_chunks.Save(batch.Get(), metadata_cf_handle_);
+  } else {
+    uint64_t src_index = src_left ? src_metadata.head : src_metadata.tail - 1;
+    std::string src_buf;
+    PutFixed64(&src_buf, src_index);
+    std::string src_sub_key =
+        InternalKey(src_ns_key, src_buf, src_metadata.version, storage_->IsSlotIdEncoded()).Encode();
+    s = storage_->Get(rocksdb::ReadOptions(), src_sub_key, elem);
+    if (!s.ok()) {
+      return s;
+    }
 
-  uint64_t src_index = src_left ? src_metadata.head : src_metadata.tail - 1;
-  std::string src_buf;
-  PutFixed64(&src_buf, src_index);
-  std::string src_sub_key =
-      InternalKey(src_ns_key, src_buf, src_metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  s = storage_->Get(rocksdb::ReadOptions(), src_sub_key, elem);
-  if (!s.ok()) {
-    return s;
+    batch->Delete(src_sub_key);
+    if (src_metadata.size == 1) {
+      batch->Delete(metadata_cf_handle_, src_ns_key);
+    } else {
+      std::string bytes;
+      src_metadata.size -= 1;
+      src_left ? ++src_metadata.head : --src_metadata.tail;
+      src_metadata.Encode(&bytes);
+      batch->Put(metadata_cf_handle_, src_ns_key, bytes);
+    }
   }
 
-  batch->Delete(src_sub_key);
-  if (src_metadata.size == 1) {
-    batch->Delete(metadata_cf_handle_, src_ns_key);
+  if (dst_metadata.IsChunkedList()) {
+    ListChunks dst_chunks(storage_, dst_ns_key, &dst_metadata);
+    s = dst_chunks.Push({*elem}, dst_left, chunkMaxSize());
+    if (!s.ok()) return s;
+    dst_chunks.Save(batch.Get(), metadata_cf_handle_);
   } else {
+    uint64_t dst_index = dst_left ? dst_metadata.head - 1 : dst_metadata.tail;
+    std::string dst_buf;
+    PutFixed64(&dst_buf, dst_index);
+    std::string dst_sub_key =
+        InternalKey(dst_ns_key, dst_buf, dst_metadata.version, storage_->IsSlotIdEncoded()).Encode();
+    batch->Put(dst_sub_key, *elem);
+    dst_left ? --dst_metadata.head : ++dst_metadata.tail;
+
     std::string bytes;
-    src_metadata.size -= 1;
-    src_left ? ++src_metadata.head : --src_metadata.tail;
-    src_metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, src_ns_key, bytes);
+    dst_metadata.size += 1;
+    dst_metadata.Encode(&bytes);
+    batch->Put(metadata_cf_handle_, dst_ns_key, bytes);
   }
 
-  uint64_t dst_index = dst_left ? dst_metadata.head - 1 : dst_metadata.tail;
-  std::string dst_buf;
-  PutFixed64(&dst_buf, dst_index);
-  std::string dst_sub_key =
-      InternalKey(dst_ns_key, dst_buf, dst_metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  batch->Put(dst_sub_key, *elem);
-  dst_left ? --dst_metadata.head : ++dst_metadata.tail;
-
-  std::string bytes;
-  dst_metadata.size += 1;
-  dst_metadata.Encode(&bytes);
-  batch->Put(metadata_cf_handle_, dst_ns_key, bytes);
-
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -628,6 +828,21 @@ rocksdb::Status List::Trim(const Slice &user_key, int start, int stop) {
   if (start < 0) start = 0;
 
   auto batch = storage_->GetWriteBatchBase();
+  if (metadata.IsChunkedList()) {
+    if (stop >= static_cast<int>(metadata.size)) stop = static_cast<int>(metadata.size) - 1;
+    if (start > stop) {
+      return storage_->Delete(storage_->DefaultWriteOptions(), metadata_cf_handle_, ns_key);
+    }
+
+    ListChunks chunks(storage_, ns_key, &metadata);
+    s = chunks.Trim(start, stop);
+    if (!s.ok()) return s;
+    batch->PutLogData(
+        ChunkedListLogData({"LTRIM", user_key.ToString(), std::to_string(start), std::to_string(stop)}).Encode());
+    chunks.Save(batch.Get(), metadata_cf_handle_);
+    return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  }
+
   WriteBatchLogData log_data(kRedisList, std::vector<std::string>{std::to_string(kRedisCmdLTrim), std::to_string(start),
                                                                   std::to_string(stop)});
   batch->PutLogData(log_data.Encode());
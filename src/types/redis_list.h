@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 
+#include <functional>
 #include <optional>
 #include <string>
 #include <vector>
@@ -53,10 +54,23 @@ class List : public Database {
   rocksdb::Status Push(const Slice &user_key, const std::vector<Slice> &elems, bool left, uint64_t *new_size);
   rocksdb::Status PushX(const Slice &user_key, const std::vector<Slice> &elems, bool left, uint64_t *new_size);
   rocksdb::Status Range(const Slice &user_key, int start, int stop, std::vector<std::string> *elems);
+  // Iterate the elements in range without copying them, `size_cb` is called with the number of elements
+  // expected by the metadata before the first `elem_cb`, and both of them come from the same snapshot.
+  // The number of elements iterated may still differ from it, e.g. if some subkeys are missing.
+  rocksdb::Status Range(const Slice &user_key, int start, int stop, const std::function<void(uint64_t)> &size_cb,
+                        const std::function<void(const Slice &)> &elem_cb);
   rocksdb::Status Pos(const Slice &user_key, const Slice &elem, const PosSpec &spec, std::vector<int64_t> *indexes);
 
  private:
+  // The max size of the chunks of a chunked list when `list-chunk-max-entries` is disabled
+  static constexpr uint32_t kDefaultChunkMaxSize = 128;
+
   rocksdb::Status GetMetadata(const Slice &ns_key, ListMetadata *metadata);
+  // Read the metadata in the snapshot of `read_options`, so it matches the elements read in the same snapshot
+  rocksdb::Status getMetadata(const rocksdb::ReadOptions &read_options, const Slice &ns_key, ListMetadata *metadata);
+  uint32_t chunkMaxSize() const;
+  // Make a new list chunked if `list-chunk-max-entries` is enabled
+  void newChunkedList(ListMetadata *metadata) const;
   rocksdb::Status push(const Slice &user_key, const std::vector<Slice> &elems, bool create_if_missing, bool left,
                        uint64_t *new_size);
   rocksdb::Status lmoveOnSingleList(const Slice &src, bool src_left, bool dst_left, std::string *elem);
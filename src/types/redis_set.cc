@@ -39,17 +39,15 @@ rocksdb::Status Set::Overwrite(Slice user_key, const std::vector<std::string> &m
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   SetMetadata metadata;
+  initInlineEncoding(&metadata);
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisSet);
   batch->PutLogData(log_data.Encode());
   for (const auto &member : members) {
-    std::string sub_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    batch->Put(sub_key, Slice());
+    putSubKey(batch.Get(), ns_key, &metadata, member, Slice());
   }
   metadata.size = static_cast<uint32_t>(members.size());
-  std::string bytes;
-  metadata.Encode(&bytes);
-  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  putCollectionMetadata(batch.Get(), ns_key, &metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -62,6 +60,7 @@ rocksdb::Status Set::Add(const Slice &user_key, const std::vector<Slice> &member
   SetMetadata metadata;
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok() && !s.IsNotFound()) return s;
+  if (s.IsNotFound()) initInlineEncoding(&metadata);
 
   std::string value;
   auto batch = storage_->GetWriteBatchBase();
@@ -72,17 +71,14 @@ rocksdb::Status Set::Add(const Slice &user_key, const std::vector<Slice> &member
     if (!mset.insert(member.ToStringView()).second) {
       continue;
     }
-    std::string sub_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, member, &value);
     if (s.ok()) continue;
-    batch->Put(sub_key, Slice());
+    putSubKey(batch.Get(), ns_key, &metadata, member, Slice());
     *added_cnt += 1;
   }
   if (*added_cnt > 0) {
     metadata.size += *added_cnt;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    putCollectionMetadata(batch.Get(), ns_key, &metadata);
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -106,18 +102,15 @@ rocksdb::Status Set::Remove(const Slice &user_key, const std::vector<Slice> &mem
     if (!mset.insert(member.ToStringView()).second) {
       continue;
     }
-    std::string sub_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, member, &value);
     if (!s.ok()) continue;
-    batch->Delete(sub_key);
+    deleteSubKey(batch.Get(), ns_key, &metadata, member);
     *removed_cnt += 1;
   }
   if (*removed_cnt > 0) {
     if (metadata.size != *removed_cnt) {
       metadata.size -= *removed_cnt;
-      std::string bytes;
-      metadata.Encode(&bytes);
-      batch->Put(metadata_cf_handle_, ns_key, bytes);
+      putCollectionMetadata(batch.Get(), ns_key, &metadata);
     } else {
       batch->Delete(metadata_cf_handle_, ns_key);
     }
@@ -154,7 +147,7 @@ rocksdb::Status Set::Members(const Slice &user_key, std::vector<std::string> *me
   rocksdb::Slice upper_bound(next_version_prefix);
   read_options.iterate_upper_bound = &upper_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = newSubKeyIterator(ns_key, metadata, read_options);
   for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     members->emplace_back(ikey.GetSubKey().ToString());
@@ -184,8 +177,7 @@ rocksdb::Status Set::MIsMember(const Slice &user_key, const std::vector<Slice> &
   read_options.snapshot = ss.GetSnapShot();
   std::string value;
   for (const auto &member : members) {
-    std::string sub_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    s = storage_->Get(read_options, sub_key, &value);
+    s = getSubKey(read_options, ns_key, metadata, member, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.IsNotFound()) {
       exists->emplace_back(0);
@@ -232,13 +224,10 @@ rocksdb::Status Set::Take(const Slice &user_key, std::vector<std::string> *membe
   // Avoid to write an empty op-log if the set is empty.
   if (members->empty()) return rocksdb::Status::OK();
   for (std::string &user_sub_key : *members) {
-    std::string sub_key = InternalKey(ns_key, user_sub_key, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    batch->Delete(sub_key);
+    deleteSubKey(batch.Get(), ns_key, &metadata, user_sub_key);
   }
   metadata.size -= members->size();
-  std::string bytes;
-  metadata.Encode(&bytes);
-  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  putCollectionMetadata(batch.Get(), ns_key, &metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
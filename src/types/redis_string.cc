@@ -20,6 +20,7 @@
 
 #include "redis_string.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -33,13 +34,17 @@
 
 namespace redis {
 
+// The value of a chunked string is split into the chunks of kStringChunkBytes, and the subkey of
+// a chunk is the offset of its first byte in the value, like the segments of bitmaps.
+// A chunk missing or shorter than its part of the value (e.g. created by a SETRANGE beyond the end)
+// is padded with zero bytes.
+constexpr uint64_t kStringChunkBytes = 16 * 1024;
+
 std::vector<rocksdb::Status> String::getRawValues(const std::vector<Slice> &keys,
                                                   std::vector<std::string> *raw_values) {
   raw_values->clear();
 
   rocksdb::ReadOptions read_options = storage_->DefaultMultiGetOptions();
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
   raw_values->resize(keys.size());
   std::vector<rocksdb::Status> statuses(keys.size());
   std::vector<rocksdb::PinnableSlice> pin_values(keys.size());
@@ -50,6 +55,9 @@ std::vector<rocksdb::Status> String::getRawValues(const std::vector<Slice> &keys
     Metadata metadata(kRedisNone, false);
     Slice slice = (*raw_values)[i];
     auto s = ParseMetadata({kRedisString}, &slice, &metadata);
+    if (s.ok() && metadata.IsChunkedString()) {
+      s = GetRawValue(keys[i].ToString(), &(*raw_values)[i]);
+    }
     if (!s.ok()) {
       statuses[i] = s;
       (*raw_values)[i].clear();
@@ -59,22 +67,101 @@ std::vector<rocksdb::Status> String::getRawValues(const std::vector<Slice> &keys
   return statuses;
 }
 
-rocksdb::Status String::getRawValue(const std::string &ns_key, std::string *raw_value) {
+rocksdb::Status String::GetRawValue(const std::string &ns_key, std::string *raw_value) {
+  std::optional<LatestSnapShot> ss;
+  rocksdb::ReadOptions read_options;
+  Metadata metadata(kRedisNone, false);
+  auto s = getMetadataForRead(ns_key, &ss, &read_options, &metadata, raw_value);
+  if (!s.ok() || !metadata.IsChunkedString()) return s;
+
+  std::string value;
+  s = readChunks(read_options, ns_key, metadata, 0, metadata.size, &value);
+  if (!s.ok()) return s;
+
+  // Keep the header and drop the version and size to get the layout of a plain string
+  raw_value->resize(Metadata::GetOffsetAfterExpire((*raw_value)[0]));
+  (*raw_value)[0] = static_cast<char>((*raw_value)[0] & ~METADATA_STRING_CHUNKED_MASK);
+  raw_value->append(value);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status String::getMetadataForRead(const std::string &ns_key, std::optional<LatestSnapShot> *ss,
+                                           rocksdb::ReadOptions *read_options, Metadata *metadata,
+                                           std::string *raw_value) {
   raw_value->clear();
 
   auto s = GetRawMetadata(ns_key, raw_value);
   if (!s.ok()) return s;
 
-  Metadata metadata(kRedisNone, false);
   Slice slice = *raw_value;
-  return ParseMetadata({kRedisString}, &slice, &metadata);
+  s = ParseMetadata({kRedisString}, &slice, metadata);
+  if (!s.ok()) {
+    raw_value->clear();
+    return s;
+  }
+  if (!metadata->IsChunkedString()) return s;
+
+  // The chunks must be read on the same snapshot as the metadata, or they may be newer than its size
+  ss->emplace(storage_);
+  read_options->snapshot = (*ss)->GetSnapShot();
+  s = storage_->Get(*read_options, metadata_cf_handle_, ns_key, raw_value);
+  if (!s.ok()) return s;
+  s = metadata->Decode(*raw_value);
+  if (!s.ok()) return s;
+  // The key may be overwritten by another type or expired since the first read
+  if (metadata->Type() != kRedisString) return rocksdb::Status::InvalidArgument(kErrMsgWrongType);
+  if (metadata->Expired()) return rocksdb::Status::NotFound(kErrMsgKeyExpired);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status String::readChunks(const rocksdb::ReadOptions &read_options, const std::string &ns_key,
+                                   const Metadata &metadata, uint64_t offset, uint64_t length, std::string *value) {
+  value->clear();
+  if (length == 0) return rocksdb::Status::OK();
+
+  uint64_t first = offset / kStringChunkBytes;
+  uint64_t last = (offset + length - 1) / kStringChunkBytes;
+  std::vector<std::string> sub_keys;
+  for (uint64_t i = first; i <= last; i++) {
+    sub_keys.emplace_back(InternalKey(ns_key, std::to_string(i * kStringChunkBytes), metadata.version,
+                                      storage_->IsSlotIdEncoded())
+                              .Encode());
+  }
+  std::vector<Slice> sub_key_slices(sub_keys.begin(), sub_keys.end());
+  std::vector<rocksdb::PinnableSlice> chunks(sub_keys.size());
+  std::vector<rocksdb::Status> statuses(sub_keys.size());
+  storage_->MultiGet(read_options, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), sub_key_slices.size(),
+                     sub_key_slices.data(), chunks.data(), statuses.data());
+
+  std::string bytes;
+  bytes.reserve(sub_keys.size() * kStringChunkBytes);
+  for (size_t i = 0; i < sub_keys.size(); i++) {
+    if (!statuses[i].ok() && !statuses[i].IsNotFound()) return statuses[i];
+    uint64_t chunk_offset = (first + i) * kStringChunkBytes;
+    uint64_t chunk_size = std::min(kStringChunkBytes, metadata.size - chunk_offset);
+    size_t prev_size = bytes.size();
+    if (statuses[i].ok()) bytes.append(chunks[i].data(), std::min<uint64_t>(chunks[i].size(), chunk_size));
+    bytes.resize(prev_size + chunk_size, '\0');
+  }
+  *value = bytes.substr(offset - first * kStringChunkBytes, length);
+  return rocksdb::Status::OK();
+}
+
+void String::putChunks(rocksdb::WriteBatchBase *batch, const std::string &ns_key, const Metadata &metadata,
+                       uint64_t offset, const Slice &bytes) {
+  for (uint64_t pos = 0; pos < bytes.size(); pos += kStringChunkBytes) {
+    std::string sub_key = InternalKey(ns_key, std::to_string(offset + pos), metadata.version,
+                                      storage_->IsSlotIdEncoded())
+                              .Encode();
+    batch->Put(sub_key, Slice(bytes.data() + pos, std::min(kStringChunkBytes, bytes.size() - pos)));
+  }
 }
 
 rocksdb::Status String::getValueAndExpire(const std::string &ns_key, std::string *value, uint64_t *expire) {
   value->clear();
 
   std::string raw_value;
-  auto s = getRawValue(ns_key, &raw_value);
+  auto s = GetRawValue(ns_key, &raw_value);
   if (!s.ok()) return s;
 
   size_t offset = Metadata::GetOffsetAfterExpire(raw_value[0]);
@@ -107,7 +194,63 @@ rocksdb::Status String::updateRawValue(const std::string &ns_key, const std::str
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisString);
   batch->PutLogData(log_data.Encode());
-  batch->Put(metadata_cf_handle_, ns_key, raw_value);
+  auto s = putRawValue(batch.Get(), ns_key, raw_value);
+  if (!s.ok()) return s;
+  return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+}
+
+rocksdb::Status String::putRawValue(rocksdb::WriteBatchBase *batch, const std::string &ns_key,
+                                    const std::string &raw_value) {
+  size_t header_offset = Metadata::GetOffsetAfterExpire(raw_value[0]);
+  uint64_t size = raw_value.size() - header_offset;
+  auto threshold = storage_->GetConfig()->string_chunk_threshold;
+  if (threshold <= 0 || size < static_cast<uint64_t>(threshold)) {
+    batch->Put(metadata_cf_handle_, ns_key, raw_value);
+    return rocksdb::Status::OK();
+  }
+
+  Metadata plain_metadata(kRedisString, false);
+  auto s = plain_metadata.Decode(raw_value);
+  if (!s.ok()) return s;
+
+  // A new version is used, so the chunks of the previous value are recycled by the compaction filter
+  Metadata metadata(kRedisString);
+  metadata.flags |= METADATA_STRING_CHUNKED_MASK;
+  metadata.expire = plain_metadata.expire;
+  metadata.size = size;
+  std::string bytes;
+  metadata.Encode(&bytes);
+  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  putChunks(batch, ns_key, metadata, 0, Slice(raw_value.data() + header_offset, size));
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status String::setRangeChunked(const std::string &ns_key, Metadata *metadata, uint64_t offset,
+                                        const std::string &value) {
+  if (value.empty()) return rocksdb::Status::OK();
+
+  // Only the chunks overlapping [offset, offset + value.size()) are read and rewritten
+  uint64_t end = offset + value.size();
+  uint64_t new_size = std::max(metadata->size, end);
+  uint64_t first_offset = offset / kStringChunkBytes * kStringChunkBytes;
+  uint64_t last_end = std::min(new_size, (end - 1) / kStringChunkBytes * kStringChunkBytes + kStringChunkBytes);
+  std::string bytes;
+  if (first_offset < metadata->size) {
+    auto s = readChunks(rocksdb::ReadOptions(), ns_key, *metadata, first_offset,
+                        std::min(metadata->size, last_end) - first_offset, &bytes);
+    if (!s.ok()) return s;
+  }
+  bytes.resize(last_end - first_offset, '\0');
+  bytes.replace(offset - first_offset, value.size(), value);
+
+  auto batch = storage_->GetWriteBatchBase();
+  WriteBatchLogData log_data(kRedisString, {std::to_string(kRedisCmdSetRange)});
+  batch->PutLogData(log_data.Encode());
+  metadata->size = new_size;
+  std::string metadata_bytes;
+  metadata->Encode(&metadata_bytes);
+  batch->Put(metadata_cf_handle_, ns_key, metadata_bytes);
+  putChunks(batch.Get(), ns_key, *metadata, first_offset, bytes);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -117,10 +260,17 @@ rocksdb::Status String::Append(const std::string &user_key, const std::string &v
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   std::string raw_value;
-  rocksdb::Status s = getRawValue(ns_key, &raw_value);
+  Metadata metadata(kRedisNone, false);
+  Slice rest;
+  rocksdb::Status s = GetMetadata({kRedisString}, ns_key, &raw_value, &metadata, &rest);
   if (!s.ok() && !s.IsNotFound()) return s;
+  if (s.ok() && metadata.IsChunkedString()) {
+    *new_size = metadata.size + value.size();
+    return setRangeChunked(ns_key, &metadata, metadata.size, value);
+  }
   if (s.IsNotFound()) {
-    Metadata metadata(kRedisString, false);
+    raw_value.clear();
+    metadata = Metadata(kRedisString, false);
     metadata.Encode(&raw_value);
   }
   raw_value.append(value);
@@ -170,13 +320,7 @@ rocksdb::Status String::GetEx(const std::string &user_key, std::string *value, u
   }
   metadata.Encode(&raw_data);
   raw_data.append(value->data(), value->size());
-  auto batch = storage_->GetWriteBatchBase();
-  WriteBatchLogData log_data(kRedisString);
-  batch->PutLogData(log_data.Encode());
-  batch->Put(metadata_cf_handle_, ns_key, raw_data);
-  s = storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
-  if (!s.ok()) return s;
-  return rocksdb::Status::OK();
+  return updateRawValue(ns_key, raw_data);
 }
 
 rocksdb::Status String::GetSet(const std::string &user_key, const std::string &new_value,
@@ -286,8 +430,14 @@ rocksdb::Status String::SetRange(const std::string &user_key, size_t offset, con
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   std::string raw_value;
-  rocksdb::Status s = getRawValue(ns_key, &raw_value);
+  Metadata metadata(kRedisNone, false);
+  Slice rest;
+  rocksdb::Status s = GetMetadata({kRedisString}, ns_key, &raw_value, &metadata, &rest);
   if (!s.ok() && !s.IsNotFound()) return s;
+  if (s.ok() && metadata.IsChunkedString()) {
+    *new_size = std::max<uint64_t>(metadata.size, offset + value.size());
+    return setRangeChunked(ns_key, &metadata, offset, value);
+  }
 
   if (s.IsNotFound()) {
     // Return 0 directly instead of storing an empty key when set nothing on a non-existing string.
@@ -296,7 +446,8 @@ rocksdb::Status String::SetRange(const std::string &user_key, size_t offset, con
       return rocksdb::Status::OK();
     }
 
-    Metadata metadata(kRedisString, false);
+    raw_value.clear();
+    metadata = Metadata(kRedisString, false);
     metadata.Encode(&raw_value);
   }
 
@@ -320,13 +471,77 @@ rocksdb::Status String::SetRange(const std::string &user_key, size_t offset, con
   return updateRawValue(ns_key, raw_value);
 }
 
+rocksdb::Status String::GetRange(const std::string &user_key, int start, int stop, std::optional<std::string> &value) {
+  value = std::nullopt;
+  std::string ns_key = AppendNamespacePrefix(user_key);
+
+  std::optional<LatestSnapShot> ss;
+  rocksdb::ReadOptions read_options;
+  Metadata metadata(kRedisNone, false);
+  std::string raw_value;
+  auto s = getMetadataForRead(ns_key, &ss, &read_options, &metadata, &raw_value);
+  if (!s.ok()) return s;
+
+  size_t header_offset = Metadata::GetOffsetAfterExpire(raw_value[0]);
+  auto size = static_cast<int64_t>(metadata.IsChunkedString() ? metadata.size : raw_value.size() - header_offset);
+  int64_t start_index = start < 0 ? size + start : start;
+  int64_t stop_index = stop < 0 ? size + stop : stop;
+  if (start_index < 0) start_index = 0;
+  if (stop_index > size) stop_index = size;
+  if (start_index > stop_index) return rocksdb::Status::OK();
+
+  auto length = static_cast<uint64_t>(std::min(stop_index, size - 1) - start_index + 1);
+  if (!metadata.IsChunkedString()) {
+    value = raw_value.substr(header_offset + start_index, length);
+    return rocksdb::Status::OK();
+  }
+  std::string range;
+  s = readChunks(read_options, ns_key, metadata, start_index, length, &range);
+  if (!s.ok()) return s;
+  value = std::move(range);
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status String::Strlen(const std::string &user_key, uint64_t *length) {
+  *length = 0;
+  std::string ns_key = AppendNamespacePrefix(user_key);
+
+  std::string raw_value;
+  Metadata metadata(kRedisNone, false);
+  Slice rest;
+  auto s = GetMetadata({kRedisString}, ns_key, &raw_value, &metadata, &rest);
+  if (!s.ok()) return s;
+  *length = metadata.IsChunkedString() ? metadata.size : rest.size();
+  return rocksdb::Status::OK();
+}
+
 rocksdb::Status String::IncrBy(const std::string &user_key, int64_t increment, int64_t *new_value) {
   std::string ns_key = AppendNamespacePrefix(user_key);
+  auto apply = [this, &ns_key](const std::vector<engine::IncrementCombiner::Increment *> &increments) {
+    applyIncrements(ns_key, increments);
+  };
+  // The writes of a transaction or a script go into its own write batch, so they can't be combined
+  // with others. Its keys are also locked by this thread, the leader of a combined group would wait
+  // for the lock while this thread waits for the group.
+  if (storage_->IsTxnMode() || txn_held_locks) {
+    engine::IncrementCombiner::Increment inc{increment};
+    apply({&inc});
+    if (inc.status.ok()) *new_value = inc.new_value;
+    return inc.status;
+  }
+  return storage_->GetIncrementCombiner()->IncrBy("s" + ns_key, increment, new_value, apply);
+}
+
+void String::applyIncrements(const std::string &ns_key,
+                             const std::vector<engine::IncrementCombiner::Increment *> &increments) {
+  auto fail_all = [&increments](const rocksdb::Status &s) {
+    for (auto *inc : increments) inc->status = s;
+  };
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   std::string raw_value;
-  rocksdb::Status s = getRawValue(ns_key, &raw_value);
-  if (!s.ok() && !s.IsNotFound()) return s;
+  rocksdb::Status s = GetRawValue(ns_key, &raw_value);
+  if (!s.ok() && !s.IsNotFound()) return fail_all(s);
   if (s.IsNotFound()) {
     Metadata metadata(kRedisString, false);
     metadata.Encode(&raw_value);
@@ -338,30 +553,43 @@ rocksdb::Status String::IncrBy(const std::string &user_key, int64_t increment, i
   if (!value.empty()) {
     auto parse_result = ParseInt<int64_t>(value, 10);
     if (!parse_result) {
-      return rocksdb::Status::InvalidArgument("value is not an integer or out of range");
+      return fail_all(rocksdb::Status::InvalidArgument("value is not an integer or out of range"));
     }
     if (isspace(value[0])) {
-      return rocksdb::Status::InvalidArgument("value is not an integer");
+      return fail_all(rocksdb::Status::InvalidArgument("value is not an integer"));
     }
     n = *parse_result;
   }
-  if ((increment < 0 && n <= 0 && increment < (LLONG_MIN - n)) ||
-      (increment > 0 && n >= 0 && increment > (LLONG_MAX - n))) {
-    return rocksdb::Status::InvalidArgument("increment or decrement would overflow");
+
+  bool updated = false;
+  for (auto *inc : increments) {
+    int64_t increment = inc->delta;
+    if ((increment < 0 && n <= 0 && increment < (LLONG_MIN - n)) ||
+        (increment > 0 && n >= 0 && increment > (LLONG_MAX - n))) {
+      inc->status = rocksdb::Status::InvalidArgument("increment or decrement would overflow");
+      continue;
+    }
+    n += increment;
+    inc->new_value = n;
+    updated = true;
   }
-  n += increment;
-  *new_value = n;
+  if (!updated) return;
 
   raw_value = raw_value.substr(0, offset);
   raw_value.append(std::to_string(n));
-  return updateRawValue(ns_key, raw_value);
+  s = updateRawValue(ns_key, raw_value);
+  if (!s.ok()) {
+    for (auto *inc : increments) {
+      if (inc->status.ok()) inc->status = s;
+    }
+  }
 }
 
 rocksdb::Status String::IncrByFloat(const std::string &user_key, double increment, double *new_value) {
   std::string ns_key = AppendNamespacePrefix(user_key);
   LockGuard guard(storage_->GetLockManager(), ns_key);
   std::string raw_value;
-  rocksdb::Status s = getRawValue(ns_key, &raw_value);
+  rocksdb::Status s = GetRawValue(ns_key, &raw_value);
   if (!s.ok() && !s.IsNotFound()) return s;
 
   if (s.IsNotFound()) {
@@ -420,7 +648,8 @@ rocksdb::Status String::MSet(const std::vector<StringPair> &pairs, uint64_t ttl,
     metadata.Encode(&bytes);
     bytes.append(pair.value.data(), pair.value.size());
     std::string ns_key = AppendNamespacePrefix(pair.key);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    auto s = putRawValue(batch.Get(), ns_key, bytes);
+    if (!s.ok()) return s;
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -89,6 +89,8 @@ class String : public Database {
   rocksdb::Status SetNX(const std::string &user_key, const std::string &value, uint64_t ttl, bool *flag);
   rocksdb::Status SetXX(const std::string &user_key, const std::string &value, uint64_t ttl, bool *flag);
   rocksdb::Status SetRange(const std::string &user_key, size_t offset, const std::string &value, uint64_t *new_size);
+  rocksdb::Status GetRange(const std::string &user_key, int start, int stop, std::optional<std::string> &value);
+  rocksdb::Status Strlen(const std::string &user_key, uint64_t *length);
   rocksdb::Status IncrBy(const std::string &user_key, int64_t increment, int64_t *new_value);
   rocksdb::Status IncrByFloat(const std::string &user_key, double increment, double *new_value);
   std::vector<rocksdb::Status> MGet(const std::vector<Slice> &keys, std::vector<std::string> *values);
@@ -99,14 +101,28 @@ class String : public Database {
   rocksdb::Status CAD(const std::string &user_key, const std::string &value, int *flag);
   rocksdb::Status LCS(const std::string &user_key1, const std::string &user_key2, StringLCSArgs args,
                       StringLCSResult *rst);
+  // Read the raw value of a string in the layout of the plain ones, i.e. the metadata header followed
+  // by the value, which is also used by the bitmap commands on strings.
+  rocksdb::Status GetRawValue(const std::string &ns_key, std::string *raw_value);
 
  private:
   rocksdb::Status getValue(const std::string &ns_key, std::string *value);
   rocksdb::Status getValueAndExpire(const std::string &ns_key, std::string *value, uint64_t *expire);
   std::vector<rocksdb::Status> getValues(const std::vector<Slice> &ns_keys, std::vector<std::string> *values);
-  rocksdb::Status getRawValue(const std::string &ns_key, std::string *raw_value);
   std::vector<rocksdb::Status> getRawValues(const std::vector<Slice> &keys, std::vector<std::string> *raw_values);
+  rocksdb::Status getMetadataForRead(const std::string &ns_key, std::optional<LatestSnapShot> *ss,
+                                     rocksdb::ReadOptions *read_options, Metadata *metadata, std::string *raw_value);
+  rocksdb::Status readChunks(const rocksdb::ReadOptions &read_options, const std::string &ns_key,
+                             const Metadata &metadata, uint64_t offset, uint64_t length, std::string *value);
+  void putChunks(rocksdb::WriteBatchBase *batch, const std::string &ns_key, const Metadata &metadata, uint64_t offset,
+                 const Slice &bytes);
   rocksdb::Status updateRawValue(const std::string &ns_key, const std::string &raw_value);
+  // Put the raw value of a plain string, which is split into chunks if it reaches `string-chunk-threshold`
+  rocksdb::Status putRawValue(rocksdb::WriteBatchBase *batch, const std::string &ns_key, const std::string &raw_value);
+  rocksdb::Status setRangeChunked(const std::string &ns_key, Metadata *metadata, uint64_t offset,
+                                  const std::string &value);
+  void applyIncrements(const std::string &ns_key,
+                       const std::vector<engine::IncrementCombiner::Increment *> &increments);
 };
 
 }  // namespace redis
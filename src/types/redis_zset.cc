@@ -20,6 +20,7 @@
 
 #include "redis_zset.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <map>
@@ -29,9 +30,248 @@
 
 #include "db_util.h"
 #include "sample_helper.h"
+#include "storage/iterator.h"
+#include "xxhash.h"
 
 namespace redis {
 
+namespace {
+
+// The rank index is a counted skip list over the score keys, i.e. the 8-byte encoded score (see PutDouble) followed
+// by the member, which is the order of the members in the sorted set. On each level, the empty key and some of the
+// members start an entry counting the members from there to the next entry. A hash of the score key picks the
+// levels of a member: 1 in 2^kRankIndexFanoutBits members start an entry on the bottom level, and the same share
+// of those on each level above, so the levels only depend on the members and are never rebalanced. The
+// members before a score key are the counts of the entries passed on the way down the levels, plus the ones before
+// it in a single bucket of the bottom level, which are scanned in the score column family even if they share its
+// score. A member update rewrites the small entry holding it on every level, and splits or merges the entries it
+// starts, if any.
+constexpr int kRankIndexFanoutBits = 5;
+
+// The number of levels where the member of the score key starts an entry, from the bottom one
+int RankIndexHeight(const Slice &score_key) {
+  uint64_t hash = XXH64(score_key.data(), score_key.size(), /*seed=*/0);
+  int height = 0;
+  while (height < ZSet::kRankIndexLevels && (hash & ((1 << kRankIndexFanoutBits) - 1)) == 0) {
+    hash >>= kRankIndexFanoutBits;
+    height++;
+  }
+  return height;
+}
+
+std::string RankIndexEntryKey(const Slice &ns_key, uint64_t version, bool slot_id_encoded, int level,
+                              const Slice &start) {
+  std::string sub_key;
+  PutFixed8(&sub_key, static_cast<uint8_t>(level));
+  sub_key.append(start.data(), start.size());
+  return InternalKey(ns_key, sub_key, version, slot_id_encoded).Encode();
+}
+
+// Decode the entry under the iterator, if it's one of the given level
+bool GetRankIndexEntry(rocksdb::Iterator *iter, bool slot_id_encoded, int level, std::string *start,
+                       uint64_t *count) {
+  if (!iter->Valid()) return false;
+  InternalKey ikey(iter->key(), slot_id_encoded);
+  Slice sub_key = ikey.GetSubKey();
+  Slice value = iter->value();
+  uint8_t entry_level = 0;
+  if (!GetFixed8(&sub_key, &entry_level) || entry_level != level || !GetFixed64(&value, count)) return false;
+  *start = sub_key.ToString();
+  return true;
+}
+
+// The smallest score key after all the ones with the given encoded score
+std::string NextScoreBytes(std::string score_bytes) {
+  for (auto it = score_bytes.rbegin(); it != score_bytes.rend(); it++) {
+    if (static_cast<uint8_t>(*it) != 0xff) {
+      (*it)++;
+      break;
+    }
+    *it = 0;
+  }
+  return score_bytes;
+}
+
+// Apply the member changes of a write to the rank index one by one. The score keys and the entries are staged in an
+// indexed batch over the database, so that each change sees the ones before it and none after, whether or not the
+// write batch of the command is readable as it is in a transaction.
+class RankIndexWriter {
+ public:
+  RankIndexWriter(engine::Storage *storage, rocksdb::ColumnFamilyHandle *score_cf_handle,
+                  rocksdb::ColumnFamilyHandle *rank_cf_handle, const Slice &ns_key, uint64_t version)
+      : storage_(storage),
+        score_cf_handle_(score_cf_handle),
+        rank_cf_handle_(rank_cf_handle),
+        ns_key_(ns_key),
+        version_(version),
+        prefix_key_(InternalKey(ns_key, "", version, storage->IsSlotIdEncoded()).Encode()),
+        next_version_prefix_key_(InternalKey(ns_key, "", version + 1, storage->IsSlotIdEncoded()).Encode()),
+        staged_(rocksdb::BytewiseComparator(), 0, /*overwrite_key=*/true) {}
+
+  rocksdb::Status Write(const std::map<std::string, int64_t> &deltas, rocksdb::WriteBatchBase *batch) {
+    // roll back the score keys which might be in the write batch already
+    for (const auto &[score_key, delta] : deltas) {
+      if (delta > 0) staged_.Delete(score_cf_handle_, scoreKey(score_key));
+      if (delta < 0) staged_.Put(score_cf_handle_, scoreKey(score_key), Slice());
+    }
+
+    read_options_ = storage_->DefaultScanOptions();
+    upper_bound_ = next_version_prefix_key_;
+    read_options_.iterate_upper_bound = &upper_bound_;
+    lower_bound_ = prefix_key_;
+    read_options_.iterate_lower_bound = &lower_bound_;
+    score_iter_.reset(newIterator(score_cf_handle_));
+    rank_iter_.reset(newIterator(rank_cf_handle_));
+
+    for (const auto &[score_key, delta] : deltas) {
+      auto s = delta > 0 ? insert(score_key) : (delta < 0 ? remove(score_key) : rocksdb::Status::OK());
+      if (!s.ok()) return s;
+    }
+
+    std::unique_ptr<rocksdb::WBWIIterator> iter(staged_.NewIterator(rank_cf_handle_));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      auto entry = iter->Entry();
+      if (entry.type == rocksdb::kPutRecord) {
+        batch->Put(rank_cf_handle_, entry.key, entry.value);
+      } else {
+        batch->Delete(rank_cf_handle_, entry.key);
+      }
+    }
+    return rocksdb::Status::OK();
+  }
+
+ private:
+  engine::Storage *storage_;
+  rocksdb::ColumnFamilyHandle *score_cf_handle_;
+  rocksdb::ColumnFamilyHandle *rank_cf_handle_;
+  Slice ns_key_;
+  uint64_t version_;
+  std::string prefix_key_;
+  std::string next_version_prefix_key_;
+  rocksdb::WriteBatchWithIndex staged_;
+  rocksdb::Slice upper_bound_;
+  rocksdb::Slice lower_bound_;
+  rocksdb::ReadOptions read_options_;
+  std::unique_ptr<rocksdb::Iterator> score_iter_;
+  std::unique_ptr<rocksdb::Iterator> rank_iter_;
+
+  static rocksdb::Status inconsistent() {
+    return rocksdb::Status::Corruption("the rank index of the sorted set is inconsistent with its members");
+  }
+
+  rocksdb::Iterator *newIterator(rocksdb::ColumnFamilyHandle *cf_handle) {
+    return staged_.NewIteratorWithBase(cf_handle, storage_->NewIterator(read_options_, cf_handle), &read_options_);
+  }
+
+  std::string scoreKey(const Slice &score_key) const {
+    return InternalKey(ns_key_, score_key, version_, storage_->IsSlotIdEncoded()).Encode();
+  }
+
+  std::string entryKey(int level, const Slice &start) const {
+    return RankIndexEntryKey(ns_key_, version_, storage_->IsSlotIdEncoded(), level, start);
+  }
+
+  bool getEntry(int level, std::string *start, uint64_t *count) const {
+    return GetRankIndexEntry(rank_iter_.get(), storage_->IsSlotIdEncoded(), level, start, count);
+  }
+
+  void putEntry(int level, const Slice &start, uint64_t count) {
+    if (count == 0) {
+      staged_.Delete(rank_cf_handle_, entryKey(level, start));
+      return;
+    }
+    std::string value;
+    PutFixed64(&value, count);
+    staged_.Put(rank_cf_handle_, entryKey(level, start), value);
+  }
+
+  // Find the last entry of the level starting at (or strictly before) the score key, or the head of the level
+  // without any members if there is none
+  void floorEntry(int level, const Slice &score_key, bool inclusive, std::string *start, uint64_t *count) {
+    rank_iter_->SeekForPrev(entryKey(level, score_key));
+    if (!inclusive && getEntry(level, start, count) && *start == score_key) rank_iter_->Prev();
+    if (!getEntry(level, start, count)) {
+      start->clear();
+      *count = 0;
+    }
+  }
+
+  std::optional<std::string> nextEntry(int level, const Slice &start) {
+    std::string next_start;
+    uint64_t count = 0;
+    rank_iter_->Seek(entryKey(level, start));
+    if (getEntry(level, &next_start, &count) && next_start == start) rank_iter_->Next();
+    if (!getEntry(level, &next_start, &count)) return std::nullopt;
+    return next_start;
+  }
+
+  // Count the members in [from, to), by the score keys on the bottom level and by the entries below otherwise
+  uint64_t countRange(int level, const Slice &from, const std::optional<std::string> &to) {
+    uint64_t total = 0;
+    if (level == 0) {
+      for (score_iter_->Seek(scoreKey(from)); score_iter_->Valid(); score_iter_->Next()) {
+        InternalKey ikey(score_iter_->key(), storage_->IsSlotIdEncoded());
+        if (to && ikey.GetSubKey().compare(*to) >= 0) break;
+        total++;
+      }
+      return total;
+    }
+    std::string start;
+    uint64_t count = 0;
+    for (rank_iter_->Seek(entryKey(level - 1, from)); getEntry(level - 1, &start, &count); rank_iter_->Next()) {
+      if (to && start >= *to) break;
+      total += count;
+    }
+    return total;
+  }
+
+  rocksdb::Status insert(const std::string &score_key) {
+    staged_.Put(score_cf_handle_, scoreKey(score_key), Slice());
+    int height = RankIndexHeight(score_key);
+    for (int level = 0; level < ZSet::kRankIndexLevels; level++) {
+      std::string start;
+      uint64_t count = 0;
+      floorEntry(level, score_key, /*inclusive=*/true, &start, &count);
+      if (level >= height) {
+        putEntry(level, start, count + 1);
+        continue;
+      }
+      // the member starts an entry, which takes over the members up to the next entry from the one holding it
+      auto next_start = nextEntry(level, start);
+      uint64_t split_count = countRange(level, score_key, next_start);
+      if (split_count == 0 || split_count > count + 1) return inconsistent();
+      putEntry(level, score_key, split_count);
+      putEntry(level, start, count + 1 - split_count);
+    }
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status remove(const std::string &score_key) {
+    staged_.Delete(score_cf_handle_, scoreKey(score_key));
+    int height = RankIndexHeight(score_key);
+    for (int level = 0; level < ZSet::kRankIndexLevels; level++) {
+      std::string start;
+      uint64_t count = 0;
+      floorEntry(level, score_key, /*inclusive=*/true, &start, &count);
+      if (level >= height) {
+        if (count == 0) return inconsistent();
+        putEntry(level, start, count - 1);
+        continue;
+      }
+      // the entry started by the member merges into the previous one
+      if (start != score_key) return inconsistent();
+      std::string prev_start;
+      uint64_t prev_count = 0;
+      floorEntry(level, score_key, /*inclusive=*/false, &prev_start, &prev_count);
+      putEntry(level, score_key, 0);
+      putEntry(level, prev_start, prev_count + count - 1);
+    }
+    return rocksdb::Status::OK();
+  }
+};
+
+}  // namespace
+
 rocksdb::Status ZSet::GetMetadata(const Slice &ns_key, ZSetMetadata *metadata) {
   return Database::GetMetadata({kRedisZSet}, ns_key, metadata);
 }
@@ -45,12 +285,17 @@ rocksdb::Status ZSet::Add(const Slice &user_key, ZAddFlags flags, MemberScores *
   ZSetMetadata metadata;
   rocksdb::Status s = GetMetadata(ns_key, &metadata);
   if (!s.ok() && !s.IsNotFound()) return s;
+  if (s.IsNotFound()) {
+    metadata.rank_indexed = storage_->GetConfig()->zset_rank_index;
+    initInlineEncoding(&metadata);
+  }
 
   int added = 0;
   int changed = 0;
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisZSet);
   batch->PutLogData(log_data.Encode());
+  RankIndexDeltas rank_deltas;
   std::unordered_set<std::string_view> added_member_keys;
   for (auto it = mscores->rbegin(); it != mscores->rend(); it++) {
     if (!added_member_keys.insert(it->member).second) {
@@ -59,7 +304,7 @@ rocksdb::Status ZSet::Add(const Slice &user_key, ZAddFlags flags, MemberScores *
     std::string member_key = InternalKey(ns_key, it->member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     if (metadata.size > 0) {
       std::string old_score_bytes;
-      s = storage_->Get(rocksdb::ReadOptions(), member_key, &old_score_bytes);
+      s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, it->member, &old_score_bytes);
       if (!s.ok() && !s.IsNotFound()) return s;
       if (s.ok()) {
         if (!s.IsNotFound() && flags.HasNX()) {
@@ -79,6 +324,14 @@ rocksdb::Status ZSet::Add(const Slice &user_key, ZAddFlags flags, MemberScores *
           if ((flags.HasLT() && it->score >= old_score) || (flags.HasGT() && it->score <= old_score)) {
             continue;
           }
+          changed++;
+          if (metadata.IsInlineEncoded()) {
+            std::string new_score_bytes;
+            PutDouble(&new_score_bytes, it->score);
+            putSubKey(batch.Get(), ns_key, &metadata, it->member, new_score_bytes);
+            continue;
+          }
+          addRankIndexDelta(&rank_deltas, old_score_bytes, it->member, -1);
           old_score_bytes.append(it->member);
           std::string old_score_key =
               InternalKey(ns_key, old_score_bytes, metadata.version, storage_->IsSlotIdEncoded()).Encode();
@@ -86,11 +339,11 @@ rocksdb::Status ZSet::Add(const Slice &user_key, ZAddFlags flags, MemberScores *
           std::string new_score_bytes;
           PutDouble(&new_score_bytes, it->score);
           batch->Put(member_key, new_score_bytes);
+          addRankIndexDelta(&rank_deltas, new_score_bytes, it->member, 1);
           new_score_bytes.append(it->member);
           std::string new_score_key =
               InternalKey(ns_key, new_score_bytes, metadata.version, storage_->IsSlotIdEncoded()).Encode();
           batch->Put(score_cf_handle_, new_score_key, Slice());
-          changed++;
         }
         continue;
       }
@@ -100,18 +353,27 @@ rocksdb::Status ZSet::Add(const Slice &user_key, ZAddFlags flags, MemberScores *
     }
     std::string score_bytes;
     PutDouble(&score_bytes, it->score);
+    added++;
+    if (metadata.IsInlineEncoded()) {
+      putSubKey(batch.Get(), ns_key, &metadata, it->member, score_bytes);
+      continue;
+    }
     batch->Put(member_key, score_bytes);
+    addRankIndexDelta(&rank_deltas, score_bytes, it->member, 1);
     score_bytes.append(it->member);
     std::string score_key = InternalKey(ns_key, score_bytes, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     batch->Put(score_cf_handle_, score_key, Slice());
-    added++;
   }
+  s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+  if (!s.ok()) return s;
   if (added > 0) {
     *added_cnt = added;
     metadata.size += added;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+  }
+  // the scores of an inline sorted set are in the metadata, so it's rewritten by any update
+  if (added > 0 || (changed > 0 && metadata.IsInlineEncoded())) {
+    s = putMetadata(batch.Get(), ns_key, &metadata);
+    if (!s.ok()) return s;
   }
   if (flags.HasCH()) {
     *added_cnt += changed;
@@ -132,7 +394,43 @@ rocksdb::Status ZSet::Card(const Slice &user_key, uint64_t *size) {
 }
 
 rocksdb::Status ZSet::Count(const Slice &user_key, const RangeScoreSpec &spec, uint64_t *size) {
-  return RangeByScore(user_key, spec, nullptr, size);
+  *size = 0;
+
+  std::string ns_key = AppendNamespacePrefix(user_key);
+
+  ZSetMetadata metadata(false);
+  rocksdb::Status s = GetMetadata(ns_key, &metadata);
+  if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
+  if (!metadata.rank_indexed || metadata.IsInlineEncoded()) return RangeByScore(user_key, spec, nullptr, size);
+
+  // -0 and +0 are equal scores but adjacent in the encoded order, so pick the one covering both of them
+  double min = spec.min == 0 ? (spec.minex ? 0.0 : -0.0) : spec.min;
+  double max = spec.max == 0 ? (spec.maxex ? -0.0 : 0.0) : spec.max;
+  std::string min_score_bytes, max_score_bytes;
+  PutDouble(&min_score_bytes, min);
+  PutDouble(&max_score_bytes, max);
+  // an exclusive min or an inclusive max bound covers the members of its score, which sort before the next one
+  if (spec.minex) min_score_bytes = NextScoreBytes(std::move(min_score_bytes));
+  if (!spec.maxex) max_score_bytes = NextScoreBytes(std::move(max_score_bytes));
+
+  std::string prefix_key = InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode();
+  std::string next_version_prefix_key =
+      InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode();
+  rocksdb::ReadOptions read_options = storage_->DefaultScanOptions();
+  LatestSnapShot ss(storage_);
+  read_options.snapshot = ss.GetSnapShot();
+  rocksdb::Slice upper_bound(next_version_prefix_key);
+  read_options.iterate_upper_bound = &upper_bound;
+  rocksdb::Slice lower_bound(prefix_key);
+  read_options.iterate_lower_bound = &lower_bound;
+  uint64_t begin = 0, end = 0;
+  s = countByRankIndex(ns_key, metadata, read_options, min_score_bytes, &begin);
+  if (!s.ok()) return s;
+  s = countByRankIndex(ns_key, metadata, read_options, max_score_bytes, &end);
+  if (!s.ok()) return s;
+
+  *size = end > begin ? end - begin : 0;
+  return rocksdb::Status::OK();
 }
 
 rocksdb::Status ZSet::IncrBy(const Slice &user_key, const Slice &member, double increment, double *score) {
@@ -177,28 +475,29 @@ rocksdb::Status ZSet::Pop(const Slice &user_key, int count, bool min, MemberScor
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options, score_cf_handle_);
+  auto iter = newScoreIterator(ns_key, metadata, read_options);
   iter->Seek(start_key);
   // see comment in RangeByScore()
   if (!min && (!iter->Valid() || !iter->key().starts_with(prefix_key))) {
     iter->SeekForPrev(start_key);
   }
+  RankIndexDeltas rank_deltas;
   for (; iter->Valid() && iter->key().starts_with(prefix_key); min ? iter->Next() : iter->Prev()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     Slice score_key = ikey.GetSubKey();
+    Slice encoded_score(score_key.data(), sizeof(double));
     GetDouble(&score_key, &score);
     mscores->emplace_back(MemberScore{score_key.ToString(), score});
-    std::string default_cf_key = InternalKey(ns_key, score_key, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-    batch->Delete(default_cf_key);
-    batch->Delete(score_cf_handle_, iter->key());
+    deleteMember(batch.Get(), ns_key, &metadata, score_key, encoded_score, &rank_deltas);
     if (mscores->size() >= static_cast<unsigned>(count)) break;
   }
 
   if (!mscores->empty()) {
+    s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+    if (!s.ok()) return s;
     metadata.size -= mscores->size();
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    s = putMetadata(batch.Get(), ns_key, &metadata);
+    if (!s.ok()) return s;
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -225,7 +524,7 @@ rocksdb::Status ZSet::RangeByRank(const Slice &user_key, const RangeRankSpec &sp
   if (start < 0) start += static_cast<int>(metadata.size);
   if (stop < 0) stop += static_cast<int>(metadata.size);
   if (start < 0) start = 0;
-  if (stop < 0 || start > stop) {
+  if (stop < 0 || start > stop || start >= static_cast<int>(metadata.size)) {
     return rocksdb::Status::OK();
   }
 
@@ -247,23 +546,35 @@ rocksdb::Status ZSet::RangeByRank(const Slice &user_key, const RangeRankSpec &sp
   read_options.iterate_lower_bound = &lower_bound;
 
   auto batch = storage_->GetWriteBatchBase();
-  auto iter = util::UniqueIterator(storage_, read_options, score_cf_handle_);
-  iter->Seek(start_key);
-  // see comment in RangeByScore()
-  if (spec.reversed && (!iter->Valid() || !iter->key().starts_with(prefix_key))) {
-    iter->SeekForPrev(start_key);
+  auto iter = newScoreIterator(ns_key, metadata, read_options);
+  int count = 0;
+  if (metadata.rank_indexed && !metadata.IsInlineEncoded() && start > 0) {
+    // jump to the first member in range instead of counting the members before it
+    uint64_t rank = !(spec.reversed) ? start : metadata.size - 1 - start;
+    std::string bucket_start;
+    uint64_t offset = 0;
+    s = seekByRankIndex(ns_key, metadata, read_options, rank, &bucket_start, &offset);
+    if (!s.ok()) return s;
+    iter->Seek(InternalKey(ns_key, bucket_start, metadata.version, storage_->IsSlotIdEncoded()).Encode());
+    for (; offset > 0 && iter->Valid(); offset--) iter->Next();
+    count = start;
+  } else {
+    iter->Seek(start_key);
+    // see comment in RangeByScore()
+    if (spec.reversed && (!iter->Valid() || !iter->key().starts_with(prefix_key))) {
+      iter->SeekForPrev(start_key);
+    }
   }
 
-  int count = 0;
+  RankIndexDeltas rank_deltas;
   for (; iter->Valid() && iter->key().starts_with(prefix_key); !(spec.reversed) ? iter->Next() : iter->Prev()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     Slice score_key = ikey.GetSubKey();
+    Slice encoded_score(score_key.data(), sizeof(double));
     GetDouble(&score_key, &score);
     if (count >= start) {
       if (spec.with_deletion) {
-        std::string sub_key = InternalKey(ns_key, score_key, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-        batch->Delete(sub_key);
-        batch->Delete(score_cf_handle_, iter->key());
+        deleteMember(batch.Get(), ns_key, &metadata, score_key, encoded_score, &rank_deltas);
         removed_subkey++;
       } else {
         if (mscores) mscores->emplace_back(MemberScore{score_key.ToString(), score});
@@ -274,10 +585,11 @@ rocksdb::Status ZSet::RangeByRank(const Slice &user_key, const RangeRankSpec &sp
   }
 
   if (removed_subkey) {
+    s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+    if (!s.ok()) return s;
     metadata.size -= removed_subkey;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    s = putMetadata(batch.Get(), ns_key, &metadata);
+    if (!s.ok()) return s;
     return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
   }
   return rocksdb::Status::OK();
@@ -353,7 +665,7 @@ rocksdb::Status ZSet::RangeByScore(const Slice &user_key, const RangeScoreSpec &
   read_options.iterate_lower_bound = &lower_bound;
 
   int pos = 0;
-  auto iter = util::UniqueIterator(storage_, read_options, score_cf_handle_);
+  auto iter = newScoreIterator(ns_key, metadata, read_options);
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisZSet);
   batch->PutLogData(log_data.Encode());
@@ -366,9 +678,11 @@ rocksdb::Status ZSet::RangeByScore(const Slice &user_key, const RangeScoreSpec &
     }
   }
 
+  RankIndexDeltas rank_deltas;
   for (; iter->Valid() && iter->key().starts_with(prefix_key); !spec.reversed ? iter->Next() : iter->Prev()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     Slice score_key = ikey.GetSubKey();
+    Slice encoded_score(score_key.data(), sizeof(double));
     double score = NAN;
     GetDouble(&score_key, &score);
     if (spec.reversed) {
@@ -380,9 +694,7 @@ rocksdb::Status ZSet::RangeByScore(const Slice &user_key, const RangeScoreSpec &
     }
     if (spec.offset >= 0 && pos++ < spec.offset) continue;
     if (spec.with_deletion) {
-      std::string sub_key = InternalKey(ns_key, score_key, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-      batch->Delete(sub_key);
-      batch->Delete(score_cf_handle_, iter->key());
+      deleteMember(batch.Get(), ns_key, &metadata, score_key, encoded_score, &rank_deltas);
     } else {
       if (mscores) mscores->emplace_back(MemberScore{score_key.ToString(), score});
     }
@@ -391,10 +703,11 @@ rocksdb::Status ZSet::RangeByScore(const Slice &user_key, const RangeScoreSpec &
   }
 
   if (spec.with_deletion && *removed_cnt > 0) {
+    s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+    if (!s.ok()) return s;
     metadata.size -= *removed_cnt;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    s = putMetadata(batch.Get(), ns_key, &metadata);
+    if (!s.ok()) return s;
     return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
   }
   return rocksdb::Status::OK();
@@ -437,7 +750,7 @@ rocksdb::Status ZSet::RangeByLex(const Slice &user_key, const RangeLexSpec &spec
   read_options.iterate_lower_bound = &lower_bound;
 
   int pos = 0;
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = newSubKeyIterator(ns_key, metadata, read_options);
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisZSet);
   batch->PutLogData(log_data.Encode());
@@ -452,6 +765,7 @@ rocksdb::Status ZSet::RangeByLex(const Slice &user_key, const RangeLexSpec &spec
     }
   }
 
+  RankIndexDeltas rank_deltas;
   for (; iter->Valid() && iter->key().starts_with(prefix_key); (!spec.reversed ? iter->Next() : iter->Prev())) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     Slice member = ikey.GetSubKey();
@@ -468,11 +782,7 @@ rocksdb::Status ZSet::RangeByLex(const Slice &user_key, const RangeLexSpec &spec
     }
     if (spec.offset >= 0 && pos++ < spec.offset) continue;
     if (spec.with_deletion) {
-      std::string score_bytes = iter->value().ToString();
-      score_bytes.append(member.data(), member.size());
-      std::string score_key = InternalKey(ns_key, score_bytes, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-      batch->Delete(score_cf_handle_, score_key);
-      batch->Delete(iter->key());
+      deleteMember(batch.Get(), ns_key, &metadata, member, iter->value(), &rank_deltas);
     } else {
       if (mscores) mscores->emplace_back(MemberScore{member.ToString(), DecodeDouble(iter->value().data())});
     }
@@ -481,10 +791,11 @@ rocksdb::Status ZSet::RangeByLex(const Slice &user_key, const RangeLexSpec &spec
   }
 
   if (spec.with_deletion && *removed_cnt > 0) {
+    s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+    if (!s.ok()) return s;
     metadata.size -= *removed_cnt;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    s = putMetadata(batch.Get(), ns_key, &metadata);
+    if (!s.ok()) return s;
     return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
   }
   return rocksdb::Status::OK();
@@ -497,12 +808,9 @@ rocksdb::Status ZSet::Score(const Slice &user_key, const Slice &member, double *
   if (!s.ok()) return s;
 
   rocksdb::ReadOptions read_options;
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
 
   std::string score_bytes;
-  std::string member_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  s = storage_->Get(read_options, member_key, &score_bytes);
+  s = getSubKey(read_options, ns_key, metadata, member, &score_bytes);
   if (!s.ok()) return s;
   *score = DecodeDouble(score_bytes.data());
   return rocksdb::Status::OK();
@@ -521,28 +829,26 @@ rocksdb::Status ZSet::Remove(const Slice &user_key, const std::vector<Slice> &me
   WriteBatchLogData log_data(kRedisZSet);
   batch->PutLogData(log_data.Encode());
   int removed = 0;
+  RankIndexDeltas rank_deltas;
   std::unordered_set<std::string_view> mset;
   for (const auto &member : members) {
     if (!mset.insert(member.ToStringView()).second) {
       continue;
     }
-    std::string member_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     std::string score_bytes;
-    s = storage_->Get(rocksdb::ReadOptions(), member_key, &score_bytes);
+    s = getSubKey(rocksdb::ReadOptions(), ns_key, metadata, member, &score_bytes);
     if (s.ok()) {
-      score_bytes.append(member.data(), member.size());
-      std::string score_key = InternalKey(ns_key, score_bytes, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-      batch->Delete(member_key);
-      batch->Delete(score_cf_handle_, score_key);
+      deleteMember(batch.Get(), ns_key, &metadata, member, score_bytes, &rank_deltas);
       removed++;
     }
   }
   if (removed > 0) {
+    s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+    if (!s.ok()) return s;
     *removed_cnt = removed;
     metadata.size -= removed;
-    std::string bytes;
-    metadata.Encode(&bytes);
-    batch->Put(metadata_cf_handle_, ns_key, bytes);
+    s = putMetadata(batch.Get(), ns_key, &metadata);
+    if (!s.ok()) return s;
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -561,8 +867,7 @@ rocksdb::Status ZSet::Rank(const Slice &user_key, const Slice &member, bool reve
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
   std::string score_bytes;
-  std::string member_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
-  s = storage_->Get(read_options, member_key, &score_bytes);
+  s = getSubKey(read_options, ns_key, metadata, member, &score_bytes);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
 
   double target_score = DecodeDouble(score_bytes.data());
@@ -581,7 +886,18 @@ rocksdb::Status ZSet::Rank(const Slice &user_key, const Slice &member, bool reve
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options, score_cf_handle_);
+  auto iter = newScoreIterator(ns_key, metadata, read_options);
+  if (metadata.rank_indexed && !metadata.IsInlineEncoded()) {
+    // the members with the same score are ordered by member, so the score key of the member tells its rank
+    uint64_t forward_rank = 0;
+    s = countByRankIndex(ns_key, metadata, read_options, score_bytes + member.ToString(), &forward_rank);
+    if (!s.ok()) return s;
+
+    *member_rank = static_cast<int>(!reversed ? forward_rank : metadata.size - 1 - forward_rank);
+    *member_score = target_score;
+    return rocksdb::Status::OK();
+  }
+
   iter->Seek(start_key);
   // see comment in RangeByScore()
   if (reversed && (!iter->Valid() || !iter->key().starts_with(prefix_key))) {
@@ -606,22 +922,31 @@ rocksdb::Status ZSet::Overwrite(const Slice &user_key, const MemberScores &mscor
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   ZSetMetadata metadata;
+  metadata.rank_indexed = storage_->GetConfig()->zset_rank_index;
+  initInlineEncoding(&metadata);
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisZSet);
   batch->PutLogData(log_data.Encode());
+  RankIndexDeltas rank_deltas;
   for (const auto &ms : mscores) {
     std::string score_bytes;
-    std::string member_key = InternalKey(ns_key, ms.member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     PutDouble(&score_bytes, ms.score);
+    if (metadata.IsInlineEncoded()) {
+      putSubKey(batch.Get(), ns_key, &metadata, ms.member, score_bytes);
+      continue;
+    }
+    std::string member_key = InternalKey(ns_key, ms.member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     batch->Put(member_key, score_bytes);
+    addRankIndexDelta(&rank_deltas, score_bytes, ms.member, 1);
     score_bytes.append(ms.member);
     std::string score_key = InternalKey(ns_key, score_bytes, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     batch->Put(score_cf_handle_, score_key, Slice());
   }
+  auto s = writeRankIndexDeltas(ns_key, metadata, rank_deltas, batch.Get());
+  if (!s.ok()) return s;
   metadata.size = static_cast<uint32_t>(mscores.size());
-  std::string bytes;
-  metadata.Encode(&bytes);
-  batch->Put(metadata_cf_handle_, ns_key, bytes);
+  s = putMetadata(batch.Get(), ns_key, &metadata);
+  if (!s.ok()) return s;
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -839,9 +1164,8 @@ rocksdb::Status ZSet::MGet(const Slice &user_key, const std::vector<Slice> &memb
   read_options.snapshot = ss.GetSnapShot();
   std::string score_bytes;
   for (const auto &member : members) {
-    std::string member_key = InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode();
     score_bytes.clear();
-    s = storage_->Get(read_options, member_key, &score_bytes);
+    s = getSubKey(read_options, ns_key, metadata, member, &score_bytes);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.IsNotFound()) {
       continue;
@@ -872,7 +1196,7 @@ rocksdb::Status ZSet::GetAllMemberScores(const Slice &user_key, std::vector<Memb
   read_options.iterate_upper_bound = &upper_bound;
   read_options.iterate_lower_bound = &lower_bound;
 
-  auto iter = util::UniqueIterator(storage_, read_options, score_cf_handle_);
+  auto iter = newScoreIterator(ns_key, metadata, read_options);
 
   for (iter->Seek(prefix_key); iter->Valid() && iter->key().starts_with(prefix_key); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
@@ -947,4 +1271,122 @@ rocksdb::Status ZSet::DiffStore(const Slice &dst, const std::vector<Slice> &keys
   return Overwrite(dst, mscores);
 }
 
+util::UniqueIterator ZSet::newScoreIterator(const Slice &ns_key, const ZSetMetadata &metadata,
+                                            const rocksdb::ReadOptions &read_options) {
+  if (metadata.IsInlineEncoded()) {
+    return util::UniqueIterator(
+        new engine::InlineSubKeyIterator(ns_key, metadata, storage_->IsSlotIdEncoded(), /*score_order=*/true));
+  }
+  return util::UniqueIterator(storage_, read_options, score_cf_handle_);
+}
+
+void ZSet::deleteMember(rocksdb::WriteBatchBase *batch, const Slice &ns_key, ZSetMetadata *metadata,
+                        const Slice &member, const Slice &score_bytes, RankIndexDeltas *rank_deltas) {
+  if (metadata->IsInlineEncoded()) {
+    deleteSubKey(batch, ns_key, metadata, member);
+    return;
+  }
+  addRankIndexDelta(rank_deltas, score_bytes, member, -1);
+  std::string score_key = score_bytes.ToString();
+  score_key.append(member.data(), member.size());
+  batch->Delete(InternalKey(ns_key, member, metadata->version, storage_->IsSlotIdEncoded()).Encode());
+  batch->Delete(score_cf_handle_,
+                InternalKey(ns_key, score_key, metadata->version, storage_->IsSlotIdEncoded()).Encode());
+}
+
+rocksdb::Status ZSet::putMetadata(rocksdb::WriteBatchBase *batch, const Slice &ns_key, ZSetMetadata *metadata) {
+  if (!putCollectionMetadata(batch, ns_key, metadata)) return rocksdb::Status::OK();
+
+  // the members moved out of the metadata need their score keys and rank index as well
+  RankIndexDeltas rank_deltas;
+  for (const auto &[member, score_bytes] : metadata->inline_entries) {
+    addRankIndexDelta(&rank_deltas, score_bytes, member, 1);
+    std::string score_key =
+        InternalKey(ns_key, score_bytes + member, metadata->version, storage_->IsSlotIdEncoded()).Encode();
+    batch->Put(score_cf_handle_, score_key, Slice());
+  }
+  metadata->inline_entries.clear();
+  return writeRankIndexDeltas(ns_key, *metadata, rank_deltas, batch);
+}
+
+void ZSet::addRankIndexDelta(RankIndexDeltas *deltas, const Slice &score_bytes, const Slice &member,
+                             int64_t delta) {
+  std::string score_key = score_bytes.ToString();
+  score_key.append(member.data(), member.size());
+  (*deltas)[score_key] += delta;
+}
+
+rocksdb::Status ZSet::writeRankIndexDeltas(const Slice &ns_key, const ZSetMetadata &metadata,
+                                           const RankIndexDeltas &deltas, rocksdb::WriteBatchBase *batch) {
+  if (!metadata.rank_indexed || deltas.empty()) return rocksdb::Status::OK();
+
+  RankIndexWriter writer(storage_, score_cf_handle_, rank_cf_handle_, ns_key, metadata.version);
+  return writer.Write(deltas, batch);
+}
+
+rocksdb::Status ZSet::countByRankIndex(const Slice &ns_key, const ZSetMetadata &metadata,
+                                       const rocksdb::ReadOptions &read_options, const Slice &score_key,
+                                       uint64_t *less_cnt) {
+  *less_cnt = 0;
+
+  // walk each level from the entry found on the level above to the last one starting at or before the score key
+  auto rank_iter = util::UniqueIterator(storage_, read_options, rank_cf_handle_);
+  std::string start, next_start;
+  uint64_t count = 0, next_count = 0;
+  for (int level = kRankIndexLevels - 1; level >= 0; level--) {
+    rank_iter->Seek(RankIndexEntryKey(ns_key, metadata.version, storage_->IsSlotIdEncoded(), level, start));
+    count = 0;
+    for (; GetRankIndexEntry(rank_iter.get(), storage_->IsSlotIdEncoded(), level, &next_start, &next_count);
+         rank_iter->Next()) {
+      if (next_start == start) {
+        count = next_count;
+        continue;
+      }
+      if (Slice(next_start).compare(score_key) > 0) break;
+      *less_cnt += count;
+      start = next_start;
+      count = next_count;
+    }
+  }
+
+  // the members before it in the bucket of the bottom level aren't counted separately
+  auto score_iter = util::UniqueIterator(storage_, read_options, score_cf_handle_);
+  for (score_iter->Seek(InternalKey(ns_key, start, metadata.version, storage_->IsSlotIdEncoded()).Encode());
+       score_iter->Valid(); score_iter->Next()) {
+    InternalKey ikey(score_iter->key(), storage_->IsSlotIdEncoded());
+    if (ikey.GetSubKey().compare(score_key) >= 0) break;
+    (*less_cnt)++;
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status ZSet::seekByRankIndex(const Slice &ns_key, const ZSetMetadata &metadata,
+                                      const rocksdb::ReadOptions &read_options, uint64_t rank,
+                                      std::string *bucket_start, uint64_t *offset) {
+  bucket_start->clear();
+
+  // descend into the entry holding the rank on each level, the rank being relative to the entry
+  auto rank_iter = util::UniqueIterator(storage_, read_options, rank_cf_handle_);
+  std::string start;
+  uint64_t count = 0;
+  for (int level = kRankIndexLevels - 1; level >= 0; level--) {
+    rank_iter->Seek(RankIndexEntryKey(ns_key, metadata.version, storage_->IsSlotIdEncoded(), level, *bucket_start));
+    if (GetRankIndexEntry(rank_iter.get(), storage_->IsSlotIdEncoded(), level, &start, &count) &&
+        start == *bucket_start) {
+      rank_iter->Next();
+    } else {
+      count = 0;
+    }
+    while (rank >= count) {
+      rank -= count;
+      if (!GetRankIndexEntry(rank_iter.get(), storage_->IsSlotIdEncoded(), level, bucket_start, &count)) {
+        return rocksdb::Status::Corruption("the rank index of the sorted set is inconsistent with its size");
+      }
+      rank_iter->Next();
+    }
+  }
+  *offset = rank;
+  return rocksdb::Status::OK();
+}
+
 }  // namespace redis
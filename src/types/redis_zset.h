@@ -90,11 +90,16 @@ namespace redis {
 class ZSet : public SubKeyScanner {
  public:
   explicit ZSet(engine::Storage *storage, const std::string &ns)
-      : SubKeyScanner(storage, ns), score_cf_handle_(storage->GetCFHandle("zset_score")) {}
+      : SubKeyScanner(storage, ns),
+        score_cf_handle_(storage->GetCFHandle(engine::kZSetScoreColumnFamilyName)),
+        rank_cf_handle_(storage->GetCFHandle(engine::kZSetRankColumnFamilyName)) {}
 
   using Members = std::vector<std::string>;
   using MemberScores = std::vector<MemberScore>;
 
+  // the levels of the rank index, so a member update rewrites one entry per level besides the splits
+  static constexpr int kRankIndexLevels = 5;
+
   rocksdb::Status Add(const Slice &user_key, ZAddFlags flags, MemberScores *mscores, uint64_t *added_cnt);
   rocksdb::Status Card(const Slice &user_key, uint64_t *size);
   rocksdb::Status IncrBy(const Slice &user_key, const Slice &member, double increment, double *score);
@@ -133,6 +138,32 @@ class ZSet : public SubKeyScanner {
 
  private:
   rocksdb::ColumnFamilyHandle *score_cf_handle_;
+  rocksdb::ColumnFamilyHandle *rank_cf_handle_;
+
+  // pending changes of the rank index: score key -> count delta of the member
+  using RankIndexDeltas = std::map<std::string, int64_t>;
+
+  static void addRankIndexDelta(RankIndexDeltas *deltas, const Slice &score_bytes, const Slice &member,
+                                int64_t delta);
+  rocksdb::Status writeRankIndexDeltas(const Slice &ns_key, const ZSetMetadata &metadata,
+                                       const RankIndexDeltas &deltas, rocksdb::WriteBatchBase *batch);
+  // Count the members whose score key (the encoded score, optionally followed by a member) sorts before the given one
+  rocksdb::Status countByRankIndex(const Slice &ns_key, const ZSetMetadata &metadata,
+                                   const rocksdb::ReadOptions &read_options, const Slice &score_key,
+                                   uint64_t *less_cnt);
+  // Find the bucket holding the member of the rank, i.e. the score key it starts from and the offset of the member
+  rocksdb::Status seekByRankIndex(const Slice &ns_key, const ZSetMetadata &metadata,
+                                  const rocksdb::ReadOptions &read_options, uint64_t rank, std::string *bucket_start,
+                                  uint64_t *offset);
+
+  // Iterate the score column family of the sorted set, or its inline members in the same order
+  util::UniqueIterator newScoreIterator(const Slice &ns_key, const ZSetMetadata &metadata,
+                                        const rocksdb::ReadOptions &read_options);
+  // Delete a member along with its score key and its count in the rank index
+  void deleteMember(rocksdb::WriteBatchBase *batch, const Slice &ns_key, ZSetMetadata *metadata, const Slice &member,
+                    const Slice &score_bytes, RankIndexDeltas *rank_deltas);
+  // Write the metadata, with the score keys and the rank index of the members moved out of it if any
+  rocksdb::Status putMetadata(rocksdb::WriteBatchBase *batch, const Slice &ns_key, ZSetMetadata *metadata);
 };
 
 }  // namespace redis
@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "server/redis_reply.h"
+#include "storage/scripting.h"
+
+class LuaReplySinkBenchmark : public testing::TestWithParam<redis::RESP> {
+ protected:
+  void SetUp() override { lua_ = luaL_newstate(); }
+  void TearDown() override { lua_close(lua_); }
+
+  lua_State *lua_ = nullptr;
+};
+
+INSTANTIATE_TEST_SUITE_P(RESP, LuaReplySinkBenchmark, testing::Values(redis::RESP::v2, redis::RESP::v3));
+
+// Convert the reply of a command called from a script into a Lua value, by parsing the RESP reply
+// like before and by the sink which builds the value while the reply is written
+TEST_P(LuaReplySinkBenchmark, Conversion) {
+  constexpr int kRounds = 100000;
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) values.emplace_back("value" + std::to_string(i));
+  auto reply = [&values](redis::ReplyWriter *w) {
+    w->ArrayLen(values.size());
+    for (const auto &v : values) w->BulkString(v);
+  };
+  auto measure = [](const std::function<void()> &fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; i++) fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / kRounds;
+  };
+
+  auto resp_ns = measure([&] {
+    std::string output;
+    {
+      redis::ReplyWriter writer(&output, GetParam());
+      reply(&writer);
+    }
+    lua::RedisProtocolToLuaType(lua_, output.data());
+    lua_pop(lua_, 1);
+  });
+  auto sink_ns = measure([&] {
+    lua::LuaReplySink sink(lua_);
+    {
+      redis::ReplyWriter writer(&sink, GetParam());
+      reply(&writer);
+    }
+    lua_pop(lua_, 1);
+  });
+  std::cout << "array of " << values.size() << " bulk strings: RESP " << resp_ns << " ns/reply, sink " << sink_ns
+            << " ns/reply" << std::endl;
+}
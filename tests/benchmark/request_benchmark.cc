@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "event_util.h"
+#include "server/redis_request.h"
+
+// Tokenize pipelines of SET commands, which is what the in-place parser is meant to speed up
+TEST(RequestBenchmark, Tokenize) {
+  constexpr int kRounds = 10000;
+  constexpr int kPipeline = 100;
+
+  std::string pipeline;
+  for (int i = 0; i < kPipeline; i++) {
+    std::string key = "key:" + std::to_string(i);
+    pipeline += "*3\r\n$3\r\nSET\r\n$" + std::to_string(key.size()) + "\r\n" + key + "\r\n$16\r\n0123456789abcdef\r\n";
+  }
+
+  Stats stats;
+  redis::Request request(&stats);
+  UniqueEvbuf input;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRounds; i++) {
+    evbuffer_add(input.get(), pipeline.data(), pipeline.size());
+    ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+    request.GetCommands()->clear();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << "Tokenize: " << elapsed.count() / (kRounds * kPipeline) << " ns/command, "
+            << pipeline.size() * kRounds * 1000 / elapsed.count() << " MB/s" << std::endl;
+}
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "sharded_rw_lock.h"
+
+template <typename Lock>
+static double SharedLockMops(int threads) {
+  constexpr int kRounds = 1000000;
+  Lock lock;
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back([&lock] {
+      for (int j = 0; j < kRounds; j++) {
+        std::shared_lock<Lock> guard(lock);
+      }
+    });
+  }
+  for (auto &t : workers) t.join();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  // Million acquisitions per second across all threads
+  return static_cast<double>(threads) * kRounds * 1000 / static_cast<double>(elapsed.count());
+}
+
+// Every command takes the work concurrency guard in shared mode, so the shared acquisitions
+// of all the worker threads are what contends on a single std::shared_mutex
+TEST(ShardedRWLockBenchmark, SharedLock) {
+  for (int threads : {1, 2, 4, 8, 16, 32}) {
+    std::cout << threads << " threads: std::shared_mutex " << SharedLockMops<std::shared_mutex>(threads)
+              << " Mops/s, ShardedRWLock " << SharedLockMops<ShardedRWLock>(threads) << " Mops/s" << std::endl;
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "storage/redis_db.h"
+#include "test_base.h"
+
+class SnapshotPinnerBenchmark : public TestBase {
+ protected:
+  // Return the nanoseconds per snapshot of the readers, while the writers keep writing meanwhile.
+  // The pinned snapshot is only reused until a write advances the latest sequence number, so the
+  // writers show how much of the gain is left under write load.
+  int64_t measure(int readers, int writers, bool pinned) {
+    constexpr int kReadsPerThread = 200000;
+    std::atomic<bool> done = false;
+    std::vector<std::thread> writer_threads;
+    for (int i = 0; i < writers; i++) {
+      writer_threads.emplace_back([&] {
+        while (!done) {
+          rocksdb::WriteBatch batch;
+          batch.Put("key", "value");
+          EXPECT_TRUE(storage_->Write(storage_->DefaultWriteOptions(), &batch).ok());
+        }
+      });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> reader_threads;
+    for (int i = 0; i < readers; i++) {
+      reader_threads.emplace_back([&] {
+        std::optional<redis::SnapshotPinner> pinner;
+        if (pinned) pinner.emplace(storage_.get());
+        for (int j = 0; j < kReadsPerThread; j++) {
+          redis::LatestSnapShot ss(storage_.get());
+        }
+      });
+    }
+    for (auto &t : reader_threads) t.join();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    done = true;
+    for (auto &t : writer_threads) t.join();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / kReadsPerThread;
+  }
+};
+
+TEST_F(SnapshotPinnerBenchmark, Contention) {
+  for (int readers : {1, 4, 8, 16}) {
+    std::cout << readers << " readers: per-read snapshot " << measure(readers, 0, false)
+              << " ns/read, pinned snapshot " << measure(readers, 0, true) << " ns/read" << std::endl;
+  }
+}
+
+TEST_F(SnapshotPinnerBenchmark, ContentionWithWriters) {
+  for (int writers : {1, 4}) {
+    for (int readers : {1, 4, 8, 16}) {
+      std::cout << readers << " readers, " << writers << " writers: per-read snapshot "
+                << measure(readers, writers, false) << " ns/read, pinned snapshot " << measure(readers, writers, true)
+                << " ns/read" << std::endl;
+    }
+  }
+}
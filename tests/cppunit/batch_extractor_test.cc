@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/batch_extractor.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "server/redis_reply.h"
+#include "test_base.h"
+#include "types/redis_list.h"
+
+class WriteBatchExtractorTest : public TestBase {
+ protected:
+  explicit WriteBatchExtractorTest() { list_ = std::make_unique<redis::List>(storage_.get(), "extractor_ns"); }
+  ~WriteBatchExtractorTest() override = default;
+
+  std::vector<std::string> extractCommandsSince(rocksdb::SequenceNumber seq) {
+    std::unique_ptr<rocksdb::TransactionLogIterator> iter;
+    EXPECT_TRUE(storage_->GetWALIter(seq, &iter).IsOK());
+    WriteBatchExtractor extractor(storage_->IsSlotIdEncoded());
+    for (; iter->Valid(); iter->Next()) {
+      auto batch = iter->GetBatch();
+      EXPECT_TRUE(batch.writeBatchPtr->Iterate(&extractor).ok());
+    }
+    return (*extractor.GetRESPCommands())["extractor_ns"];
+  }
+
+  std::unique_ptr<redis::List> list_;
+};
+
+TEST_F(WriteBatchExtractorTest, ChunkedListCommandsInOneBatch) {
+  config_.list_chunk_max_entries = 4;
+  key_ = "test-extractor-list";
+  auto seq = storage_->LatestSeqNumber() + 1;
+
+  // Both commands are committed in the same batch, e.g. by MULTI/EXEC
+  ASSERT_TRUE(storage_->BeginTxn().IsOK());
+  uint64_t size = 0;
+  ASSERT_TRUE(list_->Push(key_, {"a"}, false, &size).ok());
+  ASSERT_TRUE(list_->Push(key_, {"b", "c"}, true, &size).ok());
+  ASSERT_TRUE(storage_->CommitTxn().IsOK());
+
+  std::vector<std::string> expected = {redis::ArrayOfBulkStrings({"RPUSH", key_, "a"}),
+                                       redis::ArrayOfBulkStrings({"LPUSH", key_, "b", "c"})};
+  EXPECT_EQ(extractCommandsSince(seq), expected);
+
+  auto s = list_->Del(key_);
+  config_.list_chunk_max_entries = 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <common/bit_kernels.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using util::BitKernels;
+using util::BitKernelsISA;
+
+class BitKernelsTest : public ::testing::TestWithParam<BitKernelsISA> {
+ protected:
+  void SetUp() override {
+    kernels_ = util::GetBitKernels(GetParam());
+    if (!kernels_) GTEST_SKIP() << "the instruction set is not supported";
+  }
+
+  std::vector<uint8_t> randomBytes(size_t n) {
+    std::vector<uint8_t> bytes(n);
+    for (auto &byte : bytes) byte = static_cast<uint8_t>(rng_());
+    return bytes;
+  }
+
+  const BitKernels *kernels_ = nullptr;
+  std::mt19937 rng_{42};
+};
+
+INSTANTIATE_TEST_SUITE_P(ISA, BitKernelsTest,
+                         testing::Values(BitKernelsISA::kScalar, BitKernelsISA::kAVX2, BitKernelsISA::kAVX512));
+
+// The sizes cover the tails after the 64-bit words and the vectors
+static const std::vector<size_t> kSizes = {0, 1, 7, 8, 31, 32, 33, 63, 64, 65, 100, 1000, 1024};
+
+TEST_P(BitKernelsTest, Bitwise) {
+  for (auto n : kSizes) {
+    auto a = randomBytes(n);
+    auto b = randomBytes(n);
+    auto and_res = a, or_res = a, xor_res = a, not_res = a;
+    kernels_->and_bytes(and_res.data(), b.data(), n);
+    kernels_->or_bytes(or_res.data(), b.data(), n);
+    kernels_->xor_bytes(xor_res.data(), b.data(), n);
+    kernels_->not_bytes(not_res.data(), n);
+    for (size_t i = 0; i < n; i++) {
+      ASSERT_EQ(and_res[i], a[i] & b[i]);
+      ASSERT_EQ(or_res[i], a[i] | b[i]);
+      ASSERT_EQ(xor_res[i], a[i] ^ b[i]);
+      ASSERT_EQ(not_res[i], static_cast<uint8_t>(~a[i]));
+    }
+  }
+}
+
+TEST_P(BitKernelsTest, Popcount) {
+  for (auto n : kSizes) {
+    auto bytes = randomBytes(n);
+    size_t expected = 0;
+    for (auto byte : bytes) expected += __builtin_popcount(byte);
+    ASSERT_EQ(kernels_->popcount(bytes.data(), n), expected);
+  }
+  std::vector<uint8_t> ones(1024, 0xff);
+  ASSERT_EQ(kernels_->popcount(ones.data(), ones.size()), ones.size() * 8);
+}
+
+TEST_P(BitKernelsTest, FindFirstBit) {
+  for (auto n : kSizes) {
+    for (int64_t pos = 0; pos < static_cast<int64_t>(n * 8); pos += 13) {
+      std::vector<uint8_t> zeros(n, 0), ones(n, 0xff);
+      zeros[pos / 8] |= 1 << (pos % 8);
+      ones[pos / 8] &= ~(1 << (pos % 8));
+      ASSERT_EQ(kernels_->find_first_bit(zeros.data(), n, true), pos);
+      ASSERT_EQ(kernels_->find_first_bit(ones.data(), n, false), pos);
+      ASSERT_EQ(kernels_->find_first_bit(zeros.data(), n, false), pos == 0 ? 1 : 0);
+    }
+    std::vector<uint8_t> zeros(n, 0), ones(n, 0xff);
+    ASSERT_EQ(kernels_->find_first_bit(zeros.data(), n, true), -1);
+    ASSERT_EQ(kernels_->find_first_bit(ones.data(), n, false), -1);
+  }
+}
+
+TEST(BitKernels, ForCPU) {
+  const auto &kernels = util::BitKernelsForCPU();
+  ASSERT_EQ(util::GetBitKernels(kernels.isa), &kernels);
+}
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <storage/batch_extractor.h>
+#include <storage/group_commit.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/redis_reply.h"
+#include "test_base.h"
+
+TEST(GroupCommit, SingleWriter) {
+  int writes = 0;
+  engine::GroupCommitter committer(0, 1024, [&](const rocksdb::WriteOptions &, rocksdb::WriteBatch *updates) {
+    writes++;
+    EXPECT_EQ(updates->Count(), 2);
+    return rocksdb::Status::OK();
+  });
+
+  rocksdb::WriteBatch batch;
+  batch.Put("a", "1");
+  batch.Put("b", "2");
+  ASSERT_TRUE(committer.Write(rocksdb::WriteOptions(), &batch).ok());
+  ASSERT_EQ(writes, 1);
+  ASSERT_EQ(committer.GetStats().commits, 1);
+  ASSERT_EQ(committer.GetStats().batches, 1);
+}
+
+TEST(GroupCommit, LoneWriterIsNotDelayed) {
+  auto write_func = [](const rocksdb::WriteOptions &, rocksdb::WriteBatch *) { return rocksdb::Status::OK(); };
+  engine::GroupCommitter committer(1000 * 1000, 1024, write_func);
+
+  rocksdb::WriteBatch batch;
+  batch.Put("a", "1");
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(committer.Write(rocksdb::WriteOptions(), &batch).ok());
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+TEST(GroupCommit, ConcurrentWriters) {
+  constexpr int kThreads = 8;
+  constexpr int kWritesPerThread = 100;
+
+  std::atomic<uint32_t> records = 0;
+  std::atomic<int> synced_writes = 0;
+  auto write_func = [&](const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates) {
+    records += updates->Count();
+    if (options.sync) synced_writes++;
+    return rocksdb::Status::OK();
+  };
+  engine::GroupCommitter committer(200, 1 << 20, write_func);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([&, i] {
+      rocksdb::WriteOptions options;
+      options.sync = i == 0;
+      for (int j = 0; j < kWritesPerThread; j++) {
+        rocksdb::WriteBatch batch;
+        batch.Put("key-" + std::to_string(i), std::to_string(j));
+        EXPECT_TRUE(committer.Write(options, &batch).ok());
+      }
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  const auto &stats = committer.GetStats();
+  ASSERT_EQ(records, kThreads * kWritesPerThread);
+  ASSERT_EQ(stats.batches, kThreads * kWritesPerThread);
+  ASSERT_LE(stats.commits, stats.batches);
+  // the group containing a sync batch must be written with sync enabled
+  ASSERT_GE(synced_writes, 1);
+}
+
+TEST(GroupCommit, ErrorIsPropagated) {
+  engine::GroupCommitter committer(0, 1024, [](const rocksdb::WriteOptions &, rocksdb::WriteBatch *) {
+    return rocksdb::Status::IOError("injected");
+  });
+
+  rocksdb::WriteBatch batch;
+  batch.Put("a", "1");
+  auto s = committer.Write(rocksdb::WriteOptions(), &batch);
+  ASSERT_TRUE(s.IsIOError());
+}
+
+class GroupCommitExtractorTest : public TestBase {};
+
+// The commands of a merged group must still be extracted one by one from the WAL, e.g. by kvrocks2redis
+TEST_F(GroupCommitExtractorTest, MergedGroup) {
+  std::mutex mu;
+  std::vector<std::string> written;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic<bool> leader_writing = false;
+  engine::GroupCommitter committer(1000, 1 << 20, [&](const rocksdb::WriteOptions &, rocksdb::WriteBatch *updates) {
+    // Block the first group until the others are queued behind it, so they're merged into one group
+    leader_writing = true;
+    released.wait();
+    std::lock_guard<std::mutex> guard(mu);
+    written.emplace_back(updates->Data());
+    return rocksdb::Status::OK();
+  });
+
+  auto metadata_cf = storage_->GetCFHandle(ColumnFamilyID::kColumnFamilyIDMetadata);
+  auto write = [&](const std::string &key, const std::string &elem) {
+    rocksdb::WriteBatch batch;
+    redis::WriteBatchLogData log_data(kRedisList, {std::to_string(kRedisCmdChunkedList), "RPUSH", key, elem});
+    EXPECT_TRUE(batch.PutLogData(log_data.Encode()).ok());
+    EXPECT_TRUE(batch.Put(metadata_cf, ComposeNamespaceKey("group_ns", key, false), "").ok());
+    EXPECT_TRUE(committer.Write(rocksdb::WriteOptions(), &batch).ok());
+  };
+
+  std::vector<std::thread> threads;
+  threads.emplace_back(write, "list-a", "a");
+  while (!leader_writing) std::this_thread::yield();
+  threads.emplace_back(write, "list-b", "b");
+  threads.emplace_back(write, "list-c", "c");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  release.set_value();
+  for (auto &t : threads) t.join();
+
+  WriteBatchExtractor extractor(false);
+  for (const auto &data : written) {
+    rocksdb::WriteBatch batch(data);
+    ASSERT_TRUE(batch.Iterate(&extractor).ok());
+  }
+  auto commands = (*extractor.GetRESPCommands())["group_ns"];
+  std::sort(commands.begin(), commands.end());
+  std::vector<std::string> expected = {redis::ArrayOfBulkStrings({"RPUSH", "list-a", "a"}),
+                                       redis::ArrayOfBulkStrings({"RPUSH", "list-b", "b"}),
+                                       redis::ArrayOfBulkStrings({"RPUSH", "list-c", "c"})};
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(commands, expected);
+  ASSERT_EQ(committer.GetStats().batches, 3);
+  ASSERT_EQ(committer.GetStats().commits, 2);
+}
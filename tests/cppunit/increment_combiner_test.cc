@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <storage/increment_combiner.h>
+
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <vector>
+
+using Increment = engine::IncrementCombiner::Increment;
+
+TEST(IncrementCombiner, SingleIncrement) {
+  engine::IncrementCombiner combiner;
+  int64_t counter = 10;
+  int64_t new_value = 0;
+  auto s = combiner.IncrBy("counter", 5, &new_value, [&](const std::vector<Increment *> &increments) {
+    ASSERT_EQ(increments.size(), 1);
+    counter += increments[0]->delta;
+    increments[0]->new_value = counter;
+  });
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(new_value, 15);
+  ASSERT_EQ(combiner.GetStats().applies, 1);
+  ASSERT_EQ(combiner.GetStats().increments, 1);
+}
+
+TEST(IncrementCombiner, PerIncrementError) {
+  engine::IncrementCombiner combiner;
+  int64_t new_value = 0;
+  auto s = combiner.IncrBy("counter", 1, &new_value, [](const std::vector<Increment *> &increments) {
+    increments[0]->status = rocksdb::Status::InvalidArgument("overflow");
+  });
+  ASSERT_TRUE(s.IsInvalidArgument());
+  ASSERT_EQ(new_value, 0);
+}
+
+TEST(IncrementCombiner, ConcurrentIncrements) {
+  constexpr int kThreads = 8;
+  constexpr int kIncrementsPerThread = 1000;
+
+  engine::IncrementCombiner combiner;
+  int64_t counters[2] = {0, 0};
+  std::mutex mu;
+  std::vector<std::vector<int64_t>> results(kThreads);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([&, i] {
+      int64_t *counter = &counters[i % 2];
+      auto apply = [&, counter](const std::vector<Increment *> &increments) {
+        // Stands for the key lock and the RocksDB read and write
+        std::lock_guard<std::mutex> guard(mu);
+        for (auto *inc : increments) {
+          *counter += inc->delta;
+          inc->new_value = *counter;
+        }
+      };
+      for (int j = 0; j < kIncrementsPerThread; j++) {
+        int64_t new_value = 0;
+        auto s = combiner.IncrBy(i % 2 == 0 ? "even" : "odd", 1, &new_value, apply);
+        ASSERT_TRUE(s.ok());
+        results[i].push_back(new_value);
+      }
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  constexpr int64_t kIncrementsPerCounter = kThreads / 2 * kIncrementsPerThread;
+  ASSERT_EQ(counters[0], kIncrementsPerCounter);
+  ASSERT_EQ(counters[1], kIncrementsPerCounter);
+  ASSERT_EQ(combiner.GetStats().increments, kThreads * kIncrementsPerThread);
+  ASSERT_LE(combiner.GetStats().applies, combiner.GetStats().increments);
+
+  // Every increment gets its own new value, and those of a thread only go up
+  for (int parity = 0; parity < 2; parity++) {
+    std::set<int64_t> values;
+    for (int i = parity; i < kThreads; i += 2) {
+      ASSERT_TRUE(std::is_sorted(results[i].begin(), results[i].end()));
+      values.insert(results[i].begin(), results[i].end());
+    }
+    ASSERT_EQ(values.size(), kIncrementsPerCounter);
+    ASSERT_EQ(*values.begin(), 1);
+    ASSERT_EQ(*values.rbegin(), kIncrementsPerCounter);
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+
+#include "server/redis_reply.h"
+#include "storage/scripting.h"
+
+// Dump the value on the top of the stack into a string which doesn't
+// depend on the iteration order of tables, and pop it.
+static std::string DumpLuaValue(lua_State *lua) {
+  std::string result;
+  switch (lua_type(lua, -1)) {
+    case LUA_TNIL:
+      result = "nil";
+      break;
+    case LUA_TBOOLEAN:
+      result = lua_toboolean(lua, -1) ? "true" : "false";
+      break;
+    case LUA_TNUMBER:
+      result = std::to_string(lua_tonumber(lua, -1));
+      break;
+    case LUA_TSTRING: {
+      size_t len = 0;
+      const char *s = lua_tolstring(lua, -1, &len);
+      result = "'" + std::string(s, len) + "'";
+      break;
+    }
+    case LUA_TTABLE: {
+      std::map<std::string, std::string> fields;
+      lua_pushnil(lua);
+      while (lua_next(lua, -2) != 0) {
+        std::string value = DumpLuaValue(lua);
+        lua_pushvalue(lua, -1);
+        std::string key = DumpLuaValue(lua);
+        fields[key] = value;
+      }
+      result = "{";
+      for (const auto &[key, value] : fields) result += key + "=" + value + ",";
+      result += "}";
+      break;
+    }
+    default:
+      result = "?";
+  }
+  lua_pop(lua, 1);
+  return result;
+}
+
+class LuaReplySinkTest : public testing::TestWithParam<redis::RESP> {
+ protected:
+  void SetUp() override { lua_ = luaL_newstate(); }
+  void TearDown() override { lua_close(lua_); }
+
+  // Convert the reply by the sink and by parsing the RESP reply, both must push the same value
+  void AssertSameValue(const std::function<void(redis::ReplyWriter *)> &reply) {
+    std::string output;
+    {
+      redis::ReplyWriter writer(&output, GetParam());
+      reply(&writer);
+    }
+    lua::RedisProtocolToLuaType(lua_, output.data());
+    std::string expected = DumpLuaValue(lua_);
+
+    lua::LuaReplySink sink(lua_);
+    {
+      redis::ReplyWriter writer(&sink, GetParam());
+      reply(&writer);
+    }
+    ASSERT_TRUE(sink.IsDone());
+    ASSERT_EQ(lua_gettop(lua_), 1);
+    ASSERT_EQ(DumpLuaValue(lua_), expected);
+  }
+
+  lua_State *lua_ = nullptr;
+};
+
+INSTANTIATE_TEST_SUITE_P(RESP, LuaReplySinkTest, testing::Values(redis::RESP::v2, redis::RESP::v3));
+
+TEST_P(LuaReplySinkTest, Scalars) {
+  AssertSameValue([](redis::ReplyWriter *w) { w->SimpleString("OK"); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->Error("ERR some error"); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->Integer(-42); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->Double(3.5); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->BulkString(std::string("a\r\nb\0c", 6)); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->NilString(); });
+}
+
+TEST_P(LuaReplySinkTest, Aggregates) {
+  AssertSameValue([](redis::ReplyWriter *w) { w->ArrayLen(0); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->MapLen(0); });
+  AssertSameValue([](redis::ReplyWriter *w) {
+    w->ArrayLen(3);
+    w->BulkString("a");
+    w->NilString();
+    w->Integer(1);
+  });
+  AssertSameValue([](redis::ReplyWriter *w) {
+    w->MapLen(2);
+    w->BulkString("f1");
+    w->BulkString("v1");
+    w->BulkString("f2");
+    w->ArrayLen(2);
+    w->Integer(1);
+    w->SetLen(1);
+    w->BulkString("m");
+  });
+  AssertSameValue([](redis::ReplyWriter *w) {
+    w->ArrayLen(2);
+    w->ArrayLen(0);
+    w->Append(redis::MultiLen(2) + redis::BulkString("x") + redis::Integer(2));
+  });
+}
+
+TEST_P(LuaReplySinkTest, EncodedReply) {
+  AssertSameValue([](redis::ReplyWriter *w) { w->Append(redis::ArrayOfBulkStrings({"a", "b", "c"})); });
+  AssertSameValue([](redis::ReplyWriter *w) { w->Append(redis::MultiLen(-1)); });
+}
@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/metadata_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using engine::MetadataCache;
+using LookupResult = engine::MetadataCache::LookupResult;
+
+// The batches of the tests write the default column family, so it stands for the metadata one
+constexpr uint32_t kMetadataCFID = 0;
+
+TEST(MetadataCache, LookupRespectsReadSequence) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+  EXPECT_EQ(cache.Lookup("key", 10, &value), LookupResult::kMiss);
+
+  rocksdb::Slice v1("v1");
+  cache.Insert("key", 10, &v1);
+  EXPECT_EQ(cache.Lookup("key", 10, &value), LookupResult::kFound);
+  EXPECT_EQ(value, "v1");
+  EXPECT_EQ(cache.Lookup("key", 9, &value), LookupResult::kMiss);
+
+  cache.Insert("missing", 10, nullptr);
+  EXPECT_EQ(cache.Lookup("missing", 11, &value), LookupResult::kNotFound);
+
+  EXPECT_EQ(cache.GetStats().hits, 2);
+  EXPECT_EQ(cache.GetStats().misses, 2);
+}
+
+TEST(MetadataCache, WriteUpdatesEntries) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+  rocksdb::Slice old_value("old");
+  cache.Insert("key", 10, &old_value);
+
+  rocksdb::WriteBatch batch;
+  batch.Put("key", "new");
+  batch.Delete("deleted");
+  auto ctx = cache.BeginWrite(kMetadataCFID, &batch);
+  EXPECT_EQ(cache.Lookup("key", 100, &value), LookupResult::kMiss);
+  // A read racing with the write can't fill the cache
+  cache.Insert("key", 15, &old_value);
+  EXPECT_EQ(cache.Lookup("key", 100, &value), LookupResult::kMiss);
+
+  cache.EndWrite(ctx, true, 20);
+  EXPECT_EQ(cache.Lookup("key", 20, &value), LookupResult::kFound);
+  EXPECT_EQ(value, "new");
+  EXPECT_EQ(cache.Lookup("key", 19, &value), LookupResult::kMiss);
+  EXPECT_EQ(cache.Lookup("deleted", 20, &value), LookupResult::kNotFound);
+
+  // The read finished before the write, but inserted after it completed
+  cache.Clear();
+  cache.Insert("key", 15, &old_value);
+  EXPECT_EQ(cache.Lookup("key", 100, &value), LookupResult::kMiss);
+}
+
+TEST(MetadataCache, FailedWriteInvalidates) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+  rocksdb::Slice old_value("old");
+  cache.Insert("key", 10, &old_value);
+
+  rocksdb::WriteBatch batch;
+  batch.Put("key", "new");
+  auto ctx = cache.BeginWrite(kMetadataCFID, &batch);
+  cache.EndWrite(ctx, false, 20);
+  EXPECT_EQ(cache.Lookup("key", 100, &value), LookupResult::kMiss);
+}
+
+TEST(MetadataCache, RepeatedKeyKeepsLastValue) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+
+  rocksdb::WriteBatch batch;
+  batch.Put("key", "v1");
+  batch.Put("key", "v2");
+  batch.Merge("merged", "v1");
+  auto ctx = cache.BeginWrite(kMetadataCFID, &batch);
+  cache.EndWrite(ctx, true, 20);
+  EXPECT_EQ(cache.Lookup("key", 20, &value), LookupResult::kFound);
+  EXPECT_EQ(value, "v2");
+  EXPECT_EQ(cache.Lookup("merged", 20, &value), LookupResult::kMiss);
+}
+
+TEST(MetadataCache, DeleteRangeClearsAll) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+  rocksdb::Slice v("v");
+  for (int i = 0; i < 100; i++) {
+    cache.Insert("key" + std::to_string(i), 10, &v);
+  }
+
+  rocksdb::WriteBatch batch;
+  batch.DeleteRange("key", "kez");
+  batch.Put("key1", "v1");
+  auto ctx = cache.BeginWrite(kMetadataCFID, &batch);
+  EXPECT_EQ(cache.Size(), 0);
+  cache.Insert("key2", 30, &v);
+  EXPECT_EQ(cache.Size(), 0);
+
+  cache.EndWrite(ctx, true, 20);
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(cache.Lookup("key1", 20, &value), LookupResult::kMiss);
+}
+
+TEST(MetadataCache, BoundedByCapacity) {
+  MetadataCache cache(MetadataCache::kNumShards * 4096);
+  std::string value(64, 'v');
+  rocksdb::Slice v(value);
+  for (int i = 0; i < 10000; i++) {
+    cache.Insert("key" + std::to_string(i), 10, &v);
+  }
+  EXPECT_LE(cache.Usage(), cache.Capacity());
+  EXPECT_GT(cache.GetStats().evictions, 0);
+  EXPECT_EQ(cache.Lookup("key9999", 10, &value), LookupResult::kFound);
+
+  std::string large(MetadataCache::kMaxValueSize + 1, 'v');
+  rocksdb::Slice large_value(large);
+  cache.Insert("large", 10, &large_value);
+  EXPECT_EQ(cache.Lookup("large", 10, &value), LookupResult::kMiss);
+}
@@ -217,6 +217,111 @@ TEST(Metadata, MetadataDecoding64BitSimpleKey) {
   EXPECT_EQ(encoded_bytes.size(), 9);
 }
 
+TEST(Metadata, MetadataDecodingChunkedString) {
+  Metadata md_old(kRedisString, true, true);
+  md_old.flags |= METADATA_STRING_CHUNKED_MASK;
+  md_old.size = 100000;
+  EXPECT_TRUE(md_old.IsChunkedString());
+  EXPECT_FALSE(md_old.IsSingleKVType());
+  std::string encoded_bytes;
+  md_old.Encode(&encoded_bytes);
+  EXPECT_EQ(encoded_bytes.size(), Metadata::GetOffsetAfterSize(md_old.flags));
+
+  Metadata md_new(kRedisNone, false);
+  ASSERT_TRUE(md_new.Decode(encoded_bytes).ok());
+  EXPECT_EQ(md_new.Type(), kRedisString);
+  EXPECT_TRUE(md_new.IsChunkedString());
+  EXPECT_EQ(md_new.version, md_old.version);
+  EXPECT_EQ(md_new.size, 100000);
+}
+
+TEST(Metadata, MetadataDecodingChunkedList) {
+  ListMetadata md_old;
+  md_old.flags |= METADATA_LIST_CHUNKED_MASK;
+  md_old.head = 3;
+  md_old.tail = 7;
+  md_old.head_chunk_size = 10;
+  md_old.tail_chunk_size = 2;
+  md_old.next_chunk_id = 8;
+  md_old.size = 100;
+  EXPECT_TRUE(md_old.IsChunkedList());
+  EXPECT_FALSE(md_old.IsChunkedString());
+  std::string encoded_bytes;
+  md_old.Encode(&encoded_bytes);
+
+  ListMetadata md_new(false);
+  ASSERT_TRUE(md_new.Decode(encoded_bytes).ok());
+  EXPECT_TRUE(md_new.IsChunkedList());
+  EXPECT_EQ(md_new.head, 3);
+  EXPECT_EQ(md_new.tail, 7);
+  EXPECT_EQ(md_new.head_chunk_size, 10);
+  EXPECT_EQ(md_new.tail_chunk_size, 2);
+  EXPECT_EQ(md_new.next_chunk_id, 8);
+  EXPECT_EQ(md_new.size, 100);
+
+  // the other lists don't carry the chunk fields
+  ListMetadata md_legacy;
+  std::string legacy_bytes;
+  md_legacy.Encode(&legacy_bytes);
+  EXPECT_FALSE(md_legacy.IsChunkedList());
+  EXPECT_EQ(legacy_bytes.size() + 4 + 4 + 8, encoded_bytes.size());
+
+  ListMetadata md_truncated(false);
+  EXPECT_FALSE(md_truncated.Decode(encoded_bytes.substr(0, encoded_bytes.size() - 4)).ok());
+}
+
+TEST(Metadata, MetadataDecodingSegmentedJson) {
+  JsonMetadata md_old;
+  md_old.flags |= METADATA_JSON_SEGMENTED_MASK;
+  md_old.format = JsonStorageFormat::CBOR;
+  md_old.size = 100;
+  EXPECT_TRUE(md_old.IsSegmentedJson());
+  EXPECT_FALSE(md_old.IsSingleKVType());
+  std::string encoded_bytes;
+  md_old.Encode(&encoded_bytes);
+
+  JsonMetadata md_new(false);
+  Slice input(encoded_bytes);
+  ASSERT_TRUE(md_new.Decode(&input).ok());
+  EXPECT_TRUE(md_new.IsSegmentedJson());
+  EXPECT_EQ(md_new.version, md_old.version);
+  EXPECT_EQ(md_new.size, 100);
+  EXPECT_EQ(md_new.format, JsonStorageFormat::CBOR);
+
+  // the other documents don't carry the version and the size
+  JsonMetadata md_single;
+  std::string single_bytes;
+  md_single.Encode(&single_bytes);
+  EXPECT_TRUE(md_single.IsSingleKVType());
+  EXPECT_LT(single_bytes.size(), encoded_bytes.size());
+}
+
+TEST(Metadata, MetadataDecodingInlineCollection) {
+  ZSetMetadata md_old;
+  md_old.flags |= METADATA_INLINE_ENCODING_MASK;
+  md_old.rank_indexed = true;
+  md_old.inline_entries = {{"a", std::string(8, '\x01')}, {"b", std::string(8, '\x02')}};
+  md_old.size = 2;
+  EXPECT_TRUE(md_old.IsInlineEncoded());
+  std::string encoded_bytes;
+  md_old.Encode(&encoded_bytes);
+
+  ZSetMetadata md_new(false);
+  ASSERT_TRUE(md_new.Decode(encoded_bytes).ok());
+  EXPECT_TRUE(md_new.IsInlineEncoded());
+  EXPECT_TRUE(md_new.rank_indexed);
+  EXPECT_EQ(md_new.inline_entries, md_old.inline_entries);
+  EXPECT_EQ(md_new, md_old);
+
+  // the flag means nothing to the other types
+  Metadata md_string(kRedisString, false);
+  md_string.flags |= METADATA_INLINE_ENCODING_MASK;
+  EXPECT_FALSE(md_string.IsInlineEncoded());
+
+  Metadata md_truncated(kRedisNone, false);
+  EXPECT_FALSE(md_truncated.Decode(encoded_bytes.substr(0, encoded_bytes.size() - 5)).ok());
+}
+
 TEST(Metadata, MetadataDecodingBackwardCompatibleComplexKey) {
   auto expire_at = (util::GetTimeStamp() + 100) * 1000;
   uint32_t size = 1000000000;
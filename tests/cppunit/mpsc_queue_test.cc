@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST(MPSCQueue, PushAndPopAll) {
+  MPSCQueue<std::unique_ptr<int>> queue;
+  ASSERT_TRUE(queue.Empty());
+  ASSERT_TRUE(queue.Push(std::make_unique<int>(1)));
+  ASSERT_FALSE(queue.Push(std::make_unique<int>(2)));
+  ASSERT_FALSE(queue.Push(std::make_unique<int>(3)));
+  ASSERT_FALSE(queue.Empty());
+
+  std::vector<int> values;
+  ASSERT_EQ(queue.PopAll([&values](std::unique_ptr<int> &&v) { values.push_back(*v); }), 3);
+  ASSERT_EQ(values, (std::vector<int>{1, 2, 3}));
+  ASSERT_TRUE(queue.Empty());
+  ASSERT_EQ(queue.PopAll([](std::unique_ptr<int> &&) {}), 0);
+
+  // Notify the consumer again once the queue was drained
+  ASSERT_TRUE(queue.Push(std::make_unique<int>(4)));
+}
+
+TEST(MPSCQueue, MultipleProducers) {
+  constexpr int kProducers = 8;
+  constexpr int kItems = 100000;
+  MPSCQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducers; i++) {
+    producers.emplace_back([&queue, i] {
+      for (int j = 0; j < kItems; j++) queue.Push({i, j});
+    });
+  }
+
+  std::vector<int> next(kProducers, 0);
+  int total = 0;
+  auto consume = [&](std::pair<int, int> &&item) {
+    // The items of each producer are in the pushed order
+    ASSERT_EQ(item.second, next[item.first]++);
+    total++;
+  };
+  while (total < kProducers * kItems) {
+    queue.PopAll(consume);
+  }
+  for (auto &t : producers) t.join();
+  queue.PopAll(consume);
+  ASSERT_EQ(total, kProducers * kItems);
+}
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "pattern_index.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+
+static std::set<std::string> MatchedPatterns(const PatternIndex<int> &index, const std::string &str) {
+  std::set<std::string> patterns;
+  index.ForEachMatch(str, [&patterns](const std::string &pattern, int) { patterns.emplace(pattern); });
+  return patterns;
+}
+
+TEST(PatternIndex, Basic) {
+  PatternIndex<int> index;
+  index["news.*"] = 1;
+  index["news.sport"] = 2;
+  index["news.?port"] = 3;
+  index["*"] = 4;
+  index["n*s.[st]*"] = 5;
+  ASSERT_EQ(index.Size(), 5);
+  ASSERT_EQ(*index.Find("news.*"), 1);
+  ASSERT_EQ(index.Find("news"), nullptr);
+
+  ASSERT_EQ(MatchedPatterns(index, "news.sport"),
+            (std::set<std::string>{"news.*", "news.sport", "news.?port", "*", "n*s.[st]*"}));
+  ASSERT_EQ(MatchedPatterns(index, "news.tech"), (std::set<std::string>{"news.*", "*", "n*s.[st]*"}));
+  ASSERT_EQ(MatchedPatterns(index, "news."), (std::set<std::string>{"news.*", "*"}));
+  ASSERT_EQ(MatchedPatterns(index, "news"), (std::set<std::string>{"*"}));
+  ASSERT_EQ(MatchedPatterns(index, ""), (std::set<std::string>{}));
+
+  index.Erase("*");
+  index.Erase("news.sport");
+  index.Erase("not-exists");
+  ASSERT_EQ(index.Size(), 3);
+  ASSERT_EQ(MatchedPatterns(index, "news.sport"), (std::set<std::string>{"news.*", "news.?port", "n*s.[st]*"}));
+}
+
+TEST(PatternIndex, Escape) {
+  PatternIndex<int> index;
+  index["a\\*b"] = 1;
+  index["a\\*b*"] = 2;
+  index["a\\"] = 3;
+  ASSERT_EQ(MatchedPatterns(index, "a*b"), (std::set<std::string>{"a\\*b", "a\\*b*"}));
+  ASSERT_EQ(MatchedPatterns(index, "a*bc"), (std::set<std::string>{"a\\*b*"}));
+  ASSERT_EQ(MatchedPatterns(index, "axb"), (std::set<std::string>{}));
+  ASSERT_EQ(MatchedPatterns(index, "a\\"), (std::set<std::string>{"a\\"}));
+}
+
+TEST(PatternIndex, SameAsStringMatch) {
+  std::mt19937 gen(42);
+  const std::string pattern_chars = "ab*?[]^-\\";
+  auto random_string = [&gen](const std::string &chars, size_t max_len) {
+    std::string s(gen() % (max_len + 1), ' ');
+    for (auto &c : s) c = chars[gen() % chars.size()];
+    return s;
+  };
+
+  PatternIndex<int> index;
+  std::set<std::string> patterns;
+  for (int i = 0; i < 500; i++) {
+    auto pattern = random_string(pattern_chars, 6);
+    index[pattern] = i;
+    patterns.emplace(pattern);
+  }
+  for (int i = 0; i < 2000; i++) {
+    auto str = random_string("ab*?[]\\", 6);
+    std::set<std::string> expected;
+    for (const auto &pattern : patterns) {
+      if (util::StringMatch(pattern, str, 0)) expected.emplace(pattern);
+    }
+    ASSERT_EQ(MatchedPatterns(index, str), expected) << "string: " << str;
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+
+#include "server/pending_messages.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FakeConnection {
+  uint64_t id;
+  std::vector<std::string> replies;
+  int write_events = 0;
+
+  uint64_t GetID() const { return id; }
+};
+
+}  // namespace
+
+TEST(PendingMessages, DropMessagesToReusedFD) {
+  PendingMessages messages;
+  std::map<int, FakeConnection> conns;
+  conns[5] = {1};
+
+  ASSERT_TRUE(messages.Post(5, 1, std::make_shared<std::string>("old reply")));
+  ASSERT_FALSE(messages.Post(5, 1, nullptr));
+  // The connection is closed and its fd is reused by a new connection before the messages are drained
+  conns.erase(5);
+  conns[5] = {2};
+  ASSERT_FALSE(messages.Post(5, 2, std::make_shared<std::string>("new reply")));
+
+  auto find = [&conns](int fd) -> FakeConnection * {
+    auto iter = conns.find(fd);
+    return iter != conns.end() ? &iter->second : nullptr;
+  };
+  auto deliver = [](FakeConnection *conn, const std::shared_ptr<const std::string> &reply) {
+    if (reply) {
+      conn->replies.emplace_back(*reply);
+    } else {
+      conn->write_events++;
+    }
+  };
+  messages.Drain(find, deliver);
+  ASSERT_EQ(conns[5].replies, std::vector<std::string>{"new reply"});
+  ASSERT_EQ(conns[5].write_events, 0);
+
+  // The messages to a closed connection are dropped
+  ASSERT_TRUE(messages.Post(6, 3, nullptr));
+  messages.Drain(find, deliver);
+  ASSERT_EQ(conns.count(6), 0);
+  ASSERT_TRUE(messages.Post(5, 2, nullptr));
+  messages.Drain(find, deliver);
+  ASSERT_EQ(conns[5].write_events, 1);
+}
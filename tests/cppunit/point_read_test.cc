@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "encoding.h"
+#include "storage/redis_db.h"
+#include "test_base.h"
+#include "types/redis_hash.h"
+#include "types/redis_set.h"
+#include "types/redis_string.h"
+#include "types/redis_zset.h"
+
+class PointReadTest : public TestBase {
+ protected:
+  explicit PointReadTest() : database_(storage_.get(), "point_read_ns") {}
+
+  redis::Database database_;
+};
+
+TEST_F(PointReadTest, MultiPointRead) {
+  const std::string ns = "point_read_ns";
+  redis::String string_db(storage_.get(), ns);
+  redis::Hash hash_db(storage_.get(), ns);
+  redis::Set set_db(storage_.get(), ns);
+  redis::ZSet zset_db(storage_.get(), ns);
+
+  uint64_t ret = 0;
+  ASSERT_TRUE(string_db.Set("pr_string", "value").ok());
+  ASSERT_TRUE(hash_db.Set("pr_hash", "field", "hash-value", &ret).ok());
+  ASSERT_TRUE(set_db.Add("pr_set", {"member"}, &ret).ok());
+  std::vector<MemberScore> mscores = {{"member", 1.5}};
+  ASSERT_TRUE(zset_db.Add("pr_zset", ZAddFlags::Default(), &mscores, &ret).ok());
+
+  std::vector<redis::Database::PointRead> reads = {
+      {kRedisString, "pr_string"},
+      {kRedisString, "pr_missing"},
+      {kRedisString, "pr_hash"},
+      {kRedisNone, "pr_set"},
+      {kRedisHash, "pr_hash", "field", true},
+      {kRedisHash, "pr_hash", "missing", true},
+      {kRedisSet, "pr_set", "member", true},
+      {kRedisZSet, "pr_zset", "member", true},
+      {kRedisZSet, "pr_missing", "member", true},
+  };
+  std::vector<redis::Database::PointReadResult> results;
+  database_.MultiPointRead(reads, &results);
+  ASSERT_EQ(results.size(), reads.size());
+
+  ASSERT_TRUE(results[0].status.ok());
+  EXPECT_EQ(results[0].value, "value");
+  EXPECT_TRUE(results[1].status.IsNotFound());
+  EXPECT_TRUE(results[2].status.IsInvalidArgument());
+  ASSERT_TRUE(results[3].status.ok());
+  EXPECT_EQ(results[3].type, kRedisSet);
+  ASSERT_TRUE(results[4].status.ok());
+  EXPECT_EQ(results[4].value, "hash-value");
+  EXPECT_TRUE(results[5].status.IsNotFound());
+  EXPECT_TRUE(results[6].status.ok());
+  ASSERT_TRUE(results[7].status.ok());
+  EXPECT_EQ(DecodeDouble(results[7].value.data()), 1.5);
+  EXPECT_TRUE(results[8].status.IsNotFound());
+
+  auto s = database_.Del("pr_string");
+  s = database_.Del("pr_hash");
+  s = database_.Del("pr_set");
+  s = database_.Del("pr_zset");
+}
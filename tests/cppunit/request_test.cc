@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "server/redis_request.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "event_util.h"
+
+// Append each piece as a separate chunk, so the requests straddle the chunks of the buffer
+static void AddChunks(evbuffer *buffer, const std::vector<std::string> &pieces) {
+  for (const auto &piece : pieces) {
+    evbuffer_add_reference(buffer, piece.data(), piece.size(), nullptr, nullptr);
+  }
+}
+
+TEST(Request, Tokenize) {
+  Stats stats;
+  redis::Request request(&stats);
+  UniqueEvbuf input;
+
+  std::string data = "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$5\r\nvalue\r\n*2\r\n$3\r\nGET\r\n$3\r\nkey\r\n";
+  evbuffer_add(input.get(), data.data(), data.size());
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+
+  auto commands = request.GetCommands();
+  ASSERT_EQ(commands->size(), 2);
+  ASSERT_EQ((*commands)[0], (redis::CommandTokens{"SET", "key", "value"}));
+  ASSERT_EQ((*commands)[1], (redis::CommandTokens{"GET", "key"}));
+  ASSERT_EQ(evbuffer_get_length(input.get()), 0);
+}
+
+TEST(Request, TokenizeAcrossChunks) {
+  Stats stats;
+  redis::Request request(&stats);
+  UniqueEvbuf input;
+
+  std::vector<std::string> pieces = {"*", "2\r", "\n$3\r\nG", "ET\r\n$1", "1\r\n", "hello world", "\r\n"};
+  AddChunks(input.get(), pieces);
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+  auto commands = request.GetCommands();
+  ASSERT_EQ(commands->size(), 1);
+  ASSERT_EQ((*commands)[0], (redis::CommandTokens{"GET", "hello world"}));
+}
+
+TEST(Request, TokenizeIncomplete) {
+  Stats stats;
+  redis::Request request(&stats);
+  UniqueEvbuf input;
+  auto commands = request.GetCommands();
+
+  std::string data = "*2\r\n$4\r\nPING\r\n$5\r\nhel";
+  evbuffer_add(input.get(), data.data(), data.size());
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+  ASSERT_TRUE(commands->empty());
+
+  data = "lo\r\nPING\r\n\r\n";
+  evbuffer_add(input.get(), data.data(), data.size());
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+  ASSERT_EQ(commands->size(), 2);
+  ASSERT_EQ((*commands)[0], (redis::CommandTokens{"PING", "hello"}));
+  // inline protocol
+  ASSERT_EQ((*commands)[1], (redis::CommandTokens{"PING"}));
+}
+
+TEST(Request, TokenizeInvalid) {
+  std::vector<std::string> cases = {"*abc\r\n", "*3\n", "*2\r\n+OK\r\n", "*1\r\n$-1\r\n", "*1\r\n$x\r\n"};
+  for (const auto &data : cases) {
+    Stats stats;
+    redis::Request request(&stats);
+    UniqueEvbuf input;
+    evbuffer_add(input.get(), data.data(), data.size());
+    ASSERT_FALSE(request.Tokenize(input.get()).IsOK()) << data;
+  }
+}
+
+TEST(Request, TokenizeEmptyLineBeforeBulkLen) {
+  Stats stats;
+  redis::Request request(&stats);
+  UniqueEvbuf input;
+
+  // The empty lines where a bulk length is expected are skipped, even if split across the chunks
+  std::vector<std::string> pieces = {"*2\r\n$3\r\nGET\r\n\r", "\n\r\n$3\r\nkey\r\n"};
+  AddChunks(input.get(), pieces);
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+  auto commands = request.GetCommands();
+  ASSERT_EQ(commands->size(), 1);
+  ASSERT_EQ((*commands)[0], (redis::CommandTokens{"GET", "key"}));
+  ASSERT_EQ(evbuffer_get_length(input.get()), 0);
+
+  std::string data = "*1\r\n\r";
+  evbuffer_add(input.get(), data.data(), data.size());
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+  ASSERT_EQ(commands->size(), 1);
+  data = "\n$4\r\nPING\r\n";
+  evbuffer_add(input.get(), data.data(), data.size());
+  ASSERT_TRUE(request.Tokenize(input.get()).IsOK());
+  ASSERT_EQ(commands->size(), 2);
+  ASSERT_EQ((*commands)[1], (redis::CommandTokens{"PING"}));
+
+  data = "*1\r\n\rx$4\r\nPING\r\n";
+  evbuffer_add(input.get(), data.data(), data.size());
+  ASSERT_FALSE(request.Tokenize(input.get()).IsOK());
+}
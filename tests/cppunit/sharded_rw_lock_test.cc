@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "sharded_rw_lock.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+TEST(ShardedRWLock, SharedAndExclusive) {
+  ShardedRWLock lock;
+  {
+    std::shared_lock<ShardedRWLock> shared1(lock);
+    ASSERT_FALSE(lock.try_lock());
+    std::thread t([&lock] {
+      std::shared_lock<ShardedRWLock> shared2(lock, std::try_to_lock);
+      ASSERT_TRUE(shared2.owns_lock());
+    });
+    t.join();
+  }
+  {
+    std::unique_lock<ShardedRWLock> exclusive(lock);
+    std::thread t([&lock] {
+      ASSERT_FALSE(lock.try_lock_shared());
+      ASSERT_FALSE(lock.try_lock());
+    });
+    t.join();
+  }
+  ASSERT_TRUE(lock.try_lock());
+  lock.unlock();
+}
+
+TEST(ShardedRWLock, ExclusiveWaitsForReaders) {
+  ShardedRWLock lock;
+  constexpr int kReaders = 8;
+  constexpr int kRounds = 10000;
+
+  // The readers verify that the value is never changed inside a shared section,
+  // and the writers verify that no reader is inside while holding the lock.
+  std::atomic<int> active_readers = 0;
+  int value = 0;
+  std::atomic<bool> stop = false;
+  std::atomic<bool> failed = false;
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kReaders; i++) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        std::shared_lock<ShardedRWLock> guard(lock);
+        active_readers++;
+        int v = value;
+        std::this_thread::yield();
+        if (v != value) failed = true;
+        active_readers--;
+      }
+    });
+  }
+  for (int i = 0; i < kRounds / 100; i++) {
+    std::unique_lock<ShardedRWLock> guard(lock);
+    if (active_readers != 0) failed = true;
+    value++;
+  }
+  stop = true;
+  for (auto &t : readers) t.join();
+
+  ASSERT_FALSE(failed);
+  ASSERT_EQ(value, kRounds / 100);
+}
@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "storage/redis_db.h"
+#include "test_base.h"
+
+class SnapshotPinnerTest : public TestBase {
+ protected:
+  uint64_t numSnapshots() {
+    uint64_t num = 0;
+    storage_->GetDB()->GetIntProperty("rocksdb.num-snapshots", &num);
+    return num;
+  }
+
+  void write() {
+    rocksdb::WriteBatch batch;
+    batch.Put("key", "value");
+    ASSERT_TRUE(storage_->Write(storage_->DefaultWriteOptions(), &batch).ok());
+  }
+};
+
+TEST_F(SnapshotPinnerTest, ReuseUntilWrite) {
+  redis::SnapshotPinner pinner(storage_.get());
+  ASSERT_TRUE(pinner.IsActive());
+
+  const rocksdb::Snapshot *first = nullptr;
+  {
+    redis::LatestSnapShot ss(storage_.get());
+    first = ss.GetSnapShot();
+  }
+  {
+    redis::LatestSnapShot ss(storage_.get());
+    EXPECT_EQ(ss.GetSnapShot(), first);
+  }
+  EXPECT_EQ(numSnapshots(), 1);
+
+  write();
+  redis::LatestSnapShot ss(storage_.get());
+  EXPECT_NE(ss.GetSnapShot(), first);
+  EXPECT_EQ(ss.GetSnapShot()->GetSequenceNumber(), storage_->LatestSeqNumber());
+  EXPECT_EQ(numSnapshots(), 1);
+}
+
+TEST_F(SnapshotPinnerTest, OutdatedSnapshotKeptForReaders) {
+  {
+    redis::SnapshotPinner pinner(storage_.get());
+    redis::LatestSnapShot outer(storage_.get());
+    auto seq = outer.GetSnapShot()->GetSequenceNumber();
+
+    write();
+    {
+      redis::LatestSnapShot inner(storage_.get());
+      EXPECT_NE(inner.GetSnapShot(), outer.GetSnapShot());
+      EXPECT_EQ(numSnapshots(), 2);
+    }
+    EXPECT_EQ(outer.GetSnapShot()->GetSequenceNumber(), seq);
+
+    std::string value;
+    rocksdb::ReadOptions read_options;
+    read_options.snapshot = outer.GetSnapShot();
+    EXPECT_TRUE(storage_->Get(read_options, "key", &value).IsNotFound());
+  }
+  EXPECT_EQ(numSnapshots(), 0);
+}
+
+TEST_F(SnapshotPinnerTest, NestedAndOtherThreads) {
+  redis::SnapshotPinner pinner(storage_.get());
+  redis::SnapshotPinner nested(storage_.get());
+  EXPECT_TRUE(pinner.IsActive());
+  EXPECT_FALSE(nested.IsActive());
+
+  redis::LatestSnapShot ss(storage_.get());
+  std::thread([&] {
+    // The pinned snapshot is only shared in the thread of the pinner
+    redis::LatestSnapShot other(storage_.get());
+    EXPECT_NE(other.GetSnapShot(), ss.GetSnapShot());
+  }).join();
+}
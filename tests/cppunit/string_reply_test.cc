@@ -20,7 +20,9 @@
 
 #include <gtest/gtest.h>
 
+#include "event_util.h"
 #include "server/redis_reply.h"
+#include "stats/stats.h"
 
 class StringReplyTest : public testing::Test {
  protected:
@@ -51,3 +53,97 @@ TEST_F(StringReplyTest, BulkString) {
 
   ASSERT_EQ(result.length(), 13 * 10 + 14 * 90 + 15 * 900 + 17 * 9000 + 18 * 90000 + 9);
 }
+
+static std::string DrainEvbuf(evbuffer *buffer) {
+  std::string data(evbuffer_get_length(buffer), '\0');
+  evbuffer_remove(buffer, data.data(), data.size());
+  return data;
+}
+
+static void WriteReply(redis::ReplyWriter *writer, const std::vector<std::string> &values) {
+  writer->MapLen(2);
+  writer->BulkString("a");
+  writer->Integer(1);
+  writer->SimpleString("b");
+  writer->Double(1.5);
+  writer->SetLen(values.size());
+  for (const auto &v : values) {
+    writer->BulkString(v);
+  }
+  writer->NilString();
+  writer->Error("ERR test");
+}
+
+TEST_F(StringReplyTest, ReplyWriter) {
+  for (auto version : {redis::RESP::v2, redis::RESP::v3}) {
+    std::string expected;
+    {
+      redis::ReplyWriter writer(&expected, version);
+      WriteReply(&writer, values);
+    }
+    ASSERT_EQ(expected.substr(0, 4), version == redis::RESP::v3 ? "%2\r\n" : "*4\r\n");
+
+    Stats stats;
+    UniqueEvbuf output;
+    {
+      redis::ReplyWriter writer(output.get(), version, &stats);
+      WriteReply(&writer, values);
+    }
+    ASSERT_EQ(stats.out_bytes, expected.size());
+    ASSERT_EQ(DrainEvbuf(output.get()), expected);
+  }
+}
+
+TEST_F(StringReplyTest, ReplyWriterLargeValue) {
+  std::string large(redis::ReplyWriter::kReferenceThreshold * 4, 'x');
+  std::string expected = redis::BulkString("small") + redis::BulkString(large) + redis::BulkString(large);
+
+  Stats stats;
+  UniqueEvbuf output;
+  {
+    redis::ReplyWriter writer(output.get(), redis::RESP::v2, &stats);
+    writer.BulkString("small");
+    writer.BulkString(std::string(large));
+    rocksdb::PinnableSlice pinned;
+    pinned.PinSelf(large);
+    writer.BulkString(std::move(pinned));
+  }
+  ASSERT_EQ(stats.out_bytes, expected.size());
+  ASSERT_EQ(DrainEvbuf(output.get()), expected);
+}
+
+TEST_F(StringReplyTest, ReplyWriterDeferredLen) {
+  std::string large(redis::ReplyWriter::kReferenceThreshold * 2, 'x');
+  auto write_elements = [&large](redis::ReplyWriter *writer) {
+    writer->DeferredLen(&redis::ReplyWriter::ArrayLen, [&]() -> std::optional<size_t> {
+      for (const auto &v : values) writer->BulkString(v);
+      writer->BulkString(std::string(large));
+      return values.size() + 1;
+    });
+    // The elements are discarded on errors
+    writer->DeferredLen(&redis::ReplyWriter::MapLen, [&]() -> std::optional<size_t> {
+      writer->BulkString("a");
+      return std::nullopt;
+    });
+    writer->SimpleString("OK");
+  };
+  std::string expected = redis::MultiLen(values.size() + 1);
+  for (const auto &v : values) expected += redis::BulkString(v);
+  expected += redis::BulkString(large) + redis::SimpleString("OK");
+
+  std::string str_output;
+  {
+    redis::ReplyWriter writer(&str_output, redis::RESP::v2);
+    write_elements(&writer);
+  }
+  ASSERT_EQ(str_output, expected);
+
+  Stats stats;
+  UniqueEvbuf output;
+  {
+    redis::ReplyWriter writer(output.get(), redis::RESP::v2, &stats);
+    write_elements(&writer);
+  }
+  ASSERT_EQ(stats.out_bytes, expected.size());
+  ASSERT_EQ(DrainEvbuf(output.get()), expected);
+}
@@ -625,3 +625,167 @@ TEST_P(RedisBitmapTest, BitfieldStringGetSetTest) {
     i += 8;
   }
 }
+
+TEST_P(RedisBitmapTest, CompressedSegments) {
+  config_.bitmap_compressed_segments = true;
+  std::vector<uint32_t> offsets = {5, 1000, 8191, 10 * 8192 + 3};
+  // a run of bits in a segment of its own
+  for (uint32_t offset = 100 * 8192 + 4000; offset <= 100 * 8192 + 4100; offset++) offsets.emplace_back(offset);
+  for (auto offset : offsets) {
+    bool bit = false;
+    ASSERT_TRUE(bitmap_->SetBit(key_, offset, true, &bit).ok());
+    ASSERT_FALSE(bit);
+  }
+
+  for (uint32_t offset : {5U, 8191U, 10U * 8192 + 3, 100U * 8192 + 4050}) {
+    bool bit = false;
+    ASSERT_TRUE(bitmap_->GetBit(key_, offset, &bit).ok());
+    EXPECT_TRUE(bit);
+  }
+  bool bit = true;
+  ASSERT_TRUE(bitmap_->GetBit(key_, 10 * 8192 + 4, &bit).ok());
+  EXPECT_FALSE(bit);
+
+  uint32_t cnt = 0;
+  ASSERT_TRUE(bitmap_->BitCount(key_, 0, -1, false, &cnt).ok());
+  EXPECT_EQ(cnt, offsets.size());
+  ASSERT_TRUE(bitmap_->BitCount(key_, 1024, -1, false, &cnt).ok());
+  EXPECT_EQ(cnt, offsets.size() - 3);
+
+  int64_t pos = 0;
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 0, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 5);
+  ASSERT_TRUE(bitmap_->SetBit(key_, 5, false, &bit).ok());
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 0, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 1000);
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 1024, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 10 * 8192 + 3);
+
+  // a bitmap created before keeps its raw segments, and they can be combined
+  config_.bitmap_compressed_segments = false;
+  std::string raw_key = "test_bitmap_raw_key", dst_key = "test_bitmap_dst_key";
+  ASSERT_TRUE(bitmap_->SetBit(raw_key, 10 * 8192 + 3, true, &bit).ok());
+  ASSERT_TRUE(bitmap_->SetBit(raw_key, 20 * 8192, true, &bit).ok());
+  config_.bitmap_compressed_segments = true;
+
+  if (GetParam()) {
+    std::string value;
+    ASSERT_TRUE(bitmap_->GetString(key_, 1024 * 1024, &value).ok());
+    EXPECT_EQ(value.size(), (100 * 8192 + 4100) / 8 + 1);
+    EXPECT_EQ(value[1000 / 8], static_cast<char>(0x80 >> (1000 % 8)));
+
+    int64_t len = 0;
+    ASSERT_TRUE(bitmap_->BitOp(kBitOpOr, "OR", dst_key, {key_, raw_key}, &len).ok());
+    ASSERT_TRUE(bitmap_->BitCount(dst_key, 0, -1, false, &cnt).ok());
+    EXPECT_EQ(cnt, offsets.size());
+    ASSERT_TRUE(bitmap_->BitOp(kBitOpAnd, "AND", dst_key, {key_, raw_key}, &len).ok());
+    ASSERT_TRUE(bitmap_->BitCount(dst_key, 0, -1, false, &cnt).ok());
+    EXPECT_EQ(cnt, 1);
+    ASSERT_TRUE(bitmap_->GetBit(dst_key, 10 * 8192 + 3, &bit).ok());
+    EXPECT_TRUE(bit);
+  }
+
+  auto s = bitmap_->Del(raw_key);
+  s = bitmap_->Del(dst_key);
+  config_.bitmap_compressed_segments = false;
+}
+
+TEST_P(RedisBitmapTest, PopcountSummary) {
+  config_.bitmap_popcount_summary = true;
+  bool bit = false;
+  for (uint32_t offset : {3U, 5U, 5U * 8192 + 7, 2000U * 8192 + 1}) {
+    ASSERT_TRUE(bitmap_->SetBit(key_, offset, true, &bit).ok());
+  }
+  // fill the second segment
+  std::vector<BitfieldOperation> ops;
+  for (uint32_t offset = 8192; offset < 2 * 8192; offset += 32) {
+    BitfieldOperation op;
+    op.type = BitfieldOperation::Type::kSet;
+    op.encoding = BitfieldEncoding::Create(BitfieldEncoding::Type::kUnsigned, 32).GetValue();
+    op.offset = offset;
+    op.value = UINT32_MAX;
+    ops.emplace_back(op);
+  }
+  std::vector<std::optional<BitfieldValue>> rets;
+  ASSERT_TRUE(bitmap_->Bitfield(key_, ops, &rets).ok());
+
+  uint32_t cnt = 0;
+  ASSERT_TRUE(bitmap_->BitCount(key_, 0, -1, false, &cnt).ok());
+  EXPECT_EQ(cnt, 8196);
+  ASSERT_TRUE(bitmap_->BitCount(key_, 1, 5 * 1024, false, &cnt).ok());
+  EXPECT_EQ(cnt, 8193);
+  ASSERT_TRUE(bitmap_->BitCount(key_, 4, 5 * 8192 + 7, true, &cnt).ok());
+  EXPECT_EQ(cnt, 8194);
+  ASSERT_TRUE(bitmap_->BitCount(key_, 2 * 1024, -1, false, &cnt).ok());
+  EXPECT_EQ(cnt, 2);
+
+  int64_t pos = 0;
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 1, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 8192);
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 2 * 1024, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 5 * 8192 + 7);
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 6 * 1024, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 2000 * 8192 + 1);
+  ASSERT_TRUE(bitmap_->BitPos(key_, false, 1024, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 2 * 8192);
+
+  // the summary follows the bits cleared and set again
+  ASSERT_TRUE(bitmap_->SetBit(key_, 8192 + 100, false, &bit).ok());
+  ASSERT_TRUE(bit);
+  ASSERT_TRUE(bitmap_->BitPos(key_, false, 1024, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 8192 + 100);
+  ASSERT_TRUE(bitmap_->BitCount(key_, 0, 3 * 1024, false, &cnt).ok());
+  EXPECT_EQ(cnt, 8193);
+  ASSERT_TRUE(bitmap_->SetBit(key_, 5 * 8192 + 7, false, &bit).ok());
+  ASSERT_TRUE(bitmap_->BitPos(key_, true, 2 * 1024, -1, false, &pos).ok());
+  EXPECT_EQ(pos, 2000 * 8192 + 1);
+
+  if (GetParam()) {
+    std::string value;
+    ASSERT_TRUE(bitmap_->GetString(key_, 4 * 1024 * 1024, &value).ok());
+    EXPECT_EQ(value.size(), 2000 * 1024 + 1);
+
+    std::string dst_key = "test_bitmap_dst_key";
+    int64_t len = 0;
+    ASSERT_TRUE(bitmap_->BitOp(kBitOpNot, "NOT", dst_key, {key_}, &len).ok());
+    ASSERT_TRUE(bitmap_->BitCount(dst_key, 1024, 2 * 1024 - 1, false, &cnt).ok());
+    EXPECT_EQ(cnt, 1);
+    ASSERT_TRUE(bitmap_->BitCount(dst_key, 0, -1, false, &cnt).ok());
+    EXPECT_EQ(cnt, len * 8 - 8194);
+    ASSERT_TRUE(bitmap_->BitPos(dst_key, false, 0, -1, false, &pos).ok());
+    EXPECT_EQ(pos, 3);
+    auto s = bitmap_->Del(dst_key);
+  }
+  config_.bitmap_popcount_summary = false;
+}
+
+TEST(RedisBitmapSegment, EncodeAndDecode) {
+  auto round_trip = [](const std::string &bytes, size_t encoded_size) {
+    std::string encoded, decoded;
+    redis::Bitmap::EncodeSegment(bytes, &encoded);
+    EXPECT_EQ(encoded.size(), encoded_size);
+    ASSERT_TRUE(redis::Bitmap::DecodeSegment(encoded, &decoded).ok());
+    auto trimmed = bytes.substr(0, bytes.find_last_not_of('\0') + 1);
+    EXPECT_EQ(decoded, trimmed);
+  };
+
+  // no bits
+  round_trip(std::string(1024, 0), 1);
+  std::string sparse(1024, 0);
+  sparse[3] = 0x01;
+  sparse[1000] = 0x11;
+  // three offsets of set bits
+  round_trip(sparse, 1 + 3 * 2);
+  std::string runs(1024, 0);
+  std::fill(runs.begin() + 10, runs.begin() + 500, '\xff');
+  // a single run
+  round_trip(runs, 1 + 4);
+  std::string dense(1024, '\x55');
+  // the bytes as they are
+  round_trip(dense, 1 + 1024);
+  EXPECT_TRUE(redis::Bitmap::IsEmptySegment(std::string(1, 0)));
+
+  std::string decoded;
+  EXPECT_FALSE(redis::Bitmap::DecodeSegment(std::string("\x01\x00", 2), &decoded).ok());
+  EXPECT_FALSE(redis::Bitmap::DecodeSegment(std::string("\x03", 1), &decoded).ok());
+}
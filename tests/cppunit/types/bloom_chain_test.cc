@@ -81,3 +81,43 @@ TEST_F(RedisBloomChainTest, BasicAddAndTest) {
   }
   s = sb_chain_->Del(key_);
 }
+
+TEST_F(RedisBloomChainTest, PagedFilters) {
+  std::string legacy_key = "test_sb_chain_legacy_key";
+  auto s = sb_chain_->Reserve(legacy_key, 10, 0.01, 2);
+  EXPECT_TRUE(s.ok());
+  config_.bloom_filter_paged = true;
+  // a large filter of many pages and a scaling one of small filters
+  s = sb_chain_->Reserve(key_, 1000000, 0.01, 0);
+  EXPECT_TRUE(s.ok());
+
+  std::vector<std::string> items;
+  for (int i = 0; i < 300; i++) items.emplace_back("item" + std::to_string(i));
+  for (const auto& key : {key_, legacy_key, std::string("test_sb_chain_scaling_key")}) {
+    std::vector<redis::BloomFilterAddResult> rets(items.size());
+    s = sb_chain_->MAdd(key, items, &rets);
+    EXPECT_TRUE(s.ok());
+
+    std::vector<bool> exists(items.size());
+    s = sb_chain_->MExists(key, items, &exists);
+    EXPECT_TRUE(s.ok());
+    for (auto exist : exists) EXPECT_TRUE(exist);
+  }
+  bool exist = true;
+  s = sb_chain_->Exists(key_, "no_exist_item", &exist);
+  EXPECT_TRUE(s.ok());
+  EXPECT_FALSE(exist);
+
+  redis::BloomFilterInfo info;
+  s = sb_chain_->Info(legacy_key, &info);
+  EXPECT_TRUE(s.ok());
+  EXPECT_GT(info.n_filters, 1);
+  s = sb_chain_->Info("test_sb_chain_scaling_key", &info);
+  EXPECT_TRUE(s.ok());
+  EXPECT_GT(info.n_filters, 1);
+
+  s = sb_chain_->Del(key_);
+  s = sb_chain_->Del(legacy_key);
+  s = sb_chain_->Del("test_sb_chain_scaling_key");
+  config_.bloom_filter_paged = false;
+}
@@ -177,4 +177,42 @@ TEST(OptimalValueTest, TestBloomFilter) {
   test_optimal_num_estimation(std::numeric_limits<uint32_t>::max(), 0.25, kMaximumBloomFilterBytes * 8);
 }
 
+// The BlockTest checks that probing the blocks found by BlockOffset, one by one or in a batch,
+// is the same as probing the whole bitset.
+TEST(BlockTest, TestBloomFilter) {
+  std::mt19937_64 rng(42);
+  for (const uint32_t bloom_filter_bytes : {32, 1024, 65536}) {
+    auto [bloom_filter, data] = CreateBlockSplitBloomFilter(bloom_filter_bytes);
+
+    std::vector<uint64_t> hashes;
+    for (int i = 0; i < 1000; i++) {
+      hashes.push_back(rng());
+      if (i % 2 == 0) {
+        char* block = data.data() + BlockSplitBloomFilter::BlockOffset(hashes.back(), bloom_filter_bytes);
+        BlockSplitBloomFilter::InsertHashInBlock(hashes.back(), block);
+      }
+    }
+
+    std::vector<const char*> blocks;
+    for (auto hash : hashes) {
+      uint32_t offset = BlockSplitBloomFilter::BlockOffset(hash, bloom_filter_bytes);
+      EXPECT_EQ(offset % BlockSplitBloomFilter::kBytesPerFilterBlock, 0);
+      EXPECT_LT(offset, bloom_filter_bytes);
+      blocks.push_back(data.data() + offset);
+    }
+    std::vector<uint8_t> found(hashes.size());
+    BlockSplitBloomFilter::FindHashesInBlocks(hashes.data(), blocks.data(), hashes.size(), found.data());
+
+    const BlockSplitBloomFilter filter(data);
+    for (size_t i = 0; i < hashes.size(); i++) {
+      EXPECT_EQ(static_cast<bool>(found[i]), filter.FindHash(hashes[i]));
+      EXPECT_EQ(static_cast<bool>(found[i]), BlockSplitBloomFilter::FindHashInBlock(hashes[i], blocks[i]));
+      // no false negatives
+      if (i % 2 == 0) {
+        EXPECT_TRUE(found[i]);
+      }
+    }
+  }
+}
+
 }  // namespace test
@@ -391,3 +391,50 @@ TEST_F(RedisHashTest, HRandField) {
 
   s = hash_->Del(key_);
 }
+
+TEST_F(RedisHashTest, InlineEncoding) {
+  config_.inline_collection_max_entries = 4;
+  auto is_inline = [this] {
+    HashMetadata metadata(false);
+    auto s = hash_->Database::GetMetadata({kRedisHash}, hash_->AppendNamespacePrefix(key_), &metadata);
+    EXPECT_TRUE(s.ok());
+    return metadata.IsInlineEncoded();
+  };
+
+  uint64_t ret = 0;
+  for (size_t i = 0; i < fields_.size(); i++) {
+    EXPECT_TRUE(hash_->Set(key_, fields_[i], values_[i], &ret).ok());
+  }
+  EXPECT_TRUE(is_inline());
+  EXPECT_TRUE(hash_->Set(key_, fields_[0], "new-value", &ret).ok());
+  EXPECT_EQ(ret, 0);
+  int64_t counter = 0;
+  EXPECT_TRUE(hash_->IncrBy(key_, "counter", 5, &counter).ok());
+  EXPECT_EQ(counter, 5);
+  EXPECT_TRUE(hash_->Delete(key_, {fields_[1]}, &ret).ok());
+  EXPECT_EQ(ret, 1);
+  EXPECT_TRUE(is_inline());
+
+  std::string got;
+  EXPECT_TRUE(hash_->Get(key_, fields_[0], &got).ok());
+  EXPECT_EQ(got, "new-value");
+  EXPECT_TRUE(hash_->Get(key_, fields_[1], &got).IsNotFound());
+  std::vector<FieldValue> field_values;
+  EXPECT_TRUE(hash_->GetAll(key_, &field_values, HashFetchType::kOnlyKey).ok());
+  EXPECT_EQ(field_values.size(), 3);
+  EXPECT_TRUE(hash_->Size(key_, &ret).ok());
+  EXPECT_EQ(ret, 3);
+
+  // the fields move out of the metadata once the hash outgrows the limit
+  std::vector<FieldValue> more = {{"field-a", "a"}, {"field-b", "b"}};
+  EXPECT_TRUE(hash_->MSet(key_, more, false, &ret).ok());
+  EXPECT_EQ(ret, 2);
+  EXPECT_FALSE(is_inline());
+  EXPECT_TRUE(hash_->GetAll(key_, &field_values, HashFetchType::kOnlyKey).ok());
+  EXPECT_EQ(field_values.size(), 5);
+  EXPECT_TRUE(hash_->Get(key_, "counter", &got).ok());
+  EXPECT_EQ(got, "5");
+
+  auto s = hash_->Del(key_);
+  config_.inline_collection_max_entries = 0;
+}
@@ -692,3 +692,50 @@ TEST_F(RedisJsonTest, StrLen) {
     ASSERT_EQ(results[i], result1[i]);
   }
 }
+
+TEST_F(RedisJsonTest, SegmentedDocument) {
+  config_.json_segment_threshold = 32;
+  auto is_segmented = [&] {
+    JsonMetadata metadata(false);
+    EXPECT_TRUE(json_->Database::GetMetadata({kRedisJson}, json_->AppendNamespacePrefix(key_), &metadata).ok());
+    return metadata.IsSegmentedJson();
+  };
+
+  ASSERT_TRUE(json_->Set(key_, "$", R"({"counter": 0, "str": "foo", "obj": {"a": [1, 2, 3]}, "x": null})").ok());
+  ASSERT_TRUE(is_segmented());
+
+  JsonValue res = JsonValue::FromString("[]").GetValue();
+  ASSERT_TRUE(json_->NumIncrBy(key_, "$.counter", "5", &res).ok());
+  ASSERT_EQ(res.Print(0, true).GetValue(), "[5]");
+
+  Optionals<uint64_t> lens;
+  ASSERT_TRUE(json_->StrAppend(key_, "$['str']", "\"bar\"", &lens).ok());
+  ASSERT_EQ(lens.size(), 1);
+  ASSERT_EQ(lens[0], 6);
+
+  ASSERT_TRUE(json_->Set(key_, "$.obj", R"({"a": [1, 2, 3], "b": true})").ok());
+  size_t result = 0;
+  ASSERT_TRUE(json_->Del(key_, "$.x", &result).ok());
+  ASSERT_EQ(result, 1);
+
+  ASSERT_TRUE(json_->Get(key_, {"$.obj"}, &json_val_).ok());
+  ASSERT_EQ(json_val_.Dump().GetValue(), R"([{"a":[1,2,3],"b":true}])");
+  ASSERT_TRUE(json_->Get(key_, {}, &json_val_).ok());
+  ASSERT_EQ(json_val_.Dump().GetValue(), R"({"counter":5,"obj":{"a":[1,2,3],"b":true},"str":"foobar"})");
+  ASSERT_TRUE(is_segmented());
+
+  // the paths not under a named member read and write the whole document
+  ASSERT_TRUE(json_->Del(key_, "$..a", &result).ok());
+  ASSERT_EQ(result, 1);
+  ASSERT_TRUE(json_->Get(key_, {}, &json_val_).ok());
+  ASSERT_EQ(json_val_.Dump().GetValue(), R"({"counter":5,"obj":{"b":true},"str":"foobar"})");
+  ASSERT_TRUE(is_segmented());
+
+  ASSERT_TRUE(json_->Set(key_, "$", R"({"a": 1})").ok());
+  ASSERT_FALSE(is_segmented());
+  ASSERT_TRUE(json_->Get(key_, {}, &json_val_).ok());
+  ASSERT_EQ(json_val_.Dump().GetValue(), R"({"a":1})");
+
+  ASSERT_TRUE(json_->Del(key_, "$", &result).ok());
+  config_.json_segment_threshold = 0;
+}
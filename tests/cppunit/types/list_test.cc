@@ -628,3 +628,112 @@ TEST_F(RedisListTest, RPopMultiCountGreaterThanListSize) {
   }
   s = list_->Del(key_);
 }
+
+TEST_F(RedisListTest, ChunkedEncoding) {
+  config_.list_chunk_max_entries = 4;
+  Slice dst_key("test-chunked-dst-key");
+  auto s = list_->Del(key_);
+  std::vector<std::string> expected;
+  auto check_elems = [&] {
+    std::vector<std::string> elems;
+    EXPECT_TRUE(list_->Range(key_, 0, -1, &elems).ok());
+    EXPECT_EQ(elems, expected);
+    uint64_t size = 0;
+    EXPECT_TRUE(list_->Size(key_, &size).ok());
+    EXPECT_EQ(size, expected.size());
+  };
+
+  uint64_t ret = 0;
+  std::vector<Slice> elems{"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+  list_->Push(key_, elems, false, &ret);
+  EXPECT_EQ(ret, 10);
+  list_->Push(key_, {"y", "z"}, true, &ret);
+  EXPECT_EQ(ret, 12);
+  expected = {"z", "y", "a", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+  check_elems();
+
+  ListMetadata metadata(false);
+  s = list_->Database::GetMetadata({kRedisList}, list_->AppendNamespacePrefix(key_), &metadata);
+  ASSERT_TRUE(s.ok());
+  EXPECT_TRUE(metadata.IsChunkedList());
+
+  // ranges across the chunks
+  std::vector<std::string> range;
+  s = list_->Range(key_, 3, 8, &range);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(range, std::vector<std::string>(expected.begin() + 3, expected.begin() + 9));
+  std::string elem;
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_TRUE(list_->Index(key_, static_cast<int>(i), &elem).ok());
+    EXPECT_EQ(elem, expected[i]);
+  }
+
+  // inserts into a full chunk split it
+  int new_size = 0;
+  for (const auto &pivot : {"c", "d", "c"}) {
+    s = list_->Insert(key_, pivot, "x", true, &new_size);
+    EXPECT_TRUE(s.ok());
+  }
+  s = list_->Insert(key_, "j", "k", false, &new_size);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(new_size, 16);
+  s = list_->Insert(key_, "not-exist", "x", true, &new_size);
+  EXPECT_TRUE(s.IsNotFound());
+  EXPECT_EQ(new_size, -1);
+  expected = {"z", "y", "a", "b", "x", "x", "c", "x", "d", "e", "f", "g", "h", "i", "j", "k"};
+  check_elems();
+
+  s = list_->Set(key_, -2, "J");
+  EXPECT_TRUE(s.ok());
+  expected[14] = "J";
+  std::vector<int64_t> indexes;
+  PosSpec spec;
+  spec.rank = -1;
+  spec.count = 0;
+  s = list_->Pos(key_, "x", spec, &indexes);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(indexes, std::vector<int64_t>({7, 5, 4}));
+
+  // removals empty some of the chunks
+  uint64_t removed_cnt = 0;
+  s = list_->Rem(key_, -2, "x", &removed_cnt);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(removed_cnt, 2);
+  expected = {"z", "y", "a", "b", "x", "c", "d", "e", "f", "g", "h", "i", "J", "k"};
+  check_elems();
+  for (const auto &e : {"c", "d", "e", "f"}) {
+    s = list_->Rem(key_, 0, e, &removed_cnt);
+    EXPECT_TRUE(s.ok());
+    EXPECT_EQ(removed_cnt, 1);
+  }
+  expected = {"z", "y", "a", "b", "x", "g", "h", "i", "J", "k"};
+  check_elems();
+
+  s = list_->LMove(key_, key_, true, false, &elem);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(elem, "z");
+  s = list_->LMove(key_, dst_key, false, true, &elem);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(elem, "z");
+  expected = {"y", "a", "b", "x", "g", "h", "i", "J", "k"};
+  check_elems();
+
+  std::vector<std::string> popped;
+  s = list_->PopMulti(key_, true, 5, &popped);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(popped, std::vector<std::string>({"y", "a", "b", "x", "g"}));
+  s = list_->Trim(key_, 1, -2);
+  EXPECT_TRUE(s.ok());
+  expected = {"i", "J"};
+  check_elems();
+
+  s = list_->PopMulti(key_, false, 5, &popped);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(popped, std::vector<std::string>({"J", "i"}));
+  expected = {};
+  check_elems();
+
+  s = list_->Del(key_);
+  s = list_->Del(dst_key);
+  config_.list_chunk_max_entries = 0;
+}
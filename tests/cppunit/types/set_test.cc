@@ -274,3 +274,42 @@ TEST_F(RedisSetTest, TakeWithoutPop) {
   s = set_->Remove(key_, fields_, &ret);
   EXPECT_TRUE(s.ok() && fields_.size() == ret);
 }
+
+TEST_F(RedisSetTest, InlineEncoding) {
+  config_.inline_collection_max_entries = 8;
+  auto is_inline = [this] {
+    SetMetadata metadata(false);
+    auto s = set_->Database::GetMetadata({kRedisSet}, set_->AppendNamespacePrefix(key_), &metadata);
+    EXPECT_TRUE(s.ok());
+    return metadata.IsInlineEncoded();
+  };
+
+  uint64_t ret = 0;
+  EXPECT_TRUE(set_->Add(key_, {"m1", "m1", "m2", "m3"}, &ret).ok());
+  EXPECT_EQ(ret, 3);
+  EXPECT_TRUE(set_->Remove(key_, {"m2", "m4"}, &ret).ok());
+  EXPECT_EQ(ret, 1);
+  EXPECT_TRUE(is_inline());
+
+  std::vector<int> exists;
+  EXPECT_TRUE(set_->MIsMember(key_, {"m1", "m2", "m3"}, &exists).ok());
+  EXPECT_EQ(exists, std::vector<int>({1, 0, 1}));
+  std::vector<std::string> members;
+  EXPECT_TRUE(set_->Members(key_, &members).ok());
+  EXPECT_EQ(members, std::vector<std::string>({"m1", "m3"}));
+
+  // the members move out of the metadata once the set outgrows the limit
+  EXPECT_TRUE(set_->Add(key_, fields_, &ret).ok());
+  EXPECT_TRUE(set_->Add(key_, {"m5", "m6", "m7"}, &ret).ok());
+  EXPECT_FALSE(is_inline());
+  EXPECT_TRUE(set_->Card(key_, &ret).ok());
+  EXPECT_EQ(ret, 9);
+  EXPECT_TRUE(set_->Members(key_, &members).ok());
+  EXPECT_EQ(members.size(), 9);
+
+  EXPECT_TRUE(set_->Take(key_, &members, 9, true).ok());
+  EXPECT_EQ(members.size(), 9);
+  EXPECT_TRUE(set_->Card(key_, &ret).ok());
+  EXPECT_EQ(ret, 0);
+  config_.inline_collection_max_entries = 0;
+}
@@ -20,7 +20,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "test_base.h"
 #include "types/redis_string.h"
@@ -127,6 +133,58 @@ TEST_F(RedisStringTest, IncrBy) {
   s = string_->Del(key_);
 }
 
+TEST_F(RedisStringTest, ConcurrentIncrBy) {
+  constexpr int kThreads = 4;
+  constexpr int kIncrementsPerThread = 200;
+  std::vector<std::vector<int64_t>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([this, &results, i] {
+      for (int j = 0; j < kIncrementsPerThread; j++) {
+        int64_t ret = 0;
+        EXPECT_TRUE(string_->IncrBy(key_, 1, &ret).ok());
+        results[i].push_back(ret);
+      }
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  // The concurrent increments may be combined, but each one still gets a distinct value
+  std::set<int64_t> values;
+  for (const auto &result : results) values.insert(result.begin(), result.end());
+  EXPECT_EQ(values.size(), kThreads * kIncrementsPerThread);
+  std::string value;
+  EXPECT_TRUE(string_->Get(key_, &value).ok());
+  EXPECT_EQ(value, std::to_string(kThreads * kIncrementsPerThread));
+  auto s = string_->Del(key_);
+}
+
+TEST_F(RedisStringTest, IncrByWithTxnLocks) {
+  constexpr int kIncrements = 200;
+  auto s = string_->Del(key_);
+  // The increments under the locks of a transaction or a script must not wait for the combined
+  // increments of other threads, which in turn wait for the locks
+  std::thread other([this] {
+    for (int i = 0; i < kIncrements; i++) {
+      int64_t ret = 0;
+      EXPECT_TRUE(string_->IncrBy(key_, 1, &ret).ok());
+    }
+  });
+  for (int i = 0; i < kIncrements; i++) {
+    TxnLockGuard guard(storage_->GetLockManager(), std::vector<std::string>{string_->AppendNamespacePrefix(key_)});
+    int64_t before = 0, after = 0;
+    EXPECT_TRUE(string_->IncrBy(key_, 1, &before).ok());
+    EXPECT_TRUE(string_->IncrBy(key_, 1, &after).ok());
+    EXPECT_EQ(after, before + 1);
+  }
+  other.join();
+
+  std::string value;
+  EXPECT_TRUE(string_->Get(key_, &value).ok());
+  EXPECT_EQ(value, std::to_string(3 * kIncrements));
+  s = string_->Del(key_);
+}
+
 TEST_F(RedisStringTest, GetEmptyValue) {
   const std::string key = "empty_value_key";
   auto s = string_->Set(key, "");
@@ -358,3 +416,77 @@ TEST_F(RedisStringTest, LCS) {
                     4},
                    std::get<StringLCSIdxResult>(rst));
 }
+
+TEST_F(RedisStringTest, ChunkedString) {
+  config_.string_chunk_threshold = 1024;
+  auto is_chunked = [this]() {
+    std::string bytes;
+    Metadata metadata(kRedisNone, false);
+    EXPECT_TRUE(string_->GetRawMetadata(string_->AppendNamespacePrefix(key_), &bytes).ok());
+    EXPECT_TRUE(metadata.Decode(bytes).ok());
+    return metadata.IsChunkedString();
+  };
+  auto expect_value = [this](const std::string &expected) {
+    std::string value;
+    ASSERT_TRUE(string_->Get(key_, &value).ok());
+    EXPECT_EQ(expected, value);
+    uint64_t length = 0;
+    ASSERT_TRUE(string_->Strlen(key_, &length).ok());
+    EXPECT_EQ(expected.size(), length);
+  };
+
+  std::string expected;
+  for (int i = 0; i < 40000; i++) expected += static_cast<char>('a' + i % 26);
+  ASSERT_TRUE(string_->Set(key_, expected).ok());
+  EXPECT_TRUE(is_chunked());
+  expect_value(expected);
+
+  std::optional<std::string> range;
+  for (auto [start, stop] : std::vector<std::pair<int, int>>{
+           {0, -1}, {100, 200}, {16380, 16390}, {-5, -1}, {39999, 50000}, {-50000, 10}, {20, 10}}) {
+    ASSERT_TRUE(string_->GetRange(key_, start, stop, range).ok());
+    int64_t size = static_cast<int64_t>(expected.size());
+    int64_t begin = start < 0 ? std::max<int64_t>(size + start, 0) : start;
+    int64_t end = std::min<int64_t>(stop < 0 ? size + stop : stop, size - 1);
+    if (begin > end) {
+      EXPECT_FALSE(range.has_value());
+    } else {
+      EXPECT_EQ(expected.substr(begin, end - begin + 1), range.value());
+    }
+  }
+
+  uint64_t new_size = 0;
+  ASSERT_TRUE(string_->Append(key_, std::string(20000, 'x'), &new_size).ok());
+  expected.append(20000, 'x');
+  EXPECT_EQ(expected.size(), new_size);
+  expect_value(expected);
+
+  ASSERT_TRUE(string_->SetRange(key_, 16000, std::string(1000, 'y'), &new_size).ok());
+  expected.replace(16000, 1000, std::string(1000, 'y'));
+  EXPECT_EQ(expected.size(), new_size);
+  expect_value(expected);
+
+  // The chunks between the end and the offset read as zero bytes
+  ASSERT_TRUE(string_->SetRange(key_, 100000, "end", &new_size).ok());
+  expected.resize(100000, '\0');
+  expected.append("end");
+  EXPECT_EQ(expected.size(), new_size);
+  expect_value(expected);
+  EXPECT_TRUE(is_chunked());
+
+  std::vector<std::string> values;
+  auto statuses = string_->MGet({key_, "test-string-missing"}, &values);
+  ASSERT_TRUE(statuses[0].ok());
+  EXPECT_EQ(expected, values[0]);
+  EXPECT_TRUE(statuses[1].IsNotFound());
+
+  // A short value is stored as a plain string again
+  ASSERT_TRUE(string_->Set(key_, "short").ok());
+  EXPECT_FALSE(is_chunked());
+  expect_value("short");
+  ASSERT_TRUE(string_->Append(key_, std::string(2000, 'z'), &new_size).ok());
+  EXPECT_TRUE(is_chunked());
+  expect_value("short" + std::string(2000, 'z'));
+
+  auto s = string_->Del(key_);
+}
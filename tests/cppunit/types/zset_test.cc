@@ -22,6 +22,7 @@
 
 #include <memory>
 
+#include "storage/iterator.h"
 #include "test_base.h"
 #include "types/redis_zset.h"
 
@@ -613,3 +614,288 @@ TEST_F(RedisZSetTest, DiffStore) {
   s = zset_->Del("zsetdiff");
   EXPECT_TRUE(s.ok());
 }
+
+TEST_F(RedisZSetTest, RankIndex) {
+  config_.zset_rank_index = true;
+
+  uint64_t ret = 0;
+  std::vector<MemberScore> mscores;
+  for (int i = 0; i < 500; i++) {
+    // plenty of ties and both signs of zero to exercise every level of the index
+    double score = (i % 7 == 0) ? ((i % 2) ? -0.0 : 0.0) : (i % 50) * 1.5 - 30;
+    mscores.emplace_back(MemberScore{"member-" + std::to_string(i), score});
+  }
+  auto s = zset_->Add(key_, ZAddFlags::Default(), &mscores, &ret);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(500, ret);
+
+  std::vector<MemberScore> updates = {{"member-1", 1000}, {"member-2", -1000}, {"member-3", 0}};
+  zset_->Add(key_, ZAddFlags::Default(), &updates, &ret);
+  std::vector<Slice> removed_members = {"member-4", "member-5", "member-6"};
+  zset_->Remove(key_, removed_members, &ret);
+  EXPECT_EQ(3, ret);
+
+  // the scan from the lowest score is the source of truth
+  std::vector<MemberScore> all;
+  RangeScoreSpec all_spec;
+  zset_->RangeByScore(key_, all_spec, &all, nullptr);
+  EXPECT_EQ(497, all.size());
+
+  for (size_t i = 0; i < all.size(); i++) {
+    int rank = 0;
+    double score = 0.0;
+    zset_->Rank(key_, all[i].member, false, &rank, &score);
+    EXPECT_EQ(i, rank);
+    zset_->Rank(key_, all[i].member, true, &rank, &score);
+    EXPECT_EQ(all.size() - 1 - i, rank);
+  }
+
+  for (int start : {0, 1, 42, 250, 496}) {
+    RangeRankSpec spec;
+    spec.start = start;
+    spec.stop = start + 10;
+    std::vector<MemberScore> got;
+    zset_->RangeByRank(key_, spec, &got, nullptr);
+    for (size_t i = 0; i < got.size(); i++) {
+      EXPECT_EQ(all[start + i].member, got[i].member);
+    }
+
+    spec.reversed = true;
+    zset_->RangeByRank(key_, spec, &got, nullptr);
+    for (size_t i = 0; i < got.size(); i++) {
+      EXPECT_EQ(all[all.size() - 1 - start - i].member, got[i].member);
+    }
+  }
+
+  std::vector<RangeScoreSpec> count_specs(3);
+  count_specs[0].min = 0;
+  count_specs[0].max = 0;
+  count_specs[1].min = -3;
+  count_specs[1].minex = true;
+  count_specs[1].max = 12;
+  count_specs[2].min = 0;
+  count_specs[2].minex = true;
+  count_specs[2].max = 1000;
+  count_specs[2].maxex = true;
+  for (const auto &spec : count_specs) {
+    uint64_t expected = 0, count = 0;
+    zset_->RangeByScore(key_, spec, nullptr, &expected);
+    zset_->Count(key_, spec, &count);
+    EXPECT_EQ(expected, count);
+  }
+
+  RangeRankSpec rem_spec;
+  rem_spec.start = 100;
+  rem_spec.stop = 199;
+  rem_spec.with_deletion = true;
+  zset_->RangeByRank(key_, rem_spec, nullptr, &ret);
+  EXPECT_EQ(100, ret);
+  all.erase(all.begin() + 100, all.begin() + 200);
+  for (size_t i = 0; i < all.size(); i += 13) {
+    int rank = 0;
+    double score = 0.0;
+    zset_->Rank(key_, all[i].member, false, &rank, &score);
+    EXPECT_EQ(i, rank);
+  }
+
+  s = zset_->Del(key_);
+  EXPECT_TRUE(s.ok());
+  config_.zset_rank_index = false;
+}
+
+TEST_F(RedisZSetTest, RankIndexTies) {
+  config_.zset_rank_index = true;
+
+  // all members share the same score, so they're only told apart by scanning a bucket of the index
+  uint64_t ret = 0;
+  std::vector<MemberScore> mscores;
+  for (int i = 0; i < 300; i++) {
+    std::string member = "m" + std::to_string(i % 30) + std::string(i / 30, 'x');
+    mscores.emplace_back(MemberScore{member, 1.0});
+  }
+  mscores.emplace_back(MemberScore{"", 1.0});
+  auto s = zset_->Add(key_, ZAddFlags::Default(), &mscores, &ret);
+  EXPECT_TRUE(s.ok());
+  EXPECT_EQ(301, ret);
+  std::vector<Slice> removed_members = {"m3", "m7xx", "m12xxxxx"};
+  zset_->Remove(key_, removed_members, &ret);
+  EXPECT_EQ(3, ret);
+
+  std::vector<MemberScore> all;
+  RangeScoreSpec all_spec;
+  zset_->RangeByScore(key_, all_spec, &all, nullptr);
+  EXPECT_EQ(298, all.size());
+
+  for (size_t i = 0; i < all.size(); i++) {
+    int rank = 0;
+    double score = 0.0;
+    zset_->Rank(key_, all[i].member, false, &rank, &score);
+    EXPECT_EQ(i, rank);
+    zset_->Rank(key_, all[i].member, true, &rank, &score);
+    EXPECT_EQ(all.size() - 1 - i, rank);
+
+    RangeRankSpec spec;
+    spec.start = static_cast<int>(i);
+    spec.stop = static_cast<int>(i);
+    std::vector<MemberScore> got;
+    zset_->RangeByRank(key_, spec, &got, nullptr);
+    ASSERT_EQ(1, got.size());
+    EXPECT_EQ(all[i].member, got[0].member);
+  }
+
+  s = zset_->Del(key_);
+  EXPECT_TRUE(s.ok());
+  config_.zset_rank_index = false;
+}
+
+TEST_F(RedisZSetTest, RankIndexWrites) {
+  config_.zset_rank_index = true;
+
+  // a member added to a sorted set rewrites one small entry per level of the index, plus the ones it splits
+  const int n = 2000;
+  uint64_t ret = 0;
+  size_t total_writes = 0;
+  for (int i = 0; i < n; i++) {
+    auto start_seq = storage_->GetDB()->GetLatestSequenceNumber();
+    std::vector<MemberScore> mscores = {{"member-" + std::to_string(i), static_cast<double>(i % 10)}};
+    ASSERT_TRUE(zset_->Add(key_, ZAddFlags::Default(), &mscores, &ret).ok());
+
+    size_t writes = 0;
+    engine::WALIterator iter(storage_.get());
+    for (iter.Seek(start_seq + 1); iter.Valid(); iter.Next()) {
+      auto item = iter.Item();
+      if (item.column_family_id != kColumnFamilyIDZSetRank) continue;
+      if (item.type == engine::WALItem::Type::kTypePut) EXPECT_EQ(sizeof(uint64_t), item.value.size());
+      writes++;
+    }
+    EXPECT_LE(writes, 2 * redis::ZSet::kRankIndexLevels);
+    total_writes += writes;
+  }
+  EXPECT_LE(total_writes, n * (redis::ZSet::kRankIndexLevels + 1));
+
+  std::vector<MemberScore> all;
+  zset_->RangeByScore(key_, RangeScoreSpec(), &all, nullptr);
+  EXPECT_EQ(n, all.size());
+  for (size_t i = 0; i < all.size(); i += 7) {
+    int rank = 0;
+    double score = 0.0;
+    zset_->Rank(key_, all[i].member, false, &rank, &score);
+    EXPECT_EQ(i, rank);
+  }
+
+  auto s = zset_->Del(key_);
+  EXPECT_TRUE(s.ok());
+  config_.zset_rank_index = false;
+}
+
+TEST_F(RedisZSetTest, RankIndexInTransaction) {
+  config_.zset_rank_index = true;
+
+  // the commands of a transaction read the score keys written by the ones before them from its batch
+  uint64_t ret = 0;
+  ASSERT_TRUE(storage_->BeginTxn().IsOK());
+  for (int round = 0; round < 3; round++) {
+    std::vector<MemberScore> mscores;
+    for (int i = 0; i < 200; i++) {
+      auto score = static_cast<double>(i % (round + 3));
+      mscores.emplace_back(MemberScore{"member-" + std::to_string(i * (round + 1)), score});
+    }
+    ASSERT_TRUE(zset_->Add(key_, ZAddFlags::Default(), &mscores, &ret).ok());
+    std::string first = "member-" + std::to_string(round), second = "member-" + std::to_string(round + 10);
+    std::vector<Slice> removed_members = {first, second};
+    ASSERT_TRUE(zset_->Remove(key_, removed_members, &ret).ok());
+  }
+  ASSERT_TRUE(storage_->CommitTxn().IsOK());
+
+  std::vector<MemberScore> all;
+  zset_->RangeByScore(key_, RangeScoreSpec(), &all, nullptr);
+  uint64_t size = 0;
+  zset_->Card(key_, &size);
+  EXPECT_EQ(size, all.size());
+  for (size_t i = 0; i < all.size(); i++) {
+    int rank = 0;
+    double score = 0.0;
+    zset_->Rank(key_, all[i].member, false, &rank, &score);
+    EXPECT_EQ(i, rank);
+  }
+
+  auto s = zset_->Del(key_);
+  EXPECT_TRUE(s.ok());
+  config_.zset_rank_index = false;
+}
+
+TEST_F(RedisZSetTest, InlineEncoding) {
+  config_.inline_collection_max_entries = 16;
+  config_.zset_rank_index = true;
+  auto is_inline = [this] {
+    ZSetMetadata metadata(false);
+    auto s = zset_->Database::GetMetadata({kRedisZSet}, zset_->AppendNamespacePrefix(key_), &metadata);
+    EXPECT_TRUE(s.ok());
+    return metadata.IsInlineEncoded();
+  };
+
+  uint64_t ret = 0;
+  std::vector<MemberScore> mscores;
+  for (size_t i = 0; i < fields_.size(); i++) {
+    mscores.emplace_back(MemberScore{fields_[i].ToString(), scores_[i]});
+  }
+  zset_->Add(key_, ZAddFlags::Default(), &mscores, &ret);
+  EXPECT_EQ(fields_.size(), ret);
+  std::vector<MemberScore> updates = {{fields_[0].ToString(), 200}};
+  zset_->Add(key_, ZAddFlags::Default(), &updates, &ret);
+  EXPECT_TRUE(is_inline());
+
+  double score = 0.0;
+  EXPECT_TRUE(zset_->Score(key_, fields_[0], &score).ok());
+  EXPECT_EQ(score, 200);
+  int rank = 0;
+  zset_->Rank(key_, fields_[0], false, &rank, &score);
+  EXPECT_EQ(rank, fields_.size() - 1);
+  zset_->Rank(key_, fields_[1], false, &rank, &score);
+  EXPECT_EQ(rank, 0);
+
+  RangeRankSpec rank_spec;
+  rank_spec.start = 1;
+  rank_spec.stop = 2;
+  std::vector<MemberScore> got;
+  zset_->RangeByRank(key_, rank_spec, &got, nullptr);
+  ASSERT_EQ(got.size(), 2);
+  EXPECT_EQ(got[0].member, fields_[2].ToString());
+  EXPECT_EQ(got[1].member, fields_[3].ToString());
+
+  RangeScoreSpec score_spec;
+  score_spec.min = 0;
+  score_spec.max = 100;
+  uint64_t count = 0;
+  zset_->Count(key_, score_spec, &count);
+  EXPECT_EQ(count, 3);
+
+  zset_->Pop(key_, 1, false, &got);
+  ASSERT_EQ(got.size(), 1);
+  EXPECT_EQ(got[0].member, fields_[0].ToString());
+  std::vector<Slice> removed = {fields_[1], fields_[2]};
+  zset_->Remove(key_, removed, &ret);
+  EXPECT_EQ(ret, 2);
+  EXPECT_TRUE(is_inline());
+
+  // the members move out of the metadata along with their score keys and rank index
+  mscores.clear();
+  for (int i = 0; i < 20; i++) {
+    mscores.emplace_back(MemberScore{"member-" + std::to_string(i), i * 10.0});
+  }
+  zset_->Add(key_, ZAddFlags::Default(), &mscores, &ret);
+  EXPECT_EQ(ret, 20);
+  EXPECT_FALSE(is_inline());
+
+  std::vector<MemberScore> all;
+  zset_->RangeByScore(key_, RangeScoreSpec(), &all, nullptr);
+  EXPECT_EQ(all.size(), 24);
+  for (size_t i = 0; i < all.size(); i++) {
+    zset_->Rank(key_, all[i].member, false, &rank, &score);
+    EXPECT_EQ(rank, i);
+  }
+
+  auto s = zset_->Del(key_);
+  config_.zset_rank_index = false;
+  config_.inline_collection_max_entries = 0;
+}
@@ -451,3 +451,66 @@ func TestShouldNotReplicate(t *testing.T) {
 		require.Equal(t, "master", util.FindInfoEntry(masterClient, "role"))
 	})
 }
+
+func TestReplicationPublishFromMemory(t *testing.T) {
+	for _, mode := range []string{"memory", "memory-ordered"} {
+		t.Run(fmt.Sprintf("Forward the published messages to replicas in %s mode", mode), func(t *testing.T) {
+			master := util.StartServer(t, map[string]string{"publish-replication-mode": mode})
+			defer master.Close()
+			masterClient := master.NewClient()
+			defer func() { require.NoError(t, masterClient.Close()) }()
+
+			slave := util.StartServer(t, map[string]string{})
+			defer slave.Close()
+			slaveClient := slave.NewClient()
+			defer func() { require.NoError(t, slaveClient.Close()) }()
+
+			subSlave := util.StartServer(t, map[string]string{})
+			defer subSlave.Close()
+			subSlaveClient := subSlave.NewClient()
+			defer func() { require.NoError(t, subSlaveClient.Close()) }()
+
+			ctx := context.Background()
+			util.SlaveOf(t, slaveClient, master)
+			util.WaitForSync(t, slaveClient)
+			util.SlaveOf(t, subSlaveClient, slave)
+			util.WaitForSync(t, subSlaveClient)
+
+			slavePubSub := slaveClient.Subscribe(ctx, "chan")
+			defer func() { require.NoError(t, slavePubSub.Close()) }()
+			subSlavePubSub := subSlaveClient.Subscribe(ctx, "chan")
+			defer func() { require.NoError(t, subSlavePubSub.Close()) }()
+			for _, ps := range []*redis.PubSub{slavePubSub, subSlavePubSub} {
+				_, err := ps.Receive(ctx)
+				require.NoError(t, err)
+			}
+
+			for i := 0; i < 10; i++ {
+				require.NoError(t, masterClient.Set(ctx, "key", i, 0).Err())
+				require.NoError(t, masterClient.Publish(ctx, "chan", strconv.Itoa(i)).Err())
+			}
+			require.NoError(t, masterClient.Publish(ctx, "chan", "").Err())
+
+			for i := 0; i < 10; i++ {
+				msg, err := slavePubSub.ReceiveMessage(ctx)
+				require.NoError(t, err)
+				require.Equal(t, strconv.Itoa(i), msg.Payload)
+				if mode == "memory-ordered" {
+					// The writes before the message must have been replicated
+					value, err := slaveClient.Get(ctx, "key").Int()
+					require.NoError(t, err)
+					require.GreaterOrEqual(t, value, i)
+				}
+
+				msg, err = subSlavePubSub.ReceiveMessage(ctx)
+				require.NoError(t, err)
+				require.Equal(t, strconv.Itoa(i), msg.Payload)
+			}
+			for _, ps := range []*redis.PubSub{slavePubSub, subSlavePubSub} {
+				msg, err := ps.ReceiveMessage(ctx)
+				require.NoError(t, err)
+				require.Equal(t, "", msg.Payload)
+			}
+		})
+	}
+}
@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+package asyncexecution
+
+import (
+	"context"
+	"fmt"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/apache/kvrocks/tests/gocase/util"
+	"github.com/stretchr/testify/require"
+)
+
+func TestAsyncExecution(t *testing.T) {
+	srv := util.StartServer(t, map[string]string{
+		"workers":                 "1",
+		"async-execution-threads": "4",
+	})
+	defer srv.Close()
+
+	ctx := context.Background()
+	rdb := srv.NewClient()
+	defer func() { require.NoError(t, rdb.Close()) }()
+
+	t.Run("Pipelined commands keep the order", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+
+		require.NoError(t, c.WriteArgs("DEL", "async-counter"))
+		for i := 0; i < 100; i++ {
+			require.NoError(t, c.WriteArgs("INCR", "async-counter"))
+			require.NoError(t, c.WriteArgs("PING"))
+			require.NoError(t, c.WriteArgs("GET", "async-counter"))
+		}
+		c.MustRead(t, ":0")
+		for i := 1; i <= 100; i++ {
+			c.MustRead(t, fmt.Sprintf(":%d", i))
+			c.MustRead(t, "+PONG")
+			c.MustRead(t, fmt.Sprintf("$%d", len(fmt.Sprintf("%d", i))))
+			c.MustRead(t, fmt.Sprintf("%d", i))
+		}
+	})
+
+	t.Run("Transactions are executed by the worker", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+
+		require.NoError(t, c.WriteArgs("MULTI"))
+		require.NoError(t, c.WriteArgs("SET", "async-txn", "1"))
+		require.NoError(t, c.WriteArgs("INCR", "async-txn"))
+		require.NoError(t, c.WriteArgs("EXEC"))
+		c.MustRead(t, "+OK")
+		c.MustRead(t, "+QUEUED")
+		c.MustRead(t, "+QUEUED")
+		c.MustRead(t, "*2")
+		c.MustRead(t, "+OK")
+		c.MustRead(t, ":2")
+	})
+
+	t.Run("Concurrent connections on the same worker", func(t *testing.T) {
+		var wg sync.WaitGroup
+		for i := 0; i < 8; i++ {
+			wg.Add(1)
+			go func(i int) {
+				defer wg.Done()
+				c := srv.NewClient()
+				defer func() { require.NoError(t, c.Close()) }()
+
+				key := fmt.Sprintf("async-hash-%d", i)
+				for j := 0; j < 100; j++ {
+					require.NoError(t, c.HSet(ctx, key, fmt.Sprintf("field-%d", j), j).Err())
+				}
+				require.EqualValues(t, 100, c.HLen(ctx, key).Val())
+			}(i)
+		}
+		wg.Wait()
+	})
+
+	t.Run("Killed connections are closed after the async execution", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+
+		require.NoError(t, c.WriteArgs("CLIENT", "ID"))
+		line, err := c.ReadLine()
+		require.NoError(t, err)
+		id := strings.TrimPrefix(line, ":")
+		for i := 0; i < 1000; i++ {
+			require.NoError(t, c.WriteArgs("INCR", "async-killed"))
+		}
+		require.NoError(t, rdb.Do(ctx, "CLIENT", "KILL", "ID", id).Err())
+		require.Eventually(t, func() bool {
+			return !strings.Contains(rdb.ClientList(ctx).Val(), fmt.Sprintf("id=%s ", id))
+		}, 5*time.Second, 100*time.Millisecond)
+		require.Equal(t, "PONG", rdb.Ping(ctx).Val())
+	})
+
+	t.Run("Blocking commands still work", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "async-list").Err())
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+
+		require.NoError(t, c.WriteArgs("BLPOP", "async-list", "0"))
+		require.NoError(t, rdb.RPush(ctx, "async-list", "foo").Err())
+		c.MustRead(t, "*2")
+		c.MustRead(t, "$10")
+		c.MustRead(t, "async-list")
+		c.MustRead(t, "$3")
+		c.MustRead(t, "foo")
+	})
+}
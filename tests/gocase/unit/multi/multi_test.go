@@ -22,6 +22,7 @@ package multi
 import (
 	"context"
 	"fmt"
+	"sync"
 	"testing"
 
 	"github.com/apache/kvrocks/tests/gocase/util"
@@ -322,4 +323,119 @@ func TestMulti(t *testing.T) {
 		require.NoError(t, rdb.Do(ctx, "INCR", "x").Err())
 		require.Equal(t, rdb.Do(ctx, "EXEC").Val(), []interface{}{int64(51)})
 	})
+
+	t.Run("Concurrent transactions on the same keys are isolated", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "txn-a", "txn-b").Err())
+
+		const clients, rounds = 8, 100
+		var wg sync.WaitGroup
+		for i := 0; i < clients; i++ {
+			wg.Add(1)
+			go func() {
+				defer wg.Done()
+				c := srv.NewClient()
+				defer func() { require.NoError(t, c.Close()) }()
+				for j := 0; j < rounds; j++ {
+					var a, b *redis.IntCmd
+					_, err := c.TxPipelined(ctx, func(pipeline redis.Pipeliner) error {
+						a = pipeline.Incr(ctx, "txn-a")
+						b = pipeline.Incr(ctx, "txn-b")
+						return nil
+					})
+					require.NoError(t, err)
+					// Both keys are incremented in the same transaction, so no other
+					// transaction could be interleaved between them.
+					require.Equal(t, a.Val(), b.Val())
+				}
+			}()
+		}
+		wg.Wait()
+
+		require.EqualValues(t, fmt.Sprint(clients*rounds), rdb.Get(ctx, "txn-a").Val())
+		require.EqualValues(t, fmt.Sprint(clients*rounds), rdb.Get(ctx, "txn-b").Val())
+	})
+
+	t.Run("Increments in transactions race with the combined increments", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "txn-incr", "txn-hincr").Err())
+
+		const clients, rounds = 8, 50
+		var wg sync.WaitGroup
+		for i := 0; i < clients; i++ {
+			wg.Add(1)
+			go func() {
+				defer wg.Done()
+				c := srv.NewClient()
+				defer func() { require.NoError(t, c.Close()) }()
+				for j := 0; j < rounds; j++ {
+					var incr, incrby *redis.IntCmd
+					_, err := c.TxPipelined(ctx, func(pipeline redis.Pipeliner) error {
+						incr = pipeline.Incr(ctx, "txn-incr")
+						incrby = pipeline.IncrBy(ctx, "txn-incr", 2)
+						pipeline.HIncrBy(ctx, "txn-hincr", "f", 1)
+						pipeline.HIncrBy(ctx, "txn-hincr", "f", 2)
+						return nil
+					})
+					require.NoError(t, err)
+					require.Equal(t, incr.Val()+2, incrby.Val())
+					// The increments outside transactions may be combined with others
+					require.NoError(t, c.Incr(ctx, "txn-incr").Err())
+					require.NoError(t, c.HIncrBy(ctx, "txn-hincr", "f", 1).Err())
+				}
+			}()
+		}
+		wg.Wait()
+
+		require.Equal(t, fmt.Sprint(clients*rounds*4), rdb.Get(ctx, "txn-incr").Val())
+		require.Equal(t, fmt.Sprint(clients*rounds*4), rdb.HGet(ctx, "txn-hincr", "f").Val())
+	})
+
+	t.Run("Transactions lock the destination keys of the store commands", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "txn-geo", "txn-geo-dst", "txn-zsrc", "txn-zdst").Err())
+		require.NoError(t, rdb.GeoAdd(ctx, "txn-geo",
+			&redis.GeoLocation{Name: "a", Longitude: 13.361389, Latitude: 38.115556},
+			&redis.GeoLocation{Name: "b", Longitude: 15.087269, Latitude: 37.502669}).Err())
+		require.NoError(t, rdb.ZAdd(ctx, "txn-zsrc", redis.Z{Score: 1, Member: "a"}, redis.Z{Score: 2, Member: "b"}).Err())
+
+		ctx, cancel := context.WithCancel(ctx)
+		defer cancel()
+		var wg sync.WaitGroup
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			c := srv.NewClient()
+			defer func() { require.NoError(t, c.Close()) }()
+			// Keep overwriting the destinations outside the transactions
+			for ctx.Err() == nil {
+				c.Del(ctx, "txn-geo-dst", "txn-zdst")
+				c.ZAdd(ctx, "txn-zsrc", redis.Z{Score: 3, Member: "c"})
+				c.ZRem(ctx, "txn-zsrc", "c")
+			}
+		}()
+
+		for i := 0; i < 100; i++ {
+			var geoCard, zCard, stored *redis.IntCmd
+			_, err := rdb.TxPipelined(ctx, func(pipeline redis.Pipeliner) error {
+				pipeline.Do(ctx, "GEORADIUS", "txn-geo", 15, 37, 200, "km", "STORE", "txn-geo-dst")
+				geoCard = pipeline.ZCard(ctx, "txn-geo-dst")
+				stored = pipeline.ZRangeStore(ctx, "txn-zdst", redis.ZRangeArgs{Key: "txn-zsrc", Start: 0, Stop: -1})
+				zCard = pipeline.ZCard(ctx, "txn-zdst")
+				return nil
+			})
+			require.NoError(t, err)
+			require.EqualValues(t, 2, geoCard.Val())
+			require.Equal(t, stored.Val(), zCard.Val())
+		}
+		cancel()
+		wg.Wait()
+	})
+
+	t.Run("Transactions with commands without keys still work", func(t *testing.T) {
+		require.NoError(t, rdb.Set(ctx, "txn-c", "1", 0).Err())
+		require.NoError(t, rdb.Do(ctx, "MULTI").Err())
+		require.NoError(t, rdb.Do(ctx, "INCR", "txn-c").Err())
+		require.NoError(t, rdb.Do(ctx, "DBSIZE").Err())
+		v := rdb.Do(ctx, "EXEC").Val().([]interface{})
+		require.Len(t, v, 2)
+		require.EqualValues(t, 2, v[0])
+	})
 }
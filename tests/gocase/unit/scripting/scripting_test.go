@@ -23,6 +23,7 @@ import (
 	"context"
 	"fmt"
 	"math/big"
+	"sync"
 	"testing"
 
 	"github.com/apache/kvrocks/tests/gocase/util"
@@ -607,3 +608,97 @@ func TestScriptingWithRESP3(t *testing.T) {
 		require.EqualValues(t, []interface{}{"f1", "v1"}, vals)
 	})
 }
+
+func TestScriptingWithStrictKeyAccessing(t *testing.T) {
+	srv := util.StartServer(t, map[string]string{
+		"lua-strict-key-accessing": "yes",
+	})
+	defer srv.Close()
+
+	rdb := srv.NewClient()
+	defer func() {
+		require.NoError(t, rdb.Close())
+	}()
+
+	ctx := context.Background()
+	t.Run("EVAL can access the declared keys", func(t *testing.T) {
+		require.NoError(t, rdb.Set(ctx, "strict-a", "1", 0).Err())
+		val, err := rdb.Eval(ctx, `redis.call('incr', KEYS[1]); return redis.call('get', KEYS[1])`,
+			[]string{"strict-a"}).Result()
+		require.NoError(t, err)
+		require.Equal(t, "2", val)
+	})
+
+	t.Run("EVAL can write the declared keys inside MULTI", func(t *testing.T) {
+		require.NoError(t, rdb.Set(ctx, "strict-a", "1", 0).Err())
+		var eval *redis.Cmd
+		_, err := rdb.TxPipelined(ctx, func(pipeline redis.Pipeliner) error {
+			pipeline.Incr(ctx, "strict-a")
+			eval = pipeline.Eval(ctx, `return redis.call('incr', KEYS[1])`, []string{"strict-a"})
+			return nil
+		})
+		require.NoError(t, err)
+		require.EqualValues(t, 3, eval.Val())
+		require.Equal(t, "3", rdb.Get(ctx, "strict-a").Val())
+	})
+
+	t.Run("EVAL can increment the declared keys", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "strict-incr", "strict-hincr").Err())
+		script := `redis.call('incr', KEYS[1]); redis.call('incrby', KEYS[1], 2);
+			redis.call('hincrby', KEYS[2], 'f', 1); return redis.call('hincrby', KEYS[2], 'f', 2)`
+
+		const clients, rounds = 4, 50
+		var wg sync.WaitGroup
+		for i := 0; i < clients; i++ {
+			wg.Add(1)
+			go func() {
+				defer wg.Done()
+				c := srv.NewClient()
+				defer func() { require.NoError(t, c.Close()) }()
+				for j := 0; j < rounds; j++ {
+					require.NoError(t, c.Eval(ctx, script, []string{"strict-incr", "strict-hincr"}).Err())
+					// The plain increments may be combined with others while the scripts lock the keys
+					require.NoError(t, c.Incr(ctx, "strict-incr").Err())
+					require.NoError(t, c.HIncrBy(ctx, "strict-hincr", "f", 1).Err())
+				}
+			}()
+		}
+		wg.Wait()
+		require.Equal(t, fmt.Sprint(clients*rounds*4), rdb.Get(ctx, "strict-incr").Val())
+		require.Equal(t, fmt.Sprint(clients*rounds*4), rdb.HGet(ctx, "strict-hincr", "f").Val())
+	})
+
+	t.Run("EVAL can't access the undeclared keys", func(t *testing.T) {
+		util.ErrorRegexp(t, rdb.Eval(ctx, `return redis.call('set', 'strict-b', 'x')`, []string{"strict-a"}).Err(),
+			".*not declared in KEYS.*")
+		require.Zero(t, rdb.Exists(ctx, "strict-b").Val())
+		util.ErrorRegexp(t, rdb.Eval(ctx, `return redis.call('flushdb')`, []string{}).Err(),
+			".*not allowed from scripts in the strict key accessing mode.*")
+	})
+
+	t.Run("EVAL_RO is still read-only", func(t *testing.T) {
+		util.ErrorRegexp(t, rdb.EvalRO(ctx, `return redis.call('set', KEYS[1], 'x')`, []string{"strict-a"}).Err(),
+			".*Write commands are not allowed from read-only scripts.*")
+	})
+
+	t.Run("Concurrent EVAL on the same key are isolated", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "strict-counter").Err())
+		script := `local v = tonumber(redis.call('get', KEYS[1]) or '0'); return redis.call('set', KEYS[1], v + 1)`
+
+		const clients, rounds = 8, 100
+		var wg sync.WaitGroup
+		for i := 0; i < clients; i++ {
+			wg.Add(1)
+			go func() {
+				defer wg.Done()
+				c := srv.NewClient()
+				defer func() { require.NoError(t, c.Close()) }()
+				for j := 0; j < rounds; j++ {
+					require.NoError(t, c.Eval(ctx, script, []string{"strict-counter"}).Err())
+				}
+			}()
+		}
+		wg.Wait()
+		require.Equal(t, fmt.Sprint(clients*rounds), rdb.Get(ctx, "strict-counter").Val())
+	})
+}
@@ -1000,3 +1000,52 @@ func TestString(t *testing.T) {
 		require.Equal(t, []redis.LCSMatchedPosition{}, rdb.LCS(ctx, &redis.LCSQuery{Key1: "virus1", Key2: "virus2", Idx: true, WithMatchLen: true}).Val().Matches)
 	})
 }
+
+func TestChunkedString(t *testing.T) {
+	srv := util.StartServer(t, map[string]string{"string-chunk-threshold": "1024"})
+	defer srv.Close()
+	ctx := context.Background()
+	rdb := srv.NewClient()
+	defer func() { require.NoError(t, rdb.Close()) }()
+
+	value := strings.Repeat("abcdefgh", 10000)
+	require.NoError(t, rdb.Set(ctx, "chunked", value, 0).Err())
+
+	t.Run("Read a chunked string", func(t *testing.T) {
+		require.Equal(t, value, rdb.Get(ctx, "chunked").Val())
+		require.EqualValues(t, len(value), rdb.StrLen(ctx, "chunked").Val())
+		require.Equal(t, value[16380:16400], rdb.GetRange(ctx, "chunked", 16380, 16399).Val())
+		require.Equal(t, value[len(value)-4:], rdb.GetRange(ctx, "chunked", -4, -1).Val())
+		require.Equal(t, []interface{}{value, nil}, rdb.MGet(ctx, "chunked", "no-such-key").Val())
+		require.EqualValues(t, 1, rdb.GetBit(ctx, "chunked", 1).Val())
+
+		// The pipelined GET commands are read in a batch
+		pipe := rdb.Pipeline()
+		get := pipe.Get(ctx, "chunked")
+		pipe.Get(ctx, "no-such-key")
+		_, err := pipe.Exec(ctx)
+		require.ErrorIs(t, err, redis.Nil)
+		require.Equal(t, value, get.Val())
+	})
+
+	t.Run("Update a chunked string", func(t *testing.T) {
+		require.EqualValues(t, len(value)+3, rdb.Append(ctx, "chunked", "end").Val())
+		value += "end"
+		require.EqualValues(t, len(value), rdb.SetRange(ctx, "chunked", 16383, "xyz").Val())
+		value = value[:16383] + "xyz" + value[16386:]
+		require.EqualValues(t, 200003, rdb.SetRange(ctx, "chunked", 200000, "far").Val())
+		value += strings.Repeat("\x00", 200000-len(value)) + "far"
+		require.Equal(t, value, rdb.Get(ctx, "chunked").Val())
+
+		require.NoError(t, rdb.Expire(ctx, "chunked", time.Hour).Err())
+		require.NoError(t, rdb.Rename(ctx, "chunked", "renamed").Err())
+		require.Equal(t, value, rdb.Get(ctx, "renamed").Val())
+		require.Greater(t, rdb.TTL(ctx, "renamed").Val(), time.Duration(0))
+	})
+
+	t.Run("Overwrite a chunked string with a short value", func(t *testing.T) {
+		require.NoError(t, rdb.Set(ctx, "renamed", "short", 0).Err())
+		require.Equal(t, "short", rdb.Get(ctx, "renamed").Val())
+		require.EqualValues(t, 5, rdb.StrLen(ctx, "renamed").Val())
+	})
+}
@@ -93,8 +93,8 @@ def check_version(current: str, required: Tuple[int, int, int], prog_name: Optio
     return semver
 
 
-def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: bool, compiler: str, cmake_path: str, D: List[str],
-          skip_build: bool) -> None:
+def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: bool, benchmark: bool, compiler: str,
+          cmake_path: str, D: List[str], skip_build: bool) -> None:
     basedir = Path(__file__).parent.absolute()
 
     find_command("autoconf", msg="autoconf is required to build jemalloc")
@@ -128,6 +128,8 @@ def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: b
     target = ["kvrocks", "kvrocks2redis"]
     if unittest:
         target.append("unittest")
+    if benchmark:
+        target.append("bench")
 
     options = ["--build", "."]
     if jobs is not None:
@@ -359,6 +361,7 @@ if __name__ == '__main__':
                               help='use https://mirror.ghproxy.com to fetch dependencies')
     parser_build.add_argument('--ninja', default=False, action='store_true', help='use Ninja to build kvrocks')
     parser_build.add_argument('--unittest', default=False, action='store_true', help='build unittest target')
+    parser_build.add_argument('--benchmark', default=False, action='store_true', help='build bench target')
     parser_build.add_argument('--compiler', default='auto', choices=('auto', 'gcc', 'clang'),
                               help="compiler used to build kvrocks")
     parser_build.add_argument('--cmake-path', default='cmake', help="path of cmake binary used to build kvrocks")